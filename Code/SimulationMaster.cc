@@ -12,6 +12,7 @@
 #include "util/utilityFunctions.h"
 #include "geometry/GeometryReader.h"
 #include "geometry/LatticeData.h"
+#include "geometry/DistributionMigration.h"
 #include "util/fileutils.h"
 #include "log/Logger.h"
 #include "lb/HFunction.h"
@@ -49,6 +50,9 @@ SimulationMaster::SimulationMaster(hemelb::configuration::CommandLine & options,
   stepManager = NULL;
   netConcern = NULL;
   neighbouringDataManager = NULL;
+  loadMonitor = NULL;
+  stabilityTester = NULL;
+  incompressibilityChecker = NULL;
   imagesPerSimulation = options.NumberOfImages();
   steeringSessionId = options.GetSteeringSessionId();
 
@@ -82,6 +86,29 @@ SimulationMaster::SimulationMaster(hemelb::configuration::CommandLine & options,
 SimulationMaster::~SimulationMaster()
 {
 
+  TearDownDomain();
+  delete stabilityTester;
+  delete incompressibilityChecker;
+  delete network;
+  delete propertyExtractor;
+  delete propertyDataSource;
+  delete simulationState;
+  delete loadMonitor;
+
+  delete simConfig;
+  delete fileManager;
+  if (IsCurrentProcTheIOProc())
+  {
+    delete reporter;
+  }
+}
+
+/**
+ * Deletes everything InitialiseDomain creates, apart from the extraction objects and the
+ * stability and incompressibility testers, which outlive repartitioning.
+ */
+void SimulationMaster::TearDownDomain()
+{
   if (ioComms.OnIORank())
   {
     delete imageSendCpt;
@@ -91,25 +118,25 @@ SimulationMaster::~SimulationMaster()
   delete latticeBoltzmannModel;
   delete inletValues;
   delete outletValues;
-  delete network;
   delete steeringCpt;
   delete visualisationControl;
-  delete propertyExtractor;
-  delete propertyDataSource;
-  delete stabilityTester;
   delete entropyTester;
-  delete simulationState;
-  delete incompressibilityChecker;
   delete neighbouringDataManager;
-
-  delete simConfig;
-  delete fileManager;
-  if (IsCurrentProcTheIOProc())
-  {
-    delete reporter;
-  }
   delete stepManager;
   delete netConcern;
+
+  imageSendCpt = NULL;
+  latticeData = NULL;
+  colloidController = NULL;
+  latticeBoltzmannModel = NULL;
+  inletValues = NULL;
+  outletValues = NULL;
+  steeringCpt = NULL;
+  visualisationControl = NULL;
+  entropyTester = NULL;
+  neighbouringDataManager = NULL;
+  stepManager = NULL;
+  netConcern = NULL;
 }
 
 /**
@@ -141,6 +168,50 @@ void SimulationMaster::Initialise()
   simulationState = new hemelb::lb::SimulationState(simConfig->GetTimeStepLength(),
                                                     simConfig->GetTotalTimeSteps());
 
+  const std::string& siteWeightsPath = simConfig->GetSiteWeightsPath();
+  if (!siteWeightsPath.empty() && hemelb::util::file_exists(siteWeightsPath.c_str()))
+  {
+    siteWeights = hemelb::geometry::decomposition::SiteWeights::Load(siteWeightsPath);
+    hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Using site weights from %s",
+                                                                        siteWeightsPath.c_str());
+  }
+
+  // Initialise and begin the steering.
+  if (ioComms.OnIORank())
+  {
+    network = new hemelb::steering::Network(steeringSessionId, timings);
+  }
+  else
+  {
+    network = NULL;
+  }
+
+  InitialiseDomain(simConfig->GetDecompositionCachePath());
+
+  imagesPeriod = OutputPeriod(imagesPerSimulation);
+
+  if (monitoringConfig->doRebalance)
+  {
+    if (colloidController != NULL)
+    {
+      hemelb::log::Logger::Log<hemelb::log::Warning, hemelb::log::Singleton>("Rebalancing isn't supported with colloids, so the decomposition will stay fixed.");
+    }
+    else
+    {
+      loadMonitor = new hemelb::geometry::decomposition::LoadMonitor(ioComms, timings);
+    }
+  }
+}
+
+/**
+ * Decomposes the domain and sets up everything that depends on the decomposition: the lattice
+ * data, LBM, boundaries, monitoring, visualisation and steering, and the steps each time step
+ * is made of. This is repeated when the domain is repartitioned during the run.
+ *
+ * @param decompositionCachePath Where to cache the decomposition, or empty not to.
+ */
+void SimulationMaster::InitialiseDomain(const std::string& decompositionCachePath)
+{
   hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Initialising LatticeData.");
 
   timings[hemelb::reporting::Timers::latDatInitialise].Start();
@@ -151,13 +222,20 @@ void SimulationMaster::Initialise()
                                           latticeType::GetLatticeInfo(),
                                           timings, ioComms);
   hemelb::geometry::Geometry readGeometryData =
-      reader.LoadAndDecompose(simConfig->GetDataFilePath());
+      reader.LoadAndDecompose(simConfig->GetDataFilePath(),
+                              decompositionCachePath,
+                              simConfig->GetPartitionMethod(),
+                              siteWeights);
 
   // Create a new lattice based on that info and return it.
   latticeData = new hemelb::geometry::LatticeData(latticeType::GetLatticeInfo(), readGeometryData, ioComms);
 
   timings[hemelb::reporting::Timers::latDatInitialise].Stop();
 
+  // The halo exchange partners are fixed from here on, which some point-to-point
+  // implementations can take advantage of.
+  communicationNet.DeclareNeighbourhood(latticeData->GetNeighbouringProcRanks());
+
   neighbouringDataManager =
       new hemelb::geometry::neighbouring::NeighbouringDataManager(*latticeData,
                                                                   latticeData->GetNeighbouringData(),
@@ -199,35 +277,37 @@ void SimulationMaster::Initialise()
   }
   timings[hemelb::reporting::Timers::colloidInitialisation].Stop();
 
-  // Initialise and begin the steering.
-  if (ioComms.OnIORank())
+  // After repartitioning, the testers carry on with what they had worked out so far.
+  if (stabilityTester == NULL)
   {
-    network = new hemelb::steering::Network(steeringSessionId, timings);
+    stabilityTester = new StabilityTesterType(latticeData,
+                                              &communicationNet,
+                                              simulationState,
+                                              propertyCache,
+                                              timings,
+                                              monitoringConfig);
   }
   else
   {
-    network = NULL;
+    stabilityTester->Rebind(latticeData, propertyCache);
   }
-
-  stabilityTester = new hemelb::lb::StabilityTester<latticeType>(latticeData,
-                                                                 &communicationNet,
-                                                                 simulationState,
-                                                                 timings,
-                                                                 monitoringConfig);
   entropyTester = NULL;
 
-  if (monitoringConfig->doIncompressibilityCheck)
+  if (!monitoringConfig->doIncompressibilityCheck)
   {
-    incompressibilityChecker = new hemelb::lb::IncompressibilityChecker<
-        hemelb::net::PhasedBroadcastRegular<> >(latticeData,
-                                                &communicationNet,
-                                                simulationState,
-                                                latticeBoltzmannModel->GetPropertyCache(),
-                                                timings);
+    incompressibilityChecker = NULL;
+  }
+  else if (incompressibilityChecker == NULL)
+  {
+    incompressibilityChecker = new IncompressibilityCheckerType(latticeData,
+                                                                &communicationNet,
+                                                                simulationState,
+                                                                propertyCache,
+                                                                timings);
   }
   else
   {
-    incompressibilityChecker = NULL;
+    incompressibilityChecker->Rebind(latticeData, propertyCache);
   }
 
   hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Initialising visualisation controller.");
@@ -282,28 +362,39 @@ void SimulationMaster::Initialise()
   // Read in the visualisation parameters.
   latticeBoltzmannModel->ReadVisParameters();
 
-  propertyDataSource =
-      new hemelb::extraction::LbDataSourceIterator(latticeBoltzmannModel->GetPropertyCache(),
-                                                   *latticeData,
-                                                   ioComms.Rank(),
-                                                   *unitConverter);
-
-  if (simConfig->PropertyOutputCount() > 0)
+  // The extraction files stay open when the domain is repartitioned, so only where each rank
+  // writes in them changes.
+  if (propertyDataSource != NULL)
   {
-
-    for (unsigned outputNumber = 0; outputNumber < simConfig->PropertyOutputCount(); ++outputNumber)
+    propertyDataSource->Rebind(latticeBoltzmannModel->GetPropertyCache(), *latticeData);
+    if (propertyExtractor != NULL)
     {
-      simConfig->GetPropertyOutput(outputNumber)->filename = fileManager->GetDataExtractionPath()
-          + simConfig->GetPropertyOutput(outputNumber)->filename;
+      propertyExtractor->Redistribute();
     }
-
-    propertyExtractor = new hemelb::extraction::PropertyActor(*simulationState,
-                                                              simConfig->GetPropertyOutputs(),
-                                                              *propertyDataSource,
-                                                              timings, ioComms);
   }
+  else
+  {
+    propertyDataSource =
+        new hemelb::extraction::LbDataSourceIterator(latticeBoltzmannModel->GetPropertyCache(),
+                                                     *latticeData,
+                                                     ioComms.Rank(),
+                                                     *unitConverter);
 
-  imagesPeriod = OutputPeriod(imagesPerSimulation);
+    if (simConfig->PropertyOutputCount() > 0)
+    {
+
+      for (unsigned outputNumber = 0; outputNumber < simConfig->PropertyOutputCount(); ++outputNumber)
+      {
+        simConfig->GetPropertyOutput(outputNumber)->filename = fileManager->GetDataExtractionPath()
+            + simConfig->GetPropertyOutput(outputNumber)->filename;
+      }
+
+      propertyExtractor = new hemelb::extraction::PropertyActor(*simulationState,
+                                                                simConfig->GetPropertyOutputs(),
+                                                                *propertyDataSource,
+                                                                timings, ioComms);
+    }
+  }
 
   stepManager = new hemelb::net::phased::StepManager(2,
                                                      &timings,
@@ -459,6 +550,38 @@ void SimulationMaster::RunSimulation()
   Finalise();
 }
 
+void SimulationMaster::SaveSiteWeights()
+{
+  const std::vector<double> seconds =
+      ioComms.Reduce(latticeBoltzmannModel->GetCollisionSeconds(), MPI_SUM, ioComms.GetIORank());
+  const std::vector<hemelb::site_t> siteUpdates =
+      ioComms.Reduce(latticeBoltzmannModel->GetCollisionSiteUpdates(), MPI_SUM, ioComms.GetIORank());
+
+  if (IsCurrentProcTheIOProc())
+  {
+    std::vector<double> secondsPerSite(seconds.size(), 0.0);
+    for (size_t collisionType = 0; collisionType < seconds.size(); ++collisionType)
+    {
+      if (siteUpdates[collisionType] > 0)
+      {
+        secondsPerSite[collisionType] = seconds[collisionType] / siteUpdates[collisionType];
+      }
+    }
+
+    const hemelb::geometry::decomposition::SiteWeights siteWeights =
+        hemelb::geometry::decomposition::SiteWeights::FromCosts(secondsPerSite);
+    siteWeights.Save(simConfig->GetSiteWeightsPath());
+    hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Saved site weights %i %i %i %i %i %i to %s",
+                                                                        siteWeights[0],
+                                                                        siteWeights[1],
+                                                                        siteWeights[2],
+                                                                        siteWeights[3],
+                                                                        siteWeights[4],
+                                                                        siteWeights[5],
+                                                                        simConfig->GetSiteWeightsPath().c_str());
+  }
+}
+
 void SimulationMaster::Finalise()
 {
   timings[hemelb::reporting::Timers::total].Stop();
@@ -468,6 +591,10 @@ void SimulationMaster::Finalise()
     reporter->FillDictionary();
     reporter->Write();
   }
+  if (simConfig->IsCalibratingSiteWeights())
+  {
+    SaveSiteWeights();
+  }
   // DTMP: Logging output on communication as debug output for now.
   hemelb::log::Logger::Log<hemelb::log::Debug, hemelb::log::OnePerCore>("sync points: %lld, bytes sent: %lld",
                                                                         communicationNet.SyncPointsCounted,
@@ -570,9 +697,79 @@ void SimulationMaster::DoTimeStep()
   {
     fflush(NULL);
   }
+
+  if (loadMonitor != NULL && simulationState->GetTimeStep() % monitoringConfig->rebalancePeriod == 0)
+  {
+    CheckLoadBalance();
+  }
   simulationState->Increment();
 }
 
+void SimulationMaster::CheckLoadBalance()
+{
+  const double imbalance = loadMonitor->MeasureImbalance(*latticeData);
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("time step %i load imbalance (slowest / mean) %.3f",
+                                                                      simulationState->GetTimeStep(),
+                                                                      imbalance);
+  if (imbalance <= monitoringConfig->rebalanceThreshold)
+  {
+    return;
+  }
+
+  // Images take several time steps to produce, so wait until none are in progress.
+  const int imagesInProgress = ioComms.AllReduce(int(writtenImagesCompleted.size()
+                                                     + networkImagesCompleted.size()),
+                                                 MPI_MAX);
+  if (imagesInProgress == 0)
+  {
+    Rebalance();
+  }
+}
+
+void SimulationMaster::Rebalance()
+{
+  timings[hemelb::reporting::Timers::rebalance].Start();
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Repartitioning the domain.");
+
+  siteWeights.SetBlockLoadFactors(loadMonitor->GetBlockLoadFactors(*latticeData, siteWeights));
+  hemelb::geometry::DistributionMigration migration(*latticeData);
+
+  // The stability reduction's results since the testers last collected them, and the velocities
+  // the convergence check compares against, go with the sites.
+  bool unstable, unconverged;
+  std::vector<hemelb::distribn_t> previousVelocities;
+  latticeBoltzmannModel->GetPropertyCache().stabilityReduction.Collect(unstable, unconverged);
+  latticeBoltzmannModel->GetPropertyCache().stabilityReduction.GetPreviousVelocities(previousVelocities);
+#ifdef HEMELB_USE_FUSED_MONITORING
+  if (monitoringConfig->doConvergenceCheck)
+  {
+    migration.AddSiteValues(previousVelocities, 3);
+  }
+#endif
+
+  if (IsCurrentProcTheIOProc())
+  {
+    reporter->RemoveReportable(latticeData);
+  }
+
+  // The decomposition depends on the measured load, so isn't worth caching.
+  TearDownDomain();
+  InitialiseDomain("");
+  migration.MoveTo(*latticeData, ioComms, previousVelocities);
+
+  latticeBoltzmannModel->GetPropertyCache().stabilityReduction.AddResults(unstable, unconverged);
+  latticeBoltzmannModel->GetPropertyCache().stabilityReduction.SetPreviousVelocities(previousVelocities);
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("The property caches and virtual site iolet values start afresh, and are recalculated from the moved distributions on the next time step.");
+
+  if (IsCurrentProcTheIOProc())
+  {
+    reporter->AddReportable(latticeData);
+  }
+
+  timings[hemelb::reporting::Timers::rebalance].Stop();
+  hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Repartitioned the domain.");
+}
+
 void SimulationMaster::RecalculatePropertyRequirements()
 {
   // Get the property cache & reset its list of properties to get.
@@ -10,6 +10,7 @@
 #include "extraction/PropertyActor.h"
 #include "lb/lb.hpp"
 #include "lb/StabilityTester.h"
+#include "lb/CollectiveStabilityTester.h"
 #include "net/net.h"
 #include "steering/ImageSendComponent.h"
 #include "steering/SteeringComponent.h"
@@ -22,10 +23,14 @@
 #include "reporting/Timers.h"
 #include "reporting/BuildInfo.h"
 #include "lb/IncompressibilityChecker.hpp"
+#include "lb/CollectiveIncompressibilityChecker.h"
 #include "colloids/ColloidController.h"
 #include "net/phased/StepManager.h"
 #include "net/phased/NetConcern.h"
 #include "geometry/neighbouring/NeighbouringDataManager.h"
+#include "geometry/decomposition/LoadMonitor.h"
+#include "geometry/decomposition/SiteWeights.h"
+#include "extraction/LbDataSourceIterator.h"
 
 class SimulationMaster
 {
@@ -58,8 +63,20 @@ class SimulationMaster
     hemelb::geometry::neighbouring::NeighbouringDataManager *neighbouringDataManager;
     const hemelb::net::IOCommunicator& ioComms;
 
+    /**
+     * Repartition the domain with the measured loads, carrying on from the current time step.
+     * The state that depends on the decomposition moves with the sites.
+     */
+    void Rebalance();
+
   private:
     void Initialise();
+    void InitialiseDomain(const std::string& decompositionCachePath);
+    void TearDownDomain();
+    /**
+     * Measure the load imbalance between ranks, and repartition the domain if it's too great.
+     */
+    void CheckLoadBalance();
     void SetupReporting(); // set up the reporting file
     unsigned int OutputPeriod(unsigned int frequency);
     void HandleActors();
@@ -77,6 +94,12 @@ class SimulationMaster
      */
     void LogStabilityReport();
 
+    /**
+     * Turn the measured cost of each collision type into site weights and save them, for
+     * later decompositions to use.
+     */
+    void SaveSiteWeights();
+
     hemelb::configuration::SimConfig *simConfig;
     hemelb::io::PathManager* fileManager;
     hemelb::reporting::Timers timings;
@@ -95,10 +118,17 @@ class SimulationMaster
 
     /** Struct containing the configuration of various checkers/testers */
     const hemelb::configuration::SimConfig::MonitoringConfig* monitoringConfig;
-    hemelb::lb::StabilityTester<latticeType>* stabilityTester;
+#ifdef HEMELB_USE_COLLECTIVE_MONITORING
+    typedef hemelb::lb::CollectiveStabilityTester<latticeType> StabilityTesterType;
+    typedef hemelb::lb::CollectiveIncompressibilityChecker IncompressibilityCheckerType;
+#else
+    typedef hemelb::lb::StabilityTester<latticeType> StabilityTesterType;
+    typedef hemelb::lb::IncompressibilityChecker<hemelb::net::PhasedBroadcastRegular<> > IncompressibilityCheckerType;
+#endif
+    StabilityTesterType* stabilityTester;
     hemelb::lb::EntropyTester<latticeType>* entropyTester;
     /** Actor in charge of checking the maximum density difference across the domain */
-    hemelb::lb::IncompressibilityChecker<hemelb::net::PhasedBroadcastRegular<> >* incompressibilityChecker;
+    IncompressibilityCheckerType* incompressibilityChecker;
 
     hemelb::colloids::ColloidController* colloidController;
     hemelb::net::Net communicationNet;
@@ -106,12 +136,16 @@ class SimulationMaster
     const hemelb::util::UnitConverter* unitConverter;
 
     hemelb::vis::Control* visualisationControl;
-    hemelb::extraction::IterableDataSource* propertyDataSource;
+    hemelb::extraction::LbDataSourceIterator* propertyDataSource;
     hemelb::extraction::PropertyActor* propertyExtractor;
 
     hemelb::net::phased::StepManager* stepManager;
     hemelb::net::phased::NetConcern* netConcern;
 
+    //! The weights the domain is decomposed with.
+    hemelb::geometry::decomposition::SiteWeights siteWeights;
+    hemelb::geometry::decomposition::LoadMonitor* loadMonitor;
+
     unsigned int imagesPerSimulation;
     int steeringSessionId;
     unsigned int imagesPeriod;
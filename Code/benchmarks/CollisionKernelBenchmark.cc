@@ -0,0 +1,257 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "benchmarks/CollisionKernelBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "lb/lattices/Lattices.h"
+#include "lb/kernels/Kernels.h"
+#include "lb/kernels/momentBasis/MomentBases.h"
+#include "lb/LbmParameters.h"
+#include "reporting/Timers.h"
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    namespace
+    {
+      /**
+       * Fill the distributions with something near equilibrium that differs from site to site.
+       */
+      template<class Lattice>
+      void InitialiseDistributions(std::vector<distribn_t>& fOld, unsigned siteCount)
+      {
+        fOld.resize(siteCount * Lattice::NUMVECTORS);
+        for (unsigned site = 0; site < siteCount; ++site)
+        {
+          distribn_t density = 1.0 + 0.01 * (site % 17) / 17.0;
+          distribn_t momentum_x = 0.001 * (site % 5), momentum_y = -0.002 * (site % 3), momentum_z = 0.0005
+              * (site % 7);
+          Lattice::CalculateFeq(density, momentum_x, momentum_y, momentum_z, &fOld[site * Lattice::NUMVECTORS]);
+          for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+          {
+            fOld[site * Lattice::NUMVECTORS + direction] *= 1.0 + 1e-3 * ( (site + direction) % 11);
+          }
+        }
+      }
+
+      /**
+       * The same distributions in the structure-of-arrays layout: each direction's values for
+       * all the sites, one after another.
+       */
+      template<class Lattice>
+      void ToPlanes(const std::vector<distribn_t>& fOld, std::vector<distribn_t>& planes, unsigned siteCount)
+      {
+        planes.resize(fOld.size());
+        for (unsigned site = 0; site < siteCount; ++site)
+        {
+          for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+          {
+            planes[direction * siteCount + site] = fOld[site * Lattice::NUMVECTORS + direction];
+          }
+        }
+      }
+
+      /**
+       * Where each site's distribution in each direction streams to: the neighbouring site in
+       * that direction, as if the sites were a periodic box of width 16 along x, numbered in x,
+       * y, z order, which is how the lattice data's bulk sites are usually laid out.
+       */
+      template<class Lattice>
+      void InitialiseStreamingTargets(std::vector<site_t>& targets, unsigned siteCount)
+      {
+        const int width = 16;
+        targets.resize(siteCount * Lattice::NUMVECTORS);
+        for (unsigned site = 0; site < siteCount; ++site)
+        {
+          for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+          {
+            const long neighbour = long(site) + Lattice::CX[direction]
+                + width * (Lattice::CY[direction] + width * Lattice::CZ[direction]);
+            targets[site * Lattice::NUMVECTORS + direction] = ( (neighbour % long(siteCount)
+                + siteCount) % siteCount) * Lattice::NUMVECTORS + direction;
+          }
+        }
+      }
+
+      /**
+       * One site at a time. With planes, fOld is in the structure-of-arrays layout, so each
+       * site's distributions are gathered first, as Site::GetFOld does.
+       */
+      template<class Kernel>
+      double TimeSingleSite(Kernel& kernel, const lb::LbmParameters& lbmParams,
+                            const std::vector<distribn_t>& fOld, std::vector<distribn_t>& fNew,
+                            const std::vector<site_t>& targets, unsigned siteCount,
+                            unsigned iterations, bool planes)
+      {
+        typedef typename Kernel::LatticeType Lattice;
+        distribn_t gathered[Lattice::NUMVECTORS];
+        reporting::Timer timer;
+        timer.Start();
+        for (unsigned iteration = 0; iteration < iterations; ++iteration)
+        {
+          for (unsigned site = 0; site < siteCount; ++site)
+          {
+            if (planes)
+            {
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                gathered[direction] = fOld[direction * siteCount + site];
+              }
+            }
+            lb::kernels::HydroVars<Kernel> hydroVars(planes ?
+              gathered :
+              &fOld[site * Lattice::NUMVECTORS]);
+            hydroVars.tau = lbmParams.GetTau();
+            kernel.CalculateDensityMomentumFeq(hydroVars, site);
+            kernel.Collide(&lbmParams, hydroVars);
+            for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+            {
+              fNew[targets[site * Lattice::NUMVECTORS + direction]] = hydroVars.GetFPostCollision()[direction];
+            }
+          }
+        }
+        timer.Stop();
+        return timer.Get();
+      }
+
+      /**
+       * As the streamer does it: collide a batch, then unpack each site's results into its own
+       * HydroVars to stream from. With planes, fOld is in the structure-of-arrays layout, so
+       * the batch is read a direction at a time, as LatticeData::GetFOldForSites does.
+       */
+      template<class Kernel>
+      double TimeBatched(Kernel& kernel, const lb::LbmParameters& lbmParams,
+                         const std::vector<distribn_t>& fOld, std::vector<distribn_t>& fNew,
+                         const std::vector<site_t>& targets, unsigned siteCount,
+                         unsigned iterations, bool planes)
+      {
+        typedef typename Kernel::LatticeType Lattice;
+        typedef typename Kernel::KHydroVarsBatch Batch;
+        Batch batch;
+        distribn_t laneFOld[Lattice::NUMVECTORS];
+        reporting::Timer timer;
+        timer.Start();
+        for (unsigned iteration = 0; iteration < iterations; ++iteration)
+        {
+          for (unsigned firstSite = 0; firstSite < siteCount; firstSite += Batch::WIDTH)
+          {
+            batch.siteCount = std::min<unsigned>(Batch::WIDTH, siteCount - firstSite);
+            if (planes)
+            {
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                for (unsigned lane = 0; lane < batch.siteCount; ++lane)
+                {
+                  batch.f[direction][lane] = fOld[direction * siteCount + firstSite + lane];
+                }
+              }
+            }
+            else
+            {
+              for (unsigned lane = 0; lane < batch.siteCount; ++lane)
+              {
+                batch.SetF(lane, &fOld[ (firstSite + lane) * Lattice::NUMVECTORS]);
+              }
+            }
+            batch.PadUnusedLanes();
+
+            kernel.CalculateDensityMomentumFeqBatch(batch);
+            kernel.CollideBatch(&lbmParams, batch);
+
+            for (unsigned lane = 0; lane < batch.siteCount; ++lane)
+            {
+              const unsigned site = firstSite + lane;
+              batch.GetF(lane, laneFOld);
+              lb::kernels::HydroVars<Kernel> hydroVars(laneFOld);
+              hydroVars.tau = lbmParams.GetTau();
+              batch.Unpack(lane, hydroVars);
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                fNew[targets[site * Lattice::NUMVECTORS + direction]] = hydroVars.GetFPostCollision()[direction];
+              }
+            }
+          }
+        }
+        timer.Stop();
+        return timer.Get();
+      }
+
+      template<class Kernel>
+      void RunOne(std::ostream& out, const std::string& name, unsigned siteCount, unsigned iterations)
+      {
+        typedef typename Kernel::LatticeType Lattice;
+
+        // Time step and voxel size chosen to give tau of about 0.62.
+        lb::LbmParameters lbmParams(1e-4, 1e-4);
+        lb::kernels::InitParams initParams;
+        initParams.lbmParams = &lbmParams;
+        Kernel kernel(initParams);
+
+        std::vector<distribn_t> fOld, planes, fSingle(siteCount * Lattice::NUMVECTORS), fBatched(siteCount
+            * Lattice::NUMVECTORS);
+        InitialiseDistributions<Lattice>(fOld, siteCount);
+        ToPlanes<Lattice>(fOld, planes, siteCount);
+        std::vector<site_t> targets;
+        InitialiseStreamingTargets<Lattice>(targets, siteCount);
+
+        double singleTime = TimeSingleSite(kernel, lbmParams, fOld, fSingle, targets, siteCount, iterations, false);
+        double batchedTime = TimeBatched(kernel, lbmParams, fOld, fBatched, targets, siteCount, iterations, false);
+
+        distribn_t maxDifference = 0.0;
+        for (unsigned i = 0; i < fSingle.size(); ++i)
+        {
+          maxDifference = std::max(maxDifference, std::abs(fSingle[i] - fBatched[i]));
+        }
+
+        double planesSingleTime = TimeSingleSite(kernel, lbmParams, planes, fSingle, targets, siteCount, iterations,
+                                                 true);
+        double planesBatchedTime = TimeBatched(kernel, lbmParams, planes, fBatched, targets, siteCount, iterations,
+                                               true);
+        for (unsigned i = 0; i < fSingle.size(); ++i)
+        {
+          maxDifference = std::max(maxDifference, std::abs(fSingle[i] - fBatched[i]));
+        }
+
+        double updates = double(siteCount) * double(iterations) / 1e6;
+        out << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(12) << updates / singleTime << std::setw(12) << updates / batchedTime << std::setw(10)
+            << singleTime / batchedTime << std::setw(12) << updates / planesSingleTime << std::setw(12)
+            << updates / planesBatchedTime << std::setw(10) << planesSingleTime / planesBatchedTime
+            << std::scientific << std::setprecision(1) << std::setw(12) << maxDifference << std::endl;
+      }
+    }
+
+    void RunCollisionKernelBenchmarks(std::ostream& out, unsigned siteCount, unsigned iterations)
+    {
+      using namespace lb::lattices;
+      using namespace lb::kernels;
+
+      out << "Collision kernels: " << siteCount << " sites x " << iterations << " iterations, batch width "
+          << util::SimdDouble::WIDTH << std::endl;
+      out << std::left << std::setw(16) << "kernel" << std::right << std::setw(12) << "single" << std::setw(12)
+          << "batched" << std::setw(10) << "speedup" << std::setw(12) << "soa single" << std::setw(12)
+          << "soa batched" << std::setw(10) << "speedup" << std::setw(12) << "max diff" << std::endl;
+      out << std::left << std::setw(16) << "" << std::right << std::setw(12) << "(Mlups)" << std::setw(12)
+          << "(Mlups)" << std::setw(10) << "" << std::setw(12) << "(Mlups)" << std::setw(12) << "(Mlups)"
+          << std::endl;
+
+      RunOne<LBGK<D3Q15> >(out, "LBGK D3Q15", siteCount, iterations);
+      RunOne<LBGK<D3Q19> >(out, "LBGK D3Q19", siteCount, iterations);
+      RunOne<LBGK<D3Q27> >(out, "LBGK D3Q27", siteCount, iterations);
+      RunOne<LBGK<D3Q15i> >(out, "LBGK D3Q15i", siteCount, iterations);
+      RunOne<TRT<D3Q15> >(out, "TRT D3Q15", siteCount, iterations);
+      RunOne<TRT<D3Q19> >(out, "TRT D3Q19", siteCount, iterations);
+      RunOne<TRT<D3Q27> >(out, "TRT D3Q27", siteCount, iterations);
+      RunOne<MRT<momentBasis::DHumieresD3Q15MRTBasis> >(out, "MRT D3Q15", siteCount, iterations);
+      RunOne<MRT<momentBasis::DHumieresD3Q19MRTBasis> >(out, "MRT D3Q19", siteCount, iterations);
+    }
+  }
+}
@@ -0,0 +1,34 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_BENCHMARKS_COLLISIONKERNELBENCHMARK_H
+#define HEMELB_BENCHMARKS_COLLISIONKERNELBENCHMARK_H
+
+#include <ostream>
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    /**
+     * Time the per-site and the batched (SIMD) collision paths of the LBGK, TRT and MRT kernels
+     * on each lattice they support, and write a table of site updates per second to the stream.
+     *
+     * Each measurement is a whole stream-and-collide over an array of siteCount sites, repeated
+     * iterations times: the per-site HydroVars, the density/momentum/equilibrium calculation,
+     * the collision and streaming to the neighbouring sites. The batched path also unpacks each
+     * site's results from the batch, as the streamer has to. Both are timed again with the
+     * distributions in the structure-of-arrays layout: gathered site by site for the per-site
+     * path, and read a direction at a time for the batched one.
+     *
+     * @param out
+     * @param siteCount
+     * @param iterations
+     */
+    void RunCollisionKernelBenchmarks(std::ostream& out, unsigned siteCount, unsigned iterations);
+  }
+}
+
+#endif /* HEMELB_BENCHMARKS_COLLISIONKERNELBENCHMARK_H */
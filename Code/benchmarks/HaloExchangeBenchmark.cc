@@ -0,0 +1,119 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "benchmarks/HaloExchangeBenchmark.h"
+
+#include <iomanip>
+#include <set>
+#include <string>
+#include <vector>
+#include "net/net.h"
+#include "reporting/Timers.h"
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    namespace
+    {
+      /**
+       * A Net with the given point-to-point implementation and the usual collectives.
+       */
+      template<class PointPoint>
+      class BenchmarkNet : public PointPoint,
+                           public net::InterfaceDelegationNet,
+                           public net::SeparatedAllToAll,
+                           public net::SeparatedGathers
+      {
+        public:
+          BenchmarkNet(const net::MpiCommunicator& comms) :
+              net::BaseNet(comms), net::StoringNet(comms), PointPoint(comms),
+                  net::InterfaceDelegationNet(comms), net::SeparatedAllToAll(comms),
+                  net::SeparatedGathers(comms)
+          {
+          }
+      };
+
+      template<class PointPoint>
+      void RunOne(std::ostream& out, const std::string& name, const net::MpiCommunicator& comms,
+                  const std::vector<proc_t>& neighbours, unsigned haloSize, unsigned iterations)
+      {
+        BenchmarkNet<PointPoint> net(comms);
+        net.DeclareNeighbourhood(neighbours);
+
+        std::vector<std::vector<distribn_t> > sendBuffers(neighbours.size(),
+                                                          std::vector<distribn_t>(haloSize, comms.Rank()));
+        std::vector<std::vector<distribn_t> > receiveBuffers(neighbours.size(),
+                                                             std::vector<distribn_t>(haloSize, -1));
+
+        reporting::Timer timer;
+        // One untimed exchange, so that anything built on first use isn't counted.
+        for (unsigned iteration = 0; iteration <= iterations; ++iteration)
+        {
+          if (iteration == 1)
+          {
+            timer.Start();
+          }
+          for (size_t neighbour = 0; neighbour < neighbours.size(); ++neighbour)
+          {
+            net.RequestReceiveV(receiveBuffers[neighbour], neighbours[neighbour]);
+            net.RequestSendV(sendBuffers[neighbour], neighbours[neighbour]);
+          }
+          net.Dispatch();
+        }
+        timer.Stop();
+
+        int wrong = 0;
+        for (size_t neighbour = 0; neighbour < neighbours.size(); ++neighbour)
+        {
+          if (receiveBuffers[neighbour].front() != neighbours[neighbour]
+              || receiveBuffers[neighbour].back() != neighbours[neighbour])
+          {
+            ++wrong;
+          }
+        }
+
+        const double slowest = comms.AllReduce(timer.Get(), MPI_MAX);
+        wrong = comms.AllReduce(wrong, MPI_SUM);
+        if (comms.Rank() == 0)
+        {
+          out << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(14) << iterations / slowest << std::setw(14) << 1e6 * slowest / iterations
+              << std::setw(8) << (wrong == 0 ?
+                "ok" :
+                "WRONG") << std::endl;
+        }
+      }
+    }
+
+    void RunHaloExchangeBenchmarks(std::ostream& out, const net::MpiCommunicator& comms,
+                                   unsigned haloSize, unsigned neighbourCount, unsigned iterations)
+    {
+      // Neighbours either side in a ring, which is symmetric, as the lattice's halo is.
+      std::set<proc_t> ring;
+      for (unsigned distance = 1; distance <= neighbourCount; ++distance)
+      {
+        ring.insert( (comms.Rank() + distance) % comms.Size());
+        ring.insert( (comms.Rank() + comms.Size() - distance % comms.Size()) % comms.Size());
+      }
+      ring.erase(comms.Rank());
+      const std::vector<proc_t> neighbours(ring.begin(), ring.end());
+
+      if (comms.Rank() == 0)
+      {
+        out << "Halo exchange: " << comms.Size() << " ranks, up to " << 2 * neighbourCount << " neighbours x "
+            << haloSize << " distributions, " << iterations << " iterations" << std::endl;
+        out << std::left << std::setw(16) << "pointpoint" << std::right << std::setw(14) << "exchanges/s"
+            << std::setw(14) << "us/exchange" << std::setw(8) << "check" << std::endl;
+      }
+
+      RunOne<net::SeparatedPointPoint>(out, "Separated", comms, neighbours, haloSize, iterations);
+      RunOne<net::CoalescePointPoint>(out, "Coalesce", comms, neighbours, haloSize, iterations);
+      RunOne<net::PersistentPointPoint>(out, "Persistent", comms, neighbours, haloSize, iterations);
+      RunOne<net::NeighbourhoodPointPoint>(out, "Neighbourhood", comms, neighbours, haloSize, iterations);
+    }
+  }
+}
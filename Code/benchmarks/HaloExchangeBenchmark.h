@@ -0,0 +1,40 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_BENCHMARKS_HALOEXCHANGEBENCHMARK_H
+#define HEMELB_BENCHMARKS_HALOEXCHANGEBENCHMARK_H
+
+#include <ostream>
+#include "net/MpiCommunicator.h"
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    /**
+     * Time a halo-like exchange through the Net with each of the point-to-point implementations
+     * (Separated, Coalesce, Persistent and Neighbourhood), and write a table of exchanges per
+     * second to the stream on rank 0.
+     *
+     * Each rank exchanges haloSize distributions with each of up to neighbourCount ranks either
+     * side of it in a ring, in one message per neighbour, as LatticeData does, re-requesting
+     * the exchange every iteration. The time is the slowest rank's. Immediate is left out: its
+     * blocking sends would deadlock on a ring.
+     *
+     * This is collective over the communicator.
+     *
+     * @param out
+     * @param comms
+     * @param haloSize
+     * @param neighbourCount
+     * @param iterations
+     */
+    void RunHaloExchangeBenchmarks(std::ostream& out, const net::MpiCommunicator& comms,
+                                   unsigned haloSize, unsigned neighbourCount, unsigned iterations);
+  }
+}
+
+#endif /* HEMELB_BENCHMARKS_HALOEXCHANGEBENCHMARK_H */
@@ -0,0 +1,181 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "benchmarks/XdrBenchmark.h"
+
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "io/writers/xdr/XdrMemReader.h"
+#include "io/writers/xdr/XdrMemWriter.h"
+#include "reporting/Timers.h"
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    namespace
+    {
+      using io::writers::xdr::XdrMemReader;
+      using io::writers::xdr::XdrMemWriter;
+
+      /**
+       * The reader and writer methods for each type.
+       */
+      template<typename T>
+      struct XdrMethods;
+
+      template<>
+      struct XdrMethods<uint32_t>
+      {
+          static bool ReadOne(XdrMemReader& reader, uint32_t& value)
+          {
+            return reader.readUnsignedInt(value);
+          }
+          static bool ReadMany(XdrMemReader& reader, uint32_t* values, size_t count)
+          {
+            return reader.readUnsignedInts(values, count);
+          }
+          static bool WriteMany(XdrMemWriter& writer, const uint32_t* values, size_t count)
+          {
+            return writer.writeUnsignedInts(values, count);
+          }
+      };
+
+      template<>
+      struct XdrMethods<uint64_t>
+      {
+          static bool ReadOne(XdrMemReader& reader, uint64_t& value)
+          {
+            return reader.readUnsignedLong(value);
+          }
+          static bool ReadMany(XdrMemReader& reader, uint64_t* values, size_t count)
+          {
+            return reader.readUnsignedLongs(values, count);
+          }
+          static bool WriteMany(XdrMemWriter& writer, const uint64_t* values, size_t count)
+          {
+            return writer.writeUnsignedLongs(values, count);
+          }
+      };
+
+      template<>
+      struct XdrMethods<float>
+      {
+          static bool ReadOne(XdrMemReader& reader, float& value)
+          {
+            return reader.readFloat(value);
+          }
+          static bool ReadMany(XdrMemReader& reader, float* values, size_t count)
+          {
+            return reader.readFloats(values, count);
+          }
+          static bool WriteMany(XdrMemWriter& writer, const float* values, size_t count)
+          {
+            return writer.writeFloats(values, count);
+          }
+      };
+
+      template<>
+      struct XdrMethods<double>
+      {
+          static bool ReadOne(XdrMemReader& reader, double& value)
+          {
+            return reader.readDouble(value);
+          }
+          static bool ReadMany(XdrMemReader& reader, double* values, size_t count)
+          {
+            return reader.readDoubles(values, count);
+          }
+          static bool WriteMany(XdrMemWriter& writer, const double* values, size_t count)
+          {
+            return writer.writeDoubles(values, count);
+          }
+      };
+
+      template<typename T>
+      void RunOne(std::ostream& out, const std::string& name, unsigned valueCount,
+                  unsigned iterations)
+      {
+        typedef XdrMethods<T> Methods;
+
+        std::vector<T> values(valueCount);
+        for (unsigned i = 0; i < valueCount; ++i)
+        {
+          values[i] = T(i * 2654435761u % 1000003u) / T(7);
+        }
+        // Every type here is stored in XDR in as many bytes as in memory.
+        std::vector<char> singleBuffer(sizeof(T) * valueCount), bulkBuffer(singleBuffer.size());
+        std::vector<T> singleValues(valueCount), bulkValues(valueCount);
+
+        reporting::Timer singleWriteTimer, bulkWriteTimer, singleReadTimer, bulkReadTimer;
+        for (unsigned iteration = 0; iteration < iterations; ++iteration)
+        {
+          singleWriteTimer.Start();
+          {
+            XdrMemWriter writer(&singleBuffer[0], singleBuffer.size());
+            for (unsigned i = 0; i < valueCount; ++i)
+            {
+              writer << values[i];
+            }
+          }
+          singleWriteTimer.Stop();
+
+          bulkWriteTimer.Start();
+          {
+            XdrMemWriter writer(&bulkBuffer[0], bulkBuffer.size());
+            Methods::WriteMany(writer, &values[0], valueCount);
+          }
+          bulkWriteTimer.Stop();
+
+          singleReadTimer.Start();
+          {
+            XdrMemReader reader(&singleBuffer[0], singleBuffer.size());
+            for (unsigned i = 0; i < valueCount; ++i)
+            {
+              Methods::ReadOne(reader, singleValues[i]);
+            }
+          }
+          singleReadTimer.Stop();
+
+          bulkReadTimer.Start();
+          {
+            XdrMemReader reader(&bulkBuffer[0], bulkBuffer.size());
+            Methods::ReadMany(reader, &bulkValues[0], valueCount);
+          }
+          bulkReadTimer.Stop();
+        }
+
+        const bool same = singleBuffer == bulkBuffer && singleValues == values
+            && bulkValues == values;
+
+        const double mega = double(valueCount) * double(iterations) / 1e6;
+        out << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << mega / singleWriteTimer.Get() << std::setw(12)
+            << mega / bulkWriteTimer.Get() << std::setw(12) << mega / singleReadTimer.Get()
+            << std::setw(12) << mega / bulkReadTimer.Get() << std::setw(8)
+            << (same ?
+              "yes" :
+              "NO") << std::endl;
+      }
+    }
+
+    void RunXdrBenchmarks(std::ostream& out, unsigned valueCount, unsigned iterations)
+    {
+      out << "XDR in memory: " << valueCount << " values x " << iterations << " iterations"
+          << std::endl;
+      out << std::left << std::setw(10) << "type" << std::right << std::setw(12) << "write" << std::setw(12)
+          << "bulk write" << std::setw(12) << "read" << std::setw(12) << "bulk read" << std::setw(8)
+          << "same" << std::endl;
+      out << std::left << std::setw(10) << "" << std::right << std::setw(12) << "(M/s)" << std::setw(12)
+          << "(M/s)" << std::setw(12) << "(M/s)" << std::setw(12) << "(M/s)" << std::endl;
+
+      RunOne<uint32_t>(out, "uint32", valueCount, iterations);
+      RunOne<uint64_t>(out, "uint64", valueCount, iterations);
+      RunOne<float>(out, "float", valueCount, iterations);
+      RunOne<double>(out, "double", valueCount, iterations);
+    }
+  }
+}
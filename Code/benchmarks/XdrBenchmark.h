@@ -0,0 +1,29 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_BENCHMARKS_XDRBENCHMARK_H
+#define HEMELB_BENCHMARKS_XDRBENCHMARK_H
+
+#include <ostream>
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    /**
+     * Time encoding arrays of each basic type to XDR in memory, and decoding them again, value
+     * by value (through XdrMemWriter's operator<< and XdrMemReader's read methods) and in bulk
+     * (through the array methods), and write a table of millions of values per second to the
+     * stream. Also checks that both ways give the same bytes and values.
+     *
+     * @param out
+     * @param valueCount The length of each array.
+     * @param iterations
+     */
+    void RunXdrBenchmarks(std::ostream& out, unsigned valueCount, unsigned iterations);
+  }
+}
+
+#endif /* HEMELB_BENCHMARKS_XDRBENCHMARK_H */
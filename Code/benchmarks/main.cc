@@ -0,0 +1,58 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cstdlib>
+#include <iostream>
+#include <unistd.h>
+#include "net/mpi.h"
+#include "log/Logger.h"
+#include "net/MpiCommunicator.h"
+#include "benchmarks/CollisionKernelBenchmark.h"
+#include "benchmarks/HaloExchangeBenchmark.h"
+#include "benchmarks/XdrBenchmark.h"
+
+int main(int argc, char **argv)
+{
+  // Start MPI and the logger; the kernel benchmarks are serial, the exchange ones use every rank.
+  hemelb::net::MpiEnvironment mpi(argc, argv);
+  hemelb::log::Logger::Init();
+
+  unsigned siteCount = 4096;
+  unsigned iterations = 200;
+  unsigned haloSize = 1024;
+  unsigned neighbourCount = 3;
+  unsigned valueCount = 1 << 20;
+  int opt;
+  while ( (opt = getopt(argc, argv, "s:i:h:n:v:")) != -1)
+  {
+    switch (opt)
+    {
+      case 's':
+        siteCount = std::atoi(optarg);
+        break;
+      case 'i':
+        iterations = std::atoi(optarg);
+        break;
+      case 'h':
+        haloSize = std::atoi(optarg);
+        break;
+      case 'n':
+        neighbourCount = std::atoi(optarg);
+        break;
+      case 'v':
+        valueCount = std::atoi(optarg);
+        break;
+    }
+  }
+
+  hemelb::net::MpiCommunicator world = hemelb::net::MpiCommunicator::World();
+  if (world.Rank() == 0)
+  {
+    hemelb::benchmarks::RunCollisionKernelBenchmarks(std::cout, siteCount, iterations);
+    hemelb::benchmarks::RunXdrBenchmarks(std::cout, valueCount, iterations);
+  }
+  hemelb::benchmarks::RunHaloExchangeBenchmarks(std::cout, world, haloSize, neighbourCount, iterations);
+  return 0;
+}
@@ -74,6 +74,7 @@ hemelb_option(HEMELB_VALIDATE_GEOMETRY "Validate geometry" OFF)
 hemelb_option(HEMELB_BUILD_TESTS_ALL "Build all the tests" ON)
 hemelb_option(HEMELB_BUILD_TESTS_UNIT "Build the unit-tests (HEMELB_BUILD_TESTS_ALL takes precedence)" ON)
 hemelb_option(HEMELB_BUILD_TESTS_FUNCTIONAL "Build the functional tests (HEMELB_BUILD_TESTS_ALL takes precedence)" ON)
+hemelb_option(HEMELB_BUILD_BENCHMARKS "Build the kernel micro-benchmarks" OFF)
 hemelb_option(HEMELB_USE_ALL_WARNINGS_GNU "Show all compiler warnings on development builds (gnu-style-compilers)" ON)
 hemelb_option(HEMELB_USE_STREAKLINES "Calculate streakline images" OFF)
 hemelb_option(HEMELB_DEPENDENCIES_SET_RPATH "Set runtime RPATH" ON)
@@ -82,8 +83,20 @@ hemelb_option(HEMELB_WAIT_ON_CONNECT "Wait for steering client" OFF)
 hemelb_option(HEMELB_BUILD_MULTISCALE "Build HemeLB Multiscale functionality" OFF)
 hemelb_option(HEMELB_IMAGES_TO_NULL "Write images to null" OFF)
 hemelb_option(HEMELB_USE_SSE3 "Use SSE3 intrinsics" ON)
+hemelb_option(HEMELB_USE_AVX2 "Use AVX2 intrinsics in the batched collision kernels" OFF)
+hemelb_option(HEMELB_USE_AVX512 "Use AVX-512 intrinsics in the batched collision kernels" OFF)
+hemelb_option(HEMELB_USE_BATCHED_COLLISIONS "Collide several sites at once with the kernels' vectorised paths, where the kernel has one" OFF)
+hemelb_option(HEMELB_USE_SOA_DISTRIBUTIONS "Store the distributions for each direction contiguously (structure-of-arrays)" OFF)
+hemelb_option(HEMELB_USE_AA_STREAMING "Stream in place with the AA pattern, keeping a single distribution array" OFF)
+hemelb_option(HEMELB_USE_FLOAT_DISTRIBUTIONS "Store the distributions in single precision, still computing in double precision" OFF)
+hemelb_option(HEMELB_USE_SHIFTED_DISTRIBUTIONS "Store single-precision distributions as departures from the initial equilibrium, for accuracy (needs HEMELB_USE_FLOAT_DISTRIBUTIONS)" OFF)
+hemelb_option(HEMELB_USE_OPENMP "Use OpenMP threads within each MPI rank for the lattice-Boltzmann site loops" OFF)
+hemelb_option(HEMELB_USE_FUSED_MONITORING "Check stability and convergence in the collision loop rather than with another sweep of the distributions" OFF)
+hemelb_option(HEMELB_USE_COLLECTIVE_MONITORING "Combine the ranks' stability and incompressibility results with a non-blocking all-reduce every step rather than a tree of messages" OFF)
 hemelb_option(HEMELB_USE_VELOCITY_WEIGHTS_FILE "Use Velocity weights file" OFF)
 hemelb_option(UBUNTU_BUG_WORKAROUND "Work around the faulty HAVE_ISNAN value in Ubuntu 16.04." OFF)
+hemelb_option(HEMELB_USE_SHARED_MEMORY_HALO "Exchange distributions with ranks on the same node through a shared-memory window rather than messages" OFF)
+hemelb_option(HEMELB_USE_ASYNC_EXTRACTION_OUTPUT "Write extracted properties with non-blocking MPI-IO, filling a second buffer while the previous write completes" OFF)
 hemelb_option(HEMELB_SEPARATE_CONCERNS "Communicate for each concern separately" OFF)
 
 #
@@ -93,6 +106,8 @@ hemelb_cachevar(HEMELB_EXECUTABLE "hemelb"
   STRING "File name of executable to produce")
 hemelb_cachevar(HEMELB_READING_GROUP_SIZE 5
   INTEGER "Number of cores to use to read geometry file.")
+hemelb_cachevar(HEMELB_EXTRACTION_WRITERS_PER_NODE 0
+  INTEGER "Number of cores on each node to write extracted properties for the others (0 for every core to write its own)")
 hemelb_cachevar(HEMELB_LOG_LEVEL Info
   STRING "Log level, choose 'Critical', 'Error', 'Warning', 'Info', 'Debug' or 'Trace'" )
 hemelb_cachevar(HEMELB_STEERING_LIB basic
@@ -120,7 +135,7 @@ hemelb_cachevar(HEMELB_WALL_INLET_BOUNDARY "NASHZEROTHORDERPRESSURESBB"
 hemelb_cachevar(HEMELB_WALL_OUTLET_BOUNDARY "NASHZEROTHORDERPRESSURESBB"
   STRING "Select the boundary conditions to be used at corners between walls and outlets (NASHZEROTHORDERPRESSURESBB,NASHZEROTHORDERPRESSUREBFL,LADDIOLETSBB,LADDIOLETBFL)")
 hemelb_cachevar(HEMELB_POINTPOINT_IMPLEMENTATION Coalesce
-  STRING "Point to point comms implementation, choose 'Coalesce', 'Separated', or 'Immediate'" )
+  STRING "Point to point comms implementation, choose 'Coalesce', 'Persistent', 'Neighbourhood', 'Separated', or 'Immediate'" )
 hemelb_cachevar(HEMELB_GATHERS_IMPLEMENTATION Separated
   STRING "Gather comms implementation, choose 'Separated', or 'ViaPointPoint'" )
 hemelb_cachevar(HEMELB_ALLTOALL_IMPLEMENTATION Separated
@@ -26,8 +26,10 @@ namespace hemelb
     }
 
     SimConfig::SimConfig(const std::string& path) :
-        xmlFilePath(path), rawXmlDoc(NULL), hasColloidSection(false), warmUpSteps(0),
-            unitConverter(NULL)
+        xmlFilePath(path), rawXmlDoc(NULL),
+            partitionMethod(geometry::decomposition::ParMetisPartition), calibrateSiteWeights(false),
+            hasColloidSection(false),
+            warmUpSteps(0), unitConverter(NULL)
     {
     }
     void SimConfig::Init()
@@ -153,11 +155,48 @@ namespace hemelb
       // Required element
       // <geometry>
       //  <datafile path="relative path to GMY" />
+      //  <decomposition method="parmetis|hilbert|morton" /> (optional, default parmetis)
+      //  <decompositioncache path="relative path to a cached decomposition" /> (optional)
+      //  <siteweights path="relative path to site weights" calibrate="true|false" /> (optional)
       // </geometry>
       dataFilePath = geometryEl.GetChildOrThrow("datafile").GetAttributeOrThrow("path");
       // Convert to a full path
       dataFilePath = util::NormalizePathRelativeToPath(dataFilePath, xmlFilePath);
 
+      const io::xml::Element decompositionEl = geometryEl.GetChildOrNull("decomposition");
+      if (decompositionEl != io::xml::Element::Missing())
+      {
+        const std::string& method = decompositionEl.GetAttributeOrThrow("method");
+        if (method == "hilbert")
+        {
+          partitionMethod = geometry::decomposition::HilbertCurvePartition;
+        }
+        else if (method == "morton")
+        {
+          partitionMethod = geometry::decomposition::MortonCurvePartition;
+        }
+        else if (method != "parmetis")
+        {
+          throw Exception() << "Invalid decomposition method '" << method
+              << "' - must be parmetis, hilbert or morton";
+        }
+      }
+
+      const io::xml::Element cacheEl = geometryEl.GetChildOrNull("decompositioncache");
+      if (cacheEl != io::xml::Element::Missing())
+      {
+        decompositionCachePath = util::NormalizePathRelativeToPath(cacheEl.GetAttributeOrThrow("path"),
+                                                                   xmlFilePath);
+      }
+
+      const io::xml::Element siteWeightsEl = geometryEl.GetChildOrNull("siteweights");
+      if (siteWeightsEl != io::xml::Element::Missing())
+      {
+        siteWeightsPath = util::NormalizePathRelativeToPath(siteWeightsEl.GetAttributeOrThrow("path"),
+                                                            xmlFilePath);
+        const std::string* calibrate = siteWeightsEl.GetAttributeOrNull("calibrate");
+        calibrateSiteWeights = (calibrate != NULL && *calibrate == "true");
+      }
     }
 
     void SimConfig::CreateUnitConverter()
@@ -324,6 +363,39 @@ namespace hemelb
 
       propertyoutputEl.GetAttributeOrThrow("period", file->frequency);
 
+      const std::string* format = propertyoutputEl.GetAttributeOrNull("format");
+      if (format != NULL)
+      {
+        if (*format == "chunked")
+        {
+          file->chunked = true;
+        }
+        else if (*format != "records")
+        {
+          throw Exception() << "Unrecognised property output format '" << *format << "' in element "
+              << propertyoutputEl.GetPath();
+        }
+      }
+
+      const std::string* compression = propertyoutputEl.GetAttributeOrNull("compression");
+      if (compression != NULL)
+      {
+        if (!file->chunked)
+        {
+          throw Exception() << "Only the chunked property output format can be compressed, in element "
+              << propertyoutputEl.GetPath();
+        }
+        if (*compression == "zlib")
+        {
+          file->compression = io::formats::extraction::ZlibCompression;
+        }
+        else if (*compression != "none")
+        {
+          throw Exception() << "Unrecognised compression '" << *compression << "' in element "
+              << propertyoutputEl.GetPath();
+        }
+      }
+
       io::xml::Element geometryEl = propertyoutputEl.GetChildOrThrow("geometry");
       const std::string& type = geometryEl.GetAttributeOrThrow("type");
 
@@ -355,7 +427,15 @@ namespace hemelb
 
       for (io::xml::ChildIterator fieldPtr = propertyoutputEl.IterChildren("field");
           !fieldPtr.AtEnd(); ++fieldPtr)
+      {
         file->fields.push_back(DoIOForPropertyField(*fieldPtr));
+        if (file->fields.back().encoding != io::formats::extraction::Float32Encoding
+            && !file->chunked)
+        {
+          throw Exception() << "Only the chunked property output format can reduce the precision, in element "
+              << fieldPtr->GetPath();
+        }
+      }
 
       return file;
     }
@@ -469,6 +549,24 @@ namespace hemelb
       {
         throw Exception() << "Unrecognised field type '" << type << "' in " << fieldEl.GetPath();
       }
+
+      const std::string* precision = fieldEl.GetAttributeOrNull("precision");
+      if (precision != NULL)
+      {
+        if (*precision == "half")
+        {
+          field.encoding = io::formats::extraction::Float16Encoding;
+        }
+        else if (*precision == "quantised")
+        {
+          field.encoding = io::formats::extraction::QuantisedEncoding;
+        }
+        else if (*precision != "single")
+        {
+          throw Exception() << "Unrecognised field precision '" << *precision << "' in "
+              << fieldEl.GetPath();
+        }
+      }
       return field;
     }
 
@@ -652,6 +750,20 @@ namespace hemelb
 
       monitoringConfig.doIncompressibilityCheck = (monEl.GetChildOrNull("incompressibility")
           != io::xml::Element::Missing());
+
+      // <rebalance period="1000" threshold="1.2" /> (optional)
+      io::xml::Element rebalanceEl = monEl.GetChildOrNull("rebalance");
+      if (rebalanceEl != io::xml::Element::Missing())
+      {
+        monitoringConfig.doRebalance = true;
+        rebalanceEl.GetAttributeOrThrow("period", monitoringConfig.rebalancePeriod);
+        rebalanceEl.GetAttributeOrThrow("threshold", monitoringConfig.rebalanceThreshold);
+        if (monitoringConfig.rebalancePeriod == 0 || monitoringConfig.rebalanceThreshold <= 1.0)
+        {
+          throw Exception() << "Invalid rebalance settings in " << rebalanceEl.GetPath()
+              << " - the period must be positive and the threshold greater than 1";
+        }
+      }
     }
 
     void SimConfig::DoIOForSteadyFlowConvergence(const io::xml::Element& convEl)
@@ -14,6 +14,7 @@
 #include "extraction/PropertyOutputFile.h"
 #include "extraction/GeometrySelectors.h"
 #include "io/xml/XmlAbstractionLayer.h"
+#include "geometry/decomposition/PartitionMethod.h"
 
 namespace hemelb
 {
@@ -42,7 +43,8 @@ namespace hemelb
         {
             MonitoringConfig() :
                 doConvergenceCheck(false), convergenceRelativeTolerance(0), convergenceTerminate(false),
-                    doIncompressibilityCheck(false)
+                    doIncompressibilityCheck(false), doRebalance(false), rebalancePeriod(0),
+                    rebalanceThreshold(0)
             {
             }
             bool doConvergenceCheck; ///< Whether to turn on the convergence check or not
@@ -51,6 +53,9 @@ namespace hemelb
             double convergenceRelativeTolerance; ///< Convergence check relative tolerance
             bool convergenceTerminate; ///< Whether to terminate a converged run or not
             bool doIncompressibilityCheck; ///< Whether to turn on the IncompressibilityChecker or not
+            bool doRebalance; ///< Whether to repartition the domain when the load becomes unbalanced
+            LatticeTimeStep rebalancePeriod; ///< How many time steps between checks of the load balance
+            double rebalanceThreshold; ///< The ratio of the slowest rank's time to the mean that triggers repartitioning
         };
 
         static SimConfig* New(const std::string& path);
@@ -109,6 +114,40 @@ namespace hemelb
         {
           return dataFilePath;
         }
+        /**
+         * How the geometry is to be divided between the ranks.
+         * @return
+         */
+        geometry::decomposition::PartitionMethod GetPartitionMethod() const
+        {
+          return partitionMethod;
+        }
+        /**
+         * The file a decomposition of the geometry is cached in, or empty if there's none.
+         * @return
+         */
+        const std::string & GetDecompositionCachePath() const
+        {
+          return decompositionCachePath;
+        }
+        /**
+         * The file of site weights to balance the decomposition with, or empty to use the
+         * compiled-in weights.
+         * @return
+         */
+        const std::string & GetSiteWeightsPath() const
+        {
+          return siteWeightsPath;
+        }
+        /**
+         * Whether to measure the cost of each collision type during the run and save the
+         * resulting site weights to GetSiteWeightsPath().
+         * @return
+         */
+        bool IsCalibratingSiteWeights() const
+        {
+          return calibrateSiteWeights;
+        }
         LatticeTimeStep GetTotalTimeSteps() const
         {
           return totalTimeSteps;
@@ -270,6 +309,10 @@ namespace hemelb
         const std::string& xmlFilePath;
         io::xml::Document* rawXmlDoc;
         std::string dataFilePath;
+        std::string decompositionCachePath;
+        geometry::decomposition::PartitionMethod partitionMethod;
+        std::string siteWeightsPath;
+        bool calibrateSiteWeights;
 
         util::Vector3D<float> visualisationCentre;
         float visualisationLongitude;
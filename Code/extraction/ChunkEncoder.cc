@@ -0,0 +1,220 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "extraction/ChunkEncoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <zlib.h>
+#include "Exception.h"
+#include "io/writers/xdr/XdrByteOrder.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    ChunkEncoder::ChunkEncoder(io::formats::extraction::Compression compression) :
+        compression(compression)
+    {
+    }
+
+    void ChunkEncoder::Reset()
+    {
+      data.clear();
+    }
+
+    void ChunkEncoder::AppendPosition(const util::Vector3D<site_t>& position)
+    {
+      AppendUint32(uint32_t(position.x));
+      AppendUint32(uint32_t(position.y));
+      AppendUint32(uint32_t(position.z));
+    }
+
+    void ChunkEncoder::AppendField(io::formats::extraction::FieldEncoding encoding,
+                                   const std::vector<FloatingType>& values, double offset)
+    {
+      switch (encoding)
+      {
+        case io::formats::extraction::Float32Encoding:
+          singles.resize(values.size());
+          for (size_t i = 0; i < values.size(); ++i)
+          {
+            singles[i] = float(values[i] - offset);
+          }
+          AppendWords<uint32_t>(reinterpret_cast<const char*>(&singles[0]), singles.size());
+          break;
+        case io::formats::extraction::Float16Encoding:
+          halves.resize(values.size());
+          for (size_t i = 0; i < values.size(); ++i)
+          {
+            halves[i] = ToHalf(float(values[i] - offset));
+          }
+          AppendWords<uint16_t>(reinterpret_cast<const char*>(&halves[0]), halves.size());
+          break;
+        case io::formats::extraction::QuantisedEncoding:
+        {
+          // The range of the finite values, which share out all but the top level.
+          double least = 0.0;
+          double greatest = 0.0;
+          bool anyFinite = false;
+          for (size_t i = 0; i < values.size(); ++i)
+          {
+            const double value = values[i] - offset;
+            if (std::fabs(value) <= std::numeric_limits<double>::max())
+            {
+              least = anyFinite ? std::min(least, value) : value;
+              greatest = anyFinite ? std::max(greatest, value) : value;
+              anyFinite = true;
+            }
+          }
+          AppendDouble(least);
+          AppendDouble(greatest);
+
+          const double topLevel = io::formats::extraction::QuantisedNonFiniteLevel - 1;
+          const double scale = greatest > least ?
+            topLevel / (greatest - least) :
+            0.0;
+          halves.resize(values.size());
+          for (size_t i = 0; i < values.size(); ++i)
+          {
+            const double value = values[i] - offset;
+            // Rounding the greatest value would take it just past the top level.
+            halves[i] = std::fabs(value) <= std::numeric_limits<double>::max() ?
+              uint16_t(std::min( (value - least) * scale + 0.5, topLevel)) :
+              uint16_t(io::formats::extraction::QuantisedNonFiniteLevel);
+          }
+          AppendWords<uint16_t>(reinterpret_cast<const char*>(&halves[0]), halves.size());
+          break;
+        }
+        default:
+          throw Exception() << "Unrecognised field encoding " << encoding;
+      }
+    }
+
+    void ChunkEncoder::Finish(uint32_t siteCount, std::vector<char>& buffer)
+    {
+      const unsigned char* stored = data.empty() ?
+        NULL :
+        &data[0];
+      uLongf storedLength = data.size();
+
+      if (compression == io::formats::extraction::ZlibCompression && !data.empty())
+      {
+        compressed.resize(compressBound(data.size()));
+        uLongf compressedLength = compressed.size();
+        // Favour speed: this is on the critical path of every output step.
+        const int ret = compress2(&compressed[0],
+                                  &compressedLength,
+                                  stored,
+                                  data.size(),
+                                  Z_BEST_SPEED);
+        if (ret != Z_OK)
+        {
+          throw Exception() << "Compressing extraction data failed with zlib error " << ret;
+        }
+        // Small or noisy chunks can come out longer; those are stored as they are, which the
+        // stored length being the raw length marks.
+        if (compressedLength < storedLength)
+        {
+          stored = &compressed[0];
+          storedLength = compressedLength;
+        }
+      }
+
+      // Header, then data padded to a multiple of four bytes.
+      const size_t start = buffer.size();
+      const size_t paddedLength = (storedLength + 3) / 4 * 4;
+      buffer.resize(start + io::formats::extraction::ChunkHeaderLength + paddedLength, 0);
+
+      const uint32_t header[3] = { siteCount, uint32_t(storedLength), uint32_t(data.size()) };
+      io::writers::xdr::CopyConvertingByteOrder<uint32_t>(reinterpret_cast<const char*>(header),
+                                                          &buffer[start],
+                                                          3);
+      if (storedLength > 0)
+      {
+        std::memcpy(&buffer[start + io::formats::extraction::ChunkHeaderLength], stored, storedLength);
+      }
+    }
+
+    uint16_t ChunkEncoder::ToHalf(float value)
+    {
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+
+      const uint16_t sign = (bits >> 16) & 0x8000;
+      const uint32_t floatExponent = (bits >> 23) & 0xff;
+      uint32_t mantissa = bits & 0x7fffff;
+
+      if (floatExponent == 0xff)
+      {
+        // Infinity, or NaN, which must keep a mantissa bit.
+        return sign | 0x7c00 | (mantissa ?
+          0x200 :
+          0);
+      }
+
+      const int exponent = int(floatExponent) - 127 + 15;
+      if (exponent >= 0x1f)
+      {
+        return sign | 0x7c00;
+      }
+
+      if (exponent <= 0)
+      {
+        // Subnormal in half precision, or too small even for that.
+        if (exponent < -10)
+        {
+          return sign;
+        }
+        mantissa |= 0x800000;
+        const unsigned shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ( (1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1)))
+        {
+          // May carry into the smallest normal number, which is right.
+          ++half;
+        }
+        return sign | half;
+      }
+
+      uint32_t half = (uint32_t(exponent) << 10) | (mantissa >> 13);
+      const uint32_t remainder = mantissa & 0x1fff;
+      if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+      {
+        // May carry into the exponent, up to infinity, which is right.
+        ++half;
+      }
+      return sign | half;
+    }
+
+    void ChunkEncoder::AppendUint32(uint32_t value)
+    {
+      AppendWords<uint32_t>(reinterpret_cast<const char*>(&value), 1);
+    }
+
+    void ChunkEncoder::AppendDouble(double value)
+    {
+      AppendWords<uint64_t>(reinterpret_cast<const char*>(&value), 1);
+    }
+
+    template<typename Word>
+    void ChunkEncoder::AppendWords(const char* words, size_t count)
+    {
+      const size_t start = data.size();
+      data.resize(start + count * sizeof(Word));
+      if (count > 0)
+      {
+        io::writers::xdr::CopyConvertingByteOrder<Word>(words,
+                                                        reinterpret_cast<char*>(&data[start]),
+                                                        count);
+      }
+    }
+  }
+}
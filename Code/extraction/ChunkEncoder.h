@@ -0,0 +1,92 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_CHUNKENCODER_H
+#define HEMELB_EXTRACTION_CHUNKENCODER_H
+
+#include <vector>
+#include "io/formats/extraction.h"
+#include "extraction/IterableDataSource.h"
+#include "util/Vector3D.h"
+#include "units.h"
+
+namespace hemelb
+{
+  namespace extraction
+  {
+    /**
+     * Builds up one core's chunk of a block of the chunked extraction format (see
+     * io::formats::extraction::ChunkedVersionNumber): first the data, then the chunk as a whole,
+     * compressed.
+     */
+    class ChunkEncoder
+    {
+      public:
+        ChunkEncoder(io::formats::extraction::Compression compression);
+
+        /**
+         * Start a new chunk.
+         */
+        void Reset();
+
+        /**
+         * Add a site's position, for a grid block.
+         * @param position
+         */
+        void AppendPosition(const util::Vector3D<site_t>& position);
+
+        /**
+         * Add a field's values at every site of the chunk, for a values block.
+         * @param encoding
+         * @param values The values of every component at each site in turn.
+         * @param offset Subtracted from every value.
+         */
+        void AppendField(io::formats::extraction::FieldEncoding encoding,
+                         const std::vector<FloatingType>& values, double offset);
+
+        /**
+         * Add the whole chunk, with its header, to the end of the buffer.
+         * @param siteCount
+         * @param buffer
+         */
+        void Finish(uint32_t siteCount, std::vector<char>& buffer);
+
+        /**
+         * Convert to IEEE half precision, rounding to the nearest. Values too large become
+         * infinite.
+         * @param value
+         * @return The bits of the half-precision value.
+         */
+        static uint16_t ToHalf(float value);
+
+      private:
+        void AppendUint32(uint32_t value);
+        void AppendDouble(double value);
+
+        /**
+         * Append an array of words, converting them to XDR's byte order all at once.
+         * @param words Need not be aligned.
+         * @param count
+         */
+        template<typename Word>
+        void AppendWords(const char* words, size_t count);
+
+        const io::formats::extraction::Compression compression;
+
+        //! The chunk's data, before compression.
+        std::vector<unsigned char> data;
+
+        //! The chunk's data, compressed.
+        std::vector<unsigned char> compressed;
+
+        //! A field's values, encoded but in the host's byte order.
+        std::vector<float> singles;
+        std::vector<uint16_t> halves;
+    };
+  }
+}
+
+#endif /* HEMELB_EXTRACTION_CHUNKENCODER_H */
@@ -5,6 +5,7 @@
 // license in the file LICENSE.
 
 #include "extraction/IterableDataSource.h"
+#include "Exception.h"
 
 namespace hemelb
 {
@@ -14,5 +15,82 @@ namespace hemelb
     {
 
     }
+
+    void IterableDataSource::GetFieldValues(OutputField::FieldType field,
+                                            const std::vector<site_t>& siteIndices,
+                                            std::vector<FloatingType>& values)
+    {
+      values.clear();
+
+      Reset();
+      site_t siteIndex = 0;
+      std::vector<site_t>::const_iterator nextIndex = siteIndices.begin();
+      while (nextIndex != siteIndices.end() && ReadNext())
+      {
+        if (siteIndex == *nextIndex)
+        {
+          AppendCurrentFieldValues(field, values);
+          ++nextIndex;
+        }
+        ++siteIndex;
+      }
+    }
+
+    void IterableDataSource::AppendCurrentFieldValues(OutputField::FieldType field,
+                                                      std::vector<FloatingType>& values) const
+    {
+      switch (field)
+      {
+        case OutputField::Pressure:
+          values.push_back(GetPressure());
+          break;
+        case OutputField::Velocity:
+        {
+          const util::Vector3D<FloatingType> velocity = GetVelocity();
+          values.push_back(velocity.x);
+          values.push_back(velocity.y);
+          values.push_back(velocity.z);
+          break;
+        }
+        case OutputField::ShearStress:
+          values.push_back(GetShearStress());
+          break;
+        case OutputField::VonMisesStress:
+          values.push_back(GetVonMisesStress());
+          break;
+        case OutputField::ShearRate:
+          values.push_back(GetShearRate());
+          break;
+        case OutputField::StressTensor:
+        {
+          util::Matrix3D tensor = GetStressTensor();
+          values.push_back(tensor[0][0]);
+          values.push_back(tensor[0][1]);
+          values.push_back(tensor[0][2]);
+          values.push_back(tensor[1][1]);
+          values.push_back(tensor[1][2]);
+          values.push_back(tensor[2][2]);
+          break;
+        }
+        case OutputField::Traction:
+        {
+          const util::Vector3D<PhysicalStress> traction = GetTraction();
+          values.push_back(traction.x);
+          values.push_back(traction.y);
+          values.push_back(traction.z);
+          break;
+        }
+        case OutputField::TangentialProjectionTraction:
+        {
+          const util::Vector3D<PhysicalStress> traction = GetTangentialProjectionTraction();
+          values.push_back(traction.x);
+          values.push_back(traction.y);
+          values.push_back(traction.z);
+          break;
+        }
+        default:
+          throw Exception() << "Field " << field << " isn't available from the data source";
+      }
+    }
   }
 }
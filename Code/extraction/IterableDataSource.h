@@ -7,9 +7,12 @@
 #ifndef HEMELB_EXTRACTION_ITERABLEDATASOURCE_H
 #define HEMELB_EXTRACTION_ITERABLEDATASOURCE_H
 
+#include <string>
+#include <vector>
 #include "util/Vector3D.h"
 #include "units.h"
 #include "util/Matrix3D.h"
+#include "extraction/OutputField.h"
 
 namespace hemelb
 {
@@ -92,6 +95,24 @@ namespace hemelb
          */
         virtual util::Vector3D<PhysicalStress> GetTangentialProjectionTraction() const = 0;
 
+        /**
+         * Gets a field's values at several sites at once, so that a whole field can be written
+         * in one pass. The sites are given by their indices in the order ReadNext visits them,
+         * in ascending order. The values are stored site by site, with each site's components
+         * consecutive: three for vectors and six for the stress tensor (the upper triangular
+         * part, row-wise). The pressure doesn't have the reference pressure subtracted.
+         *
+         * The default implementation goes through the sites with ReadNext, so it leaves the
+         * iteration wherever it finished.
+         *
+         * @param field Any field but MpiRank, which isn't a property of the data source.
+         * @param siteIndices
+         * @param values Resized to hold the values.
+         */
+        virtual void GetFieldValues(OutputField::FieldType field,
+                                    const std::vector<site_t>& siteIndices,
+                                    std::vector<FloatingType>& values);
+
         /**
          * Resets the iterator to the beginning again.
          */
@@ -132,6 +153,15 @@ namespace hemelb
          * @return whether there is a boundary site at location
          */
         virtual bool IsWallSite(const util::Vector3D<site_t>& location) const = 0;
+
+      private:
+        /**
+         * Append the field's values at the current site.
+         * @param field
+         * @param values
+         */
+        void AppendCurrentFieldValues(OutputField::FieldType field,
+                                      std::vector<FloatingType>& values) const;
     };
   }
 }
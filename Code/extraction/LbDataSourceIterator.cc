@@ -5,6 +5,7 @@
 // license in the file LICENSE.
 
 #include "extraction/LbDataSourceIterator.h"
+#include "Exception.h"
 
 namespace hemelb
 {
@@ -14,16 +15,24 @@ namespace hemelb
                                                const geometry::LatticeData& data,
                                                int rank_,
                                                const util::UnitConverter& converter) :
-        propertyCache(propertyCache), data(data), rank(rank_), converter(converter), position(-1)
+        propertyCache(&propertyCache), data(&data), rank(rank_), converter(converter), position(-1)
     {
 
     }
 
+    void LbDataSourceIterator::Rebind(const lb::MacroscopicPropertyCache& newPropertyCache,
+                                      const geometry::LatticeData& newData)
+    {
+      propertyCache = &newPropertyCache;
+      data = &newData;
+      position = -1;
+    }
+
     bool LbDataSourceIterator::ReadNext()
     {
       ++position;
 
-      if (position >= data.GetLocalFluidSiteCount())
+      if (position >= data->GetLocalFluidSiteCount())
       {
         return false;
       }
@@ -33,48 +42,139 @@ namespace hemelb
 
     util::Vector3D<site_t> LbDataSourceIterator::GetPosition() const
     {
-      return data.GetSite(position).GetGlobalSiteCoords();
+      return data->GetSite(position).GetGlobalSiteCoords();
     }
 
     FloatingType LbDataSourceIterator::GetPressure() const
     {
-      return converter.ConvertPressureToPhysicalUnits(propertyCache.densityCache.Get(position) * Cs2);
+      return converter.ConvertPressureToPhysicalUnits(propertyCache->densityCache.Get(position) * Cs2);
     }
 
     util::Vector3D<FloatingType> LbDataSourceIterator::GetVelocity() const
     {
-      return converter.ConvertVelocityToPhysicalUnits(propertyCache.velocityCache.Get(position));
+      return converter.ConvertVelocityToPhysicalUnits(propertyCache->velocityCache.Get(position));
     }
 
     FloatingType LbDataSourceIterator::GetShearStress() const
     {
-      return converter.ConvertStressToPhysicalUnits(propertyCache.wallShearStressMagnitudeCache.Get(position));
+      return converter.ConvertStressToPhysicalUnits(propertyCache->wallShearStressMagnitudeCache.Get(position));
     }
 
     FloatingType LbDataSourceIterator::GetVonMisesStress() const
     {
-      return converter.ConvertStressToPhysicalUnits(propertyCache.vonMisesStressCache.Get(position));
+      return converter.ConvertStressToPhysicalUnits(propertyCache->vonMisesStressCache.Get(position));
     }
 
     FloatingType LbDataSourceIterator::GetShearRate() const
     {
-      return converter.ConvertShearRateToPhysicalUnits(propertyCache.shearRateCache.Get(position));
+      return converter.ConvertShearRateToPhysicalUnits(propertyCache->shearRateCache.Get(position));
     }
 
     util::Matrix3D LbDataSourceIterator::GetStressTensor() const
     {
-      return converter.ConvertFullStressTensorToPhysicalUnits(propertyCache.stressTensorCache.Get(position));
+      return converter.ConvertFullStressTensorToPhysicalUnits(propertyCache->stressTensorCache.Get(position));
     }
 
     util::Vector3D<PhysicalStress> LbDataSourceIterator::GetTraction() const
     {
-      return converter.ConvertTractionToPhysicalUnits(propertyCache.tractionCache.Get(position),
-                                                      data.GetSite(position).GetWallNormal());
+      return converter.ConvertTractionToPhysicalUnits(propertyCache->tractionCache.Get(position),
+                                                      data->GetSite(position).GetWallNormal());
     }
 
     util::Vector3D<PhysicalStress> LbDataSourceIterator::GetTangentialProjectionTraction() const
     {
-      return converter.ConvertStressToPhysicalUnits(propertyCache.tangentialProjectionTractionCache.Get(position));
+      return converter.ConvertStressToPhysicalUnits(propertyCache->tangentialProjectionTractionCache.Get(position));
+    }
+
+    void LbDataSourceIterator::GetFieldValues(OutputField::FieldType field,
+                                              const std::vector<site_t>& siteIndices,
+                                              std::vector<FloatingType>& values)
+    {
+      const size_t siteCount = siteIndices.size();
+      switch (field)
+      {
+        case OutputField::Pressure:
+          values.resize(siteCount);
+          for (size_t i = 0; i < siteCount; ++i)
+          {
+            values[i] = converter.ConvertPressureToPhysicalUnits(propertyCache->densityCache.Get(siteIndices[i])
+                * Cs2);
+          }
+          break;
+        case OutputField::Velocity:
+          values.resize(3 * siteCount);
+          for (size_t i = 0; i < siteCount; ++i)
+          {
+            const util::Vector3D<FloatingType> velocity =
+                converter.ConvertVelocityToPhysicalUnits(propertyCache->velocityCache.Get(siteIndices[i]));
+            values[3 * i] = velocity.x;
+            values[3 * i + 1] = velocity.y;
+            values[3 * i + 2] = velocity.z;
+          }
+          break;
+        case OutputField::ShearStress:
+          values.resize(siteCount);
+          for (size_t i = 0; i < siteCount; ++i)
+          {
+            values[i] =
+                converter.ConvertStressToPhysicalUnits(propertyCache->wallShearStressMagnitudeCache.Get(siteIndices[i]));
+          }
+          break;
+        case OutputField::VonMisesStress:
+          values.resize(siteCount);
+          for (size_t i = 0; i < siteCount; ++i)
+          {
+            values[i] = converter.ConvertStressToPhysicalUnits(propertyCache->vonMisesStressCache.Get(siteIndices[i]));
+          }
+          break;
+        case OutputField::ShearRate:
+          values.resize(siteCount);
+          for (size_t i = 0; i < siteCount; ++i)
+          {
+            values[i] = converter.ConvertShearRateToPhysicalUnits(propertyCache->shearRateCache.Get(siteIndices[i]));
+          }
+          break;
+        case OutputField::StressTensor:
+          values.resize(6 * siteCount);
+          for (size_t i = 0; i < siteCount; ++i)
+          {
+            util::Matrix3D tensor =
+                converter.ConvertFullStressTensorToPhysicalUnits(propertyCache->stressTensorCache.Get(siteIndices[i]));
+            // The upper triangular part, row-wise.
+            values[6 * i] = tensor[0][0];
+            values[6 * i + 1] = tensor[0][1];
+            values[6 * i + 2] = tensor[0][2];
+            values[6 * i + 3] = tensor[1][1];
+            values[6 * i + 4] = tensor[1][2];
+            values[6 * i + 5] = tensor[2][2];
+          }
+          break;
+        case OutputField::Traction:
+          values.resize(3 * siteCount);
+          for (size_t i = 0; i < siteCount; ++i)
+          {
+            const util::Vector3D<PhysicalStress> traction =
+                converter.ConvertTractionToPhysicalUnits(propertyCache->tractionCache.Get(siteIndices[i]),
+                                                         data->GetSite(siteIndices[i]).GetWallNormal());
+            values[3 * i] = traction.x;
+            values[3 * i + 1] = traction.y;
+            values[3 * i + 2] = traction.z;
+          }
+          break;
+        case OutputField::TangentialProjectionTraction:
+          values.resize(3 * siteCount);
+          for (size_t i = 0; i < siteCount; ++i)
+          {
+            const util::Vector3D<PhysicalStress> traction =
+                converter.ConvertStressToPhysicalUnits(propertyCache->tangentialProjectionTractionCache.Get(siteIndices[i]));
+            values[3 * i] = traction.x;
+            values[3 * i + 1] = traction.y;
+            values[3 * i + 2] = traction.z;
+          }
+          break;
+        default:
+          throw Exception() << "Field " << field << " isn't available from the data source";
+      }
     }
 
     void LbDataSourceIterator::Reset()
@@ -84,12 +184,12 @@ namespace hemelb
 
     bool LbDataSourceIterator::IsValidLatticeSite(const util::Vector3D<site_t>& location) const
     {
-      return data.IsValidLatticeSite(location);
+      return data->IsValidLatticeSite(location);
     }
 
     bool LbDataSourceIterator::IsAvailable(const util::Vector3D<site_t>& location) const
     {
-      return data.GetProcIdFromGlobalCoords(location) == rank;
+      return data->GetProcIdFromGlobalCoords(location) == rank;
     }
 
     PhysicalDistance LbDataSourceIterator::GetVoxelSize() const
@@ -104,9 +204,9 @@ namespace hemelb
 
     bool LbDataSourceIterator::IsWallSite(const util::Vector3D<site_t>& location) const
     {
-      site_t localSiteId = data.GetContiguousSiteId(location);
+      site_t localSiteId = data->GetContiguousSiteId(location);
 
-      return data.GetSite(localSiteId).IsWall();
+      return data->GetSite(localSiteId).IsWall();
     }
   }
 }
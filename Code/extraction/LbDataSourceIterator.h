@@ -30,6 +30,15 @@ namespace hemelb
                              int rank,
                              const util::UnitConverter& converter);
 
+        /**
+         * Iterate over a new lattice and its property cache instead, after the domain has been
+         * repartitioned.
+         * @param propertyCache
+         * @param data
+         */
+        void Rebind(const lb::MacroscopicPropertyCache& propertyCache,
+                    const geometry::LatticeData& data);
+
         /**
          * Reads the next fluid site from the data source. Returns true if values could
          * be obtained.
@@ -92,6 +101,16 @@ namespace hemelb
          */
         util::Vector3D<PhysicalStress> GetTangentialProjectionTraction() const;
 
+        /**
+         * Gets a field's values at several sites straight from the property cache, without
+         * going through the sites one by one. Doesn't change the position of the iteration.
+         * @param field
+         * @param siteIndices
+         * @param values
+         */
+        void GetFieldValues(OutputField::FieldType field, const std::vector<site_t>& siteIndices,
+                            std::vector<FloatingType>& values);
+
         /**
          * Resets the iterator to the beginning again.
          */
@@ -139,11 +158,11 @@ namespace hemelb
         /**
          * The cache of properties for each site, which we iterate through.
          */
-        const lb::MacroscopicPropertyCache& propertyCache;
+        const lb::MacroscopicPropertyCache* propertyCache;
         /**
          * The object containing information about the lattice.
          */
-        const geometry::LatticeData& data;
+        const geometry::LatticeData* data;
         /**
          * The rank of the current process in the LB communicator.
          */
@@ -4,10 +4,12 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include <cassert>
 #include "extraction/LocalPropertyOutput.h"
 #include "io/formats/formats.h"
 #include "io/formats/extraction.h"
+#include "io/writers/xdr/XdrByteOrder.h"
 #include "io/writers/xdr/XdrMemWriter.h"
 #include "net/IOCommunicator.h"
 #include "constants.h"
@@ -16,52 +18,42 @@ namespace hemelb
 {
   namespace extraction
   {
-    LocalPropertyOutput::LocalPropertyOutput(IterableDataSource& dataSource,
-                                             const PropertyOutputFile* outputSpec,
-                                             const net::IOCommunicator& ioComms) :
-      comms(ioComms), dataSource(dataSource), outputSpec(outputSpec)
+    namespace
     {
-      // Open the file as write-only, create it if it doesn't exist, don't create if the file
-      // already exists.
-      outputFile = net::MpiFile::Open(comms, outputSpec->filename,
-                                      MPI_MODE_WRONLY | MPI_MODE_CREATE | MPI_MODE_EXCL);
-      // Count sites on this task
-      uint64_t siteCount = 0;
-      dataSource.Reset();
-      while (dataSource.ReadNext())
+      /**
+       * Store a 32-bit value big-endian, as XDR does.
+       */
+      inline void EncodeUint32(char* destination, uint32_t value)
       {
-        if (outputSpec->geometry->Include(dataSource, dataSource.GetPosition()))
-        {
-          ++siteCount;
-        }
+        io::writers::xdr::CopyConvertingByteOrder<uint32_t>(reinterpret_cast<const char*>(&value),
+                                                            destination,
+                                                            1);
       }
 
-      // Calculate how long local writes need to be.
-
-      // First get the length per-site
-      // Always have 3 uint32's for the position of a site
-      writeLength = 3 * 4;
-
-      // Then get add each field's length
-      for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
-      {
-        writeLength += sizeof(WrittenDataType)
-            * GetFieldLength(outputSpec->fields[outputNumber].type);
-      }
-
-      //  Now multiply by local site count
-      writeLength *= siteCount;
-
-      // The IO proc also writes the iteration number
-      if (comms.OnIORank())
+      /**
+       * Store a float as XDR does.
+       */
+      inline void EncodeFloat(char* destination, float value)
       {
-        writeLength += 8;
+        io::writers::xdr::CopyConvertingByteOrder<uint32_t>(reinterpret_cast<const char*>(&value),
+                                                            destination,
+                                                            1);
       }
+    }
 
-      //! @TODO: These two MPI calls can be replaced with one
+    LocalPropertyOutput::LocalPropertyOutput(IterableDataSource& dataSource,
+                                             const PropertyOutputFile* outputSpec,
+                                             const net::IOCommunicator& ioComms,
+                                             int writersPerNode) :
+      comms(ioComms), dataSource(dataSource), outputSpec(outputSpec),
+          chunkEncoder(outputSpec->compression)
+    {
+      // Open the file as write-only, create it if it doesn't exist, don't create if the file
+      // already exists.
+      outputFile = net::MpiFile::Open(comms, outputSpec->filename,
+                                      MPI_MODE_WRONLY | MPI_MODE_CREATE | MPI_MODE_EXCL);
 
-      // Everyone needs to know the total length written during one iteration.
-      allCoresWriteLength = comms.AllReduce(writeLength, MPI_SUM);
+      const uint64_t siteCount = CalculateWriteLengths();
 
       // Only the root process needs to know the total number of sites written
       // Note this has a garbage value on other procs.
@@ -75,6 +67,11 @@ namespace hemelb
       {
         // Compute the length of the field header
         unsigned fieldHeaderLength = 0;
+        if (outputSpec->chunked)
+        {
+          // Uint32 for the compression
+          fieldHeaderLength += 4;
+        }
         for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
         {
           // Name
@@ -84,6 +81,11 @@ namespace hemelb
           fieldHeaderLength += 4;
           // Double for the offset in each field
           fieldHeaderLength += 8;
+          if (outputSpec->chunked)
+          {
+            // Uint32 for the encoding
+            fieldHeaderLength += 4;
+          }
         }
 
         // Create a header buffer
@@ -98,7 +100,9 @@ namespace hemelb
           // Fill it
           mainHeaderWriter << uint32_t(io::formats::HemeLbMagicNumber)
               << uint32_t(io::formats::extraction::MagicNumber)
-              << uint32_t(io::formats::extraction::VersionNumber);
+              << (outputSpec->chunked ?
+                uint32_t(io::formats::extraction::ChunkedVersionNumber) :
+                uint32_t(io::formats::extraction::VersionNumber));
           mainHeaderWriter << double(dataSource.GetVoxelSize());
           const util::Vector3D<distribn_t> &origin = dataSource.GetOrigin();
           mainHeaderWriter << double(origin[0]) << double(origin[1]) << double(origin[2]);
@@ -115,11 +119,19 @@ namespace hemelb
               fieldHeaderWriter(&headerBuffer[io::formats::extraction::MainHeaderLength],
                                 fieldHeaderLength);
           // Write it
+          if (outputSpec->chunked)
+          {
+            fieldHeaderWriter << uint32_t(outputSpec->compression);
+          }
           for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
           {
             fieldHeaderWriter << outputSpec->fields[outputNumber].name
                 << uint32_t(GetFieldLength(outputSpec->fields[outputNumber].type))
                 << GetOffset(outputSpec->fields[outputNumber].type);
+            if (outputSpec->chunked)
+            {
+              fieldHeaderWriter << uint32_t(outputSpec->fields[outputNumber].encoding);
+            }
           }
           //Exiting the block cleans up the writer
         }
@@ -128,36 +140,199 @@ namespace hemelb
         outputFile.WriteAt(0, headerBuffer);
       }
 
-      // Calculate where each core should start writing
-      if (comms.OnIORank())
+      if (writersPerNode > 0)
       {
-        // For core 0 this is easy: it passes the value for core 1 to the core.
-        localDataOffsetIntoFile = totalHeaderLength;
+        // Split each node's cores, in order, into groups with a writer each.
+        const net::MpiCommunicator nodeComms = comms.SplitShared();
+        const int writers = std::min(writersPerNode, nodeComms.Size());
+        writerGroup = nodeComms.Split(nodeComms.Rank() * writers / nodeComms.Size(),
+                                      nodeComms.Rank());
+      }
 
-        if (comms.Size() > 1)
-        {
-          comms.Send(localDataOffsetIntoFile+writeLength, 1, 1);
-        }
+      // Everyone's data follows the headers.
+      comms.Broadcast(totalHeaderLength, comms.GetIORank());
+      if (outputSpec->chunked)
+      {
+        blockOffsetIntoFile = totalHeaderLength;
+        WriteBlock(io::formats::extraction::GridBlock, 0);
       }
       else
       {
-        // Receive the writing start position from the previous core.
-        comms.Receive(localDataOffsetIntoFile, comms.Rank()-1, 1);
+        CalculateLocalDataOffset(totalHeaderLength);
+      }
+    }
 
-        // Send the next core its start position.
-        if (comms.Rank() != (comms.Size() - 1))
+    uint64_t LocalPropertyOutput::CalculateWriteLengths()
+    {
+      // Find the sites on this task. Whether a site is included depends only on the geometry,
+      // so this holds until the sites are redistributed.
+      std::vector<util::Vector3D<site_t> > positions;
+      siteIndices.clear();
+      site_t siteIndex = 0;
+      dataSource.Reset();
+      while (dataSource.ReadNext())
+      {
+        const util::Vector3D<site_t> position = dataSource.GetPosition();
+        if (outputSpec->geometry->Include(dataSource, position))
         {
-          comms.Send(localDataOffsetIntoFile+writeLength, comms.Rank() + 1, 1);
+          siteIndices.push_back(siteIndex);
+          positions.push_back(position);
         }
+        ++siteIndex;
+      }
+      const uint64_t siteCount = siteIndices.size();
+
+      // The chunked format writes the positions once, and works out the lengths as it goes.
+      if (outputSpec->chunked)
+      {
+        sitePositions.swap(positions);
+        return siteCount;
       }
 
-      // Create the buffer that we'll write each iteration's data into.
+      // Calculate how long local writes need to be.
+
+      // First get the length per-site
+      // Always have 3 uint32's for the position of a site
+      recordLength = 3 * 4;
+
+      // Then get add each field's length
+      for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
+      {
+        recordLength += sizeof(WrittenDataType)
+            * GetFieldLength(outputSpec->fields[outputNumber].type);
+      }
+
+      // The IO proc also writes the iteration number, before the records.
+      recordsOffsetIntoBuffer = comms.OnIORank() ?
+        8 :
+        0;
+
+      // Then add the records of all the local sites
+      writeLength = recordsOffsetIntoBuffer + recordLength * siteCount;
+
+      // Everyone needs to know the total length written during one iteration.
+      allCoresWriteLength = comms.AllReduce(writeLength, MPI_SUM);
+
+      // Create the buffer that we'll write each iteration's data into, and fill in what stays
+      // the same every iteration: the positions, and this core's rank.
       buffer.resize(writeLength);
+      for (uint64_t site = 0; site < siteCount; ++site)
+      {
+        char* record = &buffer[recordsOffsetIntoBuffer + site * recordLength];
+        EncodeUint32(record, uint32_t(positions[site].x));
+        EncodeUint32(record + 4, uint32_t(positions[site].y));
+        EncodeUint32(record + 8, uint32_t(positions[site].z));
+      }
+
+      uint64_t offsetIntoRecord = 3 * 4;
+      for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
+      {
+        if (outputSpec->fields[outputNumber].type == OutputField::MpiRank)
+        {
+          for (uint64_t site = 0; site < siteCount; ++site)
+          {
+            EncodeFloat(&buffer[recordsOffsetIntoBuffer + site * recordLength + offsetIntoRecord],
+                        static_cast<WrittenDataType>(comms.Rank()));
+          }
+        }
+        offsetIntoRecord += sizeof(WrittenDataType)
+            * GetFieldLength(outputSpec->fields[outputNumber].type);
+      }
+
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_OUTPUT
+      // The buffers take turns, so both need the positions.
+      inFlightBuffer = buffer;
+#endif
+
+      return siteCount;
+    }
+
+    void LocalPropertyOutput::CalculateLocalDataOffset(uint64_t recordOffsetIntoFile)
+    {
+      // Each core starts where the lower ranks' data ends. The IO proc is rank 0, so it starts
+      // straight away with the iteration number.
+      localDataOffsetIntoFile = recordOffsetIntoFile + comms.ExclusiveScan(writeLength, MPI_SUM);
+
+      writeRuns.clear();
+      if (!writerGroup)
+      {
+        if (writeLength > 0)
+        {
+          const WriteRun run = { 0, 0, writeLength };
+          writeRuns.push_back(run);
+        }
+        return;
+      }
+
+      // The group writer has the lowest rank in the group, so the lowest offset. Its runs
+      // merge the members' data wherever one's follows on from the previous one's.
+      const std::vector<uint64_t> lengths = writerGroup.Gather(writeLength, 0);
+      const std::vector<uint64_t> offsets = writerGroup.Gather(localDataOffsetIntoFile, 0);
+      groupWriteLengths.assign(lengths.begin(), lengths.end());
+      uint64_t offsetIntoBuffer = 0;
+      for (size_t member = 0; member < lengths.size(); ++member)
+      {
+        if (lengths[member] == 0)
+        {
+          continue;
+        }
+        const uint64_t offsetIntoFile = offsets[member] - offsets[0];
+        if (!writeRuns.empty()
+            && writeRuns.back().offsetIntoFile + writeRuns.back().length == offsetIntoFile)
+        {
+          writeRuns.back().length += lengths[member];
+        }
+        else
+        {
+          const WriteRun run = { offsetIntoFile, offsetIntoBuffer, lengths[member] };
+          writeRuns.push_back(run);
+        }
+        offsetIntoBuffer += lengths[member];
+      }
+    }
+
+    void LocalPropertyOutput::Redistribute()
+    {
+      if (outputSpec->chunked)
+      {
+        Flush();
+        CalculateWriteLengths();
+        WriteBlock(io::formats::extraction::GridBlock, 0);
+        return;
+      }
+
+      // The IO proc writes first, so it knows where the next iteration's data starts.
+      uint64_t recordOffsetIntoFile = localDataOffsetIntoFile;
+      comms.Broadcast(recordOffsetIntoFile, comms.GetIORank());
+
+      // The buffers are about to be refilled.
+      Flush();
+
+      CalculateWriteLengths();
+      CalculateLocalDataOffset(recordOffsetIntoFile);
     }
 
     LocalPropertyOutput::~LocalPropertyOutput()
     {
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_OUTPUT
+      // Don't let the file close under a write in flight. Not checked, as this mustn't throw.
+      if (!writeRequests.empty())
+      {
+        MPI_Waitall(writeRequests.size(), &writeRequests[0], MPI_STATUSES_IGNORE);
+      }
+#endif
+    }
 
+    void LocalPropertyOutput::Flush()
+    {
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_OUTPUT
+      if (!writeRequests.empty())
+      {
+        HEMELB_MPI_CALL(MPI_Waitall,
+                        (writeRequests.size(), &writeRequests[0], MPI_STATUSES_IGNORE));
+        writeRequests.clear();
+      }
+#endif
     }
 
     bool LocalPropertyOutput::ShouldWrite(unsigned long timestepNumber) const
@@ -178,96 +353,187 @@ namespace hemelb
         return;
       }
 
-      // Don't write if this core doesn't do anything.
-      if (writeLength <= 0)
+      if (outputSpec->chunked)
       {
+        WriteBlock(io::formats::extraction::ValuesBlock, timestepNumber);
         return;
       }
 
-      // Create the buffer.
-      io::writers::xdr::XdrMemWriter xdrWriter(&buffer[0], buffer.size());
+      // Don't write if this core doesn't do anything, unless its group writer is waiting for
+      // it.
+      if (writeLength <= 0 && !writerGroup)
+      {
+        return;
+      }
 
       // Firstly, the IO proc must write the iteration number.
       if (comms.OnIORank())
       {
+        io::writers::xdr::XdrMemWriter xdrWriter(&buffer[0], recordsOffsetIntoBuffer);
         xdrWriter << (uint64_t) timestepNumber;
       }
 
-      dataSource.Reset();
-
-      while (dataSource.ReadNext())
+      // Then each field in turn, into every site's record. The positions and ranks are already
+      // there.
+      uint64_t offsetIntoRecord = 3 * 4;
+      for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
       {
-        const util::Vector3D<site_t>& position = dataSource.GetPosition();
-        if (outputSpec->geometry->Include(dataSource, position))
+        const OutputField::FieldType field = outputSpec->fields[outputNumber].type;
+        if (field != OutputField::MpiRank)
         {
-          // Write the position
-          xdrWriter << (uint32_t) position.x << (uint32_t) position.y << (uint32_t) position.z;
+          EncodeField(field, offsetIntoRecord);
+        }
+        offsetIntoRecord += sizeof(WrittenDataType) * GetFieldLength(field);
+      }
+
+      // Actually do the MPI writing.
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_OUTPUT
+      // The previous write has had since the last output step to finish. Once it has, its
+      // buffer is free to fill next time.
+      Flush();
+#endif
+      if (writerGroup)
+      {
+        std::vector<char> groupBuffer = writerGroup.GatherV(buffer, groupWriteLengths, 0);
+        WriteRuns(groupBuffer);
+      }
+      else
+      {
+        WriteRuns(buffer);
+      }
+
+      // Set the offset to the right place for writing on the next iteration.
+      localDataOffsetIntoFile += allCoresWriteLength;
+    }
 
-          // Write for each field.
+    void LocalPropertyOutput::WriteBlock(io::formats::extraction::BlockType type,
+                                         unsigned long timestepNumber)
+    {
+      // The IO proc starts the block with its header, to be filled in once the length is known.
+      buffer.assign(comms.OnIORank() ?
+                      io::formats::extraction::BlockHeaderLength :
+                      0,
+                    0);
+
+      const uint64_t siteCount = siteIndices.size();
+      if (siteCount > 0)
+      {
+        chunkEncoder.Reset();
+        if (type == io::formats::extraction::GridBlock)
+        {
+          for (uint64_t site = 0; site < siteCount; ++site)
+          {
+            chunkEncoder.AppendPosition(sitePositions[site]);
+          }
+        }
+        else
+        {
           for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
           {
-            switch (outputSpec->fields[outputNumber].type)
+            const OutputField& field = outputSpec->fields[outputNumber];
+            if (field.type == OutputField::MpiRank)
             {
-              case OutputField::Pressure:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetPressure()
-                    - REFERENCE_PRESSURE_mmHg);
-                break;
-              case OutputField::Velocity:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetVelocity().x)
-                    << static_cast<WrittenDataType> (dataSource.GetVelocity().y)
-                    << static_cast<WrittenDataType> (dataSource.GetVelocity().z);
-                break;
-                //! @TODO: Work out how to handle the different stresses.
-              case OutputField::VonMisesStress:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetVonMisesStress());
-                break;
-              case OutputField::ShearStress:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetShearStress());
-                break;
-              case OutputField::ShearRate:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetShearRate());
-                break;
-              case OutputField::StressTensor:
-              {
-                util::Matrix3D tensor = dataSource.GetStressTensor();
-                // Only the upper triangular part of the symmetric tensor is stored. Storage is row-wise.
-                xdrWriter << static_cast<WrittenDataType> (tensor[0][0])
-                    << static_cast<WrittenDataType> (tensor[0][1])
-                    << static_cast<WrittenDataType> (tensor[0][2])
-                    << static_cast<WrittenDataType> (tensor[1][1])
-                    << static_cast<WrittenDataType> (tensor[1][2])
-                    << static_cast<WrittenDataType> (tensor[2][2]);
-                break;
-              }
-              case OutputField::Traction:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetTraction().x)
-                    << static_cast<WrittenDataType> (dataSource.GetTraction().y)
-                    << static_cast<WrittenDataType> (dataSource.GetTraction().z);
-                break;
-              case OutputField::TangentialProjectionTraction:
-                xdrWriter
-                    << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().x)
-                    << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().y)
-                    << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().z);
-                break;
-              case OutputField::MpiRank:
-                xdrWriter
-                    << static_cast<WrittenDataType> (comms.Rank());
-                break;
-              default:
-                // This should never trip. It only occurs when a new OutputField field is added and no
-                // implementation is provided for its serialisation.
-                assert(false);
+              fieldValues.assign(siteCount, comms.Rank());
             }
+            else
+            {
+              dataSource.GetFieldValues(field.type, siteIndices, fieldValues);
+            }
+            chunkEncoder.AppendField(field.encoding, fieldValues, GetOffset(field.type));
           }
         }
+        chunkEncoder.Finish(uint32_t(siteCount), buffer);
+      }
+      if (type == io::formats::extraction::GridBlock)
+      {
+        std::vector<util::Vector3D<site_t> >().swap(sitePositions);
       }
 
-      // Actually do the MPI writing.
-      outputFile.WriteAt(localDataOffsetIntoFile, buffer);
+      // Count the chunks and their length.
+      std::vector<uint64_t> chunkCountAndLength(2);
+      chunkCountAndLength[1] = buffer.size() - (comms.OnIORank() ?
+        io::formats::extraction::BlockHeaderLength :
+        0);
+      chunkCountAndLength[0] = chunkCountAndLength[1] > 0 ?
+        1 :
+        0;
+      chunkCountAndLength = comms.AllReduce(chunkCountAndLength, MPI_SUM);
 
-      // Set the offset to the right place for writing on the next iteration.
-      localDataOffsetIntoFile += allCoresWriteLength;
+      if (comms.OnIORank())
+      {
+        io::writers::xdr::XdrMemWriter headerWriter(&buffer[0],
+                                                    io::formats::extraction::BlockHeaderLength);
+        headerWriter << uint32_t(type) << uint32_t(chunkCountAndLength[0])
+            << uint64_t(timestepNumber) << uint64_t(chunkCountAndLength[1]);
+      }
+
+      writeLength = buffer.size();
+      CalculateLocalDataOffset(blockOffsetIntoFile);
+      blockOffsetIntoFile += io::formats::extraction::BlockHeaderLength + chunkCountAndLength[1];
+
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_OUTPUT
+      Flush();
+#endif
+      if (writerGroup)
+      {
+        std::vector<char> groupBuffer = writerGroup.GatherV(buffer, groupWriteLengths, 0);
+        WriteRuns(groupBuffer);
+      }
+      else
+      {
+        WriteRuns(buffer);
+      }
+    }
+
+    void LocalPropertyOutput::WriteRuns(std::vector<char>& data)
+    {
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_OUTPUT
+      // Keep the data until the writes finish; what was written last time is free to fill.
+      data.swap(inFlightBuffer);
+      for (size_t run = 0; run < writeRuns.size(); ++run)
+      {
+        writeRequests.push_back(MPI_REQUEST_NULL);
+        outputFile.IWriteAt(localDataOffsetIntoFile + writeRuns[run].offsetIntoFile,
+                            &inFlightBuffer[writeRuns[run].offsetIntoBuffer],
+                            writeRuns[run].length,
+                            &writeRequests.back());
+      }
+#else
+      for (size_t run = 0; run < writeRuns.size(); ++run)
+      {
+        outputFile.WriteAt(localDataOffsetIntoFile + writeRuns[run].offsetIntoFile,
+                           &data[writeRuns[run].offsetIntoBuffer],
+                           writeRuns[run].length);
+      }
+#endif
+    }
+
+    void LocalPropertyOutput::EncodeField(OutputField::FieldType field, uint64_t offsetIntoRecord)
+    {
+      if (siteIndices.empty())
+      {
+        return;
+      }
+
+      dataSource.GetFieldValues(field, siteIndices, fieldValues);
+
+      // Convert all the values first, then each site's components into its record at once.
+      const unsigned fieldLength = GetFieldLength(field);
+      const double offset = GetOffset(field);
+      writtenValues.resize(fieldValues.size());
+      for (size_t i = 0; i < fieldValues.size(); ++i)
+      {
+        writtenValues[i] = static_cast<WrittenDataType>(fieldValues[i] - offset);
+      }
+
+      char* record = &buffer[recordsOffsetIntoBuffer + offsetIntoRecord];
+      const char* values = reinterpret_cast<const char*>(&writtenValues[0]);
+      for (size_t site = 0; site < siteIndices.size(); ++site)
+      {
+        io::writers::xdr::CopyConvertingByteOrder<uint32_t>(values, record, fieldLength);
+        record += recordLength;
+        values += sizeof(WrittenDataType) * fieldLength;
+      }
     }
 
     unsigned LocalPropertyOutput::GetFieldLength(OutputField::FieldType field)
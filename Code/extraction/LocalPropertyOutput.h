@@ -7,6 +7,7 @@
 #ifndef HEMELB_EXTRACTION_LOCALPROPERTYOUTPUT_H
 #define HEMELB_EXTRACTION_LOCALPROPERTYOUTPUT_H
 
+#include "extraction/ChunkEncoder.h"
 #include "extraction/IterableDataSource.h"
 #include "extraction/PropertyOutputFile.h"
 #include "net/mpi.h"
@@ -22,6 +23,23 @@ namespace hemelb
   {
     /**
      * Stores sufficient information to output property information from this core.
+     *
+     * Each core's part of an iteration's data follows the previous core's, so where it goes
+     * in the file comes from a prefix sum of the lengths.
+     *
+     * With HEMELB_EXTRACTION_WRITERS_PER_NODE set above zero, the cores on each node are split
+     * into that many groups of consecutive ranks. Each group gathers its data onto its lowest
+     * rank, which writes it with as few calls as the data's places in the file allow (one, when
+     * the group's ranks are consecutive overall). Otherwise every core writes its own part.
+     *
+     * In the chunked format (see io::formats::extraction::ChunkedVersionNumber), each core
+     * writes its sites' positions in a grid block to start with and whenever the sites are
+     * redistributed, and only the values after that. Every write's length is then only known
+     * once the data is encoded, so the offsets are worked out again for each.
+     *
+     * With HEMELB_USE_ASYNC_EXTRACTION_OUTPUT, each write is started with a non-blocking
+     * MPI_File_iwrite_at and left to complete while the simulation carries on. The next write
+     * fills the other of two buffers, and only then waits for the previous one.
      */
     class LocalPropertyOutput
     {
@@ -30,9 +48,13 @@ namespace hemelb
          * Initialises a LocalPropertyOutput. Required so we can use const reference types.
          * @param file
          * @param offset
+         * @param writersPerNode How many cores on each node write for the others, or zero for
+         * every core to write its own data.
          * @return
          */
-        LocalPropertyOutput(IterableDataSource& dataSource, const PropertyOutputFile* outputSpec, const net::IOCommunicator& ioComms);
+        LocalPropertyOutput(IterableDataSource& dataSource, const PropertyOutputFile* outputSpec,
+                            const net::IOCommunicator& ioComms,
+                            int writersPerNode = WRITERS_PER_NODE);
 
         /**
          * Tidies up the LocalPropertyOutput (close files etc).
@@ -58,7 +80,57 @@ namespace hemelb
          */
         void Write(unsigned long timestepNumber);
 
+        /**
+         * Wait until everything written so far is in the file. Only needed with
+         * HEMELB_USE_ASYNC_EXTRACTION_OUTPUT, where Write only starts the writing.
+         */
+        void Flush();
+
+        /**
+         * Recalculate which part of the file this core writes, once the sites of the data
+         * source have been repartitioned between the cores. A collective operation.
+         */
+        void Redistribute();
+
       private:
+        /**
+         * Find the sites on this core to be written, and from them set how much this core and
+         * all cores write each iteration. Encodes the parts of each site's record that don't
+         * change between iterations (its position and rank) into the buffer. A collective
+         * operation.
+         * @return The number of sites on this core to be written.
+         */
+        uint64_t CalculateWriteLengths();
+
+        /**
+         * Write a block of the chunked format, with this core's chunk. A collective operation.
+         * @param type
+         * @param timestepNumber
+         */
+        void WriteBlock(io::formats::extraction::BlockType type, unsigned long timestepNumber);
+
+        /**
+         * Encode one field for every written site into the buffer, each value going into its
+         * site's record.
+         * @param field
+         * @param offsetIntoRecord Where the field begins in each record, in bytes.
+         */
+        void EncodeField(OutputField::FieldType field, uint64_t offsetIntoRecord);
+
+        /**
+         * Work out where in the file this core writes, with each core following the previous
+         * one, and what this core writes on behalf of its group. A collective operation.
+         * @param recordOffsetIntoFile Where the first core begins writing.
+         */
+        void CalculateLocalDataOffset(uint64_t recordOffsetIntoFile);
+
+        /**
+         * Write this core's runs of data, or start writing them with
+         * HEMELB_USE_ASYNC_EXTRACTION_OUTPUT.
+         * @param data The data to write, which may be swapped for a buffer to fill next time.
+         */
+        void WriteRuns(std::vector<char>& data);
+
         /**
          * Returns the number of floats written for the field.
          * @param field
@@ -104,14 +176,102 @@ namespace hemelb
         uint64_t allCoresWriteLength;
 
         /**
-         * Buffer to write into before writing to disk.
+         * The indices of the sites written, in the order the data source reads them.
+         */
+        std::vector<site_t> siteIndices;
+
+        /**
+         * The length, in bytes, of each site's record.
+         */
+        uint64_t recordLength;
+
+        /**
+         * Where in the buffer the sites' records begin, after the iteration number on the IO
+         * proc.
+         */
+        uint64_t recordsOffsetIntoBuffer;
+
+        /**
+         * Buffer to write into before writing to disk. The sites' positions stay in place from
+         * one iteration to the next.
          */
         std::vector<char> buffer;
 
+        /**
+         * The values of the field being encoded.
+         */
+        std::vector<FloatingType> fieldValues;
+
+        /**
+         * In the chunked format, the positions of the sites written, until they're written.
+         */
+        std::vector<util::Vector3D<site_t> > sitePositions;
+
+        /**
+         * In the chunked format, where the next block begins.
+         */
+        uint64_t blockOffsetIntoFile;
+
+        /**
+         * Encodes this core's chunks, in the chunked format.
+         */
+        ChunkEncoder chunkEncoder;
+
+        /**
+         * A contiguous part of the data written by this core.
+         */
+        struct WriteRun
+        {
+            //! Where in the file the run goes, relative to this core's own data.
+            uint64_t offsetIntoFile;
+            uint64_t offsetIntoBuffer;
+            uint64_t length;
+        };
+
+        /**
+         * What this core writes each iteration: its own data, or its group's if it writes for
+         * a group.
+         */
+        std::vector<WriteRun> writeRuns;
+
+        /**
+         * The cores whose data this core's group writer writes, or a null communicator if
+         * every core writes its own.
+         */
+        net::MpiCommunicator writerGroup;
+
+        /**
+         * On the group writer, the length of each group member's data.
+         */
+        std::vector<int> groupWriteLengths;
+
+#ifdef HEMELB_USE_ASYNC_EXTRACTION_OUTPUT
+        /**
+         * The buffer being written to disk, if a write is in flight.
+         */
+        std::vector<char> inFlightBuffer;
+
+        /**
+         * The writes in flight.
+         */
+        std::vector<MPI_Request> writeRequests;
+#endif
+
         /**
          * Type of written values
          */
         typedef float WrittenDataType;
+
+        /**
+         * The values of the field being encoded, as written but in the host's byte order.
+         */
+        std::vector<WrittenDataType> writtenValues;
+
+        /**
+         * How many cores on each node write for the others, or zero for every core to write
+         * its own data.
+         */
+        static const int WRITERS_PER_NODE = HEMELB_EXTRACTION_WRITERS_PER_NODE;
     };
   }
 }
@@ -7,12 +7,20 @@
 #ifndef HEMELB_EXTRACTION_OUTPUTFIELD_H
 #define HEMELB_EXTRACTION_OUTPUTFIELD_H
 
+#include <string>
+#include "io/formats/extraction.h"
+
 namespace hemelb
 {
   namespace extraction
   {
     struct OutputField
     {
+        OutputField() :
+            encoding(io::formats::extraction::Float32Encoding)
+        {
+        }
+
         // #658 Refactor out enum
         enum FieldType
         {
@@ -29,6 +37,8 @@ namespace hemelb
 
         std::string name;
         FieldType type;
+        //! How to store the values, in the chunked format.
+        io::formats::extraction::FieldEncoding encoding;
     };
   }
 }
@@ -46,6 +46,12 @@ namespace hemelb
          */
         void EndIteration();
 
+        /**
+         * Recalculate where each core writes, once the data source's sites have been
+         * repartitioned. A collective operation.
+         */
+        void Redistribute();
+
       private:
         const lb::SimulationState& simulationState;
         PropertyWriter* propertyWriter;
@@ -18,7 +18,8 @@ namespace hemelb
   {
     struct PropertyOutputFile
     {
-        PropertyOutputFile()
+        PropertyOutputFile() :
+            chunked(false), compression(io::formats::extraction::NoCompression)
         {
           geometry = NULL;
         }
@@ -32,6 +33,10 @@ namespace hemelb
         unsigned long frequency;
         GeometrySelector* geometry;
         std::vector<OutputField> fields;
+        //! Whether to write the chunked format, rather than a record for every site every time.
+        bool chunked;
+        //! How to compress the chunks, in the chunked format.
+        io::formats::extraction::Compression compression;
     };
   }
 }
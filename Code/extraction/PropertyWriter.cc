@@ -28,6 +28,14 @@ namespace hemelb
       }
     }
 
+    void PropertyWriter::Redistribute()
+    {
+      for (unsigned outputNumber = 0; outputNumber < localPropertyOutputs.size(); ++outputNumber)
+      {
+        localPropertyOutputs[outputNumber]->Redistribute();
+      }
+    }
+
     const std::vector<LocalPropertyOutput*>& PropertyWriter::GetPropertyOutputs() const
     {
       return localPropertyOutputs;
@@ -39,6 +39,11 @@ namespace hemelb
          */
         void Write(unsigned long iterationNumber) const;
 
+        /**
+         * Recalculate where each core writes, after the sites have been repartitioned.
+         */
+        void Redistribute();
+
         /**
          * Returns a vector of all the LocalPropertyOutputs.
          * @return
@@ -0,0 +1,147 @@
+#!/usr/bin/env python
+# This file is part of HemeLB and is Copyright (C)
+# the HemeLB team and/or their institutions, as detailed in the
+# file AUTHORS. This software is provided under the terms of the
+# license in the file LICENSE.
+
+# encoding: utf-8
+"""Report how far a build that stores its distributions in single precision
+(HEMELB_USE_FLOAT_DISTRIBUTIONS, optionally HEMELB_USE_SHIFTED_DISTRIBUTIONS)
+drifts from the double-precision build.
+
+Either run both executables on each of the given configurations, e.g. the
+functional-test geometries:
+
+    precisiondrift.py double/hemelb float/hemelb \\
+        ../../unittests/resources/four_cube.xml resources/poiseuille_flow_test.xml
+
+or compare the outputs of two runs that have already been done:
+
+    precisiondrift.py --compare double_results float_results
+
+Every property extraction file is compared at every time step. For each field
+the largest absolute difference is reported, along with that difference
+relative to the largest magnitude of the field in the double-precision run.
+The exit status is non-zero if any relative drift exceeds the tolerance.
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+import numpy as np
+from hemeTools.parsers.extraction import ExtractedProperty
+
+# Fields that identify a site rather than being a property of the flow.
+SiteFields = ('id', 'grid', 'position')
+
+
+def RunSimulation(executable, config, outputDir, processes):
+    """Run HemeLB on the config, from the config's directory, writing to outputDir.
+    """
+    command = ['mpirun', '-np', str(processes), os.path.abspath(executable),
+               '-in', os.path.basename(config), '-out', outputDir]
+    subprocess.check_call(command, cwd=os.path.dirname(os.path.abspath(config)))
+
+
+def SortedBySite(data):
+    """Order the rows of one time step's data by grid position, so that runs
+    with different decompositions can be compared.
+    """
+    grid = data.grid
+    return data[np.lexsort((grid[:, 2], grid[:, 1], grid[:, 0]))]
+
+
+def CompareExtractionFiles(referenceFile, candidateFile):
+    """Yield (field, time step, max absolute drift, max relative drift) for
+    every field at every time step in the two files.
+    """
+    reference = ExtractedProperty(referenceFile)
+    candidate = ExtractedProperty(candidateFile)
+    assert reference.siteCount == candidate.siteCount, \
+        "Different numbers of sites in '{}' and '{}'".format(referenceFile, candidateFile)
+    assert np.all(reference.times == candidate.times), \
+        "Different time steps in '{}' and '{}'".format(referenceFile, candidateFile)
+
+    fields = [spec[0] for spec in reference.GetFieldSpec() if spec[0] not in SiteFields]
+    for t in reference.times:
+        referenceData = SortedBySite(reference.GetByTimeStep(t))
+        candidateData = SortedBySite(candidate.GetByTimeStep(t))
+        for field in fields:
+            referenceValues = np.asarray(referenceData[field], dtype=float)
+            candidateValues = np.asarray(candidateData[field], dtype=float)
+            absolute = np.abs(candidateValues - referenceValues).max()
+            scale = np.abs(referenceValues).max()
+            relative = absolute / scale if scale > 0 else absolute
+            yield field, t, absolute, relative
+
+
+def CompareOutputs(referenceDir, candidateDir, out=sys.stdout):
+    """Compare every extraction file in two HemeLB output directories, print a
+    summary line per field and return the largest relative drift.
+    """
+    referenceExtracted = os.path.join(referenceDir, 'Extracted')
+    candidateExtracted = os.path.join(candidateDir, 'Extracted')
+    worst = 0.0
+    out.write('{:<40} {:<20} {:>8} {:>14} {:>14}\n'.format('file', 'field', 'step',
+                                                       'max abs drift', 'max rel drift'))
+    for name in sorted(os.listdir(referenceExtracted)):
+        candidateFile = os.path.join(candidateExtracted, name)
+        if not os.path.isfile(candidateFile):
+            out.write('{:<40} missing from {}\n'.format(name, candidateDir))
+            worst = float('inf')
+            continue
+
+        # Report the time step at which each field drifts furthest.
+        fieldWorst = {}
+        for field, t, absolute, relative in CompareExtractionFiles(os.path.join(referenceExtracted, name),
+                                                                   candidateFile):
+            if field not in fieldWorst or relative > fieldWorst[field][2]:
+                fieldWorst[field] = (t, absolute, relative)
+
+        for field in sorted(fieldWorst):
+            t, absolute, relative = fieldWorst[field]
+            out.write('{:<40} {:<20} {:>8d} {:>14.4e} {:>14.4e}\n'.format(name, field, t, absolute, relative))
+            worst = max(worst, relative)
+    return worst
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--compare', action='store_true',
+                        help='Compare two existing output directories instead of running simulations')
+    parser.add_argument('--np', type=int, default=1, help='Number of MPI processes per run')
+    parser.add_argument('--tolerance', type=float, default=1e-4,
+                        help='Largest acceptable relative drift')
+    parser.add_argument('reference', help='Double-precision executable (or output directory)')
+    parser.add_argument('candidate', help='Single-precision executable (or output directory)')
+    parser.add_argument('configs', nargs='*', help='Configuration files to run')
+    args = parser.parse_args()
+
+    worst = 0.0
+    if args.compare:
+        worst = CompareOutputs(args.reference, args.candidate)
+    else:
+        if not args.configs:
+            parser.error('at least one configuration file is needed to run simulations')
+        for config in args.configs:
+            sys.stdout.write('# {}\n'.format(config))
+            workDir = tempfile.mkdtemp('_HemeLB_PrecisionDrift')
+            try:
+                referenceDir = os.path.join(workDir, 'reference')
+                candidateDir = os.path.join(workDir, 'candidate')
+                RunSimulation(args.reference, config, referenceDir, args.np)
+                RunSimulation(args.candidate, config, candidateDir, args.np)
+                worst = max(worst, CompareOutputs(referenceDir, candidateDir))
+            finally:
+                shutil.rmtree(workDir)
+
+    sys.stdout.write('# Largest relative drift {:.4e} (tolerance {:.4e})\n'.format(worst, args.tolerance))
+    return 0 if worst <= args.tolerance else 1
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,208 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <utility>
+
+#include "geometry/DistributionMigration.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    DistributionMigration::DistributionMigration(const LatticeData& latticeData) :
+        numVectors(latticeData.GetLatticeInfo().GetNumVectors()),
+            globalSiteCount(latticeData.GetSiteDimensions().x * latticeData.GetSiteDimensions().y
+                * latticeData.GetSiteDimensions().z), valuesPerSite(0)
+    {
+      const site_t localSiteCount = latticeData.GetLocalFluidSiteCount();
+      siteIds.reserve(localSiteCount);
+      distributions.reserve(localSiteCount * numVectors);
+      for (site_t site = 0; site < localSiteCount; ++site)
+      {
+        const Site<const LatticeData> siteDetails = latticeData.GetSite(site);
+        siteIds.push_back(latticeData.GetGlobalNoncontiguousSiteIdFromGlobalCoords(siteDetails.GetGlobalSiteCoords()));
+        const distribn_t* fOld = siteDetails.GetFOld(numVectors);
+        distributions.insert(distributions.end(), fOld, fOld + numVectors);
+      }
+    }
+
+    void DistributionMigration::AddSiteValues(const std::vector<distribn_t>& values,
+                                              unsigned valuesPerSite)
+    {
+      if (values.size() != siteIds.size() * valuesPerSite)
+      {
+        throw Exception() << "Got " << values.size() << " values for " << siteIds.size()
+            << " sites at " << valuesPerSite << " per site";
+      }
+      siteValues = values;
+      this->valuesPerSite = valuesPerSite;
+    }
+
+    proc_t DistributionMigration::GetDirectoryRank(site_t globalSiteId, proc_t rankCount) const
+    {
+      // Each rank looks after an equal range of ids.
+      const site_t idsPerRank = (globalSiteCount + rankCount - 1) / rankCount;
+      return proc_t(globalSiteId / idsPerRank);
+    }
+
+    template<typename T>
+    std::vector<T> DistributionMigration::Exchange(const net::MpiCommunicator& comms,
+                                                   const std::vector<T>& values,
+                                                   const std::vector<int>& sendCounts,
+                                                   std::vector<int>& receiveCounts)
+    {
+      receiveCounts = comms.AllToAll(sendCounts);
+      return comms.AllToAllV(values, sendCounts, receiveCounts);
+    }
+
+    void DistributionMigration::MoveTo(LatticeData& latticeData,
+                                       const net::MpiCommunicator& comms) const
+    {
+      std::vector<distribn_t> movedValues;
+      MoveTo(latticeData, comms, movedValues);
+    }
+
+    void DistributionMigration::MoveTo(LatticeData& latticeData,
+                                       const net::MpiCommunicator& comms,
+                                       std::vector<distribn_t>& movedValues) const
+    {
+      const proc_t rankCount = comms.Size();
+
+      // Sort the ids of the sites that were here, and of those that are here now, by directory
+      // rank, remembering where each came from.
+      std::vector<std::pair<proc_t, site_t> > oldSitesByDirectory(siteIds.size());
+      for (site_t site = 0; site < (site_t) siteIds.size(); ++site)
+      {
+        oldSitesByDirectory[site] = std::make_pair(GetDirectoryRank(siteIds[site], rankCount), site);
+      }
+      std::sort(oldSitesByDirectory.begin(), oldSitesByDirectory.end());
+
+      const site_t newSiteCount = latticeData.GetLocalFluidSiteCount();
+      std::vector<std::pair<proc_t, site_t> > newSitesByDirectory(newSiteCount);
+      for (site_t site = 0; site < newSiteCount; ++site)
+      {
+        const site_t id =
+            latticeData.GetGlobalNoncontiguousSiteIdFromGlobalCoords(latticeData.GetSite(site).GetGlobalSiteCoords());
+        newSitesByDirectory[site] = std::make_pair(GetDirectoryRank(id, rankCount), id);
+      }
+      std::sort(newSitesByDirectory.begin(), newSitesByDirectory.end());
+
+      std::vector<int> oldSendCounts(rankCount, 0), newSendCounts(rankCount, 0);
+      std::vector<site_t> oldIds(siteIds.size()), newIds(newSiteCount);
+      for (size_t site = 0; site < oldSitesByDirectory.size(); ++site)
+      {
+        ++oldSendCounts[oldSitesByDirectory[site].first];
+        oldIds[site] = siteIds[oldSitesByDirectory[site].second];
+      }
+      for (site_t site = 0; site < newSiteCount; ++site)
+      {
+        ++newSendCounts[newSitesByDirectory[site].first];
+        newIds[site] = newSitesByDirectory[site].second;
+      }
+
+      // Tell the directories where every site is now...
+      std::vector<int> newReceiveCounts;
+      const std::vector<site_t> directoryNewIds = Exchange(comms,
+                                                           newIds,
+                                                           newSendCounts,
+                                                           newReceiveCounts);
+      std::vector<std::pair<site_t, proc_t> > newRankForIds;
+      newRankForIds.reserve(directoryNewIds.size());
+      size_t received = 0;
+      for (proc_t rank = 0; rank < rankCount; ++rank)
+      {
+        for (int i = 0; i < newReceiveCounts[rank]; ++i, ++received)
+        {
+          newRankForIds.push_back(std::make_pair(directoryNewIds[received], rank));
+        }
+      }
+      std::sort(newRankForIds.begin(), newRankForIds.end());
+
+      // ... and ask them where the sites that were here have gone.
+      std::vector<int> oldReceiveCounts;
+      const std::vector<site_t> directoryOldIds = Exchange(comms,
+                                                           oldIds,
+                                                           oldSendCounts,
+                                                           oldReceiveCounts);
+      std::vector<proc_t> directoryAnswers(directoryOldIds.size());
+      for (size_t i = 0; i < directoryOldIds.size(); ++i)
+      {
+        const std::vector<std::pair<site_t, proc_t> >::const_iterator found =
+            std::lower_bound(newRankForIds.begin(),
+                             newRankForIds.end(),
+                             std::make_pair(directoryOldIds[i], proc_t(0)));
+        if (found == newRankForIds.end() || found->first != directoryOldIds[i])
+        {
+          throw Exception() << "Site " << directoryOldIds[i] << " is missing from the new decomposition";
+        }
+        directoryAnswers[i] = found->second;
+      }
+      std::vector<int> answerCounts;
+      const std::vector<proc_t> newRankForOldSites = Exchange(comms,
+                                                              directoryAnswers,
+                                                              oldReceiveCounts,
+                                                              answerCounts);
+
+      // Send each site's distributions, followed by any other values, to its new rank.
+      const unsigned sentPerSite = numVectors + valuesPerSite;
+      std::vector<std::pair<proc_t, site_t> > oldSitesByNewRank(siteIds.size());
+      for (size_t i = 0; i < oldSitesByDirectory.size(); ++i)
+      {
+        oldSitesByNewRank[i] = std::make_pair(newRankForOldSites[i], oldSitesByDirectory[i].second);
+      }
+      std::sort(oldSitesByNewRank.begin(), oldSitesByNewRank.end());
+
+      std::vector<int> idSendCounts(rankCount, 0), distributionSendCounts(rankCount, 0);
+      std::vector<site_t> sentIds(siteIds.size());
+      std::vector<distribn_t> sentDistributions(siteIds.size() * sentPerSite);
+      for (size_t i = 0; i < oldSitesByNewRank.size(); ++i)
+      {
+        const site_t site = oldSitesByNewRank[i].second;
+        ++idSendCounts[oldSitesByNewRank[i].first];
+        distributionSendCounts[oldSitesByNewRank[i].first] += sentPerSite;
+        sentIds[i] = siteIds[site];
+        std::copy(&distributions[site * numVectors],
+                  &distributions[site * numVectors] + numVectors,
+                  &sentDistributions[i * sentPerSite]);
+        if (valuesPerSite > 0)
+        {
+          std::copy(&siteValues[site * valuesPerSite],
+                    &siteValues[site * valuesPerSite] + valuesPerSite,
+                    &sentDistributions[i * sentPerSite + numVectors]);
+        }
+      }
+
+      std::vector<int> idReceiveCounts, distributionReceiveCounts;
+      const std::vector<site_t> receivedIds = Exchange(comms,
+                                                       sentIds,
+                                                       idSendCounts,
+                                                       idReceiveCounts);
+      const std::vector<distribn_t> receivedDistributions = Exchange(comms,
+                                                                     sentDistributions,
+                                                                     distributionSendCounts,
+                                                                     distributionReceiveCounts);
+
+      if ((site_t) receivedIds.size() != newSiteCount)
+      {
+        throw Exception() << "Received " << receivedIds.size() << " sites' distributions but have "
+            << newSiteCount << " sites";
+      }
+      movedValues.resize(newSiteCount * valuesPerSite);
+      for (size_t i = 0; i < receivedIds.size(); ++i)
+      {
+        const site_t site = latticeData.GetLocalContiguousIdFromGlobalNoncontiguousId(receivedIds[i]);
+        latticeData.SetFOld(site, &receivedDistributions[i * sentPerSite]);
+        if (valuesPerSite > 0)
+        {
+          std::copy(&receivedDistributions[i * sentPerSite + numVectors],
+                    &receivedDistributions[i * sentPerSite] + sentPerSite,
+                    &movedValues[site * valuesPerSite]);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,97 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DISTRIBUTIONMIGRATION_H
+#define HEMELB_GEOMETRY_DISTRIBUTIONMIGRATION_H
+
+#include <vector>
+#include "geometry/LatticeData.h"
+#include "net/MpiCommunicator.h"
+#include "units.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * Carries the distributions of the fluid sites over from one decomposition of the domain
+     * to another, so the simulation can carry on after repartitioning.
+     *
+     * The distributions are copied out of the old lattice data, which can then be deleted.
+     * Once the new lattice data exists, each site's distributions are sent straight to the
+     * rank that now has it. Neither rank knows the other, so they meet at a directory rank
+     * chosen from the site's position, which tells the old rank where the site has gone.
+     */
+    class DistributionMigration
+    {
+      public:
+        /**
+         * Copy the distributions of every fluid site on this rank, as at the start of a time
+         * step.
+         *
+         * @param latticeData
+         */
+        DistributionMigration(const LatticeData& latticeData);
+
+        /**
+         * Store the copied distributions in a new decomposition of the same domain. A
+         * collective operation.
+         *
+         * @param latticeData
+         * @param comms
+         */
+        void MoveTo(LatticeData& latticeData, const net::MpiCommunicator& comms) const;
+
+        /**
+         * Also carry over some other values of every fluid site on this rank, in the same order
+         * as the sites.
+         *
+         * @param values
+         * @param valuesPerSite
+         */
+        void AddSiteValues(const std::vector<distribn_t>& values, unsigned valuesPerSite);
+
+        /**
+         * Store the copied distributions in a new decomposition of the same domain, as above,
+         * and get the other values carried over, in the order of the new decomposition's sites.
+         *
+         * @param latticeData
+         * @param comms
+         * @param movedValues
+         */
+        void MoveTo(LatticeData& latticeData, const net::MpiCommunicator& comms,
+                    std::vector<distribn_t>& movedValues) const;
+
+      private:
+        /**
+         * The rank that knows where a site is in the new decomposition.
+         */
+        proc_t GetDirectoryRank(site_t globalSiteId, proc_t rankCount) const;
+
+        /**
+         * Send variable numbers of values to each rank, returning the values received and
+         * setting the number from each rank.
+         */
+        template<typename T>
+        static std::vector<T> Exchange(const net::MpiCommunicator& comms,
+                                       const std::vector<T>& values,
+                                       const std::vector<int>& sendCounts,
+                                       std::vector<int>& receiveCounts);
+
+        const unsigned numVectors;
+        //! The number of sites in the bounding box of the domain.
+        const site_t globalSiteCount;
+        //! The global non-contiguous id of each site that was on this rank.
+        std::vector<site_t> siteIds;
+        //! Their distributions, site by site.
+        std::vector<distribn_t> distributions;
+        //! Any other values carried over, site by site.
+        std::vector<distribn_t> siteValues;
+        unsigned valuesPerSite;
+    };
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DISTRIBUTIONMIGRATION_H */
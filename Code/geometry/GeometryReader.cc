@@ -5,6 +5,7 @@
 // license in the file LICENSE.
 
 #include <cmath>
+#include <cstring>
 #include <list>
 #include <map>
 #include <algorithm>
@@ -14,6 +15,7 @@
 #include "io/formats/geometry.h"
 #include "io/writers/xdr/XdrMemReader.h"
 #include "geometry/decomposition/BasicDecomposition.h"
+#include "geometry/decomposition/NodePlacement.h"
 #include "geometry/decomposition/OptimisedDecomposition.h"
 #include "geometry/GeometryReader.h"
 #include "lb/lattices/D3Q27.h"
@@ -26,11 +28,37 @@ namespace hemelb
 {
   namespace geometry
   {
+    namespace
+    {
+      /**
+       * Take the next word of a block's data.
+       */
+      inline uint32_t NextWord(const std::vector<uint32_t>& words, size_t& position)
+      {
+        if (position >= words.size())
+        {
+          throw Exception() << "Malformed GMY file, a block's data ends part way through a site.";
+        }
+        return words[position++];
+      }
+
+      /**
+       * Take the next word of a block's data as a float.
+       */
+      inline float NextFloat(const std::vector<uint32_t>& words, size_t& position)
+      {
+        const uint32_t word = NextWord(words, position);
+        float value;
+        std::memcpy(&value, &word, sizeof(value));
+        return value;
+      }
+    }
 
     GeometryReader::GeometryReader(const bool reserveSteeringCore,
                                    const lb::lattices::LatticeInfo& latticeInfo,
                                    reporting::Timers &atimings, const net::IOCommunicator& ioComm) :
-      latticeInfo(latticeInfo), hemeLbComms(ioComm), timings(atimings)
+      latticeInfo(latticeInfo), hemeLbComms(ioComm), geometryHash(decomposition::DecompositionCache::INITIAL_HASH),
+          timings(atimings)
     {
       // This rank should participate in the domain decomposition if
       //  - there's no steering core (then all ranks are involved)
@@ -61,7 +89,10 @@ namespace hemelb
     {
     }
 
-    Geometry GeometryReader::LoadAndDecompose(const std::string& dataFilePath)
+    Geometry GeometryReader::LoadAndDecompose(const std::string& dataFilePath,
+                                              const std::string& decompositionCachePath,
+                                              decomposition::PartitionMethod partitionMethod,
+                                              const decomposition::SiteWeights& siteWeights)
     {
       log::Logger::Log<log::Debug, log::OnePerCore>("Starting file read timer");
       timings[hemelb::reporting::Timers::fileRead].Start();
@@ -105,6 +136,19 @@ namespace hemelb
       log::Logger::Log<log::Debug, log::OnePerCore>("Beginning initial decomposition");
       principalProcForEachBlock.resize(geometry.GetBlockCount());
 
+      // Only the ranks in the topology use the cache, as only they decompose the geometry.
+      const bool useDecompositionCache = participateInTopology && !decompositionCachePath.empty();
+      decomposition::DecompositionCache decompositionCache(decompositionCachePath,
+                                                           computeComms,
+                                                           useDecompositionCache
+                                                             ? GetDecompositionKey(partitionMethod, siteWeights)
+                                                             : 0);
+      std::vector<bool> blockHasSitesHere;
+      const bool useCachedDecomposition = useDecompositionCache
+          && decompositionCache.ReadBlocksWithSitesOn(ConvertTopologyRankToGlobalRank(computeComms.Rank()),
+                                                       geometry.GetBlockCount(),
+                                                       blockHasSitesHere);
+
       if (!participateInTopology)
       {
         // If we are the steering core, mark them all as unknown.
@@ -113,6 +157,19 @@ namespace hemelb
           principalProcForEachBlock[block] = -1;
         }
       }
+      else if (useCachedDecomposition)
+      {
+        // The cache tells us which blocks we have sites on, so reading those (and their halo)
+        // gets us everything the final decomposition needs.
+        log::Logger::Log<log::Info, log::Singleton>("Using the decomposition cached in %s",
+                                                    decompositionCachePath.c_str());
+        for (site_t block = 0; block < geometry.GetBlockCount(); ++block)
+        {
+          principalProcForEachBlock[block] = blockHasSitesHere[block]
+            ? computeComms.Rank()
+            : -1;
+        }
+      }
       else
       {
         // Get an initial base-level decomposition of the domain macro-blocks over processors.
@@ -155,9 +212,26 @@ namespace hemelb
       // domain decomposition.
       if (participateInTopology)
       {
-        log::Logger::Log<log::Debug, log::OnePerCore>("Beginning domain decomposition optimisation");
-        OptimiseDomainDecomposition(geometry, principalProcForEachBlock);
-        log::Logger::Log<log::Debug, log::OnePerCore>("Ending domain decomposition optimisation");
+        if (useCachedDecomposition)
+        {
+          decompositionCache.ReadSiteRanks(geometry, fluidSitesOnEachBlock);
+        }
+        else
+        {
+          log::Logger::Log<log::Debug, log::OnePerCore>("Beginning domain decomposition optimisation");
+          OptimiseDomainDecomposition(geometry,
+                                      principalProcForEachBlock,
+                                      partitionMethod,
+                                      siteWeights);
+          log::Logger::Log<log::Debug, log::OnePerCore>("Ending domain decomposition optimisation");
+
+          // Every block has been reread by the rank it was first assigned to, which knows where
+          // all its sites went.
+          if (useDecompositionCache)
+          {
+            decompositionCache.Write(geometry, fluidSitesOnEachBlock, principalProcForEachBlock);
+          }
+        }
 
         if (ShouldValidate())
         {
@@ -193,6 +267,9 @@ namespace hemelb
     {
       const unsigned preambleBytes = io::formats::geometry::PreambleLength;
       std::vector<char> preambleBuffer = ReadOnAllTasks(preambleBytes);
+      geometryHash = decomposition::DecompositionCache::Hash(&preambleBuffer[0],
+                                                             preambleBytes,
+                                                             geometryHash);
 
       // Create an Xdr translator based on the read-in data.
       io::writers::xdr::XdrReader preambleReader = io::writers::xdr::XdrMemReader(&preambleBuffer[0],
@@ -263,6 +340,9 @@ namespace hemelb
     {
       site_t headerByteCount = GetHeaderLength(blockCount);
       std::vector<char> headerBuffer = ReadOnAllTasks(headerByteCount);
+      geometryHash = decomposition::DecompositionCache::Hash(&headerBuffer[0],
+                                                             headerByteCount,
+                                                             geometryHash);
 
       // Create a Xdr translation object to translate from binary
       hemelb::io::writers::xdr::XdrReader preambleReader =
@@ -319,125 +399,231 @@ namespace hemelb
         }
       }
 
+      // The offset of each block in the file, and of the end of the file.
+      std::vector<MPI_Offset> blockOffsets(geometry.GetBlockCount() + 1);
+      blockOffsets[0] = io::formats::geometry::PreambleLength + GetHeaderLength(geometry.GetBlockCount());
+      for (site_t block = 0; block < geometry.GetBlockCount(); ++block)
+      {
+        blockOffsets[block + 1] = blockOffsets[block] + bytesPerCompressedBlock[block];
+      }
+
+      // Each reading core reads a contiguous range of blocks, so that it can read them in a few
+      // large pieces.
+      const proc_t readingGroupSize = util::NumericalFunctions::min(READING_GROUP_SIZE, computeComms.Size());
+      std::vector<site_t> firstBlockOnReadingCore = DivideBlocksBetweenReadingCores(blockOffsets, readingGroupSize);
+
       // Next we spread round the lists of which blocks each core needs access to.
       log::Logger::Log<log::Debug, log::OnePerCore>("Informing reading cores of block needs");
       net::Net net = net::Net(computeComms);
       Needs needs(geometry.GetBlockCount(),
                   readBlock,
-                  util::NumericalFunctions::min(READING_GROUP_SIZE, computeComms.Size()),
+                  readingGroupSize,
                   net,
-                  ShouldValidate());
+                  ShouldValidate(),
+                  firstBlockOnReadingCore);
 
       timings[hemelb::reporting::Timers::readBlocksPrelim].Stop();
       log::Logger::Log<log::Debug, log::OnePerCore>("Reading blocks");
       timings[hemelb::reporting::Timers::readBlocksAll].Start();
 
-      // Set the initial offset to the first block, which will be updated as we progress
-      // through the blocks.
-      MPI_Offset offset = io::formats::geometry::PreambleLength
-          + GetHeaderLength(geometry.GetBlockCount());
-
-      // Iterate over each block.
-      for (site_t nextBlockToRead = 0; nextBlockToRead < geometry.GetBlockCount(); ++nextBlockToRead)
+      // Work through the ranges a slice at a time, to bound the memory needed. Every core knows
+      // the size of every block, so all agree on the slices without communicating.
+      std::vector<site_t> firstBlockToRead(firstBlockOnReadingCore.begin(), firstBlockOnReadingCore.end() - 1);
+      std::vector<site_t> endBlockToRead(readingGroupSize);
+      bool moreToRead = true;
+      while (moreToRead)
       {
-        // Read in the block on all cores (nothing will be done if this core doesn't need the block).
-        ReadInBlock(offset,
-                    geometry,
-                    needs.ProcessorsNeedingBlock(nextBlockToRead),
-                    nextBlockToRead,
-                    readBlock[nextBlockToRead]);
+        moreToRead = false;
+        for (proc_t readingCore = 0; readingCore < readingGroupSize; ++readingCore)
+        {
+          site_t end = firstBlockToRead[readingCore];
+          while (end < firstBlockOnReadingCore[readingCore + 1]
+              && (end == firstBlockToRead[readingCore]
+                  || blockOffsets[end + 1] - blockOffsets[firstBlockToRead[readingCore]] <= READING_SLICE_BYTES))
+          {
+            ++end;
+          }
+          endBlockToRead[readingCore] = end;
+          moreToRead |= (end > firstBlockToRead[readingCore]);
+        }
 
-        // Update the offset to be ready for the next block.
-        offset += bytesPerCompressedBlock[nextBlockToRead];
+        if (moreToRead)
+        {
+          ReadInBlockSlices(geometry, needs, readBlock, blockOffsets, firstBlockToRead, endBlockToRead);
+          firstBlockToRead = endBlockToRead;
+        }
       }
 
       timings[hemelb::reporting::Timers::readBlocksAll].Stop();
     }
 
-    void GeometryReader::ReadInBlock(MPI_Offset offsetSoFar, Geometry& geometry,
-                                     const std::vector<proc_t>& procsWantingThisBlock,
-                                     const site_t blockNumber, const bool neededOnThisRank)
+    std::vector<site_t> GeometryReader::DivideBlocksBetweenReadingCores(const std::vector<MPI_Offset>& blockOffsets,
+                                                                        const proc_t readingGroupSize) const
     {
-      // Easy case if there are no sites on the block.
-      if (fluidSitesOnEachBlock[blockNumber] <= 0)
+      const site_t blockCount = blockOffsets.size() - 1;
+      const MPI_Offset totalBytes = blockOffsets[blockCount] - blockOffsets[0];
+
+      // A block goes to the core whose share of the bytes it starts in.
+      std::vector<site_t> firstBlockOnReadingCore(readingGroupSize + 1, blockCount);
+      firstBlockOnReadingCore[0] = 0;
+      site_t block = 0;
+      for (proc_t readingCore = 1; readingCore < readingGroupSize; ++readingCore)
       {
-        return;
+        const MPI_Offset shareStart = blockOffsets[0] + (totalBytes * readingCore) / readingGroupSize;
+        while (block < blockCount && blockOffsets[block] < shareStart)
+        {
+          ++block;
+        }
+        firstBlockOnReadingCore[readingCore] = block;
       }
-      std::vector<char> compressedBlockData;
-      proc_t readingCore = GetReadingCoreForBlock(blockNumber);
-
-      net::Net net = net::Net(computeComms);
+      return firstBlockOnReadingCore;
+    }
 
-      if (readingCore == computeComms.Rank())
+    void GeometryReader::ReadInBlockSlices(Geometry& geometry, const Needs& needs,
+                                           const std::vector<bool>& readBlock,
+                                           const std::vector<MPI_Offset>& blockOffsets,
+                                           const std::vector<site_t>& firstBlockToRead,
+                                           const std::vector<site_t>& endBlockToRead)
+    {
+      const proc_t localRank = computeComms.Rank();
+      const proc_t readingGroupSize = firstBlockToRead.size();
+
+      // Read the slice, in a single collective call.
+      timings[hemelb::reporting::Timers::readBlock].Start();
+      std::vector<char> sliceData;
+      MPI_Offset sliceOffset = 0;
+      if (localRank < readingGroupSize)
       {
-        timings[hemelb::reporting::Timers::readBlock].Start();
-        // Read the data.
-        compressedBlockData.resize(bytesPerCompressedBlock[blockNumber]);
-        file.ReadAt(offsetSoFar, compressedBlockData);
+        sliceOffset = blockOffsets[firstBlockToRead[localRank]];
+        sliceData.resize(blockOffsets[endBlockToRead[localRank]] - sliceOffset);
+      }
+      file.ReadAtAll(sliceOffset, sliceData);
 
-        // Spread it.
-        for (std::vector<proc_t>::const_iterator receiver = procsWantingThisBlock.begin(); receiver
-            != procsWantingThisBlock.end(); receiver++)
+      // Pack each block that has fluid sites for every core that wants it, in block order.
+      std::vector<int> sendCounts(computeComms.Size(), 0);
+      std::vector<char> sendData;
+      if (localRank < readingGroupSize)
+      {
+        for (site_t block = firstBlockToRead[localRank]; block < endBlockToRead[localRank]; ++block)
         {
-          if (*receiver != computeComms.Rank())
+          if (fluidSitesOnEachBlock[block] > 0)
           {
-
-            net.RequestSendV(compressedBlockData, *receiver);
+            const std::vector<proc_t>& procsWantingThisBlock = needs.ProcessorsNeedingBlock(block);
+            for (std::vector<proc_t>::const_iterator receiver = procsWantingThisBlock.begin();
+                receiver != procsWantingThisBlock.end(); ++receiver)
+            {
+              sendCounts[*receiver] += bytesPerCompressedBlock[block];
+            }
           }
         }
-        timings[hemelb::reporting::Timers::readBlock].Stop();
-      }
-      else if (neededOnThisRank)
-      {
-        compressedBlockData.resize(bytesPerCompressedBlock[blockNumber]);
 
-        net.RequestReceiveV(compressedBlockData, readingCore);
+        std::vector<int> packedSoFar(computeComms.Size(), 0);
+        for (proc_t receiver = 1; receiver < computeComms.Size(); ++receiver)
+        {
+          packedSoFar[receiver] = packedSoFar[receiver - 1] + sendCounts[receiver - 1];
+        }
+        sendData.resize(packedSoFar.back() + sendCounts.back());
 
+        for (site_t block = firstBlockToRead[localRank]; block < endBlockToRead[localRank]; ++block)
+        {
+          if (fluidSitesOnEachBlock[block] > 0)
+          {
+            const std::vector<proc_t>& procsWantingThisBlock = needs.ProcessorsNeedingBlock(block);
+            const char* blockData = &sliceData[blockOffsets[block] - sliceOffset];
+            for (std::vector<proc_t>::const_iterator receiver = procsWantingThisBlock.begin();
+                receiver != procsWantingThisBlock.end(); ++receiver)
+            {
+              std::copy(blockData, blockData + bytesPerCompressedBlock[block], &sendData[packedSoFar[*receiver]]);
+              packedSoFar[*receiver] += bytesPerCompressedBlock[block];
+            }
+          }
+        }
       }
-      else
+      timings[hemelb::reporting::Timers::readBlock].Stop();
+
+      // Every core knows which blocks it needs and how big they are, so it knows how much to
+      // expect from each reading core.
+      std::vector<int> receiveCounts(computeComms.Size(), 0);
+      for (proc_t readingCore = 0; readingCore < readingGroupSize; ++readingCore)
       {
-        return;
+        for (site_t block = firstBlockToRead[readingCore]; block < endBlockToRead[readingCore]; ++block)
+        {
+          if (fluidSitesOnEachBlock[block] > 0 && readBlock[block])
+          {
+            receiveCounts[readingCore] += bytesPerCompressedBlock[block];
+          }
+        }
       }
+
       timings[hemelb::reporting::Timers::readNet].Start();
-      net.Dispatch();
+      std::vector<char> receivedData = computeComms.AllToAllV(sendData, sendCounts, receiveCounts);
       timings[hemelb::reporting::Timers::readNet].Stop();
+
       timings[hemelb::reporting::Timers::readParse].Start();
-      if (neededOnThisRank)
+      // The received blocks are in order of reading core, then block.
+      std::vector<char>::const_iterator nextBlockData = receivedData.begin();
+      for (proc_t readingCore = 0; readingCore < readingGroupSize; ++readingCore)
       {
-        // Create an Xdr interpreter.
-        std::vector<char> blockData = DecompressBlockData(compressedBlockData,
-                                                          bytesPerUncompressedBlock[blockNumber]);
-        io::writers::xdr::XdrMemReader lReader(&blockData.front(), blockData.size());
-
-        ParseBlock(geometry, blockNumber, lReader);
-
-        // If debug-level logging, check that we've read in as many sites as anticipated.
-        if (ShouldValidate())
+        for (site_t block = firstBlockToRead[readingCore]; block < endBlockToRead[readingCore]; ++block)
         {
-          // Count the sites read,
-          site_t numSitesRead = 0;
-          for (site_t site = 0; site < geometry.GetSitesPerBlock(); ++site)
+          // Easy case if there are no sites on the block.
+          if (fluidSitesOnEachBlock[block] <= 0)
           {
-            if (geometry.Blocks[blockNumber].Sites[site].targetProcessor != SITE_OR_BLOCK_SOLID)
-            {
-              ++numSitesRead;
-            }
+            continue;
+          }
+
+          if (readBlock[block])
+          {
+            std::vector<char> compressedBlockData(nextBlockData, nextBlockData + bytesPerCompressedBlock[block]);
+            nextBlockData += bytesPerCompressedBlock[block];
+            ParseCompressedBlock(geometry, block, compressedBlockData);
           }
-          // Compare with the sites we expected to read.
-          if (numSitesRead != fluidSitesOnEachBlock[blockNumber])
+          else if (!geometry.Blocks[block].Sites.empty())
           {
-            log::Logger::Log<log::Error, log::OnePerCore>("Was expecting %i fluid sites on block %i but actually read %i",
-                                                          fluidSitesOnEachBlock[blockNumber],
-                                                          blockNumber,
-                                                          numSitesRead);
+            geometry.Blocks[block].Sites = std::vector<GeometrySite>(0, GeometrySite(false));
           }
         }
       }
-      else if (!geometry.Blocks[blockNumber].Sites.empty())
+      timings[hemelb::reporting::Timers::readParse].Stop();
+    }
+
+    void GeometryReader::ParseCompressedBlock(Geometry& geometry, const site_t blockNumber,
+                                              const std::vector<char>& compressedBlockData)
+    {
+      // Create an Xdr interpreter.
+      std::vector<char> blockData = DecompressBlockData(compressedBlockData,
+                                                        bytesPerUncompressedBlock[blockNumber]);
+      io::writers::xdr::XdrMemReader lReader(&blockData.front(), blockData.size());
+
+      // Every value in the block is a 4-byte XDR word, so decode them all in one go.
+      std::vector<uint32_t> words(blockData.size() / sizeof(uint32_t));
+      if (!words.empty())
       {
-        geometry.Blocks[blockNumber].Sites = std::vector<GeometrySite>(0, GeometrySite(false));
+        lReader.readUnsignedInts(&words.front(), words.size());
+      }
+      ParseBlock(geometry, blockNumber, words);
+
+      // If debug-level logging, check that we've read in as many sites as anticipated.
+      if (ShouldValidate())
+      {
+        // Count the sites read,
+        site_t numSitesRead = 0;
+        for (site_t site = 0; site < geometry.GetSitesPerBlock(); ++site)
+        {
+          if (geometry.Blocks[blockNumber].Sites[site].targetProcessor != SITE_OR_BLOCK_SOLID)
+          {
+            ++numSitesRead;
+          }
+        }
+        // Compare with the sites we expected to read.
+        if (numSitesRead != fluidSitesOnEachBlock[blockNumber])
+        {
+          log::Logger::Log<log::Error, log::OnePerCore>("Was expecting %i fluid sites on block %i but actually read %i",
+                                                        fluidSitesOnEachBlock[blockNumber],
+                                                        blockNumber,
+                                                        numSitesRead);
+        }
       }
-      timings[hemelb::reporting::Timers::readParse].Stop();
     }
 
     std::vector<char> GeometryReader::DecompressBlockData(const std::vector<char>& compressed,
@@ -479,28 +665,23 @@ namespace hemelb
     }
 
     void GeometryReader::ParseBlock(Geometry& geometry, const site_t block,
-                                    io::writers::xdr::XdrReader& reader)
+                                    const std::vector<uint32_t>& words)
     {
       // We start by clearing the sites on the block. We read the blocks twice (once before
       // optimisation and once after), so there can be sites on the block from the previous read.
       geometry.Blocks[block].Sites.clear();
 
+      size_t position = 0;
       for (site_t localSiteIndex = 0; localSiteIndex < geometry.GetSitesPerBlock(); ++localSiteIndex)
       {
-        geometry.Blocks[block].Sites.push_back(ParseSite(reader));
+        geometry.Blocks[block].Sites.push_back(ParseSite(words, position));
       }
     }
 
-    GeometrySite GeometryReader::ParseSite(io::writers::xdr::XdrReader& reader)
+    GeometrySite GeometryReader::ParseSite(const std::vector<uint32_t>& words, size_t& position)
     {
       // Read the fluid property.
-      unsigned isFluid;
-      bool success = reader.readUnsignedInt(isFluid);
-
-      if (!success)
-      {
-        log::Logger::Log<log::Error, log::OnePerCore>("Error reading site type");
-      }
+      const unsigned isFluid = NextWord(words, position);
 
       /// @todo #598 use constant in hemelb::io::formats::geometry
       GeometrySite readInSite(isFluid != 0);
@@ -522,8 +703,7 @@ namespace hemelb
       for (Direction readDirection = 0; readDirection < neighbourhood.size(); readDirection++)
       {
         // read the type of the intersection and create a link...
-        unsigned intersectionType;
-        reader.readUnsignedInt(intersectionType);
+        const unsigned intersectionType = NextWord(words, position);
 
         GeometrySiteLink link;
         link.type = (GeometrySiteLink::IntersectionType) intersectionType;
@@ -532,21 +712,14 @@ namespace hemelb
         if (link.type == GeometrySiteLink::WALL_INTERSECTION)
         {
           isGmyWallSite = true;
-          float distance;
-          reader.readFloat(distance);
-          link.distanceToIntersection = distance;
+          link.distanceToIntersection = NextFloat(words, position);
         }
         // inlets and outlets (which together with none make up the other intersection types)
         // have an iolet id and a distance float...
         else if (link.type != GeometrySiteLink::NO_INTERSECTION)
         {
-          float distance;
-          unsigned ioletId;
-          reader.readUnsignedInt(ioletId);
-          reader.readFloat(distance);
-
-          link.ioletId = ioletId;
-          link.distanceToIntersection = distance;
+          link.ioletId = NextWord(words, position);
+          link.distanceToIntersection = NextFloat(words, position);
         }
 
         // Now, attempt to match the direction read from the local neighbourhood to one in the
@@ -563,8 +736,7 @@ namespace hemelb
         }
       }
 
-      unsigned normalAvailable;
-      reader.readUnsignedInt(normalAvailable);
+      const unsigned normalAvailable = NextWord(words, position);
       readInSite.wallNormalAvailable = (normalAvailable
           == io::formats::geometry::WALL_NORMAL_AVAILABLE);
 
@@ -579,20 +751,14 @@ namespace hemelb
 
       if (readInSite.wallNormalAvailable)
       {
-        reader.readFloat(readInSite.wallNormal[0]);
-        reader.readFloat(readInSite.wallNormal[1]);
-        reader.readFloat(readInSite.wallNormal[2]);
+        readInSite.wallNormal[0] = NextFloat(words, position);
+        readInSite.wallNormal[1] = NextFloat(words, position);
+        readInSite.wallNormal[2] = NextFloat(words, position);
       }
 
       return readInSite;
     }
 
-    proc_t GeometryReader::GetReadingCoreForBlock(site_t blockNumber)
-    {
-      return proc_t(blockNumber % util::NumericalFunctions::min(READING_GROUP_SIZE,
-                                                                computeComms.Size()));
-    }
-
     /**
      * This function is only called if in geometry-validation mode.
      * @param geometry
@@ -754,14 +920,18 @@ namespace hemelb
     }
 
     void GeometryReader::OptimiseDomainDecomposition(Geometry& geometry,
-                                                     const std::vector<proc_t>& procForEachBlock)
+                                                     const std::vector<proc_t>& procForEachBlock,
+                                                     decomposition::PartitionMethod partitionMethod,
+                                                     const decomposition::SiteWeights& siteWeights)
     {
       decomposition::OptimisedDecomposition optimiser(timings,
                                                       computeComms,
                                                       geometry,
                                                       latticeInfo,
                                                       procForEachBlock,
-                                                      fluidSitesOnEachBlock);
+                                                      fluidSitesOnEachBlock,
+                                                      partitionMethod,
+                                                      siteWeights);
 
       timings[hemelb::reporting::Timers::reRead].Start();
       log::Logger::Log<log::Debug, log::OnePerCore>("Rereading blocks");
@@ -895,6 +1065,39 @@ namespace hemelb
       }
     }
 
+    uint64_t GeometryReader::GetDecompositionKey(decomposition::PartitionMethod partitionMethod,
+                                                 const decomposition::SiteWeights& siteWeights) const
+    {
+      // The decomposition depends on the block layout and fluid site counts (which the header
+      // gives without reading every block), how sites are linked and weighted, how they're
+      // partitioned, and the ranks and which of them share a node, as the parts are placed on
+      // nodes after partitioning.
+      const unsigned latticeVectors = latticeInfo.GetNumVectors();
+      const int ranks[2] = { hemeLbComms.Size(), computeComms.Size() };
+      uint64_t key = decomposition::DecompositionCache::Hash(&latticeVectors,
+                                                             sizeof(latticeVectors),
+                                                             geometryHash);
+      key = decomposition::DecompositionCache::Hash(&partitionMethod, sizeof(partitionMethod), key);
+      for (unsigned type = 0; type < decomposition::SiteWeights::TYPE_COUNT; ++type)
+      {
+        const int weight = siteWeights[type];
+        key = decomposition::DecompositionCache::Hash(&weight, sizeof(weight), key);
+      }
+      const std::vector<float>& blockLoadFactors = siteWeights.GetBlockLoadFactors();
+      if (!blockLoadFactors.empty())
+      {
+        key = decomposition::DecompositionCache::Hash(&blockLoadFactors[0],
+                                                      sizeof(float) * blockLoadFactors.size(),
+                                                      key);
+      }
+      key = decomposition::DecompositionCache::Hash(ranks, sizeof(ranks), key);
+      const decomposition::NodePlacement nodePlacement(computeComms);
+      const std::vector<int>& nodeForEachRank = nodePlacement.GetNodeForEachRank();
+      return decomposition::DecompositionCache::Hash(&nodeForEachRank[0],
+                                                     sizeof(int) * nodeForEachRank.size(),
+                                                     key);
+    }
+
     proc_t GeometryReader::ConvertTopologyRankToGlobalRank(proc_t topologyRankIn) const
     {
       // If the global rank is not equal to the topology rank, we are not using rank 0 for
@@ -20,6 +20,9 @@
 #include "units.h"
 #include "geometry/Geometry.h"
 #include "geometry/needs/Needs.h"
+#include "geometry/decomposition/DecompositionCache.h"
+#include "geometry/decomposition/PartitionMethod.h"
+#include "geometry/decomposition/SiteWeights.h"
 
 #include "net/MpiFile.h"
 
@@ -37,7 +40,22 @@ namespace hemelb
                        reporting::Timers &timings, const net::IOCommunicator& ioComm);
         ~GeometryReader();
 
-        Geometry LoadAndDecompose(const std::string& dataFilePath);
+        /**
+         * Read the geometry file and decompose it between the ranks.
+         *
+         * @param dataFilePath The geometry (.gmy) file.
+         * @param decompositionCachePath If not empty, a file to take the decomposition from if it
+         * was saved for this geometry and number of ranks, and otherwise to save it to.
+         * @param partitionMethod How to divide the sites between the ranks.
+         * @param siteWeights The relative cost of each type of site, to balance the load.
+         * @return
+         */
+        Geometry LoadAndDecompose(const std::string& dataFilePath,
+                                  const std::string& decompositionCachePath = std::string(),
+                                  decomposition::PartitionMethod partitionMethod =
+                                      decomposition::ParMetisPartition,
+                                  const decomposition::SiteWeights& siteWeights =
+                                      decomposition::SiteWeights());
 
       private:
         /**
@@ -77,19 +95,43 @@ namespace hemelb
                                                                const proc_t localRank);
 
         /**
-         * Reads in a single block and ensures it is distributed to all cores that need it.
+         * Divide the blocks into one contiguous range for each reading core, with roughly the
+         * same number of bytes of block data in each.
+         *
+         * @param blockOffsets [in] The offset of each block in the file, and of the end of the last.
+         * @param readingGroupSize [in] The number of reading cores.
+         * @return The first block of each reading core's range, then the block count.
+         */
+        std::vector<site_t> DivideBlocksBetweenReadingCores(const std::vector<MPI_Offset>& blockOffsets,
+                                                            const proc_t readingGroupSize) const;
+
+        /**
+         * Collectively read the next slice of blocks on each reading core, and distribute them to
+         * all cores that need them in a single exchange.
+         *
+         * @param geometry [out] The geometry object to populate with info about the blocks.
+         * @param needs [in] Which procs need each of the blocks this core reads.
+         * @param readBlock [in] Which blocks are needed on this core.
+         * @param blockOffsets [in] The offset of each block in the file, and of the end of the last.
+         * @param firstBlockToRead [in] The first block each reading core reads this time.
+         * @param endBlockToRead [in] One past the last block each reading core reads this time.
+         */
+        void ReadInBlockSlices(Geometry& geometry,
+                               const Needs& needs,
+                               const std::vector<bool>& readBlock,
+                               const std::vector<MPI_Offset>& blockOffsets,
+                               const std::vector<site_t>& firstBlockToRead,
+                               const std::vector<site_t>& endBlockToRead);
+
+        /**
+         * Decompress and parse a block of data that has been read in for this core.
          *
-         * @param offsetSoFar [in] The offset into the file to read from to get the block.
          * @param geometry [out] The geometry object to populate with info about the block.
-         * @param procsWantingThisBlock [in] A list of proc ids where info about this block is required.
-         * @param blockNumber [in] The id of the block we're reading.
-         * @param neededOnThisRank [in] A boolean indicating whether the block is required locally.
+         * @param blockNumber [in] The id of the block.
+         * @param compressedBlockData [in] The block as it is in the file.
          */
-        void ReadInBlock(MPI_Offset offsetSoFar,
-                         Geometry& geometry,
-                         const std::vector<proc_t>& procsWantingThisBlock,
-                         const site_t blockNumber,
-                         const bool neededOnThisRank);
+        void ParseCompressedBlock(Geometry& geometry, const site_t blockNumber,
+                                  const std::vector<char>& compressedBlockData);
 
         /**
          * Decompress the block data. Uses the known number of sites to get an
@@ -102,31 +144,34 @@ namespace hemelb
         std::vector<char> DecompressBlockData(const std::vector<char>& compressed,
                                               const unsigned int uncompressedBytes);
 
-        void ParseBlock(Geometry& geometry, const site_t block, io::writers::xdr::XdrReader& reader);
-
         /**
-         * Parse the next site from the XDR reader. Note that we return by copy here.
-         * @param reader
-         * @return
+         * Parse the sites of a block from its uncompressed data, decoded from XDR into the
+         * 32-bit words that every value of the block is stored as.
+         * @param geometry
+         * @param block
+         * @param words
          */
-        GeometrySite ParseSite(io::writers::xdr::XdrReader& reader);
+        void ParseBlock(Geometry& geometry, const site_t block, const std::vector<uint32_t>& words);
 
         /**
-         * Calculates the number of the rank used to read in a given block.
-         * Intent is to move this into Decomposition class, which will also handle knowledge of which procs to use for reading, and own the decomposition topology.
-         *
-         * @param blockNumber
+         * Parse the next site from the block's words. Note that we return by copy here.
+         * @param words
+         * @param position The index of the site's first word, moved on past its last.
          * @return
          */
-        proc_t GetReadingCoreForBlock(site_t blockNumber);
+        GeometrySite ParseSite(const std::vector<uint32_t>& words, size_t& position);
 
         /**
          * Optimise the domain decomposition using ParMetis. We take this approach because ParMetis
          * is more efficient when given an initial decomposition to start with.
          * @param geometry
          * @param procForEachBlock
+         * @param partitionMethod
+         * @param siteWeights
          */
-        void OptimiseDomainDecomposition(Geometry& geometry, const std::vector<proc_t>& procForEachBlock);
+        void OptimiseDomainDecomposition(Geometry& geometry, const std::vector<proc_t>& procForEachBlock,
+                                         decomposition::PartitionMethod partitionMethod,
+                                         const decomposition::SiteWeights& siteWeights);
 
         void ValidateGeometry(const Geometry& geometry);
 
@@ -148,6 +193,16 @@ namespace hemelb
                             const std::vector<idx_t>& movesFromEachProc,
                             const std::vector<idx_t>& movesList) const;
 
+        /**
+         * Get the key identifying decompositions of this geometry, lattice and set of ranks in
+         * the decomposition cache. A collective operation over the ranks in the topology.
+         * @param partitionMethod
+         * @param siteWeights
+         * @return
+         */
+        uint64_t GetDecompositionKey(decomposition::PartitionMethod partitionMethod,
+                                     const decomposition::SiteWeights& siteWeights) const;
+
         proc_t ConvertTopologyRankToGlobalRank(proc_t topologyRank) const;
 
         /**
@@ -160,6 +215,9 @@ namespace hemelb
         static const proc_t HEADER_READING_RANK = 0;
         //! The number of cores (0-READING_GROUP_SIZE-1) that read files in parallel
         static const proc_t READING_GROUP_SIZE = HEMELB_READING_GROUP_SIZE;
+        //! The most block data each reading core reads and sends on at once, unless a single
+        //! block is bigger.
+        static const MPI_Offset READING_SLICE_BYTES = 1 << 26;
 
         //! Info about the connectivity of the lattice.
         const lb::lattices::LatticeInfo& latticeInfo;
@@ -180,6 +238,8 @@ namespace hemelb
         std::vector<unsigned int> bytesPerUncompressedBlock;
         //! The processor assigned to each block.
         std::vector<proc_t> principalProcForEachBlock;
+        //! Hash of the file preamble and header, to identify the geometry.
+        uint64_t geometryHash;
 
         //! Timings object for recording the time taken for each step of the domain decomposition.
         hemelb::reporting::Timers &timings;
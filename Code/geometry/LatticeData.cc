@@ -4,6 +4,7 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include <map>
 #include <limits>
 
@@ -14,23 +15,25 @@
 #include "geometry/LatticeData.h"
 #include "geometry/neighbouring/NeighbouringLatticeData.h"
 #include "util/utilityFunctions.h"
+#include "util/Threading.h"
 
 namespace hemelb
 {
   namespace geometry
   {
     LatticeData::LatticeData(const lb::lattices::LatticeInfo& latticeInfo, const net::IOCommunicator& comms_) :
-        latticeInfo(latticeInfo), neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), comms(comms_)
+        latticeInfo(latticeInfo), neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), nodeHalo(NULL), comms(comms_)
     {
     }
 
     LatticeData::~LatticeData()
     {
+      delete nodeHalo;
       delete neighbouringData;
     }
 
     LatticeData::LatticeData(const lb::lattices::LatticeInfo& latticeInfo, const Geometry& readResult, const net::IOCommunicator& comms_) :
-        latticeInfo(latticeInfo), neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), comms(comms_)
+        latticeInfo(latticeInfo), neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), nodeHalo(NULL), comms(comms_)
     {
       SetBasicDetails(readResult.GetBlockDimensions(),
                       readResult.GetBlockSize());
@@ -330,6 +333,60 @@ namespace hemelb
       }
     }
 
+    void LatticeData::FirstTouchDistributions()
+    {
+      const Direction numVectors = latticeInfo.GetNumVectors();
+
+      // Walk the collision-type ranges in the same order as LBM does, splitting each one
+      // between threads in the same way.
+      const site_t* collisionCounts[2] = { midDomainProcCollisions, domainEdgeProcCollisions };
+      site_t offset = 0;
+      for (unsigned part = 0; part < 2; part++)
+      {
+        for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; collisionType++)
+        {
+          const site_t firstIndex = offset;
+          const site_t siteCount = collisionCounts[part][collisionType];
+#ifdef HEMELB_USE_OPENMP
+#pragma omp parallel
+#endif
+          {
+            site_t threadFirstIndex, threadSiteCount;
+            util::threading::GetThreadRange(firstIndex, siteCount, threadFirstIndex, threadSiteCount);
+            for (site_t siteIndex = threadFirstIndex; siteIndex < threadFirstIndex + threadSiteCount; siteIndex++)
+            {
+              for (Direction direction = 0; direction < numVectors; direction++)
+              {
+                const site_t distributionIndex = GetDistributionIndex(siteIndex, direction);
+                oldDistributions[distributionIndex] = 0.0;
+#ifndef HEMELB_USE_AA_STREAMING
+                newDistributions[distributionIndex] = 0.0;
+#endif
+              }
+            }
+          }
+          offset += siteCount;
+        }
+      }
+
+      // The rubbish site and the shared distributions are only handled by the master thread.
+      std::fill(oldDistributions.begin() + localFluidSites * numVectors, oldDistributions.end(), 0.0);
+#ifndef HEMELB_USE_AA_STREAMING
+      std::fill(newDistributions.begin() + localFluidSites * numVectors, newDistributions.end(), 0.0);
+#endif
+    }
+
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+    void LatticeData::SetStorageShiftDensity(distribn_t density)
+    {
+      storageShifts.resize(latticeInfo.GetNumVectors());
+      for (Direction direction = 0; direction < latticeInfo.GetNumVectors(); direction++)
+      {
+        storageShifts[direction] = density * latticeInfo.GetEquilibriumWeight(direction);
+      }
+    }
+#endif
+
     void LatticeData::InitialiseNeighbourLookups()
     {
       // Allocate the index in which to put the distribution functions received from the other
@@ -349,6 +406,11 @@ namespace hemelb
       InitialiseNeighbourLookup(sharedDistributionLocationForEachProc);
       InitialisePointToPointComms(sharedDistributionLocationForEachProc);
       InitialiseReceiveLookup(sharedDistributionLocationForEachProc);
+#ifdef HEMELB_USE_SHARED_MEMORY_HALO
+      nodeHalo = new NodeSharedHalo(comms,
+                                    neighbouringProcs,
+                                    GetLocalFluidSiteCount() * latticeInfo.GetNumVectors() + 1);
+#endif
     }
 
     void LatticeData::InitialiseNeighbourLookup(std::vector<std::vector<site_t> >& sharedFLocationForEachProc)
@@ -373,7 +435,7 @@ namespace hemelb
           site_t localIndex = map_block_p.GetLocalContiguousIndexForSite(siteTraverser.GetCurrentIndex());
           // Set neighbour location for the distribution component at the centre of
           // this site.
-          SetNeighbourLocation(localIndex, 0, localIndex * latticeInfo.GetNumVectors() + 0);
+          SetNeighbourLocation(localIndex, 0, GetDistributionIndex(localIndex, 0));
           for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
           {
             util::Vector3D<site_t> currentLocationCoords = blockTraverser.GetCurrentLocation() * blockSize
@@ -406,7 +468,7 @@ namespace hemelb
             {
               // Pointer to the neighbour.
               site_t contigSiteId = GetContiguousSiteId(neighbourCoords);
-              SetNeighbourLocation(localIndex, direction, contigSiteId * latticeInfo.GetNumVectors() + direction);
+              SetNeighbourLocation(localIndex, direction, GetDistributionIndex(contigSiteId, direction));
               continue;
             }
             else
@@ -451,6 +513,7 @@ namespace hemelb
         // other processor.
         if (neigh_proc_p->Rank > localRank)
         {
+          SortSharedDistributions(sharedFLocationForEachProc[neigh_proc_p->Rank]);
           tempNet.RequestSendV(sharedFLocationForEachProc[neigh_proc_p->Rank], neigh_proc_p->Rank);
         }
         else
@@ -497,13 +560,72 @@ namespace hemelb
           SetNeighbourLocation(contigSiteId, (unsigned int) ( (l)), ++f_count);
           // Set the place where we put the received distribution functions, which is
           // f_new[number of fluid site that sends, inverse direction].
-          streamingIndicesForReceivedDistributions[sharedSitesSeen] = contigSiteId * latticeInfo.GetNumVectors()
-              + latticeInfo.GetInverseIndex(l);
+          streamingIndicesForReceivedDistributions[sharedSitesSeen] =
+              GetDistributionIndex(contigSiteId, latticeInfo.GetInverseIndex(l));
           ++sharedSitesSeen;
         }
 
       }
 
+      InitialiseReceivedRuns();
+    }
+
+    void LatticeData::SortSharedDistributions(std::vector<site_t>& sharedFLocations) const
+    {
+      // The lower-ranked of each pair of neighbours decides the order of the distributions they
+      // share, which is the order of the values sent both ways. Order them by where this rank
+      // copies the values it receives, so that they can be copied in long runs. This puts the
+      // values that go to one site together, whatever the layout, and with structure-of-arrays
+      // distributions also those that go to neighbouring sites in the same direction.
+      const site_t sharedCount = sharedFLocations.size() / 4;
+      std::vector<std::pair<site_t, site_t> > targetAndPosition(sharedCount);
+      for (site_t sharedDistributionId = 0; sharedDistributionId < sharedCount; sharedDistributionId++)
+      {
+        const site_t* f_data_p = &sharedFLocations[sharedDistributionId * 4];
+        const site_t contigSiteId = GetContiguousSiteId(util::Vector3D<site_t>(f_data_p[0], f_data_p[1], f_data_p[2]));
+        targetAndPosition[sharedDistributionId] =
+            std::make_pair(GetDistributionIndex(contigSiteId, latticeInfo.GetInverseIndex(f_data_p[3])),
+                           sharedDistributionId);
+      }
+      std::sort(targetAndPosition.begin(), targetAndPosition.end());
+
+      std::vector<site_t> sortedLocations(sharedFLocations.size());
+      for (site_t sharedDistributionId = 0; sharedDistributionId < sharedCount; sharedDistributionId++)
+      {
+        std::copy(&sharedFLocations[targetAndPosition[sharedDistributionId].second * 4],
+                  &sharedFLocations[targetAndPosition[sharedDistributionId].second * 4] + 4,
+                  &sortedLocations[sharedDistributionId * 4]);
+      }
+      sharedFLocations.swap(sortedLocations);
+    }
+
+    void LatticeData::InitialiseReceivedRuns()
+    {
+      receivedRuns.clear();
+      firstReceivedRun.resize(neighbouringProcs.size() + 1);
+
+      site_t received = 0;
+      for (size_t neighbourId = 0; neighbourId < neighbouringProcs.size(); neighbourId++)
+      {
+        firstReceivedRun[neighbourId] = receivedRuns.size();
+        for (site_t sharedDistributionId = 0;
+            sharedDistributionId < neighbouringProcs[neighbourId].SharedDistributionCount;
+            sharedDistributionId++, received++)
+        {
+          const site_t target = streamingIndicesForReceivedDistributions[received];
+          if (receivedRuns.size() > firstReceivedRun[neighbourId]
+              && receivedRuns.back().firstTarget + receivedRuns.back().length == target)
+          {
+            ++receivedRuns.back().length;
+          }
+          else
+          {
+            ReceivedRun run = { target, 1 };
+            receivedRuns.push_back(run);
+          }
+        }
+      }
+      firstReceivedRun[neighbouringProcs.size()] = receivedRuns.size();
     }
 
     proc_t LatticeData::GetProcIdFromGlobalCoords(const util::Vector3D<site_t>& globalSiteCoords) const
@@ -658,26 +780,139 @@ namespace hemelb
       for (std::vector<NeighbouringProcessor>::const_iterator it = neighbouringProcs.begin();
           it != neighbouringProcs.end(); ++it)
       {
+        if (nodeHalo && nodeHalo->IsOnNode(it - neighbouringProcs.begin()))
+        {
+          continue;
+        }
+#ifdef HEMELB_USE_AA_STREAMING
+        // There's only one distribution array, whose shared part we're sending from, so receive
+        // into a separate buffer at the same offset.
+        net->RequestReceive<distribn_storage_t>(&receivedDistributions[ (*it).FirstSharedDistribution
+                                                    - neighbouringProcs[0].FirstSharedDistribution],
+                                                (int) ( ( (*it).SharedDistributionCount)),
+                                                (*it).Rank);
+        // Request the send from the shared part of the array.
+        net->RequestSend<distribn_storage_t>(&oldDistributions[ (*it).FirstSharedDistribution],
+                                             (int) ( ( (*it).SharedDistributionCount)),
+                                             (*it).Rank);
+#else
         // Request the receive into the appropriate bit of FOld.
-        net->RequestReceive<distribn_t>(GetFOld( (*it).FirstSharedDistribution),
-                                        (int) ( ( (*it).SharedDistributionCount)),
-                                        (*it).Rank);
+        net->RequestReceive<distribn_storage_t>(&oldDistributions[ (*it).FirstSharedDistribution],
+                                                (int) ( ( (*it).SharedDistributionCount)),
+                                                (*it).Rank);
         // Request the send from the right bit of FNew.
-        net->RequestSend<distribn_t>(GetFNew( (*it).FirstSharedDistribution),
-                                     (int) ( ( (*it).SharedDistributionCount)),
-                                     (*it).Rank);
+        net->RequestSend<distribn_storage_t>(&newDistributions[ (*it).FirstSharedDistribution],
+                                             (int) ( ( (*it).SharedDistributionCount)),
+                                             (*it).Rank);
+#endif
+        // On even AA steps the values received are copied into the block we sent from, so wait
+        // for the send as well as the receive: the notification covers both.
+        net->RequestExchangeNotification( (*it).Rank, *this);
+      }
+    }
 
+    void LatticeData::ExchangeComplete(proc_t rank)
+    {
+      for (size_t neighbourId = 0; neighbourId < neighbouringProcs.size(); neighbourId++)
+      {
+        if (neighbouringProcs[neighbourId].Rank == rank)
+        {
+          CopyReceived(neighbourId);
+          return;
+        }
       }
     }
 
     void LatticeData::CopyReceived()
     {
+      for (size_t neighbourId = 0; neighbourId < neighbouringProcs.size(); neighbourId++)
+      {
+        CopyReceived(neighbourId);
+      }
+    }
+
+    void LatticeData::CopyReceived(size_t neighbourIndex)
+    {
+      const NeighbouringProcessor& neighbour = neighbouringProcs[neighbourIndex];
+#ifdef HEMELB_USE_AA_STREAMING
+      CopyReceived(neighbourIndex,
+                   &receivedDistributions[neighbour.FirstSharedDistribution
+                       - neighbouringProcs[0].FirstSharedDistribution]);
+#else
+      CopyReceived(neighbourIndex, &oldDistributions[neighbour.FirstSharedDistribution]);
+#endif
+    }
+
+    void LatticeData::CopyReceivedFromNode()
+    {
+      if (!nodeHalo)
+      {
+        return;
+      }
+      for (size_t neighbourId = 0; neighbourId < neighbouringProcs.size(); neighbourId++)
+      {
+        if (nodeHalo->IsOnNode(neighbourId))
+        {
+          CopyReceived(neighbourId, nodeHalo->Receive(neighbourId));
+        }
+      }
+      nodeHalo->EndReceive();
+    }
+
+    void LatticeData::CopyReceived(size_t neighbourIndex, const distribn_storage_t* received)
+    {
+#ifdef HEMELB_USE_AA_STREAMING
+      if (!aaOddStep)
+      {
+        const NeighbouringProcessor& neighbour = neighbouringProcs[neighbourIndex];
+        // After an even step, each received value is one that a local site will pull from its
+        // upstream neighbour on the odd step. The neighbour lookup for that link points at the
+        // shared slot we sent from, which is now free, so put it there.
+        std::copy(received,
+                  received + neighbour.SharedDistributionCount,
+                  &oldDistributions[neighbour.FirstSharedDistribution]);
+        return;
+      }
+      // After an odd step, received values go straight to their site, as usual.
+      DistributionVector& destination = oldDistributions;
+#else
       // Copy the distribution functions received from the neighbouring
-      // processors into the destination buffer "f_new".
-      for (site_t i = 0; i < totalSharedFs; i++)
+      // processors into the destination buffer "f_new". These are copied as stored: see
+      // GetStorageShift.
+      DistributionVector& destination = newDistributions;
+#endif
+      for (std::vector<ReceivedRun>::const_iterator run = receivedRuns.begin() + firstReceivedRun[neighbourIndex];
+          run != receivedRuns.begin() + firstReceivedRun[neighbourIndex + 1]; ++run)
+      {
+        std::copy(received, received + run->length, &destination[run->firstTarget]);
+        received += run->length;
+      }
+    }
+
+    void LatticeData::PackSharedDistributions()
+    {
+#ifdef HEMELB_USE_AA_STREAMING
+      if (!aaOddStep && !neighbouringProcs.empty())
+      {
+        // On even steps the post-collision value for a link to another rank has been written
+        // back to the sending site, in the slot of the opposite direction. That's the same slot
+        // that a value received along the reverse link is copied to after an odd step.
+        distribn_storage_t* shared = &oldDistributions[neighbouringProcs[0].FirstSharedDistribution];
+        for (std::vector<ReceivedRun>::const_iterator run = receivedRuns.begin(); run != receivedRuns.end(); ++run)
+        {
+          shared = std::copy(&oldDistributions[run->firstTarget],
+                             &oldDistributions[run->firstTarget] + run->length,
+                             shared);
+        }
+      }
+#endif
+      if (nodeHalo && !neighbouringProcs.empty())
       {
-        *GetFNew(streamingIndicesForReceivedDistributions[i]) = *GetFOld(neighbouringProcs[0].FirstSharedDistribution
-            + i);
+#ifdef HEMELB_USE_AA_STREAMING
+        nodeHalo->Publish(&oldDistributions[neighbouringProcs[0].FirstSharedDistribution]);
+#else
+        nodeHalo->Publish(&newDistributions[neighbouringProcs[0].FirstSharedDistribution]);
+#endif
       }
     }
 
@@ -16,11 +16,13 @@
 #include "geometry/Block.h"
 #include "geometry/GeometryReader.h"
 #include "geometry/NeighbouringProcessor.h"
+#include "geometry/NodeSharedHalo.h"
 #include "geometry/Site.h"
 #include "geometry/neighbouring/NeighbouringSite.h"
 #include "geometry/SiteData.h"
 #include "reporting/Reportable.h"
 #include "reporting/Timers.h"
+#include "util/UninitialisedAllocator.h"
 #include "util/Vector3D.h"
 
 namespace hemelb
@@ -33,7 +35,7 @@ namespace hemelb
 
   namespace geometry
   {
-    class LatticeData : public reporting::Reportable
+    class LatticeData : public reporting::Reportable, public net::ExchangeListener
     {
       public:
         template<class Lattice> friend class lb::LBM; //! Let the LBM have access to internals so it can initialise the distribution arrays.
@@ -45,15 +47,88 @@ namespace hemelb
 
         /**
          * Swap the fOld and fNew arrays around.
+         *
+         * With in-place AA-pattern streaming (HEMELB_USE_AA_STREAMING) there is only one array,
+         * and this instead moves on to the other half of the even/odd step pair.
          */
         inline void SwapOldAndNew()
         {
+#ifdef HEMELB_USE_AA_STREAMING
+          aaOddStep = !aaOddStep;
+#else
           oldDistributions.swap(newDistributions);
+#endif
         }
 
+        /**
+         * Request the exchange of shared distributions with every neighbouring rank. Each
+         * neighbour's received distributions are copied (see ExchangeComplete) as soon as that
+         * exchange completes, during the Net's Wait.
+         *
+         * With HEMELB_USE_SHARED_MEMORY_HALO, neighbours on the same node are left out: see
+         * CopyReceivedFromNode.
+         *
+         * @param net
+         */
         void SendAndReceive(net::Net* net);
         void CopyReceived();
 
+        /**
+         * Copy the distributions received from one neighbouring rank to the sites they stream
+         * to, so that this can be done as each receive completes.
+         *
+         * @param neighbourIndex The position of the rank among this rank's neighbours.
+         */
+        void CopyReceived(size_t neighbourIndex);
+
+        /**
+         * Copy the distributions from the neighbouring ranks on the same node, once they've
+         * made them available, with HEMELB_USE_SHARED_MEMORY_HALO. Does nothing otherwise.
+         */
+        void CopyReceivedFromNode();
+
+        /**
+         * Copy the distributions received from a neighbouring rank, now that the exchange with it
+         * has completed.
+         *
+         * @param rank
+         */
+        void ExchangeComplete(proc_t rank);
+
+        /**
+         * Fill the buffer of distributions to be sent to neighbouring ranks, once all the
+         * domain-edge sites have been streamed and collided.
+         *
+         * Normally streaming writes straight into that buffer so this does nothing. On the even
+         * steps of the AA pattern every site writes back to itself, so the values that cross to
+         * other ranks have to be copied out.
+         *
+         * With HEMELB_USE_SHARED_MEMORY_HALO, this also makes the distributions available to the
+         * neighbours on the same node.
+         */
+        void PackSharedDistributions();
+
+        /**
+         * Whether the current time step is the odd half of the AA pattern
+         * (HEMELB_USE_AA_STREAMING). Always false otherwise.
+         *
+         * On even steps each site reads its own distributions and writes the post-collision
+         * values back to itself, in the slot of the opposite direction. On odd steps each site
+         * reads from its neighbours' slots and writes to the neighbours' slots in the same
+         * direction. Either way a site only ever overwrites values that it has itself just read,
+         * so a single array suffices.
+         *
+         * @return
+         */
+        inline bool IsAAOddStep() const
+        {
+#ifdef HEMELB_USE_AA_STREAMING
+          return aaOddStep;
+#else
+          return false;
+#endif
+        }
+
         /**
          * Get the lattice info object for the current lattice
          * @return
@@ -142,14 +217,97 @@ namespace hemelb
 
         bool IsValidLatticeSite(const util::Vector3D<site_t>& siteCoords) const;
 
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+        /**
+         * A reference to one stored distribution. With HEMELB_USE_SHIFTED_DISTRIBUTIONS the
+         * lattice data holds the departure of f_i from the equilibrium at rest at the initial
+         * density, which keeps more of the significant digits of f_i in single precision. The
+         * reference reads and writes the full value f_i.
+         */
+        template<typename StorageType>
+        class ShiftedDistributionReference
+        {
+          public:
+            ShiftedDistributionReference(StorageType* stored, distribn_t shift) :
+                stored(stored), shift(shift)
+            {
+            }
+
+            operator distribn_t() const
+            {
+              return *stored + shift;
+            }
+
+            ShiftedDistributionReference& operator=(distribn_t value)
+            {
+              *stored = value - shift;
+              return *this;
+            }
+
+            ShiftedDistributionReference& operator=(const ShiftedDistributionReference& other)
+            {
+              return *this = distribn_t(other);
+            }
+
+          private:
+            StorageType* stored;
+            distribn_t shift;
+        };
+
+        /**
+         * Stands in for a pointer into the distribution arrays, for the same reason. The shift
+         * for the distribution it points at is worked out once, when it's made.
+         */
+        template<typename StorageType>
+        class ShiftedDistributionPointer
+        {
+          public:
+            ShiftedDistributionPointer(StorageType* storage, site_t distributionIndex, const LatticeData& latticeData,
+                                       distribn_t shift) :
+                storage(storage), distributionIndex(distributionIndex), latticeData(&latticeData), shift(shift)
+            {
+            }
+
+            ShiftedDistributionReference<StorageType> operator*() const
+            {
+              return ShiftedDistributionReference<StorageType>(storage + distributionIndex, shift);
+            }
+
+            ShiftedDistributionReference<StorageType> operator[](site_t offset) const
+            {
+              return ShiftedDistributionReference<StorageType>(storage + distributionIndex + offset,
+                                                               offset == 0 ?
+                                                                 shift :
+                                                                 latticeData->GetStorageShift(distributionIndex
+                                                                     + offset));
+            }
+
+          private:
+            StorageType* storage;
+            site_t distributionIndex;
+            const LatticeData* latticeData;
+            distribn_t shift;
+        };
+
+        typedef ShiftedDistributionPointer<distribn_storage_t> DistributionPointer;
+        typedef ShiftedDistributionPointer<const distribn_storage_t> ConstDistributionPointer;
+#else
+        typedef distribn_storage_t* DistributionPointer;
+        typedef const distribn_storage_t* ConstDistributionPointer;
+#endif
+
         /**
          * Get a pointer into the fNew array at the given index
          * @param distributionIndex
          * @return
          */
-        inline distribn_t* GetFNew(site_t distributionIndex)
+        inline DistributionPointer GetFNew(site_t distributionIndex)
         {
-          return &newDistributions[distributionIndex];
+#ifdef HEMELB_USE_AA_STREAMING
+          return MakeDistributionPointer(oldDistributions, distributionIndex);
+#else
+          return MakeDistributionPointer(newDistributions, distributionIndex);
+#endif
         }
 
         /**
@@ -158,9 +316,187 @@ namespace hemelb
          * @param distributionIndex
          * @return
          */
-        inline const distribn_t* GetFNew(site_t siteNumber) const
+        inline ConstDistributionPointer GetFNew(site_t siteNumber) const
+        {
+#ifdef HEMELB_USE_AA_STREAMING
+          return MakeDistributionPointer(oldDistributions, siteNumber);
+#else
+          return MakeDistributionPointer(newDistributions, siteNumber);
+#endif
+        }
+
+        /**
+         * Get a pointer into the fNew array at the index of a distribution whose direction is
+         * known, as it is in the streaming loops. With HEMELB_USE_SHIFTED_DISTRIBUTIONS that
+         * gives the storage shift without working it out from the index.
+         *
+         * @param distributionIndex
+         * @param direction The direction of the distribution at that index, or any direction
+         * with the same lattice weight, such as its inverse.
+         * @return
+         */
+        inline DistributionPointer GetFNew(site_t distributionIndex, Direction direction)
+        {
+#ifdef HEMELB_USE_AA_STREAMING
+          return MakeDistributionPointer(oldDistributions, distributionIndex, direction);
+#else
+          return MakeDistributionPointer(newDistributions, distributionIndex, direction);
+#endif
+        }
+
+        /**
+         * Get the index into the fOld / fNew arrays of the distribution in the given direction
+         * at the given (local, contiguous) site.
+         *
+         * By default the distributions of each site are stored together (array-of-structures).
+         * When built with HEMELB_USE_SOA_DISTRIBUTIONS the distributions for each direction are
+         * stored together instead (structure-of-arrays), so that consecutive sites are adjacent
+         * in memory. In both layouts the fluid sites occupy the first
+         * localFluidSites * NUMVECTORS entries, followed by the 'rubbish site' and the shared
+         * distributions, so only the ordering within that first block depends on the layout.
+         *
+         * @param siteIndex
+         * @param direction
+         * @return
+         */
+        template<typename LatticeType>
+        inline site_t GetDistributionIndex(site_t siteIndex, Direction direction) const
+        {
+#ifdef HEMELB_USE_SOA_DISTRIBUTIONS
+          return direction * localFluidSites + siteIndex;
+#else
+          return siteIndex * LatticeType::NUMVECTORS + direction;
+#endif
+        }
+
+        /**
+         * Non-templated version of GetDistributionIndex, for when you haven't got a lattice type
+         * handy.
+         *
+         * @param siteIndex
+         * @param direction
+         * @return
+         */
+        inline site_t GetDistributionIndex(site_t siteIndex, Direction direction) const
+        {
+#ifdef HEMELB_USE_SOA_DISTRIBUTIONS
+          return direction * localFluidSites + siteIndex;
+#else
+          return siteIndex * latticeInfo.GetNumVectors() + direction;
+#endif
+        }
+
+        /**
+         * Get the index of the distribution in the given direction at the given site, as it is
+         * at the start of the current time step (i.e. the pre-collision value).
+         *
+         * This is just GetDistributionIndex, except with AA-pattern streaming where, at the start
+         * of an odd step, each value is still sitting in the slot that the upstream neighbour
+         * wrote it to.
+         *
+         * @param siteIndex
+         * @param direction
+         * @return
+         */
+        template<typename LatticeType>
+        inline site_t GetFOldIndex(site_t siteIndex, Direction direction) const
+        {
+#ifdef HEMELB_USE_AA_STREAMING
+          return GetAAIndex(siteIndex, direction, LatticeType::INVERSEDIRECTIONS[direction], aaOddStep);
+#else
+          return GetDistributionIndex<LatticeType>(siteIndex, direction);
+#endif
+        }
+
+        /**
+         * Get the distributions at the start of the time step for a run of consecutive sites,
+         * direction by direction: f[direction][i] is for site firstSite + i.
+         *
+         * With the structure-of-arrays layout, each direction's values for the run are adjacent,
+         * so they are read a plane at a time with unit stride. Otherwise they are gathered site
+         * by site, as Site::GetFOld does.
+         *
+         * @param firstSite
+         * @param siteCount At most Width.
+         * @param f
+         */
+        template<typename LatticeType, unsigned Width>
+        inline void GetFOldForSites(site_t firstSite, unsigned siteCount,
+                                    distribn_t (&f)[LatticeType::NUMVECTORS][Width]) const
+        {
+#if defined(HEMELB_USE_SOA_DISTRIBUTIONS) && !defined(HEMELB_USE_AA_STREAMING)
+          for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+          {
+            const distribn_storage_t* plane = &oldDistributions[direction * localFluidSites + firstSite];
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+            const distribn_t shift = storageShifts[direction];
+#else
+            const distribn_t shift = 0.0;
+#endif
+            for (unsigned i = 0; i < siteCount; ++i)
+            {
+              f[direction][i] = plane[i] + shift;
+            }
+          }
+#else
+          for (unsigned i = 0; i < siteCount; ++i)
+          {
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              f[direction][i] = *GetFOld(GetFOldIndex<LatticeType>(firstSite + i, direction), direction);
+            }
+          }
+#endif
+        }
+
+        /**
+         * Overwrite the distributions at a site with their values at the start of a time step,
+         * for example when the site has moved here from another rank.
+         *
+         * @param siteIndex
+         * @param fOld The distributions, ordered by direction.
+         */
+        void SetFOld(site_t siteIndex, const distribn_t* fOld)
+        {
+          for (Direction direction = 0; direction < latticeInfo.GetNumVectors(); ++direction)
+          {
+            *GetFOld(GetFOldIndex(siteIndex, direction), direction) = fOld[direction];
+          }
+        }
+
+        /**
+         * Non-templated version of GetFOldIndex.
+         *
+         * @param siteIndex
+         * @param direction
+         * @return
+         */
+        inline site_t GetFOldIndex(site_t siteIndex, Direction direction) const
         {
-          return &newDistributions[siteNumber];
+#ifdef HEMELB_USE_AA_STREAMING
+          return GetAAIndex(siteIndex, direction, latticeInfo.GetInverseIndex(direction), aaOddStep);
+#else
+          return GetDistributionIndex(siteIndex, direction);
+#endif
+        }
+
+        /**
+         * Get the index of the distribution in the given direction at the given site, as it
+         * will be once the current time step has streamed (and the received distributions have
+         * been copied in).
+         *
+         * @param siteIndex
+         * @param direction
+         * @return
+         */
+        template<typename LatticeType>
+        inline site_t GetFNewIndex(site_t siteIndex, Direction direction) const
+        {
+#ifdef HEMELB_USE_AA_STREAMING
+          return GetAAIndex(siteIndex, direction, LatticeType::INVERSEDIRECTIONS[direction], !aaOddStep);
+#else
+          return GetDistributionIndex<LatticeType>(siteIndex, direction);
+#endif
         }
 
         proc_t GetProcIdFromGlobalCoords(const util::Vector3D<site_t>& globalSiteCoords) const;
@@ -298,6 +634,22 @@ namespace hemelb
           return fluidSitesOnEachProcessor[proc];
         }
 
+        /**
+         * Get the ranks this one exchanges distributions with. Sharing is mutual, so these are
+         * the ranks both sent to and received from.
+         * @return
+         */
+        inline std::vector<proc_t> GetNeighbouringProcRanks() const
+        {
+          std::vector<proc_t> ranks;
+          for (std::vector<NeighbouringProcessor>::const_iterator it = neighbouringProcs.begin();
+              it != neighbouringProcs.end(); ++it)
+          {
+            ranks.push_back(it->Rank);
+          }
+          return ranks;
+        }
+
         /**
          * Get the total number of fluid sites in the whole geometry.
          * @return
@@ -405,8 +757,24 @@ namespace hemelb
           }
 
           oldDistributions.resize(localFluidSites * latticeInfo.GetNumVectors() + 1 + totalSharedFs);
+#ifdef HEMELB_USE_AA_STREAMING
+          receivedDistributions.resize(totalSharedFs);
+          aaOddStep = false;
+#else
           newDistributions.resize(localFluidSites * latticeInfo.GetNumVectors() + 1 + totalSharedFs);
+#endif
+          FirstTouchDistributions();
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+          SetStorageShiftDensity(1.0);
+#endif
         }
+
+        /**
+         * Zero the distribution arrays, touching each site's distributions from the thread that
+         * will later stream and collide it (see LBM::StreamAndCollide), so that with
+         * HEMELB_USE_OPENMP the pages are placed on that thread's NUMA node.
+         */
+        void FirstTouchDistributions();
         void CollectFluidSiteDistribution();
         void CollectGlobalSiteExtrema();
 
@@ -415,6 +783,17 @@ namespace hemelb
         void InitialiseNeighbourLookup(std::vector<std::vector<site_t> >& sharedFLocationForEachProc);
         void InitialisePointToPointComms(std::vector<std::vector<site_t> >& sharedFLocationForEachProc);
         void InitialiseReceiveLookup(std::vector<std::vector<site_t> >& sharedFLocationForEachProc);
+        void SortSharedDistributions(std::vector<site_t>& sharedFLocations) const;
+        void InitialiseReceivedRuns();
+
+        /**
+         * Copy the distributions received from one neighbouring rank, from wherever they are, to
+         * where they stream to.
+         *
+         * @param neighbourIndex
+         * @param received
+         */
+        void CopyReceived(size_t neighbourIndex, const distribn_storage_t* received);
 
         sitedata_t GetSiteData(site_t iSiteI, site_t iSiteJ, site_t iSiteK) const;
 
@@ -458,9 +837,9 @@ namespace hemelb
          * @return
          */
         // Method should remain protected, intent is to access this information via Site
-        distribn_t* GetFOld(site_t distributionIndex)
+        DistributionPointer GetFOld(site_t distributionIndex)
         {
-          return &oldDistributions[distributionIndex];
+          return MakeDistributionPointer(oldDistributions, distributionIndex);
         }
 
         /**
@@ -471,11 +850,111 @@ namespace hemelb
          * @return
          */
         // Method should remain protected, intent is to access this information via Site
-        const distribn_t* GetFOld(site_t distributionIndex) const
+        ConstDistributionPointer GetFOld(site_t distributionIndex) const
         {
-          return &oldDistributions[distributionIndex];
+          return MakeDistributionPointer(oldDistributions, distributionIndex);
         }
 
+        /**
+         * Get a pointer into the fOld array at the index of a distribution whose direction is
+         * known: see GetFNew.
+         * @param distributionIndex
+         * @param direction
+         * @return
+         */
+        // Method should remain protected, intent is to access this information via Site
+        DistributionPointer GetFOld(site_t distributionIndex, Direction direction)
+        {
+          return MakeDistributionPointer(oldDistributions, distributionIndex, direction);
+        }
+
+        // Method should remain protected, intent is to access this information via Site
+        ConstDistributionPointer GetFOld(site_t distributionIndex, Direction direction) const
+        {
+          return MakeDistributionPointer(oldDistributions, distributionIndex, direction);
+        }
+
+        typedef std::vector<distribn_storage_t, util::UninitialisedAllocator<distribn_storage_t> > DistributionVector;
+
+        inline DistributionPointer MakeDistributionPointer(DistributionVector& distributions,
+                                                           site_t distributionIndex)
+        {
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+          return DistributionPointer(&distributions[0], distributionIndex, *this, GetStorageShift(distributionIndex));
+#else
+          return &distributions[distributionIndex];
+#endif
+        }
+
+        inline ConstDistributionPointer MakeDistributionPointer(const DistributionVector& distributions,
+                                                                site_t distributionIndex) const
+        {
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+          return ConstDistributionPointer(&distributions[0], distributionIndex, *this, GetStorageShift(distributionIndex));
+#else
+          return &distributions[distributionIndex];
+#endif
+        }
+
+        inline DistributionPointer MakeDistributionPointer(DistributionVector& distributions,
+                                                           site_t distributionIndex, Direction direction)
+        {
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+          return DistributionPointer(&distributions[0], distributionIndex, *this, storageShifts[direction]);
+#else
+          return &distributions[distributionIndex];
+#endif
+        }
+
+        inline ConstDistributionPointer MakeDistributionPointer(const DistributionVector& distributions,
+                                                                site_t distributionIndex, Direction direction) const
+        {
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+          return ConstDistributionPointer(&distributions[0], distributionIndex, *this, storageShifts[direction]);
+#else
+          return &distributions[distributionIndex];
+#endif
+        }
+
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+        /**
+         * Set the density of the equilibrium at rest that is subtracted from the distributions
+         * before they are stored. This must be done before any are stored.
+         *
+         * @param density
+         */
+        void SetStorageShiftDensity(distribn_t density);
+
+        /**
+         * The amount subtracted from the distribution at the given index before it is stored:
+         * the equilibrium at rest for its direction.
+         *
+         * The shared distributions are copied between ranks and into place without being
+         * unshifted, so each shared slot uses the weight of the direction it is received into.
+         * That is the opposite of the direction it is sent in, which has the same weight.
+         *
+         * @param distributionIndex
+         * @return
+         */
+        inline distribn_t GetStorageShift(site_t distributionIndex) const
+        {
+          const site_t fluidDistributions = localFluidSites * latticeInfo.GetNumVectors();
+          if (distributionIndex == fluidDistributions)
+          {
+            return 0.0;
+          }
+          if (distributionIndex > fluidDistributions)
+          {
+            distributionIndex = streamingIndicesForReceivedDistributions[distributionIndex - fluidDistributions - 1];
+          }
+#ifdef HEMELB_USE_SOA_DISTRIBUTIONS
+          return storageShifts[distributionIndex / localFluidSites];
+#else
+          return storageShifts[distributionIndex % latticeInfo.GetNumVectors()];
+#endif
+        }
+#endif
+
         /*
          * This returns the index of the distribution to stream to.
          *
@@ -489,6 +968,38 @@ namespace hemelb
           return neighbourIndices[iSiteIndex * LatticeType::NUMVECTORS + iDirectionIndex];
         }
 
+#ifdef HEMELB_USE_AA_STREAMING
+        /**
+         * Where the distribution in the given direction at the given site lives, in either of
+         * the two AA-pattern layouts.
+         *
+         * In the 'swapped' layout (after an even step) the value arriving at a site along
+         * direction i is in the upstream neighbour's slot for the opposite direction, which is
+         * exactly where the neighbour lookup for the opposite direction points: another local
+         * site, or the shared buffer for one on another rank. Values arriving from a wall or
+         * iolet have no upstream site; the boundary delegates leave those in the site's own slot.
+         *
+         * @param siteIndex
+         * @param direction
+         * @param inverseDirection
+         * @param swapped
+         * @return
+         */
+        inline site_t GetAAIndex(site_t siteIndex, Direction direction, Direction inverseDirection,
+                                 bool swapped) const
+        {
+          if (swapped)
+          {
+            const site_t upstream = neighbourIndices[siteIndex * latticeInfo.GetNumVectors() + inverseDirection];
+            if (upstream != localFluidSites * latticeInfo.GetNumVectors())
+            {
+              return upstream;
+            }
+          }
+          return GetDistributionIndex(siteIndex, direction);
+        }
+#endif
+
         /**
          * Get the site data object for the given index.
          * @param iSiteIndex
@@ -560,8 +1071,18 @@ namespace hemelb
         site_t midDomainProcCollisions[COLLISION_TYPES]; //! Number of fluid sites with all fluid neighbours on this rank, for each collision type.
         site_t domainEdgeProcCollisions[COLLISION_TYPES]; //! Number of fluid sites with at least one fluid neighbour on another rank, for each collision type.
         site_t localFluidSites; //! The number of local fluid sites.
-        std::vector<distribn_t> oldDistributions; //! The distribution values for the previous time step.
-        std::vector<distribn_t> newDistributions; //! The distribution values for the next time step.
+        //! The distribution values for the previous time step. Allocated uninitialised; see FirstTouchDistributions.
+        DistributionVector oldDistributions;
+        //! The distribution values for the next time step. Unused with AA-pattern streaming.
+        DistributionVector newDistributions;
+#ifdef HEMELB_USE_AA_STREAMING
+        //! Distributions received from neighbouring ranks, kept apart from the send buffer at the end of oldDistributions.
+        std::vector<distribn_storage_t> receivedDistributions;
+        bool aaOddStep; //! Whether the current step is the odd half of the AA pattern.
+#endif
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+        std::vector<distribn_t> storageShifts; //! For each direction, what is subtracted from the distributions before storing them.
+#endif
         std::vector<Block> blocks; //! Data where local fluid sites are stored contiguously.
 
         std::vector<distribn_t> distanceToWall; //! Hold the distance to the wall for each fluid site.
@@ -573,7 +1094,22 @@ namespace hemelb
         util::Vector3D<site_t> globalSiteMins, globalSiteMaxes; //! The minimal and maximal coordinates of any fluid sites.
         std::vector<site_t> neighbourIndices; //! Data about neighbouring fluid sites.
         std::vector<site_t> streamingIndicesForReceivedDistributions; //! The indices to stream to for distributions received from other processors.
+
+        /**
+         * A run of distributions received consecutively that stream to consecutive indices.
+         */
+        struct ReceivedRun
+        {
+            site_t firstTarget;
+            site_t length;
+        };
+        //! streamingIndicesForReceivedDistributions, compressed into runs, in the order received.
+        std::vector<ReceivedRun> receivedRuns;
+        //! The runs received from neighbour n are [firstReceivedRun[n], firstReceivedRun[n + 1]).
+        std::vector<size_t> firstReceivedRun;
         neighbouring::NeighbouringLatticeData *neighbouringData;
+        //! The exchange with neighbours on the same node, with HEMELB_USE_SHARED_MEMORY_HALO; otherwise NULL.
+        NodeSharedHalo* nodeHalo;
         const net::IOCommunicator& comms;
     };
   }
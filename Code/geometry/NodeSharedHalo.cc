@@ -0,0 +1,154 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include "Exception.h"
+#include "geometry/NodeSharedHalo.h"
+#include "net/MpiGroup.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace
+    {
+      // Keep the buffers on their own cache lines, away from the counter.
+      const size_t CACHE_LINE = 64;
+    }
+
+    NodeSharedHalo::NodeSharedHalo(const net::MpiCommunicator& comms,
+                                   const std::vector<NeighbouringProcessor>& neighbours,
+                                   site_t firstSharedDistribution) :
+        nodeComms(comms.SplitShared()), neighbourWindows(neighbours.size(), NULL),
+            neighbourOffsets(neighbours.size(), -1), published(0), received(0)
+    {
+      // Find which neighbours are on this node, and where.
+      std::vector<int> ranks(neighbours.size());
+      for (size_t neighbourId = 0; neighbourId < neighbours.size(); ++neighbourId)
+      {
+        ranks[neighbourId] = neighbours[neighbourId].Rank;
+      }
+      std::vector<int> nodeRanks(neighbours.size());
+      if (!neighbours.empty())
+      {
+        HEMELB_MPI_CALL(MPI_Group_translate_ranks,
+                        (comms.Group(), (int) ranks.size(), &ranks[0], nodeComms.Group(), &nodeRanks[0]));
+      }
+
+      const int nodeSize = nodeComms.Size();
+      site_t bufferSize = 0;
+      for (size_t neighbourId = 0; neighbourId < neighbours.size(); ++neighbourId)
+      {
+        if (nodeRanks[neighbourId] != MPI_UNDEFINED)
+        {
+          Span span = { neighbours[neighbourId].FirstSharedDistribution - firstSharedDistribution,
+                        bufferSize,
+                        neighbours[neighbourId].SharedDistributionCount };
+          spans.push_back(span);
+          bufferSize += span.count;
+        }
+      }
+
+      headerBytes = sizeof(WindowHeader) + nodeSize * sizeof(int64_t);
+      headerBytes = (headerBytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+      const MPI_Aint windowBytes = headerBytes + 2 * bufferSize * sizeof(distribn_storage_t);
+      HEMELB_MPI_CALL(MPI_Win_allocate_shared,
+                      (windowBytes, 1, MPI_INFO_NULL, nodeComms, &localPart, &window));
+
+      // Say where each on-node neighbour will find its values.
+      WindowHeader* header = reinterpret_cast<WindowHeader*>(localPart);
+      header->published = 0;
+      header->bufferSize = bufferSize;
+      int64_t* offsets = reinterpret_cast<int64_t*>(localPart + sizeof(WindowHeader));
+      std::fill(offsets, offsets + nodeSize, -1);
+      std::vector<Span>::const_iterator span = spans.begin();
+      for (size_t neighbourId = 0; neighbourId < neighbours.size(); ++neighbourId)
+      {
+        if (nodeRanks[neighbourId] != MPI_UNDEFINED)
+        {
+          offsets[nodeRanks[neighbourId]] = (span++)->bufferOffset;
+        }
+      }
+
+      // The window is only ever accessed directly, synchronised with MPI_Win_sync.
+      HEMELB_MPI_CALL(MPI_Win_lock_all, (MPI_MODE_NOCHECK, window));
+      HEMELB_MPI_CALL(MPI_Win_sync, (window));
+      HEMELB_MPI_CALL(MPI_Barrier, (nodeComms));
+      HEMELB_MPI_CALL(MPI_Win_sync, (window));
+
+      for (size_t neighbourId = 0; neighbourId < neighbours.size(); ++neighbourId)
+      {
+        if (nodeRanks[neighbourId] == MPI_UNDEFINED)
+        {
+          continue;
+        }
+        MPI_Aint size;
+        int displacementUnit;
+        char* neighbourPart;
+        HEMELB_MPI_CALL(MPI_Win_shared_query,
+                        (window, nodeRanks[neighbourId], &size, &displacementUnit, &neighbourPart));
+        neighbourWindows[neighbourId] = neighbourPart;
+        neighbourOffsets[neighbourId] =
+            reinterpret_cast<const int64_t*>(neighbourPart + sizeof(WindowHeader))[nodeComms.Rank()];
+        if (neighbourOffsets[neighbourId] < 0)
+        {
+          throw Exception() << "Rank " << comms.Rank() << " neighbours rank " << neighbours[neighbourId].Rank
+              << " but not the other way round";
+        }
+      }
+    }
+
+    NodeSharedHalo::~NodeSharedHalo()
+    {
+      int finalized;
+      MPI_Finalized(&finalized);
+      if (!finalized)
+      {
+        MPI_Win_unlock_all(window);
+        MPI_Win_free(&window);
+      }
+    }
+
+    const distribn_storage_t* NodeSharedHalo::Buffer(const char* windowPart, int64_t step) const
+    {
+      const int64_t bufferSize = reinterpret_cast<const WindowHeader*>(windowPart)->bufferSize;
+      return reinterpret_cast<const distribn_storage_t*>(windowPart + headerBytes) + (step % 2) * bufferSize;
+    }
+
+    void NodeSharedHalo::Publish(const distribn_storage_t* sharedDistributions)
+    {
+      distribn_storage_t* buffer = const_cast<distribn_storage_t*>(Buffer(localPart, published));
+      for (std::vector<Span>::const_iterator span = spans.begin(); span != spans.end(); ++span)
+      {
+        std::copy(sharedDistributions + span->sourceOffset,
+                  sharedDistributions + span->sourceOffset + span->count,
+                  buffer + span->bufferOffset);
+      }
+
+      // The values must be visible before the counter is.
+      HEMELB_MPI_CALL(MPI_Win_sync, (window));
+      reinterpret_cast<WindowHeader*>(localPart)->published = ++published;
+      HEMELB_MPI_CALL(MPI_Win_sync, (window));
+    }
+
+    const distribn_storage_t* NodeSharedHalo::Receive(size_t neighbourIndex)
+    {
+      const char* neighbourPart = neighbourWindows[neighbourIndex];
+      const WindowHeader* header = reinterpret_cast<const WindowHeader*>(neighbourPart);
+      while (header->published <= received)
+      {
+        HEMELB_MPI_CALL(MPI_Win_sync, (window));
+      }
+      // And the counter must be seen before the values are read.
+      HEMELB_MPI_CALL(MPI_Win_sync, (window));
+      return Buffer(neighbourPart, received) + neighbourOffsets[neighbourIndex];
+    }
+
+    void NodeSharedHalo::EndReceive()
+    {
+      ++received;
+    }
+  }
+}
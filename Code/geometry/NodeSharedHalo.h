@@ -0,0 +1,125 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_NODESHAREDHALO_H
+#define HEMELB_GEOMETRY_NODESHAREDHALO_H
+
+#include <vector>
+#include "net/MpiError.h"
+#include "geometry/NeighbouringProcessor.h"
+#include "net/MpiCommunicator.h"
+#include "units.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * Exchanges the shared distributions with the neighbouring ranks on the same node through
+     * an MPI-3 shared-memory window rather than messages (HEMELB_USE_SHARED_MEMORY_HALO).
+     *
+     * Each rank copies the distributions bound for its on-node neighbours into its own part of
+     * the window and then bumps a counter there. Each neighbour waits for the counter and
+     * copies the values straight from the window to the sites they stream to, so they are
+     * copied twice in all, with no message matching or progress involved. The window holds two
+     * buffers used on alternate steps: a rank can't get two steps ahead of a neighbour, as it
+     * needs the neighbour's distributions from the step in between.
+     */
+    class NodeSharedHalo
+    {
+      public:
+        /**
+         * Set up the window. A collective operation.
+         *
+         * @param comms The communicator that the neighbours' ranks are in.
+         * @param neighbours This rank's neighbours, whose lists must be symmetric.
+         * @param firstSharedDistribution The index of the first shared distribution of the
+         * first neighbour, from which the neighbours' FirstSharedDistributions follow on.
+         */
+        NodeSharedHalo(const net::MpiCommunicator& comms,
+                       const std::vector<NeighbouringProcessor>& neighbours,
+                       site_t firstSharedDistribution);
+
+        /**
+         * Free the window. A collective operation.
+         */
+        ~NodeSharedHalo();
+
+        /**
+         * Whether a neighbour is on this node, so exchanges with it through the window.
+         *
+         * @param neighbourIndex The position of the rank among this rank's neighbours.
+         * @return
+         */
+        inline bool IsOnNode(size_t neighbourIndex) const
+        {
+          return neighbourWindows[neighbourIndex] != NULL;
+        }
+
+        /**
+         * Make this step's distributions for the on-node neighbours available to them.
+         *
+         * @param sharedDistributions The distributions to send, starting from
+         * firstSharedDistribution.
+         */
+        void Publish(const distribn_storage_t* sharedDistributions);
+
+        /**
+         * Wait for an on-node neighbour to publish this step's distributions.
+         *
+         * @param neighbourIndex
+         * @return Where they are, in the order they would have been received in.
+         */
+        const distribn_storage_t* Receive(size_t neighbourIndex);
+
+        /**
+         * Finish with this step's distributions from all the on-node neighbours, so that their
+         * buffer can be reused.
+         */
+        void EndReceive();
+
+      private:
+        /**
+         * The start of each rank's part of the window. The offsets of the values for each rank
+         * of the node within the buffers follow it, and then the buffers.
+         */
+        struct WindowHeader
+        {
+            //! The number of steps published. Written by the owner only.
+            volatile int64_t published;
+            //! The number of distributions in each buffer.
+            int64_t bufferSize;
+        };
+
+        /**
+         * The distributions for one on-node neighbour.
+         */
+        struct Span
+        {
+            //! From the first shared distribution.
+            site_t sourceOffset;
+            //! Within each buffer.
+            site_t bufferOffset;
+            site_t count;
+        };
+
+        const distribn_storage_t* Buffer(const char* windowPart, int64_t step) const;
+
+        const net::MpiCommunicator nodeComms;
+        MPI_Win window;
+        size_t headerBytes;
+        char* localPart;
+        std::vector<Span> spans;
+        //! For each neighbour, the start of its part of the window, or NULL if it's off the node.
+        std::vector<const char*> neighbourWindows;
+        //! For each on-node neighbour, the offset of the values for this rank within its buffers.
+        std::vector<site_t> neighbourOffsets;
+        int64_t published;
+        int64_t received;
+    };
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_NODESHAREDHALO_H */
@@ -10,6 +10,9 @@
 #include "units.h"
 #include "geometry/SiteData.h"
 #include "util/Vector3D.h"
+#if defined(HEMELB_USE_SOA_DISTRIBUTIONS) || defined(HEMELB_USE_AA_STREAMING) || defined(HEMELB_USE_FLOAT_DISTRIBUTIONS)
+#include "lb/lattices/D3Q27.h"
+#endif
 
 namespace hemelb
 {
@@ -103,16 +106,45 @@ namespace hemelb
           return latticeData.template GetStreamedIndex<LatticeType>(index, direction);
         }
 
+        /**
+         * Get the distributions at this site from the previous time step, ordered by direction.
+         *
+         * With the structure-of-arrays distribution layout (HEMELB_USE_SOA_DISTRIBUTIONS), or
+         * with AA-pattern streaming (HEMELB_USE_AA_STREAMING), the values for one site are not
+         * contiguous in the lattice data. With single-precision storage
+         * (HEMELB_USE_FLOAT_DISTRIBUTIONS) they aren't doubles. In those cases they are gathered
+         * into storage owned by this object, and the returned pointer is then only valid for as
+         * long as this Site is.
+         *
+         * @return
+         */
         template<typename LatticeType>
         inline const distribn_t* GetFOld() const
         {
+#if defined(HEMELB_USE_SOA_DISTRIBUTIONS) || defined(HEMELB_USE_AA_STREAMING) || defined(HEMELB_USE_FLOAT_DISTRIBUTIONS)
+          for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+          {
+            gatheredFOld[direction] =
+                *latticeData.GetFOld(latticeData.template GetFOldIndex<LatticeType>(index, direction), direction);
+          }
+          return gatheredFOld;
+#else
           return latticeData.GetFOld(index * LatticeType::NUMVECTORS);
+#endif
         }
 
         // Non-templated version of GetFOld, for when you haven't got a lattice type handy
         inline const distribn_t* GetFOld(int numvectors) const
         {
+#if defined(HEMELB_USE_SOA_DISTRIBUTIONS) || defined(HEMELB_USE_AA_STREAMING) || defined(HEMELB_USE_FLOAT_DISTRIBUTIONS)
+          for (int direction = 0; direction < numvectors; ++direction)
+          {
+            gatheredFOld[direction] = *latticeData.GetFOld(latticeData.GetFOldIndex(index, direction), direction);
+          }
+          return gatheredFOld;
+#else
           return latticeData.GetFOld(index * numvectors);
+#endif
         }
 
         inline const SiteData& GetSiteData() const
@@ -133,6 +165,10 @@ namespace hemelb
       protected:
         site_t index;
         DataSource & latticeData;
+#if defined(HEMELB_USE_SOA_DISTRIBUTIONS) || defined(HEMELB_USE_AA_STREAMING) || defined(HEMELB_USE_FLOAT_DISTRIBUTIONS)
+        //! Copy of this site's fOld, sized for the largest lattice we support.
+        mutable distribn_t gatheredFOld[lb::lattices::D3Q27::NUMVECTORS];
+#endif
     };
   }
 }
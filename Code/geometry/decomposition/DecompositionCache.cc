@@ -0,0 +1,312 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+#include "geometry/decomposition/DecompositionCache.h"
+#include "io/formats/decomposition.h"
+#include "io/writers/xdr/XdrMemReader.h"
+#include "io/writers/xdr/XdrMemWriter.h"
+#include "log/Logger.h"
+#include "net/MpiError.h"
+#include "util/fileutils.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      namespace fmt = io::formats::decomposition;
+
+      DecompositionCache::DecompositionCache(const std::string& path,
+                                             const net::MpiCommunicator& comms, uint64_t key) :
+          path(path), comms(comms), key(key), siteRanksOffset(0)
+      {
+      }
+
+      uint64_t DecompositionCache::Hash(const void* data, size_t bytes, uint64_t hash)
+      {
+        const unsigned char* byte = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; ++i)
+        {
+          hash ^= byte[i];
+          hash *= 1099511628211ULL;
+        }
+        return hash;
+      }
+
+      bool DecompositionCache::ReadBlocksWithSitesOn(proc_t rank, site_t blockCount,
+                                                     std::vector<bool>& blockHasSitesOnRank)
+      {
+        int exists = 0;
+        if (comms.Rank() == 0)
+        {
+          exists = util::file_exists(path.c_str());
+        }
+        comms.Broadcast(exists, 0);
+        if (!exists)
+        {
+          log::Logger::Log<log::Info, log::Singleton>("No decomposition cached in %s", path.c_str());
+          return false;
+        }
+
+        net::MpiFile file = net::MpiFile::Open(comms, path, MPI_MODE_RDONLY);
+
+        // One rank reads the header and the block owners, which every rank needs.
+        std::vector<char> header(fmt::HeaderLength);
+        if (comms.Rank() == 0)
+        {
+          file.ReadAt(0, header);
+        }
+        comms.Broadcast(header, 0);
+
+        io::writers::xdr::XdrMemReader headerReader(&header[0], fmt::HeaderLength);
+        unsigned hlbMagicNumber, decompositionMagicNumber, version, rankCount, fileBlockCount,
+            ownerCount;
+        uint64_t fileKey;
+        headerReader.readUnsignedInt(hlbMagicNumber);
+        headerReader.readUnsignedInt(decompositionMagicNumber);
+        headerReader.readUnsignedInt(version);
+        headerReader.readUnsignedLong(fileKey);
+        headerReader.readUnsignedInt(rankCount);
+        headerReader.readUnsignedInt(fileBlockCount);
+        headerReader.readUnsignedInt(ownerCount);
+
+        if (hlbMagicNumber != io::formats::HemeLbMagicNumber
+            || decompositionMagicNumber != fmt::MagicNumber || version != fmt::VersionNumber
+            || fileKey != key || rankCount != (unsigned) comms.Size()
+            || fileBlockCount != (unsigned) blockCount)
+        {
+          log::Logger::Log<log::Info, log::Singleton>("The decomposition cached in %s is for a different geometry, rank count or node layout",
+                                                      path.c_str());
+          file.Close();
+          return false;
+        }
+
+        std::vector<char> owners(sizeof(unsigned) * (blockCount + ownerCount));
+        if (comms.Rank() == 0)
+        {
+          file.ReadAt(fmt::HeaderLength, owners);
+        }
+        comms.Broadcast(owners, 0);
+        file.Close();
+
+        // The number of owners of each block, then each block's owners.
+        io::writers::xdr::XdrMemReader ownersReader(&owners[0], owners.size());
+        std::vector<unsigned> ownerWords(blockCount + ownerCount);
+        if (!ownerWords.empty())
+        {
+          ownersReader.readUnsignedInts(&ownerWords[0], ownerWords.size());
+        }
+
+        blockHasSitesOnRank.assign(blockCount, false);
+        std::vector<unsigned>::const_iterator ownerRank = ownerWords.begin() + blockCount;
+        for (site_t block = 0; block < blockCount; ++block)
+        {
+          for (unsigned owner = 0; owner < ownerWords[block]; ++owner, ++ownerRank)
+          {
+            if (*ownerRank == (unsigned) rank)
+            {
+              blockHasSitesOnRank[block] = true;
+            }
+          }
+        }
+
+        siteRanksOffset = fmt::HeaderLength + owners.size();
+        return true;
+      }
+
+      void DecompositionCache::ReadSiteRanks(Geometry& geometry,
+                                             const std::vector<site_t>& fluidSitesOnEachBlock)
+      {
+        net::MpiFile file = net::MpiFile::Open(comms, path, MPI_MODE_RDONLY);
+
+        // Read each run of consecutive blocks we have in one go.
+        site_t siteIndex = 0;
+        site_t block = 0;
+        while (block < geometry.GetBlockCount())
+        {
+          if (geometry.Blocks[block].Sites.empty())
+          {
+            siteIndex += fluidSitesOnEachBlock[block];
+            ++block;
+            continue;
+          }
+
+          const site_t firstBlock = block;
+          const site_t firstSite = siteIndex;
+          while (block < geometry.GetBlockCount() && !geometry.Blocks[block].Sites.empty())
+          {
+            siteIndex += fluidSitesOnEachBlock[block];
+            ++block;
+          }
+          ReadSiteRanksOnBlocks(file, geometry, firstBlock, block, firstSite, siteIndex - firstSite);
+        }
+
+        file.Close();
+      }
+
+      void DecompositionCache::ReadSiteRanksOnBlocks(net::MpiFile& file, Geometry& geometry,
+                                                     site_t firstBlock, site_t endBlock,
+                                                     site_t firstSite, site_t siteCount) const
+      {
+        if (siteCount == 0)
+        {
+          return;
+        }
+
+        std::vector<char> ranks(sizeof(unsigned) * siteCount);
+        file.ReadAt(siteRanksOffset + sizeof(unsigned) * firstSite, ranks);
+        io::writers::xdr::XdrMemReader reader(&ranks[0], ranks.size());
+        std::vector<unsigned> siteRanks(siteCount);
+        reader.readUnsignedInts(&siteRanks[0], siteRanks.size());
+
+        std::vector<unsigned>::const_iterator rank = siteRanks.begin();
+        for (site_t block = firstBlock; block < endBlock; ++block)
+        {
+          std::vector<GeometrySite>& sites = geometry.Blocks[block].Sites;
+          for (std::vector<GeometrySite>::iterator site = sites.begin(); site != sites.end(); ++site)
+          {
+            if (site->targetProcessor != SITE_OR_BLOCK_SOLID)
+            {
+              site->targetProcessor = *rank;
+              ++rank;
+            }
+          }
+        }
+      }
+
+      void DecompositionCache::Write(const Geometry& geometry,
+                                     const std::vector<site_t>& fluidSitesOnEachBlock,
+                                     const std::vector<proc_t>& writerForEachBlock)
+      {
+        const site_t blockCount = geometry.GetBlockCount();
+
+        // Find the ranks with sites on each block we write, and tell everyone how many there are
+        // so all know where each block's records go.
+        std::map<site_t, std::vector<unsigned> > ownersOfBlock;
+        std::vector<site_t> ownersOnEachBlock(blockCount, 0);
+        for (site_t block = 0; block < blockCount; ++block)
+        {
+          if (writerForEachBlock[block] != comms.Rank() || fluidSitesOnEachBlock[block] == 0)
+          {
+            continue;
+          }
+
+          std::vector<unsigned>& owners = ownersOfBlock[block];
+          const std::vector<GeometrySite>& sites = geometry.Blocks[block].Sites;
+          for (std::vector<GeometrySite>::const_iterator site = sites.begin(); site != sites.end();
+              ++site)
+          {
+            if (site->targetProcessor != SITE_OR_BLOCK_SOLID)
+            {
+              owners.push_back(site->targetProcessor);
+            }
+          }
+          std::sort(owners.begin(), owners.end());
+          owners.erase(std::unique(owners.begin(), owners.end()), owners.end());
+          ownersOnEachBlock[block] = owners.size();
+        }
+        ownersOnEachBlock = comms.AllReduce(ownersOnEachBlock, MPI_SUM);
+
+        std::vector<site_t> firstOwnerOnBlock(blockCount + 1, 0);
+        std::vector<site_t> firstSiteOnBlock(blockCount + 1, 0);
+        for (site_t block = 0; block < blockCount; ++block)
+        {
+          firstOwnerOnBlock[block + 1] = firstOwnerOnBlock[block] + ownersOnEachBlock[block];
+          firstSiteOnBlock[block + 1] = firstSiteOnBlock[block] + fluidSitesOnEachBlock[block];
+        }
+        const MPI_Offset ownersOffset = fmt::HeaderLength + sizeof(unsigned) * blockCount;
+        siteRanksOffset = ownersOffset + sizeof(unsigned) * firstOwnerOnBlock[blockCount];
+
+        // Write to a temporary file, which is only renamed once complete, so a run that dies
+        // part way through can't leave a bad cache behind.
+        const std::string temporaryPath = path + ".part";
+        net::MpiFile file;
+        try
+        {
+          file = net::MpiFile::Open(comms, temporaryPath, MPI_MODE_WRONLY | MPI_MODE_CREATE);
+        }
+        catch (const net::MpiError& e)
+        {
+          log::Logger::Log<log::Warning, log::Singleton>("Couldn't save the decomposition to %s: %s",
+                                                         path.c_str(),
+                                                         e.what());
+          return;
+        }
+
+        if (comms.Rank() == 0)
+        {
+          std::vector<char> header(fmt::HeaderLength);
+          io::writers::xdr::XdrMemWriter headerWriter(&header[0], fmt::HeaderLength);
+          headerWriter << (unsigned) io::formats::HemeLbMagicNumber << (unsigned) fmt::MagicNumber
+              << (unsigned) fmt::VersionNumber << key << (unsigned) comms.Size()
+              << (unsigned) blockCount << (unsigned) firstOwnerOnBlock[blockCount];
+          file.WriteAt(0, header);
+
+          WriteUnsignedInts(file,
+                            fmt::HeaderLength,
+                            std::vector<unsigned>(ownersOnEachBlock.begin(), ownersOnEachBlock.end()));
+        }
+
+        for (std::map<site_t, std::vector<unsigned> >::const_iterator it = ownersOfBlock.begin();
+            it != ownersOfBlock.end(); ++it)
+        {
+          const site_t block = it->first;
+          WriteUnsignedInts(file,
+                            ownersOffset + sizeof(unsigned) * firstOwnerOnBlock[block],
+                            it->second);
+
+          std::vector<unsigned> siteRanks;
+          siteRanks.reserve(fluidSitesOnEachBlock[block]);
+          const std::vector<GeometrySite>& sites = geometry.Blocks[block].Sites;
+          for (std::vector<GeometrySite>::const_iterator site = sites.begin(); site != sites.end();
+              ++site)
+          {
+            if (site->targetProcessor != SITE_OR_BLOCK_SOLID)
+            {
+              siteRanks.push_back(site->targetProcessor);
+            }
+          }
+          WriteUnsignedInts(file,
+                            siteRanksOffset + sizeof(unsigned) * firstSiteOnBlock[block],
+                            siteRanks);
+        }
+
+        file.Close();
+
+        if (comms.Rank() == 0)
+        {
+          if (std::rename(temporaryPath.c_str(), path.c_str()) == 0)
+          {
+            log::Logger::Log<log::Info, log::Singleton>("Saved the decomposition to %s", path.c_str());
+          }
+          else
+          {
+            log::Logger::Log<log::Warning, log::Singleton>("Couldn't save the decomposition to %s",
+                                                           path.c_str());
+          }
+        }
+      }
+
+      void DecompositionCache::WriteUnsignedInts(net::MpiFile& file, MPI_Offset offset,
+                                                 const std::vector<unsigned>& values) const
+      {
+        if (values.empty())
+        {
+          return;
+        }
+
+        std::vector<char> buffer(sizeof(unsigned) * values.size());
+        io::writers::xdr::XdrMemWriter writer(&buffer[0], buffer.size());
+        writer.writeUnsignedInts(&values[0], values.size());
+        file.WriteAt(offset, buffer);
+      }
+    }
+  }
+}
@@ -0,0 +1,109 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DECOMPOSITION_DECOMPOSITIONCACHE_H
+#define HEMELB_GEOMETRY_DECOMPOSITION_DECOMPOSITIONCACHE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "geometry/Geometry.h"
+#include "net/MpiCommunicator.h"
+#include "net/MpiFile.h"
+#include "units.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      /**
+       * A domain decomposition saved to disk, so that later runs of the same geometry on the
+       * same number of ranks can skip decomposing it. The file records the rank of every fluid
+       * site, and which ranks have fluid sites on each block; see io/formats/decomposition.h.
+       */
+      class DecompositionCache
+      {
+        public:
+          /**
+           * @param path The file the decomposition is cached in.
+           * @param comms The ranks taking part in the decomposition.
+           * @param key Identifies what the decomposition depends on (the geometry, lattice,
+           * site weights and rank count), computed with Hash.
+           */
+          DecompositionCache(const std::string& path, const net::MpiCommunicator& comms,
+                             uint64_t key);
+
+          //! The value to start a hash from (the FNV-1a offset basis).
+          static const uint64_t INITIAL_HASH = 14695981039346656037ULL;
+
+          /**
+           * Extend a 64-bit FNV-1a hash with some bytes.
+           *
+           * @param data
+           * @param bytes
+           * @param hash The hash of everything before data.
+           * @return
+           */
+          static uint64_t Hash(const void* data, size_t bytes, uint64_t hash = INITIAL_HASH);
+
+          /**
+           * Read which blocks have fluid sites on a rank. A collective operation.
+           *
+           * @param rank [in] The rank (as stored in the sites' targetProcessor) to look for.
+           * @param blockCount [in] The number of blocks in the geometry.
+           * @param blockHasSitesOnRank [out] True for each block with a fluid site on rank.
+           * @return False if there is no cache file or it doesn't match the key, in which
+           * case the geometry must be decomposed as usual.
+           */
+          bool ReadBlocksWithSitesOn(proc_t rank, site_t blockCount,
+                                     std::vector<bool>& blockHasSitesOnRank);
+
+          /**
+           * Set the target processor of each fluid site on every block this rank has read in.
+           * A collective operation, only valid after ReadBlocksWithSitesOn has succeeded.
+           *
+           * @param geometry
+           * @param fluidSitesOnEachBlock
+           */
+          void ReadSiteRanks(Geometry& geometry, const std::vector<site_t>& fluidSitesOnEachBlock);
+
+          /**
+           * Save the decomposition held in the sites' target processors. Each block is written by
+           * one rank, which must have all the block's sites read in. A collective operation.
+           * Failing to create the file is only logged, as the cache isn't essential.
+           *
+           * @param geometry
+           * @param fluidSitesOnEachBlock
+           * @param writerForEachBlock The rank in comms that writes each block.
+           */
+          void Write(const Geometry& geometry, const std::vector<site_t>& fluidSitesOnEachBlock,
+                     const std::vector<proc_t>& writerForEachBlock);
+
+        private:
+          /**
+           * Read the ranks of the fluid sites on a run of consecutive blocks.
+           */
+          void ReadSiteRanksOnBlocks(net::MpiFile& file, Geometry& geometry, site_t firstBlock,
+                                     site_t endBlock, site_t firstSite, site_t siteCount) const;
+
+          /**
+           * Write some unsigned ints to the file as XDR.
+           */
+          void WriteUnsignedInts(net::MpiFile& file, MPI_Offset offset,
+                                 const std::vector<unsigned>& values) const;
+
+          const std::string path;
+          const net::MpiCommunicator& comms;
+          const uint64_t key;
+          //! Where the site ranks start in the file, once known.
+          MPI_Offset siteRanksOffset;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DECOMPOSITION_DECOMPOSITIONCACHE_H */
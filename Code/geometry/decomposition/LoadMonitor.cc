@@ -0,0 +1,107 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "geometry/decomposition/LoadMonitor.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      LoadMonitor::LoadMonitor(const net::MpiCommunicator& comms, const reporting::Timers& timers) :
+          comms(comms), timers(timers), secondsAtLastMeasurement(GetComputeSeconds()),
+              measuredSeconds(0.0)
+      {
+      }
+
+      double LoadMonitor::GetComputeSeconds() const
+      {
+        return timers[reporting::Timers::lb_calc].Get()
+            + timers[reporting::Timers::colloidCalculateForces].Get()
+            + timers[reporting::Timers::colloidUpdateCalculations].Get()
+            + timers[reporting::Timers::extractionWriting].Get();
+      }
+
+      double LoadMonitor::MeasureImbalance(const LatticeData& latticeData)
+      {
+        const double seconds = GetComputeSeconds();
+        measuredSeconds = seconds - secondsAtLastMeasurement;
+        secondsAtLastMeasurement = seconds;
+
+        // Only count the ranks that have any of the domain (not, for instance, a separate
+        // steering rank).
+        const double maxSeconds = comms.AllReduce(measuredSeconds, MPI_MAX);
+        const double totalSeconds = comms.AllReduce(measuredSeconds, MPI_SUM);
+        const int computingRanks = comms.AllReduce(latticeData.GetLocalFluidSiteCount() > 0
+                                                     ? 1
+                                                     : 0,
+                                                   MPI_SUM);
+        return (totalSeconds > 0.0)
+          ? maxSeconds * computingRanks / totalSeconds
+          : 1.0;
+      }
+
+      std::vector<float> LoadMonitor::GetBlockLoadFactors(const LatticeData& latticeData,
+                                                          const SiteWeights& siteWeights) const
+      {
+        // The sites are stored grouped by collision type, mid-domain ones first.
+        std::vector<int> weightOfEachSite;
+        weightOfEachSite.reserve(latticeData.GetLocalFluidSiteCount());
+        for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; ++collisionType)
+        {
+          weightOfEachSite.insert(weightOfEachSite.end(),
+                                  latticeData.GetMidDomainCollisionCount(collisionType),
+                                  siteWeights[collisionType]);
+        }
+        for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; ++collisionType)
+        {
+          weightOfEachSite.insert(weightOfEachSite.end(),
+                                  latticeData.GetDomainEdgeCollisionCount(collisionType),
+                                  siteWeights[collisionType]);
+        }
+
+        double localWeight = 0.0;
+        for (std::vector<int>::const_iterator weight = weightOfEachSite.begin();
+            weight != weightOfEachSite.end(); ++weight)
+        {
+          localWeight += *weight;
+        }
+
+        // This rank's time per unit weight, relative to the whole domain's.
+        const double totalSeconds = comms.AllReduce(measuredSeconds, MPI_SUM);
+        const double totalWeight = comms.AllReduce(localWeight, MPI_SUM);
+        const double rankFactor = (localWeight > 0.0 && totalSeconds > 0.0)
+          ? (measuredSeconds / localWeight) / (totalSeconds / totalWeight)
+          : 1.0;
+
+        // Average the factors of the ranks with sites on each block, by weight.
+        std::vector<double> factorTimesWeightOnEachBlock(latticeData.GetBlockCount(), 0.0);
+        std::vector<double> weightOnEachBlock(latticeData.GetBlockCount(), 0.0);
+        for (site_t site = 0; site < latticeData.GetLocalFluidSiteCount(); ++site)
+        {
+          const util::Vector3D<site_t> blockCoords = latticeData.GetSite(site).GetGlobalSiteCoords()
+              / latticeData.GetBlockSize();
+          const site_t block = latticeData.GetBlockIdFromBlockCoords(blockCoords);
+          factorTimesWeightOnEachBlock[block] += rankFactor * weightOfEachSite[site];
+          weightOnEachBlock[block] += weightOfEachSite[site];
+        }
+        factorTimesWeightOnEachBlock = comms.AllReduce(factorTimesWeightOnEachBlock, MPI_SUM);
+        weightOnEachBlock = comms.AllReduce(weightOnEachBlock, MPI_SUM);
+
+        std::vector<float> factorForEachBlock(latticeData.GetBlockCount(), 1.0f);
+        for (site_t block = 0; block < latticeData.GetBlockCount(); ++block)
+        {
+          if (weightOnEachBlock[block] > 0.0)
+          {
+            factorForEachBlock[block] = float(factorTimesWeightOnEachBlock[block]
+                / weightOnEachBlock[block]);
+          }
+        }
+        return factorForEachBlock;
+      }
+    }
+  }
+}
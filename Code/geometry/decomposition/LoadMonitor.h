@@ -0,0 +1,77 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DECOMPOSITION_LOADMONITOR_H
+#define HEMELB_GEOMETRY_DECOMPOSITION_LOADMONITOR_H
+
+#include <vector>
+#include "geometry/LatticeData.h"
+#include "geometry/decomposition/SiteWeights.h"
+#include "net/MpiCommunicator.h"
+#include "reporting/Timers.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      /**
+       * Watches how long each rank spends computing, to tell when the decomposition has become
+       * unbalanced during a run (for instance because colloids have gathered in one part of the
+       * domain, or some ranks do more extraction than others), and works out how to weight the
+       * sites when repartitioning to correct it.
+       *
+       * The computation time is that spent on the lattice Boltzmann update, the colloid
+       * calculations and extraction writing, but not waiting for communication, since ranks
+       * with less work simply wait longer.
+       */
+      class LoadMonitor
+      {
+        public:
+          /**
+           * @param comms The ranks the domain is decomposed over.
+           * @param timers This rank's timers.
+           */
+          LoadMonitor(const net::MpiCommunicator& comms, const reporting::Timers& timers);
+
+          /**
+           * Measure the computation time of every rank since the last measurement (or
+           * construction). A collective operation.
+           *
+           * @param latticeData The current decomposition.
+           * @return The ratio of the greatest time to the mean over the ranks with fluid sites.
+           */
+          double MeasureImbalance(const LatticeData& latticeData);
+
+          /**
+           * Get a factor for each block by which to scale the weights of its sites when
+           * repartitioning, so that sites on ranks which took longer than average per unit of
+           * site weight during the last measurement weigh more. A collective operation.
+           *
+           * @param latticeData The current decomposition.
+           * @param siteWeights The weights the current decomposition was made with.
+           * @return
+           */
+          std::vector<float> GetBlockLoadFactors(const LatticeData& latticeData,
+                                                 const SiteWeights& siteWeights) const;
+
+        private:
+          /**
+           * The total computation time on this rank so far.
+           */
+          double GetComputeSeconds() const;
+
+          const net::MpiCommunicator& comms;
+          const reporting::Timers& timers;
+          double secondsAtLastMeasurement;
+          //! This rank's computation time between the last two measurements.
+          double measuredSeconds;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DECOMPOSITION_LOADMONITOR_H */
@@ -0,0 +1,147 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+#include "geometry/decomposition/NodePlacement.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      NodePlacement::NodePlacement(const net::MpiCommunicator& comms)
+      {
+        // Identify each node by the lowest rank on it, then number the nodes in that order.
+        proc_t lowestRankOnNode = comms.Rank();
+        const net::MpiCommunicator nodeComms = comms.SplitShared();
+        nodeComms.Broadcast(lowestRankOnNode, 0);
+        const std::vector<proc_t> lowestRankOnEachRanksNode = comms.AllGather(lowestRankOnNode);
+
+        std::vector<proc_t> nodeIds(lowestRankOnEachRanksNode);
+        std::sort(nodeIds.begin(), nodeIds.end());
+        nodeIds.erase(std::unique(nodeIds.begin(), nodeIds.end()), nodeIds.end());
+        nodeCount = nodeIds.size();
+
+        nodeForEachRank.resize(comms.Size());
+        for (proc_t rank = 0; rank < comms.Size(); ++rank)
+        {
+          nodeForEachRank[rank] = std::lower_bound(nodeIds.begin(),
+                                                   nodeIds.end(),
+                                                   lowestRankOnEachRanksNode[rank]) - nodeIds.begin();
+        }
+      }
+
+      NodePlacement::NodePlacement(const std::vector<int>& nodeForEachRank) :
+          nodeForEachRank(nodeForEachRank),
+              nodeCount(nodeForEachRank.empty()
+                ? 0
+                : *std::max_element(nodeForEachRank.begin(), nodeForEachRank.end()) + 1)
+      {
+      }
+
+      std::vector<proc_t> NodePlacement::PlaceParts(const std::vector<PartLink>& links) const
+      {
+        const proc_t parts = nodeForEachRank.size();
+        std::vector<proc_t> unchanged(parts);
+        for (proc_t part = 0; part < parts; ++part)
+        {
+          unchanged[part] = part;
+        }
+        if (nodeCount < 2)
+        {
+          return unchanged;
+        }
+
+        // Symmetrise the links.
+        std::vector<std::map<proc_t, int64_t> > linksFrom(parts);
+        for (std::vector<PartLink>::const_iterator link = links.begin(); link != links.end(); ++link)
+        {
+          if (link->from != link->to)
+          {
+            linksFrom[link->from][link->to] += link->count;
+            linksFrom[link->to][link->from] += link->count;
+          }
+        }
+
+        std::vector<std::vector<proc_t> > ranksOnEachNode(nodeCount);
+        for (proc_t rank = 0; rank < parts; ++rank)
+        {
+          ranksOnEachNode[nodeForEachRank[rank]].push_back(rank);
+        }
+
+        std::vector<bool> placed(parts, false);
+        proc_t lowestUnplaced = 0;
+        std::vector<proc_t> rankForEachPart(parts);
+        for (int node = 0; node < nodeCount; ++node)
+        {
+          // The unplaced parts linked to this node's group, by decreasing number of links and then
+          // increasing part number.
+          std::vector<int64_t> linksToGroup(parts, 0);
+          std::set<std::pair<int64_t, proc_t> > candidates;
+          std::vector<proc_t> group;
+
+          while (group.size() < ranksOnEachNode[node].size())
+          {
+            proc_t next;
+            if (candidates.empty())
+            {
+              while (placed[lowestUnplaced])
+              {
+                ++lowestUnplaced;
+              }
+              next = lowestUnplaced;
+            }
+            else
+            {
+              next = candidates.begin()->second;
+              candidates.erase(candidates.begin());
+            }
+            placed[next] = true;
+            group.push_back(next);
+
+            for (std::map<proc_t, int64_t>::const_iterator neighbour = linksFrom[next].begin();
+                neighbour != linksFrom[next].end(); ++neighbour)
+            {
+              if (!placed[neighbour->first])
+              {
+                candidates.erase(std::make_pair(-linksToGroup[neighbour->first], neighbour->first));
+                linksToGroup[neighbour->first] += neighbour->second;
+                candidates.insert(std::make_pair(-linksToGroup[neighbour->first], neighbour->first));
+              }
+            }
+          }
+
+          std::sort(group.begin(), group.end());
+          for (size_t i = 0; i < group.size(); ++i)
+          {
+            rankForEachPart[group[i]] = ranksOnEachNode[node][i];
+          }
+        }
+
+        return CountLinksBetweenNodes(links, rankForEachPart) <= CountLinksBetweenNodes(links, unchanged)
+          ? rankForEachPart
+          : unchanged;
+      }
+
+      int64_t NodePlacement::CountLinksBetweenNodes(const std::vector<PartLink>& links,
+                                                    const std::vector<proc_t>& rankForEachPart) const
+      {
+        int64_t between = 0;
+        for (std::vector<PartLink>::const_iterator link = links.begin(); link != links.end(); ++link)
+        {
+          if (nodeForEachRank[rankForEachPart[link->from]] != nodeForEachRank[rankForEachPart[link->to]])
+          {
+            between += link->count;
+          }
+        }
+        return between;
+      }
+    }
+  }
+}
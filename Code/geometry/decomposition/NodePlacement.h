@@ -0,0 +1,104 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DECOMPOSITION_NODEPLACEMENT_H
+#define HEMELB_GEOMETRY_DECOMPOSITION_NODEPLACEMENT_H
+
+#include <stdint.h>
+#include <vector>
+#include "net/MpiCommunicator.h"
+#include "units.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      /**
+       * Knows which ranks share a node, and chooses which rank each part of a partition should
+       * go to so that as few links between parts as possible cross between nodes. Links within a
+       * node are much cheaper to exchange over.
+       *
+       * This makes the decomposition hierarchical without partitioning twice: the domain is cut
+       * into one part per rank as usual, and the parts are then grouped into nodes, growing each
+       * node's group from the part most strongly linked to it. Each part keeps its weight, so
+       * the balance between ranks is unchanged.
+       */
+      class NodePlacement
+      {
+        public:
+          /**
+           * The number of links between two parts.
+           */
+          struct PartLink
+          {
+              proc_t from;
+              proc_t to;
+              int64_t count;
+          };
+
+          /**
+           * Find which ranks of the communicator are on each node. A collective operation.
+           *
+           * @param comms
+           */
+          NodePlacement(const net::MpiCommunicator& comms);
+
+          /**
+           * Use a given layout.
+           *
+           * @param nodeForEachRank The node of each rank, numbered from 0.
+           */
+          NodePlacement(const std::vector<int>& nodeForEachRank);
+
+          inline int GetNodeCount() const
+          {
+            return nodeCount;
+          }
+
+          inline int GetNode(proc_t rank) const
+          {
+            return nodeForEachRank[rank];
+          }
+
+          inline const std::vector<int>& GetNodeForEachRank() const
+          {
+            return nodeForEachRank;
+          }
+
+          /**
+           * Choose the rank for each part, where there are as many parts as ranks.
+           *
+           * Nodes are filled in turn, starting from the lowest-numbered part not yet placed and
+           * then adding whichever part has the most links to those already on the node. Each
+           * node's parts go to its ranks in ascending order, so on a single node every part
+           * stays where it was. If this would cut more links between nodes than leaving each
+           * part on the rank of the same number, that is done instead.
+           *
+           * @param links The links between parts, in either or both directions.
+           * @return The rank for each part.
+           */
+          std::vector<proc_t> PlaceParts(const std::vector<PartLink>& links) const;
+
+          /**
+           * Count the links that would cross between nodes.
+           *
+           * @param links
+           * @param rankForEachPart
+           * @return
+           */
+          int64_t CountLinksBetweenNodes(const std::vector<PartLink>& links,
+                                         const std::vector<proc_t>& rankForEachPart) const;
+
+        private:
+          std::vector<int> nodeForEachRank;
+          int nodeCount;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DECOMPOSITION_NODEPLACEMENT_H */
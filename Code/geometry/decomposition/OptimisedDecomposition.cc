@@ -3,9 +3,11 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include "geometry/ParmetisHeader.h"
 #include "geometry/decomposition/OptimisedDecomposition.h"
-#include "geometry/decomposition/DecompositionWeights.h"
+#include "geometry/decomposition/NodePlacement.h"
+#include "geometry/decomposition/SpaceFillingCurve.h"
 #include "lb/lattices/D3Q27.h"
 #include "log/Logger.h"
 #include "net/net.h"
@@ -19,9 +21,11 @@ namespace hemelb
       OptimisedDecomposition::OptimisedDecomposition(
           reporting::Timers& timers, net::MpiCommunicator& comms, const Geometry& geometry,
           const lb::lattices::LatticeInfo& latticeInfo, const std::vector<proc_t>& procForEachBlock,
-          const std::vector<site_t>& fluidSitesOnEachBlock) :
+          const std::vector<site_t>& fluidSitesOnEachBlock, PartitionMethod partitionMethod,
+          const SiteWeights& siteWeights) :
           timers(timers), comms(comms), geometry(geometry), latticeInfo(latticeInfo),
-              procForEachBlock(procForEachBlock), fluidSitesPerBlock(fluidSitesOnEachBlock)
+              procForEachBlock(procForEachBlock), fluidSitesPerBlock(fluidSitesOnEachBlock),
+              siteWeights(siteWeights)
       {
         timers[hemelb::reporting::Timers::InitialGeometryRead].Start(); //overall dbg timing
 
@@ -57,7 +61,6 @@ namespace hemelb
 
         // Call parmetis.
         timers[hemelb::reporting::Timers::parmetis].Start();
-        log::Logger::Log<log::Debug, log::OnePerCore>("Making the call to Parmetis");
 
         bool do_decomposition = true;
 #ifdef HEMELB_NO_DECOMPOSITION
@@ -66,9 +69,26 @@ namespace hemelb
 
         if (do_decomposition)
         {
-          CallParmetis(localVertexCount);
+          // Populate the vertex weight data arrays (for the partitioner) and print out the number
+          // of different fluid sites on each core
+          PopulateVertexWeightData(localVertexCount);
+
+          if (partitionMethod == ParMetisPartition)
+          {
+            log::Logger::Log<log::Debug, log::OnePerCore>("Making the call to Parmetis");
+            CallParmetis(localVertexCount);
+            log::Logger::Log<log::Debug, log::OnePerCore>("Parmetis has finished.");
+          }
+          else
+          {
+            CallSpaceFillingCurve(localVertexCount, partitionMethod);
+          }
+          PopulateAdjacencyParts(localVertexCount);
+          const NodePlacement nodePlacement(comms);
+          PlacePartsOnNodes(localVertexCount, nodePlacement);
           timers[hemelb::reporting::Timers::parmetis].Stop();
-          log::Logger::Log<log::Debug, log::OnePerCore>("Parmetis has finished.");
+
+          ReportPartitionQuality(localVertexCount, partitionMethod, nodePlacement);
 
           // Convert the ParMetis results into a nice format.
           timers[hemelb::reporting::Timers::PopulateOptimisationMovesList].Start();
@@ -116,9 +136,6 @@ namespace hemelb
         // Weight all vertices evenly.
         //std::vector < idx_t > vertexWeight(localVertexCount, 1);
 
-        // Populate the vertex weight data arrays (for ParMetis) and print out the number of different fluid sites on each core
-        PopulateVertexWeightData(localVertexCount);
-
         // Set the weights of each partition to be even, and to sum to 1.
         idx_t desiredPartitionSize = comms.Size();
 
@@ -187,6 +204,238 @@ namespace hemelb
         }
       }
 
+      void OptimisedDecomposition::CallSpaceFillingCurve(idx_t localVertexCount,
+                                                         PartitionMethod partitionMethod)
+      {
+        // Find how many bits the largest site coordinate needs.
+        const site_t sitesAlongLongestSide = geometry.GetBlockSize()
+            * std::max(geometry.GetBlockDimensions().x,
+                       std::max(geometry.GetBlockDimensions().y, geometry.GetBlockDimensions().z));
+        unsigned bits = 1;
+        while ( (site_t(1) << bits) < sitesAlongLongestSide)
+        {
+          ++bits;
+        }
+        if (bits > SpaceFillingCurve::MAX_BITS)
+        {
+          throw Exception() << "The geometry is " << sitesAlongLongestSide
+              << " sites across, too big to partition along a space-filling curve.";
+        }
+
+        std::vector<uint64_t> keys(localVertexCount);
+        for (idx_t vertex = 0; vertex < localVertexCount; ++vertex)
+        {
+          const util::Vector3D<site_t> site((site_t) vertexCoordinates[3 * vertex],
+                                            (site_t) vertexCoordinates[3 * vertex + 1],
+                                            (site_t) vertexCoordinates[3 * vertex + 2]);
+          keys[vertex] = (partitionMethod == HilbertCurvePartition)
+            ? SpaceFillingCurve::HilbertKey(site, bits)
+            : SpaceFillingCurve::MortonKey(site, bits);
+        }
+
+        partitionVector = SpaceFillingCurve::Partition(comms, keys, vertexWeights, comms.Size());
+      }
+
+      void OptimisedDecomposition::PopulateAdjacencyParts(idx_t localVertexCount)
+      {
+        const idx_t myLowest = vtxDistribn[comms.Rank()];
+        const idx_t myEnd = vtxDistribn[comms.Rank() + 1];
+
+        // Ask the owner of each neighbouring site elsewhere which part it's in.
+        std::vector<std::vector<idx_t> > verticesNeededFrom(comms.Size());
+        for (idx_t adjacency = 0; adjacency < (idx_t) localAdjacencies.size(); ++adjacency)
+        {
+          const idx_t neighbour = localAdjacencies[adjacency];
+          if (neighbour < myLowest || neighbour >= myEnd)
+          {
+            const proc_t owner = std::upper_bound(vtxDistribn.begin(), vtxDistribn.end(), neighbour)
+                - vtxDistribn.begin() - 1;
+            verticesNeededFrom[owner].push_back(neighbour);
+          }
+        }
+        std::vector<int> countNeededFrom(comms.Size());
+        for (proc_t rank = 0; rank < comms.Size(); ++rank)
+        {
+          std::vector<idx_t>& needed = verticesNeededFrom[rank];
+          std::sort(needed.begin(), needed.end());
+          needed.erase(std::unique(needed.begin(), needed.end()), needed.end());
+          countNeededFrom[rank] = needed.size();
+        }
+        const std::vector<int> countNeededBy = comms.AllToAll(countNeededFrom);
+
+        std::vector<std::vector<idx_t> > verticesNeededBy(comms.Size());
+        net::Net netForParts(comms);
+        for (proc_t rank = 0; rank < comms.Size(); ++rank)
+        {
+          if (countNeededBy[rank] > 0)
+          {
+            verticesNeededBy[rank].resize(countNeededBy[rank]);
+            netForParts.RequestReceiveV(verticesNeededBy[rank], rank);
+          }
+          if (countNeededFrom[rank] > 0)
+          {
+            netForParts.RequestSendV(verticesNeededFrom[rank], rank);
+          }
+        }
+        netForParts.Dispatch();
+
+        std::vector<std::vector<idx_t> > partsNeededBy(comms.Size());
+        std::vector<std::vector<idx_t> > partsNeededFrom(comms.Size());
+        for (proc_t rank = 0; rank < comms.Size(); ++rank)
+        {
+          if (countNeededBy[rank] > 0)
+          {
+            for (std::vector<idx_t>::const_iterator vertex = verticesNeededBy[rank].begin();
+                vertex != verticesNeededBy[rank].end(); ++vertex)
+            {
+              partsNeededBy[rank].push_back(partitionVector[*vertex - myLowest]);
+            }
+            netForParts.RequestSendV(partsNeededBy[rank], rank);
+          }
+          if (countNeededFrom[rank] > 0)
+          {
+            partsNeededFrom[rank].resize(countNeededFrom[rank]);
+            netForParts.RequestReceiveV(partsNeededFrom[rank], rank);
+          }
+        }
+        netForParts.Dispatch();
+
+        adjacencyParts.resize(localAdjacencies.size());
+        for (idx_t adjacency = 0; adjacency < (idx_t) localAdjacencies.size(); ++adjacency)
+        {
+          const idx_t neighbour = localAdjacencies[adjacency];
+          if (neighbour >= myLowest && neighbour < myEnd)
+          {
+            adjacencyParts[adjacency] = partitionVector[neighbour - myLowest];
+          }
+          else
+          {
+            const proc_t owner = std::upper_bound(vtxDistribn.begin(), vtxDistribn.end(), neighbour)
+                - vtxDistribn.begin() - 1;
+            const std::vector<idx_t>& needed = verticesNeededFrom[owner];
+            adjacencyParts[adjacency] = partsNeededFrom[owner][std::lower_bound(needed.begin(),
+                                                                                needed.end(),
+                                                                                neighbour)
+                - needed.begin()];
+          }
+        }
+      }
+
+      void OptimisedDecomposition::PlacePartsOnNodes(idx_t localVertexCount,
+                                                     const NodePlacement& nodePlacement)
+      {
+        if (nodePlacement.GetNodeCount() < 2)
+        {
+          return;
+        }
+
+        // Count the links between each pair of parts here, and send them to rank 0 to choose
+        // where each part goes.
+        std::map<std::pair<proc_t, proc_t>, int64_t> localLinks;
+        for (idx_t vertex = 0; vertex < localVertexCount; ++vertex)
+        {
+          for (idx_t adjacency = adjacenciesPerVertex[vertex]; adjacency < adjacenciesPerVertex[vertex + 1];
+              ++adjacency)
+          {
+            if (adjacencyParts[adjacency] != partitionVector[vertex])
+            {
+              ++localLinks[std::make_pair(proc_t(partitionVector[vertex]), proc_t(adjacencyParts[adjacency]))];
+            }
+          }
+        }
+        std::vector<int64_t> linkData;
+        for (std::map<std::pair<proc_t, proc_t>, int64_t>::const_iterator link = localLinks.begin();
+            link != localLinks.end(); ++link)
+        {
+          linkData.push_back(link->first.first);
+          linkData.push_back(link->first.second);
+          linkData.push_back(link->second);
+        }
+        std::vector<int> sendCounts(comms.Size(), 0);
+        sendCounts[0] = linkData.size();
+        const std::vector<int> receiveCounts = comms.AllToAll(sendCounts);
+        const std::vector<int64_t> allLinkData = comms.AllToAllV(linkData, sendCounts, receiveCounts);
+
+        std::vector<proc_t> rankForEachPart(comms.Size());
+        if (comms.Rank() == 0)
+        {
+          std::vector<NodePlacement::PartLink> links(allLinkData.size() / 3);
+          for (size_t link = 0; link < links.size(); ++link)
+          {
+            links[link].from = allLinkData[3 * link];
+            links[link].to = allLinkData[3 * link + 1];
+            links[link].count = allLinkData[3 * link + 2];
+          }
+          rankForEachPart = nodePlacement.PlaceParts(links);
+        }
+        comms.Broadcast(rankForEachPart, 0);
+
+        for (idx_t vertex = 0; vertex < localVertexCount; ++vertex)
+        {
+          partitionVector[vertex] = rankForEachPart[partitionVector[vertex]];
+        }
+        for (size_t adjacency = 0; adjacency < adjacencyParts.size(); ++adjacency)
+        {
+          adjacencyParts[adjacency] = rankForEachPart[adjacencyParts[adjacency]];
+        }
+      }
+
+      void OptimisedDecomposition::ReportPartitionQuality(idx_t localVertexCount,
+                                                          PartitionMethod partitionMethod,
+                                                          const NodePlacement& nodePlacement)
+      {
+        // Count the links leaving each site for another part (so every cut edge twice), and
+        // those of them that leave the node, and total the weight of each part.
+        int64_t localLinksCut[2] = { 0, 0 };
+        std::vector<int64_t> weightOfEachPart(comms.Size(), 0);
+        for (idx_t vertex = 0; vertex < localVertexCount; ++vertex)
+        {
+          weightOfEachPart[partitionVector[vertex]] += vertexWeights[vertex];
+
+          for (idx_t adjacency = adjacenciesPerVertex[vertex];
+              adjacency < adjacenciesPerVertex[vertex + 1]; ++adjacency)
+          {
+            const idx_t neighbourPart = adjacencyParts[adjacency];
+            if (neighbourPart != partitionVector[vertex])
+            {
+              ++localLinksCut[0];
+              if (nodePlacement.GetNode(neighbourPart) != nodePlacement.GetNode(partitionVector[vertex]))
+              {
+                ++localLinksCut[1];
+              }
+            }
+          }
+        }
+
+        const std::vector<int64_t> linksCut =
+            comms.AllReduce(std::vector<int64_t>(localLinksCut, localLinksCut + 2), MPI_SUM);
+        const int64_t edgesCut = linksCut[0] / 2;
+        const int64_t edgesBetweenNodes = linksCut[1] / 2;
+        weightOfEachPart = comms.AllReduce(weightOfEachPart, MPI_SUM);
+        int64_t totalWeight = 0;
+        int64_t heaviestPart = 0;
+        for (proc_t part = 0; part < comms.Size(); ++part)
+        {
+          totalWeight += weightOfEachPart[part];
+          heaviestPart = std::max(heaviestPart, weightOfEachPart[part]);
+        }
+
+        if (comms.Rank() == 0)
+        {
+          const char* methodNames[] = { "ParMetis", "a Hilbert curve", "a Morton curve" };
+          log::Logger::Log<log::Info, log::OnePerCore>("Partitioning with %s cut %ld edges, with load imbalance %.3f (heaviest part weight / mean)",
+                                                       methodNames[partitionMethod],
+                                                       (long) edgesCut,
+                                                       totalWeight > 0
+                                                         ? double(heaviestPart) * comms.Size() / totalWeight
+                                                         : 1.0);
+          log::Logger::Log<log::Info, log::OnePerCore>("Over %d node(s), %ld cut edges are within nodes and %ld between them",
+                                                       nodePlacement.GetNodeCount(),
+                                                       (long) (edgesCut - edgesBetweenNodes),
+                                                       (long) edgesBetweenNodes);
+        }
+      }
+
       void OptimisedDecomposition::PopulateVertexWeightData(idx_t localVertexCount)
       {
         // These counters will be used later on to count the number of each type of vertex site
@@ -245,32 +494,32 @@ namespace hemelb
                     switch (siteData.GetCollisionType())
                     {
                       case FLUID:
-                        localweight = hemelbSiteWeights[0];
+                        localweight = siteWeights.GetWeight(0, blockNumber);
                         ++FluidSiteCounter;
                         break;
 
                       case WALL:
-                        localweight = hemelbSiteWeights[1];
+                        localweight = siteWeights.GetWeight(1, blockNumber);
                         ++WallSiteCounter;
                         break;
 
                       case INLET:
-                        localweight = hemelbSiteWeights[2];
+                        localweight = siteWeights.GetWeight(2, blockNumber);
                         ++IOSiteCounter;
                         break;
 
                       case OUTLET:
-                        localweight = hemelbSiteWeights[3];
+                        localweight = siteWeights.GetWeight(3, blockNumber);
                         ++IOSiteCounter;
                         break;
 
                       case (INLET | WALL):
-                        localweight = hemelbSiteWeights[4];
+                        localweight = siteWeights.GetWeight(4, blockNumber);
                         ++WallIOSiteCounter;
                         break;
 
                       case (OUTLET | WALL):
-                        localweight = hemelbSiteWeights[5];
+                        localweight = siteWeights.GetWeight(5, blockNumber);
                         ++WallIOSiteCounter;
                         break;
                     }
@@ -291,9 +540,9 @@ namespace hemelb
           }
         }
 
-        int TotalCoreWeight = ( (FluidSiteCounter * hemelbSiteWeights[0])
-            + (WallSiteCounter * hemelbSiteWeights[1]) + (IOSiteCounter * hemelbSiteWeights[2])
-            + (WallIOSiteCounter * hemelbSiteWeights[4])) / hemelbSiteWeights[0];
+        int TotalCoreWeight = ( (FluidSiteCounter * siteWeights[0])
+            + (WallSiteCounter * siteWeights[1]) + (IOSiteCounter * siteWeights[2])
+            + (WallIOSiteCounter * siteWeights[4])) / siteWeights[0];
         int TotalSites = FluidSiteCounter + WallSiteCounter + WallIOSiteCounter;
 
         log::Logger::Log<log::Debug, log::OnePerCore>("There are %u Bulk Flow Sites, %u Wall Sites, %u IO Sites, %u WallIO Sites on core %u. Total: %u (Weighted %u Points)",
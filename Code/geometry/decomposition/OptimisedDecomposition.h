@@ -16,6 +16,9 @@
 #include "net/MpiCommunicator.h"
 #include "geometry/SiteData.h"
 #include "geometry/GeometryBlock.h"
+#include "geometry/decomposition/NodePlacement.h"
+#include "geometry/decomposition/PartitionMethod.h"
+#include "geometry/decomposition/SiteWeights.h"
 
 namespace hemelb
 {
@@ -30,7 +33,9 @@ namespace hemelb
                                  const Geometry& geometry,
                                  const lb::lattices::LatticeInfo& latticeInfo,
                                  const std::vector<proc_t>& procForEachBlock,
-                                 const std::vector<site_t>& fluidSitesPerBlock);
+                                 const std::vector<site_t>& fluidSitesPerBlock,
+                                 PartitionMethod partitionMethod = ParMetisPartition,
+                                 const SiteWeights& siteWeights = SiteWeights());
 
           /**
            * Returns a vector with the number of moves coming from each core
@@ -88,6 +93,45 @@ namespace hemelb
            */
           void CallParmetis(idx_t localVertexCount);
 
+          /**
+           * Partition the sites along a space-filling curve through them, putting the result in
+           * the partition vector.
+           *
+           * @param localVertexCount [in] The number of local fluid sites
+           * @param partitionMethod [in] Which curve to use
+           */
+          void CallSpaceFillingCurve(idx_t localVertexCount, PartitionMethod partitionMethod);
+
+          /**
+           * Find the part of the neighbour at each local adjacency, from the partition vector,
+           * asking the ranks that hold the neighbours elsewhere.
+           *
+           * @param localVertexCount [in] The number of local fluid sites
+           */
+          void PopulateAdjacencyParts(idx_t localVertexCount);
+
+          /**
+           * Renumber the parts, which are ranks, so that as many of the links between them as
+           * possible are between ranks on the same node (see NodePlacement).
+           *
+           * @param localVertexCount [in] The number of local fluid sites
+           * @param nodePlacement [in] The ranks on each node
+           */
+          void PlacePartsOnNodes(idx_t localVertexCount, const NodePlacement& nodePlacement);
+
+          /**
+           * Log how good the partition vector is: the number of lattice links between sites in
+           * different parts, how many of those cross between nodes, and the weight of the
+           * heaviest part relative to the mean. This allows the partitioning methods to be
+           * compared on a given geometry.
+           *
+           * @param localVertexCount [in] The number of local fluid sites
+           * @param partitionMethod [in] The method that made the partition
+           * @param nodePlacement [in] The ranks on each node
+           */
+          void ReportPartitionQuality(idx_t localVertexCount, PartitionMethod partitionMethod,
+                                      const NodePlacement& nodePlacement);
+
           /**
            * Populate the list of moves from each proc that we need locally, using the
            * partition vector.
@@ -212,6 +256,7 @@ namespace hemelb
           const lb::lattices::LatticeInfo& latticeInfo; //! The lattice info to optimise for.
           const std::vector<proc_t>& procForEachBlock; //! The processor assigned to each block at the moment
           const std::vector<site_t>& fluidSitesPerBlock; //! The number of fluid sites on each block.
+          const SiteWeights siteWeights; //! The relative cost of each type of site.
           std::vector<idx_t> vtxDistribn; //! The vertex distribution across participating cores.
           std::vector<idx_t> firstSiteIndexPerBlock; //! The global contiguous index of the first fluid site on each block.
           std::vector<idx_t> adjacenciesPerVertex; //! The number of adjacencies for each local fluid site
@@ -219,6 +264,7 @@ namespace hemelb
           std::vector<real_t> vertexCoordinates; //! The coordinates of each local fluid site
           std::vector<idx_t> localAdjacencies; //! The list of adjacent vertex numbers for each local fluid site
           std::vector<idx_t> partitionVector; //! The results of the optimisation -- which core each fluid site should go to.
+          std::vector<idx_t> adjacencyParts; //! The part of the neighbour at each local adjacency.
           std::vector<idx_t> allMoves; //! The list of move counts from each core
           std::vector<idx_t> movesList;
       };
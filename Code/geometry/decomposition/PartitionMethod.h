@@ -0,0 +1,28 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DECOMPOSITION_PARTITIONMETHOD_H
+#define HEMELB_GEOMETRY_DECOMPOSITION_PARTITIONMETHOD_H
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      /**
+       * The ways OptimisedDecomposition can divide the fluid sites between ranks.
+       */
+      enum PartitionMethod
+      {
+        ParMetisPartition, //!< Minimise the edge cut with ParMETIS.
+        HilbertCurvePartition, //!< Cut a Hilbert curve through the sites into equally weighted pieces.
+        MortonCurvePartition //!< The same, with a Morton (Z-order) curve.
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DECOMPOSITION_PARTITIONMETHOD_H */
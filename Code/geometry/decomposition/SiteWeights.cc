@@ -0,0 +1,102 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "geometry/decomposition/SiteWeights.h"
+#include "geometry/decomposition/DecompositionWeights.h"
+#include "io/xml/XmlAbstractionLayer.h"
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      namespace
+      {
+        //! The attribute holding each type's weight in the file.
+        const char* const typeNames[SiteWeights::TYPE_COUNT] = { "bulk", "wall", "inlet", "outlet",
+                                                                 "inletwall", "outletwall" };
+      }
+
+      const unsigned SiteWeights::TYPE_COUNT;
+      const int SiteWeights::MEASURED_BULK_WEIGHT;
+      const int SiteWeights::LOAD_FACTOR_RESOLUTION;
+
+      SiteWeights::SiteWeights()
+      {
+        std::copy(hemelbSiteWeights, hemelbSiteWeights + TYPE_COUNT, weights);
+      }
+
+      SiteWeights SiteWeights::Load(const std::string& path)
+      {
+        // The file is an element like:
+        // <siteweights bulk="10" wall="13" inlet="21" outlet="21" inletwall="24" outletwall="24" />
+        io::xml::Document document(path);
+        io::xml::Element weightsEl = document.GetRoot();
+        if (weightsEl.GetName() != "siteweights")
+        {
+          throw Exception() << "Invalid root element in site weights file: " << weightsEl.GetPath();
+        }
+
+        SiteWeights ans;
+        for (unsigned type = 0; type < TYPE_COUNT; ++type)
+        {
+          weightsEl.GetAttributeOrThrow(typeNames[type], ans.weights[type]);
+          if (ans.weights[type] < 1)
+          {
+            throw Exception() << "Site weights must be positive: " << typeNames[type] << " is "
+                << ans.weights[type];
+          }
+        }
+        return ans;
+      }
+
+      SiteWeights SiteWeights::FromCosts(const std::vector<double>& secondsPerSite)
+      {
+        SiteWeights ans;
+        // Without a measurement for bulk sites there's nothing to scale the others by.
+        if (secondsPerSite[0] <= 0.0)
+        {
+          return ans;
+        }
+
+        for (unsigned type = 0; type < TYPE_COUNT; ++type)
+        {
+          const double relativeCost = (secondsPerSite[type] > 0.0)
+            ? secondsPerSite[type] / secondsPerSite[0]
+            : double(hemelbSiteWeights[type]) / hemelbSiteWeights[0];
+          ans.weights[type] = std::max(1, (int) std::floor(relativeCost * MEASURED_BULK_WEIGHT + 0.5));
+        }
+        return ans;
+      }
+
+      void SiteWeights::SetBlockLoadFactors(const std::vector<float>& factors)
+      {
+        blockLoadFactors = factors;
+      }
+
+      void SiteWeights::Save(const std::string& path) const
+      {
+        std::ofstream file(path.c_str());
+        file << "<siteweights";
+        for (unsigned type = 0; type < TYPE_COUNT; ++type)
+        {
+          file << " " << typeNames[type] << "=\"" << weights[type] << "\"";
+        }
+        file << " />" << std::endl;
+
+        if (!file)
+        {
+          throw Exception() << "Couldn't write site weights to " << path;
+        }
+      }
+    }
+  }
+}
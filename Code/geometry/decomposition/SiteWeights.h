@@ -0,0 +1,117 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DECOMPOSITION_SITEWEIGHTS_H
+#define HEMELB_GEOMETRY_DECOMPOSITION_SITEWEIGHTS_H
+
+#include <string>
+#include <vector>
+#include "constants.h"
+#include "units.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      /**
+       * The relative cost of updating a site of each collision type, used to balance the load
+       * when decomposing the geometry. By default these are the compiled-in guesses from
+       * DecompositionWeights.h, but they can be measured on the machine in use by a calibration
+       * run and saved to a file for later runs.
+       *
+       * The types are in the same order as LatticeData's collision types: bulk fluid, wall,
+       * inlet, outlet, inlet and wall, outlet and wall.
+       */
+      class SiteWeights
+      {
+        public:
+          //! The number of collision types.
+          static const unsigned TYPE_COUNT = COLLISION_TYPES;
+          //! The weight of a bulk site when weights are calculated from measured costs.
+          static const int MEASURED_BULK_WEIGHT = 10;
+          //! How much finer weights are when scaled by block, so small factors still count.
+          static const int LOAD_FACTOR_RESOLUTION = 16;
+
+          /**
+           * The compiled-in weights.
+           */
+          SiteWeights();
+
+          /**
+           * Read weights from a file written by Save.
+           *
+           * @param path
+           * @return
+           */
+          static SiteWeights Load(const std::string& path);
+
+          /**
+           * Make weights proportional to the measured cost of updating a site of each type, with
+           * a bulk site weighing MEASURED_BULK_WEIGHT. Types that weren't measured (with a
+           * cost of zero) keep the compiled-in weight relative to bulk sites.
+           *
+           * @param secondsPerSite The measured time per site update for each collision type.
+           * @return
+           */
+          static SiteWeights FromCosts(const std::vector<double>& secondsPerSite);
+
+          /**
+           * Write the weights to a file.
+           *
+           * @param path
+           */
+          void Save(const std::string& path) const;
+
+          int operator[](unsigned collisionType) const
+          {
+            return weights[collisionType];
+          }
+
+          /**
+           * Scale the weights of the sites on each block, for example by how much slower the
+           * sites there have been to update than elsewhere.
+           *
+           * @param factors The factor for each block, or empty to scale none.
+           */
+          void SetBlockLoadFactors(const std::vector<float>& factors);
+
+          const std::vector<float>& GetBlockLoadFactors() const
+          {
+            return blockLoadFactors;
+          }
+
+          /**
+           * Get the weight of a site of the given type on the given block, which is never less
+           * than one. With block load factors, all weights are also multiplied by
+           * LOAD_FACTOR_RESOLUTION.
+           *
+           * @param collisionType
+           * @param block
+           * @return
+           */
+          int GetWeight(unsigned collisionType, site_t block) const
+          {
+            if (blockLoadFactors.empty())
+            {
+              return weights[collisionType];
+            }
+            const int scaled = int(weights[collisionType] * LOAD_FACTOR_RESOLUTION
+                * blockLoadFactors[block] + 0.5f);
+            return scaled < 1
+              ? 1
+              : scaled;
+          }
+
+        private:
+          int weights[TYPE_COUNT];
+          std::vector<float> blockLoadFactors;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DECOMPOSITION_SITEWEIGHTS_H */
@@ -0,0 +1,169 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <utility>
+#include "geometry/decomposition/SpaceFillingCurve.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      namespace
+      {
+        /**
+         * Make a key from the bits of three coordinates, most significant first, taking x then y
+         * then z at each level.
+         */
+        uint64_t Interleave(const uint64_t coords[3], unsigned bits)
+        {
+          uint64_t key = 0;
+          for (int bit = bits - 1; bit >= 0; --bit)
+          {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+              key = (key << 1) | ( (coords[axis] >> bit) & 1);
+            }
+          }
+          return key;
+        }
+      }
+
+      uint64_t SpaceFillingCurve::MortonKey(const util::Vector3D<site_t>& point, unsigned bits)
+      {
+        const uint64_t coords[3] = { uint64_t(point.x), uint64_t(point.y), uint64_t(point.z) };
+        return Interleave(coords, bits);
+      }
+
+      uint64_t SpaceFillingCurve::HilbertKey(const util::Vector3D<site_t>& point, unsigned bits)
+      {
+        uint64_t coords[3] = { uint64_t(point.x), uint64_t(point.y), uint64_t(point.z) };
+        const uint64_t topBit = uint64_t(1) << (bits - 1);
+
+        // Undo the rotations and reflections of the sub-cubes, from the coarsest level down.
+        for (uint64_t levelBit = topBit; levelBit > 1; levelBit >>= 1)
+        {
+          const uint64_t lowerBits = levelBit - 1;
+          for (int axis = 0; axis < 3; ++axis)
+          {
+            if (coords[axis] & levelBit)
+            {
+              coords[0] ^= lowerBits;
+            }
+            else
+            {
+              const uint64_t swap = (coords[0] ^ coords[axis]) & lowerBits;
+              coords[0] ^= swap;
+              coords[axis] ^= swap;
+            }
+          }
+        }
+
+        // Gray encode.
+        coords[1] ^= coords[0];
+        coords[2] ^= coords[1];
+        uint64_t flip = 0;
+        for (uint64_t levelBit = topBit; levelBit > 1; levelBit >>= 1)
+        {
+          if (coords[2] & levelBit)
+          {
+            flip ^= levelBit - 1;
+          }
+        }
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          coords[axis] ^= flip;
+        }
+
+        return Interleave(coords, bits);
+      }
+
+      std::vector<idx_t> SpaceFillingCurve::Partition(const net::MpiCommunicator& comms,
+                                                      const std::vector<uint64_t>& keys,
+                                                      const std::vector<idx_t>& weights,
+                                                      proc_t parts)
+      {
+        // Sort the local points along the curve, and total the weight below each.
+        std::vector<std::pair<uint64_t, idx_t> > sortedPoints(keys.size());
+        for (size_t point = 0; point < keys.size(); ++point)
+        {
+          sortedPoints[point] = std::make_pair(keys[point], weights[point]);
+        }
+        std::sort(sortedPoints.begin(), sortedPoints.end());
+
+        std::vector<uint64_t> sortedKeys(keys.size());
+        std::vector<int64_t> weightBelow(keys.size() + 1, 0);
+        for (size_t point = 0; point < keys.size(); ++point)
+        {
+          sortedKeys[point] = sortedPoints[point].first;
+          weightBelow[point + 1] = weightBelow[point] + sortedPoints[point].second;
+        }
+
+        const int64_t totalWeight = comms.AllReduce(weightBelow.back(), MPI_SUM);
+        const uint64_t endKey = comms.AllReduce(sortedKeys.empty()
+                                                  ? uint64_t(0)
+                                                  : sortedKeys.back() + 1,
+                                                MPI_MAX);
+
+        // Cut c is at the lowest key with at least (c + 1) / parts of the weight below it, so is
+        // between lowestCut[c] and highestCut[c] inclusive.
+        const size_t cutCount = parts - 1;
+        std::vector<int64_t> targetWeight(cutCount);
+        std::vector<uint64_t> lowestCut(cutCount, 0);
+        std::vector<uint64_t> highestCut(cutCount, endKey);
+        for (size_t cut = 0; cut < cutCount; ++cut)
+        {
+          targetWeight[cut] = totalWeight * (cut + 1) / parts;
+        }
+
+        bool cutsFound = (endKey == 0);
+        while (cutCount > 0 && !cutsFound)
+        {
+          std::vector<uint64_t> middle(cutCount);
+          std::vector<int64_t> localWeightBelowMiddle(cutCount);
+          for (size_t cut = 0; cut < cutCount; ++cut)
+          {
+            middle[cut] = lowestCut[cut] + (highestCut[cut] - lowestCut[cut]) / 2;
+            localWeightBelowMiddle[cut] =
+                weightBelow[std::lower_bound(sortedKeys.begin(), sortedKeys.end(), middle[cut])
+                    - sortedKeys.begin()];
+          }
+
+          const std::vector<int64_t> weightBelowMiddle = comms.AllReduce(localWeightBelowMiddle,
+                                                                         MPI_SUM);
+
+          cutsFound = true;
+          for (size_t cut = 0; cut < cutCount; ++cut)
+          {
+            if (lowestCut[cut] == highestCut[cut])
+            {
+              continue;
+            }
+            if (weightBelowMiddle[cut] >= targetWeight[cut])
+            {
+              highestCut[cut] = middle[cut];
+            }
+            else
+            {
+              lowestCut[cut] = middle[cut] + 1;
+            }
+            cutsFound &= (lowestCut[cut] == highestCut[cut]);
+          }
+        }
+
+        // Each point's part is the number of cuts at or before it.
+        std::vector<idx_t> partForEachPoint(keys.size());
+        for (size_t point = 0; point < keys.size(); ++point)
+        {
+          partForEachPoint[point] = std::upper_bound(lowestCut.begin(), lowestCut.end(), keys[point])
+              - lowestCut.begin();
+        }
+        return partForEachPoint;
+      }
+    }
+  }
+}
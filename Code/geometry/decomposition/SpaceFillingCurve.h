@@ -0,0 +1,76 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DECOMPOSITION_SPACEFILLINGCURVE_H
+#define HEMELB_GEOMETRY_DECOMPOSITION_SPACEFILLINGCURVE_H
+
+#include <stdint.h>
+#include <vector>
+#include "geometry/ParmetisForward.h"
+#include "net/MpiCommunicator.h"
+#include "units.h"
+#include "util/Vector3D.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      /**
+       * Partitions points by ordering them along a space-filling curve and cutting the curve
+       * into pieces of equal weight. Nearby points tend to be close along the curve, so the
+       * pieces are reasonably compact, and unlike a graph partitioner this needs no adjacency
+       * data and only a few small reductions.
+       */
+      class SpaceFillingCurve
+      {
+        public:
+          //! The most bits of each coordinate that fit in a key.
+          static const unsigned MAX_BITS = 21;
+
+          /**
+           * Get the position of a point along a Morton (Z-order) curve, by interleaving the bits
+           * of its coordinates.
+           *
+           * @param point Coordinates, each less than 2^bits.
+           * @param bits
+           * @return
+           */
+          static uint64_t MortonKey(const util::Vector3D<site_t>& point, unsigned bits);
+
+          /**
+           * Get the position of a point along a Hilbert curve, where successive points are
+           * always adjacent. Uses Skilling's transpose algorithm (AIP Conf. Proc. 707, 381, 2004).
+           *
+           * @param point Coordinates, each less than 2^bits.
+           * @param bits
+           * @return
+           */
+          static uint64_t HilbertKey(const util::Vector3D<site_t>& point, unsigned bits);
+
+          /**
+           * Divide weighted points, spread between the ranks of comms, into parts of roughly
+           * equal weight, each of which is a contiguous piece of the curve. A collective
+           * operation.
+           *
+           * The cut points are found by bisecting the key space for all parts at once, with one
+           * reduction of the weight below each candidate cut per step.
+           *
+           * @param comms
+           * @param keys [in] The distinct position along the curve of each local point.
+           * @param weights [in] The weight of each local point.
+           * @param parts [in] The number of parts.
+           * @return The part each local point is in.
+           */
+          static std::vector<idx_t> Partition(const net::MpiCommunicator& comms,
+                                              const std::vector<uint64_t>& keys,
+                                              const std::vector<idx_t>& weights, proc_t parts);
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DECOMPOSITION_SPACEFILLINGCURVE_H */
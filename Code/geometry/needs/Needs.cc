@@ -4,6 +4,7 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include "geometry/needs/Needs.h"
 #include "log/Logger.h"
 #include "util/utilityFunctions.h"
@@ -16,8 +17,10 @@ namespace hemelb
                  const std::vector<bool>& readBlock,
                  const proc_t readingGroupSize,
                  net::InterfaceDelegationNet & net,
-                 bool shouldValidate_) :
-        procsWantingBlocksBuffer(blockCount), communicator(net.GetCommunicator()), readingGroupSize(readingGroupSize), shouldValidate(shouldValidate_)
+                 bool shouldValidate_,
+                 const std::vector<site_t>& firstBlockOnReadingCore) :
+        procsWantingBlocksBuffer(blockCount), communicator(net.GetCommunicator()), readingGroupSize(readingGroupSize),
+            firstBlockOnReadingCore(firstBlockOnReadingCore), shouldValidate(shouldValidate_)
     {
       // Compile the blocks needed here into an array of indices, instead of an array of bools
       std::vector<std::vector<site_t> > blocksNeededHere(readingGroupSize);
@@ -122,7 +125,13 @@ namespace hemelb
 
     proc_t Needs::GetReadingCoreForBlock(const site_t blockNumber) const
     {
-      return proc_t(blockNumber % readingGroupSize);
+      if (firstBlockOnReadingCore.empty())
+      {
+        return proc_t(blockNumber % readingGroupSize);
+      }
+      // The last core whose range starts at or before the block.
+      return proc_t(std::upper_bound(firstBlockOnReadingCore.begin(), firstBlockOnReadingCore.end(), blockNumber)
+          - firstBlockOnReadingCore.begin() - 1);
     }
   } //namespace
 } //namespace
@@ -29,12 +29,16 @@ namespace hemelb
          * @param readBlock Which cores need which blocks, as an array of booleans.
          * @param readingGroupSize Number sof cores to use for reading blocks
          * @param net Instance of Net communication class to use.
+         * @param firstBlockOnReadingCore If given, each reading core reads a contiguous range of
+         * blocks, starting at this entry for that core and ending before the next one (so there
+         * is one more entry than reading cores). Otherwise blocks are dealt out in turn.
          */
        Needs(const site_t blockCount,
                           const std::vector<bool>& readBlock,
                           const proc_t readingGroupSize,
                           net::InterfaceDelegationNet &net,
-                          bool shouldValidate); // Temporarily during the refactor, constructed just to abstract the block sharing bit
+                          bool shouldValidate,
+                          const std::vector<site_t>& firstBlockOnReadingCore = std::vector<site_t>()); // Temporarily during the refactor, constructed just to abstract the block sharing bit
 
         /***
          * Which processors need a given block?
@@ -58,6 +62,7 @@ namespace hemelb
         std::vector<std::vector<proc_t> > procsWantingBlocksBuffer;
         const net::MpiCommunicator & communicator;
         const proc_t readingGroupSize;
+        const std::vector<site_t> firstBlockOnReadingCore;
         bool shouldValidate;
         void Validate(const site_t blockCount, const std::vector<bool>& readBlock);
     };
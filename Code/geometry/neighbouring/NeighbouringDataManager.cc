@@ -108,16 +108,26 @@ namespace hemelb
         // on the sending and receiving procs.
         // But, the needsEachProcHasFromMe is always ordered,
         // by the same order, as the neededSites, so this should be OK.
+        const unsigned numVectors = localLatticeData.GetLatticeInfo().GetNumVectors();
         for (std::vector<site_t>::iterator localNeed = neededSites.begin();
             localNeed != neededSites.end(); localNeed++)
         {
           proc_t source = ProcForSite(*localNeed);
           NeighbouringSite site = neighbouringLatticeData.GetSite(*localNeed);
-          net.RequestReceive(site.GetFOld(localLatticeData.GetLatticeInfo().GetNumVectors()),
-                             localLatticeData.GetLatticeInfo().GetNumVectors(),
-                             source);
+          net.RequestReceive(site.GetFOld(numVectors), numVectors, source);
 
         }
+#if defined(HEMELB_USE_SOA_DISTRIBUTIONS) || defined(HEMELB_USE_AA_STREAMING) || defined(HEMELB_USE_FLOAT_DISTRIBUTIONS)
+        size_t totalSends = 0;
+        for (proc_t other = 0; other < net.Size(); other++)
+        {
+          totalSends += needsEachProcHasFromMe[other].size();
+        }
+        sendBuffer.resize(totalSends * numVectors);
+        distribn_t* nextSend = sendBuffer.empty() ?
+          NULL :
+          &sendBuffer[0];
+#endif
         for (proc_t other = 0; other < net.Size(); other++)
         {
           for (std::vector<site_t>::iterator needOnProcFromMe =
@@ -128,10 +138,15 @@ namespace hemelb
                 localLatticeData.GetLocalContiguousIdFromGlobalNoncontiguousId(*needOnProcFromMe);
             Site<LatticeData> site =
                 const_cast<LatticeData&>(localLatticeData).GetSite(localContiguousId);
+#if defined(HEMELB_USE_SOA_DISTRIBUTIONS) || defined(HEMELB_USE_AA_STREAMING) || defined(HEMELB_USE_FLOAT_DISTRIBUTIONS)
+            const distribn_t* fOld = site.GetFOld(numVectors);
+            std::copy(fOld, fOld + numVectors, nextSend);
+            net.RequestSend(nextSend, numVectors, other);
+            nextSend += numVectors;
+#else
             // have to cast away the const, because no respect for const-ness for sends in MPI
-            net.RequestSend(const_cast<distribn_t*>(site.GetFOld(localLatticeData.GetLatticeInfo().GetNumVectors())),
-                            localLatticeData.GetLatticeInfo().GetNumVectors(),
-                            other);
+            net.RequestSend(const_cast<distribn_t*>(site.GetFOld(numVectors)), numVectors, other);
+#endif
 
           }
         }
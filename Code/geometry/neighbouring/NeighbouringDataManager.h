@@ -60,6 +60,13 @@ namespace hemelb
 
           bool needsHaveBeenShared;
 
+#if defined(HEMELB_USE_SOA_DISTRIBUTIONS) || defined(HEMELB_USE_AA_STREAMING) || defined(HEMELB_USE_FLOAT_DISTRIBUTIONS)
+          //! With structure-of-arrays storage, AA-pattern streaming or single-precision storage
+          //! a site's distributions aren't contiguous doubles, so the ones we send are gathered
+          //! here first.
+          std::vector<distribn_t> sendBuffer;
+#endif
+
       };
 
     }
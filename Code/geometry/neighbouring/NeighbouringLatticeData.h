@@ -77,6 +77,51 @@ namespace hemelb
            */
           const distribn_t* GetFOld(site_t distributionIndex) const;
 
+          /**
+           * As LatticeData::GetFOld with a direction. The neighbouring data is never shifted,
+           * so the direction isn't needed.
+           * @param distributionIndex
+           * @param direction
+           * @return
+           */
+          const distribn_t* GetFOld(site_t distributionIndex, Direction direction) const
+          {
+            return GetFOld(distributionIndex);
+          }
+
+          /**
+           * Get the index of the distribution in the given direction at the given site. Unlike
+           * LatticeData, the neighbouring data always keeps a site's distributions together.
+           * @param globalIndex
+           * @param direction
+           * @return
+           */
+          template<typename LatticeType>
+          site_t GetDistributionIndex(site_t globalIndex, Direction direction) const
+          {
+            return globalIndex * LatticeType::NUMVECTORS + direction;
+          }
+
+          site_t GetDistributionIndex(site_t globalIndex, Direction direction) const
+          {
+            return globalIndex * latticeInfo.GetNumVectors() + direction;
+          }
+
+          /**
+           * The neighbouring data holds a plain copy of each site's distributions, so the
+           * pre-collision values are always where GetDistributionIndex says.
+           */
+          template<typename LatticeType>
+          site_t GetFOldIndex(site_t globalIndex, Direction direction) const
+          {
+            return GetDistributionIndex<LatticeType>(globalIndex, direction);
+          }
+
+          site_t GetFOldIndex(site_t globalIndex, Direction direction) const
+          {
+            return GetDistributionIndex(globalIndex, direction);
+          }
+
           /*
            * This is not defined for Neighbouring Data.
            * Data streamed across boundaries is handled by the existing mechanism.
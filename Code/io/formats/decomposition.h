@@ -0,0 +1,61 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_FORMATS_DECOMPOSITION_H
+#define HEMELB_IO_FORMATS_DECOMPOSITION_H
+
+#include "io/formats/formats.h"
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace formats
+    {
+      namespace decomposition
+      {
+        /* A cached domain decomposition of a geometry file, for a given number of
+         * ranks. The format comprises a header and then a body.
+         * Header is made up of (hex file position, type, description)
+         * 00   uint       HemeLB magic number (see formats.h)
+         * 04   uint       Decomposition magic number (see below)
+         * 08   uint       Version number
+         * 12   uhyper     Key: hash of the geometry file preamble and header, the lattice,
+         *                 the site weights and the number of ranks
+         * 20   uint       Number of ranks
+         * 24   uint       Number of blocks
+         * 28   uint       Total number of (block, rank) owner records
+         * Header length = 32 bytes
+         *
+         * Body consists of
+         * Block count x uint        Number of ranks with fluid sites on each block
+         * Owner record count x uint Those ranks, block by block
+         * Fluid site count x uint   The rank of each fluid site, block by block, in the
+         *                           order the sites appear in the geometry file
+         */
+
+        enum
+        {
+          /* Identify decomposition files
+           * ASCII for 'dcp', then EOF
+           * Combined magic number is
+           * hex    68 6c 62 21 64 63 70 04
+           * ascii:  h  l  b  !  d  c  p EOF
+           */
+          MagicNumber = 0x64637004
+        };
+        enum
+        {
+          VersionNumber = 1
+        };
+        enum
+        {
+          HeaderLength = 32
+        };
+      }
+    }
+  }
+}
+#endif /* HEMELB_IO_FORMATS_DECOMPOSITION_H */
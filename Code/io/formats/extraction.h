@@ -7,6 +7,8 @@
 #ifndef HEMELB_IO_FORMATS_EXTRACTION_H
 #define HEMELB_IO_FORMATS_EXTRACTION_H
 
+#include <string>
+
 namespace hemelb
 {
   namespace io
@@ -32,6 +34,92 @@ namespace hemelb
           VersionNumber = 4
         };
 
+        /**
+         * The version number of the chunked format. This stores the sites' positions only when
+         * they change, and can compress the data and store the values with less precision.
+         *
+         * The main header is as in VersionNumber. The field header starts with a uint for the
+         * Compression, then for each field:
+         * string - Name
+         * uint - Number of components
+         * double - Offset to add to each value
+         * uint - FieldEncoding
+         *
+         * Then come blocks, each of a header of BlockHeaderLength:
+         * uint - BlockType
+         * uint - Number of chunks
+         * uhyper - Iteration number (values blocks only)
+         * uhyper - Length of the chunks that follow
+         *
+         * and the chunks, one from each core with sites, in order. Each chunk is made up of:
+         * uint - Number of sites
+         * uint - Length of the data, as stored
+         * uint - Length of the data once decompressed
+         * then the data, compressed as a whole and padded to a multiple of four bytes. Data that
+         * doesn't get any shorter by compressing is stored uncompressed, with the two lengths
+         * equal.
+         *
+         * The data of a grid block's chunks is three uints for the position of each site. Each
+         * values block holds values at the sites of the chunk in the same place in the last
+         * grid block. Its data has each field in turn, with each site's components in turn,
+         * encoded as the field header says.
+         */
+        enum
+        {
+          ChunkedVersionNumber = 5
+        };
+
+        /**
+         * How the data of a chunk is compressed.
+         */
+        enum Compression
+        {
+          NoCompression = 0,
+          //! With zlib's compress.
+          ZlibCompression = 1
+        };
+
+        /**
+         * How the values of a field are stored, after subtracting its offset.
+         */
+        enum FieldEncoding
+        {
+          //! XDR floats.
+          Float32Encoding = 0,
+          //! IEEE half-precision floats, big-endian.
+          Float16Encoding = 1,
+          //! Two doubles, the least and greatest of the chunk's finite values of the field,
+          //! then a big-endian ushort for each value, spreading the range out between 0 and
+          //! 65534. Values that aren't finite are stored as QuantisedNonFiniteLevel.
+          QuantisedEncoding = 2
+        };
+
+        /**
+         * The level of the quantised encoding that marks a NaN or infinite value, which is read
+         * back as NaN.
+         */
+        enum
+        {
+          QuantisedNonFiniteLevel = 65535
+        };
+
+        /**
+         * The kinds of block in the chunked format.
+         */
+        enum BlockType
+        {
+          //! The positions of the sites, for the values blocks that follow.
+          GridBlock = 1,
+          //! The values of the fields at one iteration.
+          ValuesBlock = 2
+        };
+
+        enum
+        {
+          BlockHeaderLength = 24,
+          ChunkHeaderLength = 12
+        };
+
         /**
          * The length of the main header. Made up of:
          * uint - HemeLbMagicNumber
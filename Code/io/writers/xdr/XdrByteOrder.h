@@ -0,0 +1,88 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_WRITERS_XDR_XDRBYTEORDER_H
+#define HEMELB_IO_WRITERS_XDR_XDRBYTEORDER_H
+
+#include <cstddef>
+#include <cstring>
+#if HEMELB_HAVE_CSTDINT
+# include <cstdint>
+#else
+# include <stdint.h>
+#endif
+
+namespace hemelb
+{
+  namespace io
+  {
+    namespace writers
+    {
+      namespace xdr
+      {
+        /**
+         * Convert a word between the host's byte order and XDR's, which is big-endian. The
+         * conversion is its own inverse. XDR itself has no 16-bit words, but the extraction
+         * format stores them big-endian too.
+         */
+        inline uint16_t ConvertByteOrder(uint16_t word)
+        {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+          return word;
+#else
+          return uint16_t( (word >> 8) | (word << 8));
+#endif
+        }
+
+        inline uint32_t ConvertByteOrder(uint32_t word)
+        {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+          return word;
+#elif defined(__GNUC__)
+          return __builtin_bswap32(word);
+#else
+          return (word >> 24) | ( (word >> 8) & 0xff00u) | ( (word << 8) & 0xff0000u) | (word << 24);
+#endif
+        }
+
+        inline uint64_t ConvertByteOrder(uint64_t word)
+        {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+          return word;
+#elif defined(__GNUC__)
+          return __builtin_bswap64(word);
+#else
+          return (uint64_t(ConvertByteOrder(uint32_t(word))) << 32)
+              | ConvertByteOrder(uint32_t(word >> 32));
+#endif
+        }
+
+        /**
+         * Copy an array of words, of uint16_t, uint32_t or uint64_t, converting each between the host's
+         * byte order and XDR's. Neither array need be aligned. The loop is simple enough for the
+         * compiler to vectorise.
+         * @param from
+         * @param to
+         * @param count The number of words.
+         */
+        template<typename Word>
+        inline void CopyConvertingByteOrder(const char* from, char* to, size_t count)
+        {
+          for (size_t i = 0; i < count; ++i)
+          {
+            Word word;
+            std::memcpy(&word, from + i * sizeof(Word), sizeof(Word));
+            word = ConvertByteOrder(word);
+            std::memcpy(to + i * sizeof(Word), &word, sizeof(Word));
+          }
+        }
+
+      } // namespace xdr
+    } // namespace writers
+  }
+}
+
+#endif // HEMELB_IO_WRITERS_XDR_XDRBYTEORDER_H
@@ -12,6 +12,7 @@
  */
 
 #include "io/writers/xdr/XdrMemReader.h"
+#include "io/writers/xdr/XdrByteOrder.h"
 
 namespace hemelb
 {
@@ -22,11 +23,50 @@ namespace hemelb
       namespace xdr
       {
         // Constructor to create an Xdr object based on a memory buffer
-        XdrMemReader::XdrMemReader(char* dataBuffer, unsigned int dataLength)
+        XdrMemReader::XdrMemReader(char* dataBuffer, unsigned int dataLength) :
+            buffer(dataBuffer), bufferLength(dataLength)
         {
           xdrmem_create(&mXdr, dataBuffer, dataLength, XDR_DECODE);
         }
 
+        bool XdrMemReader::readInts(int32_t* values, size_t count)
+        {
+          return readWords<uint32_t>(values, count);
+        }
+
+        bool XdrMemReader::readUnsignedInts(uint32_t* values, size_t count)
+        {
+          return readWords<uint32_t>(values, count);
+        }
+
+        bool XdrMemReader::readUnsignedLongs(uint64_t* values, size_t count)
+        {
+          return readWords<uint64_t>(values, count);
+        }
+
+        bool XdrMemReader::readFloats(float* values, size_t count)
+        {
+          return readWords<uint32_t>(values, count);
+        }
+
+        bool XdrMemReader::readDoubles(double* values, size_t count)
+        {
+          return readWords<uint64_t>(values, count);
+        }
+
+        // Read the values' bytes straight from the buffer, then move the XDR stream on past them.
+        template<typename Word>
+        bool XdrMemReader::readWords(void* values, size_t count)
+        {
+          const unsigned int position = GetPosition();
+          if (count > (bufferLength - position) / sizeof(Word))
+          {
+            return false;
+          }
+          CopyConvertingByteOrder<Word>(buffer + position, static_cast<char*>(values), count);
+          return SetPosition(position + count * sizeof(Word));
+        }
+
       } // namespace xdr
     } // namespace writers
   }
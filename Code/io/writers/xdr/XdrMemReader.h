@@ -25,6 +25,21 @@ namespace hemelb
           public:
             XdrMemReader(char* dataBuffer, unsigned int dataLength);
 
+            // Methods to read whole arrays from the current position, converting them from XDR
+            // in one pass rather than value by value. Each returns false, and reads nothing, if
+            // the buffer holds too few values.
+            bool readInts(int32_t* values, size_t count);
+            bool readUnsignedInts(uint32_t* values, size_t count);
+            bool readUnsignedLongs(uint64_t* values, size_t count);
+            bool readFloats(float* values, size_t count);
+            bool readDoubles(double* values, size_t count);
+
+          private:
+            template<typename Word>
+            bool readWords(void* values, size_t count);
+
+            const char* const buffer;
+            const unsigned int bufferLength;
         };
       } // namespace xdr
     } // namespace writers
@@ -5,6 +5,7 @@
 // license in the file LICENSE.
 
 #include "io/writers/xdr/XdrMemWriter.h"
+#include "io/writers/xdr/XdrByteOrder.h"
 
 namespace hemelb
 {
@@ -16,7 +17,8 @@ namespace hemelb
       {
 
         // Constructor for a Xdr writer held in a memory buffer.
-        XdrMemWriter::XdrMemWriter(char* dataBuffer, unsigned int dataLength)
+        XdrMemWriter::XdrMemWriter(char* dataBuffer, unsigned int dataLength) :
+            buffer(dataBuffer), bufferLength(dataLength)
         {
           xdrmem_create(&mXdr, dataBuffer, dataLength, XDR_ENCODE);
         }
@@ -27,6 +29,44 @@ namespace hemelb
           xdr_destroy(&mXdr);
         }
 
+        bool XdrMemWriter::writeInts(const int32_t* values, size_t count)
+        {
+          return writeWords<uint32_t>(values, count);
+        }
+
+        bool XdrMemWriter::writeUnsignedInts(const uint32_t* values, size_t count)
+        {
+          return writeWords<uint32_t>(values, count);
+        }
+
+        bool XdrMemWriter::writeUnsignedLongs(const uint64_t* values, size_t count)
+        {
+          return writeWords<uint64_t>(values, count);
+        }
+
+        bool XdrMemWriter::writeFloats(const float* values, size_t count)
+        {
+          return writeWords<uint32_t>(values, count);
+        }
+
+        bool XdrMemWriter::writeDoubles(const double* values, size_t count)
+        {
+          return writeWords<uint64_t>(values, count);
+        }
+
+        // Write the values' bytes straight into the buffer, then move the XDR stream on past them.
+        template<typename Word>
+        bool XdrMemWriter::writeWords(const void* values, size_t count)
+        {
+          const unsigned int position = getCurrentStreamPosition();
+          if (count > (bufferLength - position) / sizeof(Word))
+          {
+            return false;
+          }
+          CopyConvertingByteOrder<Word>(static_cast<const char*>(values), buffer + position, count);
+          return xdr_setpos(&mXdr, position + count * sizeof(Word));
+        }
+
       } // namespace xdr
     } // namespace writers
   }
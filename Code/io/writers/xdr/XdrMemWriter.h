@@ -7,6 +7,8 @@
 #ifndef HEMELB_IO_WRITERS_XDR_XDRMEMWRITER_H
 #define HEMELB_IO_WRITERS_XDR_XDRMEMWRITER_H
 
+#include <cstddef>
+
 #include "io/writers/xdr/XdrWriter.h"
 
 namespace hemelb
@@ -27,6 +29,22 @@ namespace hemelb
             // Constructor and destructor for the in-memory Xdr writer.
             XdrMemWriter(char* dataBuffer, unsigned int dataLength);
             ~XdrMemWriter();
+
+            // Methods to write whole arrays at the current position, converting them to XDR in
+            // one pass rather than value by value through operator<<. Each returns false, and
+            // writes nothing, if the array won't fit in the buffer.
+            bool writeInts(const int32_t* values, size_t count);
+            bool writeUnsignedInts(const uint32_t* values, size_t count);
+            bool writeUnsignedLongs(const uint64_t* values, size_t count);
+            bool writeFloats(const float* values, size_t count);
+            bool writeDoubles(const double* values, size_t count);
+
+          private:
+            template<typename Word>
+            bool writeWords(const void* values, size_t count);
+
+            char* const buffer;
+            const unsigned int bufferLength;
         };
 
       } // namespace xdr
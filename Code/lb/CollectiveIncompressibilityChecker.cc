@@ -0,0 +1,119 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cassert>
+#include <cfloat>
+#include "lb/CollectiveIncompressibilityChecker.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    CollectiveIncompressibilityChecker::CollectiveIncompressibilityChecker(const geometry::LatticeData * latticeData,
+                                                                           net::Net* net,
+                                                                           SimulationState* simState,
+                                                                           lb::MacroscopicPropertyCache& propertyCache,
+                                                                           reporting::Timers& timings,
+                                                                           distribn_t maximumRelativeDensityDifferenceAllowed) :
+        net::CollectiveAction(net->GetCommunicator()), mLatDat(latticeData), propertyCache(&propertyCache),
+            timings(timings), maximumRelativeDensityDifferenceAllowed(maximumRelativeDensityDifferenceAllowed),
+            densitiesAvailable(false)
+    {
+      localValues[NEGATED_MIN_DENSITY] = -DBL_MAX;
+      localValues[MAX_DENSITY] = -DBL_MAX;
+      localValues[MAX_VELOCITY_MAGNITUDE] = 0.0;
+    }
+
+    void CollectiveIncompressibilityChecker::Rebind(const geometry::LatticeData * latticeData,
+                                                    lb::MacroscopicPropertyCache& propertyCache)
+    {
+      mLatDat = latticeData;
+      this->propertyCache = &propertyCache;
+    }
+
+    void CollectiveIncompressibilityChecker::StartCollective()
+    {
+      timings[hemelb::reporting::Timers::monitoring].Start();
+
+      for (site_t i = 0; i < mLatDat->GetLocalFluidSiteCount(); i++)
+      {
+        const distribn_t density = propertyCache->densityCache.Get(i);
+        const distribn_t velocityMagnitude = propertyCache->velocityCache.Get(i).GetMagnitude();
+        if (-density > localValues[NEGATED_MIN_DENSITY])
+        {
+          localValues[NEGATED_MIN_DENSITY] = -density;
+        }
+        if (density > localValues[MAX_DENSITY])
+        {
+          localValues[MAX_DENSITY] = density;
+        }
+        if (velocityMagnitude > localValues[MAX_VELOCITY_MAGNITUDE])
+        {
+          localValues[MAX_VELOCITY_MAGNITUDE] = velocityMagnitude;
+        }
+      }
+
+      timings[hemelb::reporting::Timers::monitoring].Stop();
+
+      StartAllReduce(localValues, globalValues, VALUE_COUNT, MPI_MAX);
+    }
+
+    void CollectiveIncompressibilityChecker::CollectiveComplete()
+    {
+      densitiesAvailable = true;
+    }
+
+    distribn_t CollectiveIncompressibilityChecker::GetGlobalSmallestDensity() const
+    {
+      assert(AreDensitiesAvailable());
+      return -globalValues[NEGATED_MIN_DENSITY];
+    }
+
+    distribn_t CollectiveIncompressibilityChecker::GetGlobalLargestDensity() const
+    {
+      assert(AreDensitiesAvailable());
+      return globalValues[MAX_DENSITY];
+    }
+
+    double CollectiveIncompressibilityChecker::GetMaxRelativeDensityDifference() const
+    {
+      distribn_t maxDensityDiff = GetGlobalLargestDensity() - GetGlobalSmallestDensity();
+      assert(maxDensityDiff >= 0.0);
+      return maxDensityDiff / REFERENCE_DENSITY;
+    }
+
+    double CollectiveIncompressibilityChecker::GetMaxRelativeDensityDifferenceAllowed() const
+    {
+      return maximumRelativeDensityDifferenceAllowed;
+    }
+
+    bool CollectiveIncompressibilityChecker::AreDensitiesAvailable() const
+    {
+      return densitiesAvailable;
+    }
+
+    bool CollectiveIncompressibilityChecker::IsDensityDiffWithinRange() const
+    {
+      return (GetMaxRelativeDensityDifference() < maximumRelativeDensityDifferenceAllowed);
+    }
+
+    void CollectiveIncompressibilityChecker::Report(reporting::Dict& dictionary)
+    {
+      if (AreDensitiesAvailable() && !IsDensityDiffWithinRange())
+      {
+        reporting::Dict incomp = dictionary.AddSectionDictionary("DENSITIES");
+        incomp.SetFormattedValue("ALLOWED", "%.1f%%", GetMaxRelativeDensityDifferenceAllowed() * 100);
+        incomp.SetFormattedValue("ACTUAL", "%.1f%%", GetMaxRelativeDensityDifference() * 100);
+      }
+    }
+
+    double CollectiveIncompressibilityChecker::GetGlobalLargestVelocityMagnitude() const
+    {
+      assert(AreDensitiesAvailable());
+      return globalValues[MAX_VELOCITY_MAGNITUDE];
+    }
+  }
+}
@@ -0,0 +1,147 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_COLLECTIVEINCOMPRESSIBILITYCHECKER_H
+#define HEMELB_LB_COLLECTIVEINCOMPRESSIBILITYCHECKER_H
+
+#include "geometry/LatticeData.h"
+#include "lb/IncompressibilityChecker.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "net/CollectiveAction.h"
+#include "net/net.h"
+#include "reporting/Reportable.h"
+#include "reporting/Timers.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    /**
+     * Keeps track of the smallest and largest densities, and the largest velocity magnitude, seen
+     * anywhere in the domain, as IncompressibilityChecker does, but combining the ranks' values
+     * on every time step with a non-blocking all-reduce (see net::CollectiveAction) rather than
+     * a tree. The values available are those up to the previous step.
+     */
+    class CollectiveIncompressibilityChecker : public net::CollectiveAction,
+                                               public reporting::Reportable
+    {
+      public:
+        /**
+         * Constructor
+         *
+         * @param latticeData geometry object
+         * @param net network interface object
+         * @param simState simulation state
+         * @param maximumRelativeDensityDifferenceAllowed maximum density difference allowed in the domain (relative to reference density, default 5%)
+         */
+        CollectiveIncompressibilityChecker(const geometry::LatticeData * latticeData,
+                                           net::Net* net,
+                                           SimulationState* simState,
+                                           lb::MacroscopicPropertyCache& propertyCache,
+                                           reporting::Timers& timings,
+                                           distribn_t maximumRelativeDensityDifferenceAllowed = 0.05);
+
+        /**
+         * Carry on with a new decomposition of the domain, after repartitioning, keeping the
+         * densities seen so far.
+         *
+         * @param latticeData
+         * @param propertyCache
+         */
+        void Rebind(const geometry::LatticeData * latticeData, lb::MacroscopicPropertyCache& propertyCache);
+
+        void Report(reporting::Dict& dictionary);
+
+        /**
+         * Returns smallest density in the domain as agreed by all the processes.
+         *
+         * @return smallest density
+         */
+        distribn_t GetGlobalSmallestDensity() const;
+
+        /**
+         * Returns largest density in the domain as agreed by all the processes.
+         *
+         * @return largest density
+         */
+        distribn_t GetGlobalLargestDensity() const;
+
+        /**
+         * Return current maximum density difference across the domain (relative to domain reference density).
+         *
+         * @return current maximum density difference across the domain
+         */
+        double GetMaxRelativeDensityDifference() const;
+
+        /**
+         * Return allowed maximum density difference across the domain (relative to domain reference density).
+         *
+         * @return allowed maximum density difference across the domain
+         */
+        double GetMaxRelativeDensityDifferenceAllowed() const;
+
+        /**
+         * Returns whether the first reduction has finished and therefore there are density
+         * values available.
+         *
+         * @return whether there are density values available
+         */
+        bool AreDensitiesAvailable() const;
+
+        /**
+         * Checks whether the maximum density difference is smaller that the maximum allowed.
+         *
+         * @return whether the maximum density difference is smaller that the maximum allowed
+         */
+        bool IsDensityDiffWithinRange() const;
+
+        /**
+         * Return largest velocity magnitude in the domain as agreed by all the processes.
+         *
+         * @return largest velocity magnitude
+         */
+        double GetGlobalLargestVelocityMagnitude() const;
+
+      protected:
+        void StartCollective();
+        void CollectiveComplete();
+
+      private:
+        /**
+         * The values reduced over the ranks. All are maxima, so the smallest density is
+         * reduced negated.
+         */
+        enum
+        {
+          NEGATED_MIN_DENSITY = 0,
+          MAX_DENSITY,
+          MAX_VELOCITY_MAGNITUDE,
+          VALUE_COUNT
+        };
+
+        /** Pointer to lattice data object. */
+        const geometry::LatticeData * mLatDat;
+
+        /** Cache of macroscopic properties (including density). */
+        lb::MacroscopicPropertyCache* propertyCache;
+
+        /** Timing object. */
+        reporting::Timers& timings;
+
+        /** Maximum density difference allowed in the domain (relative to reference density) */
+        distribn_t maximumRelativeDensityDifferenceAllowed;
+
+        /** This rank's values, over every step so far. */
+        distribn_t localValues[VALUE_COUNT];
+
+        /** The values reduced over all ranks, once densitiesAvailable. */
+        distribn_t globalValues[VALUE_COUNT];
+        bool densitiesAvailable;
+    };
+  }
+}
+
+#endif /* HEMELB_LB_COLLECTIVEINCOMPRESSIBILITYCHECKER_H */
@@ -0,0 +1,122 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_COLLECTIVESTABILITYTESTER_H
+#define HEMELB_LB_COLLECTIVESTABILITYTESTER_H
+
+#include "net/CollectiveAction.h"
+#include "net/net.h"
+#include "lb/LocalStabilityCheck.h"
+#include "reporting/Timers.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    /**
+     * Class to assess the stability of the simulation on every time step, combining the ranks'
+     * results with a non-blocking all-reduce (see net::CollectiveAction) instead of the tree of
+     * StabilityTester. The stability set in the simulation state is that of the previous step.
+     *
+     * Each rank contributes whether any of its sites is unstable and whether any is unconverged;
+     * the maximum of each over all ranks tells whether the whole simulation is. Ranks without
+     * fluid sites have nothing unconverged, so don't hold up convergence.
+     */
+    template<class LatticeType>
+    class CollectiveStabilityTester : public net::CollectiveAction
+    {
+      public:
+        CollectiveStabilityTester(const geometry::LatticeData * iLatDat, net::Net* net,
+                                  SimulationState* simState, lb::MacroscopicPropertyCache& propertyCache,
+                                  reporting::Timers& timings,
+                                  const hemelb::configuration::SimConfig::MonitoringConfig* testerConfig) :
+            net::CollectiveAction(net->GetCommunicator()), mSimState(simState),
+                localCheck(iLatDat, propertyCache, testerConfig), timings(timings)
+        {
+          Reset();
+        }
+
+        /**
+         * Forget any stability worked out so far.
+         */
+        void Reset()
+        {
+          AbandonCollective();
+          mSimState->SetStability(UndefinedStability);
+        }
+
+        /**
+         * Carry on with a new decomposition of the domain, after repartitioning, keeping the
+         * stability worked out so far.
+         *
+         * @param iLatDat
+         * @param propertyCache
+         */
+        void Rebind(const geometry::LatticeData * iLatDat, lb::MacroscopicPropertyCache& propertyCache)
+        {
+          localCheck.Rebind(iLatDat, propertyCache);
+        }
+
+      protected:
+        void StartCollective()
+        {
+          timings[hemelb::reporting::Timers::monitoring].Start();
+
+          const Stability localStability = localCheck.Assess();
+          localFlags[UNSTABLE] = localStability == Unstable ?
+            1 :
+            0;
+          localFlags[UNCONVERGED] = localStability == Stable ?
+            1 :
+            0;
+
+          timings[hemelb::reporting::Timers::monitoring].Stop();
+
+          StartAllReduce(localFlags, globalFlags, FLAG_COUNT, MPI_MAX);
+        }
+
+        void CollectiveComplete()
+        {
+          if (globalFlags[UNSTABLE])
+          {
+            mSimState->SetStability(Unstable);
+          }
+          else
+          {
+            // Only with the convergence check on can every rank report itself converged.
+            mSimState->SetStability(globalFlags[UNCONVERGED] ?
+              Stable :
+              StableAndConverged);
+          }
+        }
+
+      private:
+        /** The flags reduced over the ranks. */
+        enum
+        {
+          UNSTABLE = 0,
+          UNCONVERGED,
+          FLAG_COUNT
+        };
+
+        int localFlags[FLAG_COUNT];
+        int globalFlags[FLAG_COUNT];
+
+        /**
+         * Pointer to the simulation state used in the rest of the simulation.
+         */
+        lb::SimulationState* mSimState;
+
+        /** Assesses this rank's own sites. */
+        LocalStabilityCheck<LatticeType> localCheck;
+
+        /** Timing object. */
+        reporting::Timers& timings;
+    };
+  }
+}
+
+#endif /* HEMELB_LB_COLLECTIVESTABILITYTESTER_H */
@@ -134,6 +134,15 @@ namespace hemelb
          */
         virtual ~IncompressibilityChecker();
 
+        /**
+         * Carry on with a new decomposition of the domain, after repartitioning, keeping the
+         * densities seen so far.
+         *
+         * @param latticeData
+         * @param propertyCache
+         */
+        void Rebind(const geometry::LatticeData * latticeData, lb::MacroscopicPropertyCache& propertyCache);
+
         void Report(reporting::Dict& dictionary);
 
         /**
@@ -231,7 +240,7 @@ namespace hemelb
         const geometry::LatticeData * mLatDat;
 
         /** Cache of macroscopic properties (including density). */
-        lb::MacroscopicPropertyCache& propertyCache;
+        lb::MacroscopicPropertyCache* propertyCache;
 
         /** Pointer to the simulation state used in the rest of the simulation. */
         lb::SimulationState* mSimState;
@@ -103,7 +103,7 @@ namespace hemelb
                                                                         lb::MacroscopicPropertyCache& propertyCache,
                                                                         reporting::Timers& timings,
                                                                         distribn_t maximumRelativeDensityDifferenceAllowed) :
-        BroadcastPolicy(net, simState, SPREADFACTOR), mLatDat(latticeData), propertyCache(propertyCache), mSimState(simState), timings(timings), maximumRelativeDensityDifferenceAllowed(maximumRelativeDensityDifferenceAllowed), globalDensityTracker(NULL)
+        BroadcastPolicy(net, simState, SPREADFACTOR), mLatDat(latticeData), propertyCache(&propertyCache), mSimState(simState), timings(timings), maximumRelativeDensityDifferenceAllowed(maximumRelativeDensityDifferenceAllowed), globalDensityTracker(NULL)
     {
       /*
        *  childrenDensitiesSerialised must be initialised to something sensible since ReceiveFromChildren won't
@@ -138,6 +138,14 @@ namespace hemelb
     {
     }
 
+    template<class BroadcastPolicy>
+    void IncompressibilityChecker<BroadcastPolicy>::Rebind(const geometry::LatticeData * latticeData,
+                                                           lb::MacroscopicPropertyCache& propertyCache)
+    {
+      mLatDat = latticeData;
+      this->propertyCache = &propertyCache;
+    }
+
     template<class BroadcastPolicy>
     distribn_t IncompressibilityChecker<BroadcastPolicy>::GetGlobalSmallestDensity() const
     {
@@ -188,8 +196,8 @@ namespace hemelb
 
       for (site_t i = 0; i < mLatDat->GetLocalFluidSiteCount(); i++)
       {
-        upwardsDensityTracker.UpdateDensityTracker(propertyCache.densityCache.Get(i),
-                                                   propertyCache.velocityCache.Get(i).GetMagnitude());
+        upwardsDensityTracker.UpdateDensityTracker(propertyCache->densityCache.Get(i),
+                                                   propertyCache->velocityCache.Get(i).GetMagnitude());
       }
 
       timings[hemelb::reporting::Timers::monitoring].Stop();
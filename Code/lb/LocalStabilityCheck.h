@@ -0,0 +1,198 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_LOCALSTABILITYCHECK_H
+#define HEMELB_LB_LOCALSTABILITYCHECK_H
+
+#include <cmath>
+#include "configuration/SimConfig.h"
+#include "geometry/LatticeData.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "lb/SimulationState.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    /**
+     * Assesses the stability, and optionally the convergence, of this rank's sites. The testers
+     * combine the results of every rank.
+     *
+     * With HEMELB_USE_FUSED_MONITORING, the local stability and convergence are worked out by
+     * the streamers as they collide each site (see StabilityReduction), rather than by another
+     * sweep over the distributions here. That version sees the distributions a step later, but
+     * covers every step since the last check rather than just the current one.
+     */
+    template<class LatticeType>
+    class LocalStabilityCheck
+    {
+      public:
+        LocalStabilityCheck(const geometry::LatticeData * latDat,
+                            lb::MacroscopicPropertyCache& propertyCache,
+                            const hemelb::configuration::SimConfig::MonitoringConfig* testerConfig) :
+            mLatDat(latDat), propertyCache(&propertyCache), testerConfig(testerConfig)
+        {
+#if !defined(HEMELB_USE_FUSED_MONITORING) && defined(HEMELB_USE_AA_STREAMING)
+          // The stability check itself only looks at the sign of each stored value, which doesn't
+          // depend on the layout, but there is no copy of the previous step to converge against.
+          if (testerConfig->doConvergenceCheck)
+          {
+            throw Exception() << "The convergence check is not supported with AA-pattern streaming.";
+          }
+#endif
+          Rebind(latDat, propertyCache);
+        }
+
+        /**
+         * Check the sites of a new decomposition of the domain from now on, after the domain
+         * has been repartitioned.
+         *
+         * @param latDat
+         * @param propertyCache
+         */
+        void Rebind(const geometry::LatticeData * latDat, lb::MacroscopicPropertyCache& propertyCache)
+        {
+          mLatDat = latDat;
+          this->propertyCache = &propertyCache;
+#ifdef HEMELB_USE_FUSED_MONITORING
+          if (testerConfig->doConvergenceCheck)
+          {
+            if (testerConfig->convergenceVariable != extraction::OutputField::Velocity)
+            {
+              throw Exception()
+                  << "Convergence check based on requested variable currently not available";
+            }
+            propertyCache.stabilityReduction.SetConvergenceCheck(testerConfig->convergenceRelativeTolerance
+                * testerConfig->convergenceReferenceValue);
+          }
+#endif
+        }
+
+        /**
+         * Check this rank's sites.
+         *
+         * @return Unstable if any site is; otherwise StableAndConverged if the convergence check
+         * is on and every site has converged, or Stable.
+         */
+        Stability Assess()
+        {
+          bool unstableSitePresent = false;
+          bool unconvergedSitePresent = false;
+
+#ifdef HEMELB_USE_FUSED_MONITORING
+          propertyCache->stabilityReduction.Collect(unstableSitePresent, unconvergedSitePresent);
+#else
+          for (site_t i = 0; i < mLatDat->GetLocalFluidSiteCount() && !unstableSitePresent; i++)
+          {
+            distribn_t fNew[LatticeType::NUMVECTORS];
+            for (unsigned int l = 0; l < LatticeType::NUMVECTORS; l++)
+            {
+              distribn_t value = fNew[l] =
+                  *mLatDat->GetFNew(mLatDat->GetDistributionIndex<LatticeType>(i, l));
+
+              // Note that by testing for value > 0.0, we also catch stray NaNs.
+              if (! (value > 0.0))
+              {
+                unstableSitePresent = true;
+                break;
+              }
+            }
+
+            if (!unstableSitePresent && testerConfig->doConvergenceCheck)
+            {
+              distribn_t relativeDifference =
+                  ComputeRelativeDifference(fNew, mLatDat->GetSite(i).GetFOld<LatticeType>());
+
+              if (relativeDifference > testerConfig->convergenceRelativeTolerance)
+              {
+                // The simulation is stable but hasn't converged in the whole domain yet.
+                unconvergedSitePresent = true;
+              }
+            }
+          }
+#endif
+
+          if (unstableSitePresent)
+          {
+            return Unstable;
+          }
+          return (testerConfig->doConvergenceCheck && !unconvergedSitePresent) ?
+            StableAndConverged :
+            Stable;
+        }
+
+      private:
+        /**
+         * Computes the relative difference between the densities at the beginning and end of a
+         * timestep, i.e. |(rho_new - rho_old) / (rho_old - rho_0)|.
+         *
+         * @param fNew Distribution function after stream and collide, i.e. solution of the current timestep.
+         * @param fOld Distribution function at the end of the previous timestep.
+         * @return relative difference between the densities computed from fNew and fOld.
+         */
+        inline double ComputeRelativeDifference(const distribn_t* fNew,
+                                                const distribn_t* fOld) const
+        {
+          distribn_t newDensity;
+          distribn_t newMomentumX;
+          distribn_t newMomentumY;
+          distribn_t newMomentumZ;
+          LatticeType::CalculateDensityAndMomentum(fNew,
+                                                   newDensity,
+                                                   newMomentumX,
+                                                   newMomentumY,
+                                                   newMomentumZ);
+
+          distribn_t oldDensity;
+          distribn_t oldMomentumX;
+          distribn_t oldMomentumY;
+          distribn_t oldMomentumZ;
+          LatticeType::CalculateDensityAndMomentum(fOld,
+                                                   oldDensity,
+                                                   oldMomentumX,
+                                                   oldMomentumY,
+                                                   oldMomentumZ);
+
+          distribn_t absoluteError;
+          distribn_t referenceValue;
+
+          switch (testerConfig->convergenceVariable)
+          {
+            case extraction::OutputField::Velocity:
+            {
+              distribn_t diff_vel_x = newMomentumX / newDensity - oldMomentumX / oldDensity;
+              distribn_t diff_vel_y = newMomentumY / newDensity - oldMomentumY / oldDensity;
+              distribn_t diff_vel_z = newMomentumZ / newDensity - oldMomentumZ / oldDensity;
+
+              absoluteError = sqrt(diff_vel_x * diff_vel_x + diff_vel_y * diff_vel_y
+                  + diff_vel_z * diff_vel_z);
+              referenceValue = testerConfig->convergenceReferenceValue;
+              break;
+            }
+            default:
+              // Never reached
+              throw Exception()
+                  << "Convergence check based on requested variable currently not available";
+          }
+
+          return absoluteError / referenceValue;
+        }
+
+        const geometry::LatticeData * mLatDat;
+
+        /**
+         * The property cache, whose stability reduction is filled in by the streamers with
+         * HEMELB_USE_FUSED_MONITORING.
+         */
+        lb::MacroscopicPropertyCache* propertyCache;
+
+        /** Object containing the user-provided configuration for this class */
+        const hemelb::configuration::SimConfig::MonitoringConfig* testerConfig;
+    };
+  }
+}
+
+#endif /* HEMELB_LB_LOCALSTABILITYCHECK_H */
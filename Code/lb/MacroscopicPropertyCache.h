@@ -10,6 +10,7 @@
 #include <vector>
 #include "geometry/LatticeData.h"
 #include "lb/SimulationState.h"
+#include "lb/StabilityReduction.h"
 #include "units.h"
 #include "util/RefreshableCache.hpp"
 
@@ -83,6 +84,12 @@ namespace hemelb
          */
         util::RefreshableCache<util::Vector3D<LatticeStress> > tangentialProjectionTractionCache;
 
+        /**
+         * The stability and convergence of the sites collided since the StabilityTester last
+         * looked. Only filled in with HEMELB_USE_FUSED_MONITORING.
+         */
+        StabilityReduction stabilityReduction;
+
       private:
         /**
          * The state of the simulation, including the number of timesteps passed.
@@ -0,0 +1,80 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <limits>
+#include "Exception.h"
+#include "lb/StabilityReduction.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    StabilityReduction::StabilityReduction(site_t siteCount) :
+        threadResults(util::threading::GetMaxThreadCount()), siteCount(siteCount),
+            checkConvergence(false), toleranceSquared(0.0)
+    {
+      bool unstable, unconverged;
+      Collect(unstable, unconverged);
+    }
+
+    void StabilityReduction::SetConvergenceCheck(distribn_t velocityTolerance)
+    {
+      checkConvergence = true;
+      toleranceSquared = velocityTolerance * velocityTolerance;
+      previousVelocities.assign(siteCount,
+                                util::Vector3D<distribn_t>(std::numeric_limits<distribn_t>::quiet_NaN()));
+    }
+
+    void StabilityReduction::Collect(bool& unstable, bool& unconverged)
+    {
+      unstable = false;
+      unconverged = false;
+      for (std::vector<ThreadResult>::iterator result = threadResults.begin(); result != threadResults.end();
+          ++result)
+      {
+        unstable |= result->unstable;
+        unconverged |= result->unconverged;
+        result->unstable = false;
+        result->unconverged = false;
+      }
+    }
+
+    void StabilityReduction::AddResults(bool unstable, bool unconverged)
+    {
+      threadResults[0].unstable |= unstable;
+      threadResults[0].unconverged |= unconverged;
+    }
+
+    void StabilityReduction::GetPreviousVelocities(std::vector<distribn_t>& velocities) const
+    {
+      velocities.resize(3 * previousVelocities.size());
+      for (size_t site = 0; site < previousVelocities.size(); ++site)
+      {
+        velocities[3 * site] = previousVelocities[site].x;
+        velocities[3 * site + 1] = previousVelocities[site].y;
+        velocities[3 * site + 2] = previousVelocities[site].z;
+      }
+    }
+
+    void StabilityReduction::SetPreviousVelocities(const std::vector<distribn_t>& velocities)
+    {
+      if (!checkConvergence)
+      {
+        return;
+      }
+      if (velocities.size() != 3 * previousVelocities.size())
+      {
+        throw Exception() << "Got " << velocities.size() / 3 << " previous velocities for "
+            << previousVelocities.size() << " sites";
+      }
+      for (size_t site = 0; site < previousVelocities.size(); ++site)
+      {
+        previousVelocities[site] = util::Vector3D<distribn_t>(velocities[3 * site],
+                                                              velocities[3 * site + 1],
+                                                              velocities[3 * site + 2]);
+      }
+    }
+  }
+}
@@ -0,0 +1,140 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_STABILITYREDUCTION_H
+#define HEMELB_LB_STABILITYREDUCTION_H
+
+#include <vector>
+#include "units.h"
+#include "util/Threading.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    /**
+     * Stability and convergence checks made by the streamers as they collide each site
+     * (HEMELB_USE_FUSED_MONITORING), so that the StabilityTester doesn't have to sweep the
+     * distributions again.
+     *
+     * The streamers add each site's pre-collision distributions, which are those left by the
+     * previous time step, so the result lags the sweep over fNew by one step. A site is unstable
+     * if any of its distributions isn't positive (or is NaN). If the convergence check is on,
+     * the velocity of each site is kept between steps and a site is unconverged if it changed
+     * by more than the tolerance; the first step a site is added, it is always unconverged.
+     *
+     * Results are ORed together over every step since the last Collect. Each thread of the
+     * collision loop has its own accumulator, on its own cache line.
+     */
+    class StabilityReduction
+    {
+      public:
+        /**
+         * @param siteCount The number of local fluid sites.
+         */
+        StabilityReduction(site_t siteCount);
+
+        /**
+         * Also check whether the velocity of every site has converged.
+         *
+         * @param velocityTolerance The largest change in a site's velocity between consecutive
+         * steps, in lattice units, for it to count as converged.
+         */
+        void SetConvergenceCheck(distribn_t velocityTolerance);
+
+        /**
+         * Add the distributions of a site, and the moments calculated from them, to the calling
+         * thread's accumulator. Sites may be added from several threads of the same parallel
+         * region at once.
+         *
+         * @param siteIndex
+         * @param f
+         * @param density
+         * @param momentum
+         */
+        template<class LatticeType>
+        inline void AddSite(site_t siteIndex, const distribn_t* f, distribn_t density,
+                            const util::Vector3D<distribn_t>& momentum)
+        {
+          ThreadResult& result = threadResults[util::threading::GetThreadNumber()];
+
+          // Note that by testing for value > 0.0, we also catch stray NaNs. This is a reduction
+          // without early exit, so that the compiler can vectorise it.
+          bool positive = true;
+          for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+          {
+            positive &= (f[direction] > 0.0);
+          }
+          result.unstable |= !positive;
+
+          if (checkConvergence)
+          {
+            const util::Vector3D<distribn_t> velocity = momentum / density;
+            util::Vector3D<distribn_t>& previousVelocity = previousVelocities[siteIndex];
+            const distribn_t changeSquared = (velocity - previousVelocity).GetMagnitudeSquared();
+            // Also true for the NaN that the previous velocities start with.
+            result.unconverged |= ! (changeSquared <= toleranceSquared);
+            previousVelocity = velocity;
+          }
+        }
+
+        /**
+         * Combine the results of all threads since the last call, and start accumulating
+         * again.
+         *
+         * @param unstable Whether any site added was unstable.
+         * @param unconverged Whether any site added was unconverged. Always false if the
+         * convergence check isn't on.
+         */
+        void Collect(bool& unstable, bool& unconverged);
+
+        /**
+         * Add results collected elsewhere to those of the next Collect, e.g. those a previous
+         * decomposition of the domain hadn't collected yet.
+         *
+         * @param unstable
+         * @param unconverged
+         */
+        void AddResults(bool unstable, bool unconverged);
+
+        /**
+         * Get the velocity each site had when it was last added, three components per site, so
+         * they can be carried over to a new decomposition of the domain. Empty if the
+         * convergence check isn't on.
+         *
+         * @param velocities
+         */
+        void GetPreviousVelocities(std::vector<distribn_t>& velocities) const;
+
+        /**
+         * Set the velocity each site had when it was last added, as from
+         * GetPreviousVelocities. Does nothing if the convergence check isn't on.
+         *
+         * @param velocities
+         */
+        void SetPreviousVelocities(const std::vector<distribn_t>& velocities);
+
+      private:
+        /**
+         * The results of one thread, padded to a cache line so that threads don't share lines.
+         */
+        struct ThreadResult
+        {
+            bool unstable;
+            bool unconverged;
+            char padding[64 - 2 * sizeof(bool)];
+        };
+
+        std::vector<ThreadResult> threadResults;
+        site_t siteCount;
+        bool checkConvergence;
+        distribn_t toleranceSquared;
+        //! The velocity of each site when it was last added.
+        std::vector<util::Vector3D<distribn_t> > previousVelocities;
+    };
+  }
+}
+
+#endif /* HEMELB_LB_STABILITYREDUCTION_H */
@@ -9,6 +9,8 @@
 
 #include "net/PhasedBroadcastRegular.h"
 #include "geometry/LatticeData.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "lb/LocalStabilityCheck.h"
 
 namespace hemelb
 {
@@ -24,17 +26,19 @@ namespace hemelb
      * at the same time on all nodes), only one communication is needed between depths, which
      * can't overlap. We go down the tree to pass the overall stability to all nodes, and we go up
      * the tree to compose the local stability for all nodes to discover whether the simulation as
-     * a whole is stable.
+     * a whole is stable. Each node's own sites are assessed by a LocalStabilityCheck.
      */
     template<class LatticeType>
     class StabilityTester : public net::PhasedBroadcastRegular<>
     {
       public:
         StabilityTester(const geometry::LatticeData * iLatDat, net::Net* net,
-                        SimulationState* simState, reporting::Timers& timings,
+                        SimulationState* simState, lb::MacroscopicPropertyCache& propertyCache,
+                        reporting::Timers& timings,
                         const hemelb::configuration::SimConfig::MonitoringConfig* testerConfig) :
-            net::PhasedBroadcastRegular<>(net, simState, SPREADFACTOR), mLatDat(iLatDat),
-                mSimState(simState), timings(timings), testerConfig(testerConfig)
+            net::PhasedBroadcastRegular<>(net, simState, SPREADFACTOR),
+                mSimState(simState), localCheck(iLatDat, propertyCache, testerConfig),
+                timings(timings), testerConfig(testerConfig)
         {
           Reset();
         }
@@ -55,6 +59,18 @@ namespace hemelb
           }
         }
 
+        /**
+         * Carry on with a new decomposition of the domain, after repartitioning, keeping the
+         * stability worked out so far.
+         *
+         * @param iLatDat
+         * @param propertyCache
+         */
+        void Rebind(const geometry::LatticeData * iLatDat, lb::MacroscopicPropertyCache& propertyCache)
+        {
+          localCheck.Rebind(iLatDat, propertyCache);
+        }
+
       protected:
         /**
          * Override the methods from the base class to propagate data from the root, and
@@ -95,114 +111,12 @@ namespace hemelb
           // sending up a 'Unstable' value anyway.
           if (mUpwardsStability != Unstable)
           {
-            bool unconvergedSitePresent = false;
-
-            for (site_t i = 0; i < mLatDat->GetLocalFluidSiteCount(); i++)
-            {
-              for (unsigned int l = 0; l < LatticeType::NUMVECTORS; l++)
-              {
-                distribn_t value = *mLatDat->GetFNew(i * LatticeType::NUMVECTORS + l);
-
-                // Note that by testing for value > 0.0, we also catch stray NaNs.
-                if (! (value > 0.0))
-                {
-                  mUpwardsStability = Unstable;
-                  break;
-                }
-              }
-              ///@todo: If we refactor the previous loop out, we can get away with a single break statement
-              if (mUpwardsStability == Unstable)
-              {
-                break;
-              }
-
-              if (testerConfig->doConvergenceCheck)
-              {
-                distribn_t relativeDifference =
-                    ComputeRelativeDifference(mLatDat->GetFNew(i * LatticeType::NUMVECTORS),
-                                              mLatDat->GetSite(i).GetFOld<LatticeType>());
-
-                if (relativeDifference > testerConfig->convergenceRelativeTolerance)
-                {
-                  // The simulation is stable but hasn't converged in the whole domain yet.
-                  unconvergedSitePresent = true;
-                }
-              }
-            }
-
-            switch (mUpwardsStability)
-            {
-              case UndefinedStability:
-              case Stable:
-              case StableAndConverged:
-                mUpwardsStability = (testerConfig->doConvergenceCheck && !unconvergedSitePresent) ?
-                  StableAndConverged :
-                  Stable;
-                break;
-              case Unstable:
-                break;
-            }
+            mUpwardsStability = localCheck.Assess();
           }
 
           timings[hemelb::reporting::Timers::monitoring].Stop();
         }
 
-        /**
-         * Computes the relative difference between the densities at the beginning and end of a
-         * timestep, i.e. |(rho_new - rho_old) / (rho_old - rho_0)|.
-         *
-         * @param fNew Distribution function after stream and collide, i.e. solution of the current timestep.
-         * @param fOld Distribution function at the end of the previous timestep.
-         * @return relative difference between the densities computed from fNew and fOld.
-         */
-        inline double ComputeRelativeDifference(const distribn_t* fNew,
-                                                const distribn_t* fOld) const
-        {
-          distribn_t newDensity;
-          distribn_t newMomentumX;
-          distribn_t newMomentumY;
-          distribn_t newMomentumZ;
-          LatticeType::CalculateDensityAndMomentum(fNew,
-                                                   newDensity,
-                                                   newMomentumX,
-                                                   newMomentumY,
-                                                   newMomentumZ);
-
-          distribn_t oldDensity;
-          distribn_t oldMomentumX;
-          distribn_t oldMomentumY;
-          distribn_t oldMomentumZ;
-          LatticeType::CalculateDensityAndMomentum(fOld,
-                                                   oldDensity,
-                                                   oldMomentumX,
-                                                   oldMomentumY,
-                                                   oldMomentumZ);
-
-          distribn_t absoluteError;
-          distribn_t referenceValue;
-
-          switch (testerConfig->convergenceVariable)
-          {
-            case extraction::OutputField::Velocity:
-            {
-              distribn_t diff_vel_x = newMomentumX / newDensity - oldMomentumX / oldDensity;
-              distribn_t diff_vel_y = newMomentumY / newDensity - oldMomentumY / oldDensity;
-              distribn_t diff_vel_z = newMomentumZ / newDensity - oldMomentumZ / oldDensity;
-
-              absoluteError = sqrt(diff_vel_x * diff_vel_x + diff_vel_y * diff_vel_y
-                  + diff_vel_z * diff_vel_z);
-              referenceValue = testerConfig->convergenceReferenceValue;
-              break;
-            }
-            default:
-              // Never reached
-              throw Exception()
-                  << "Convergence check based on requested variable currently not available";
-          }
-
-          return absoluteError / referenceValue;
-        }
-
         /**
          * Take the combined stability information (an int, with a value of hemelb::lb::Unstable
          * if any child node is unstable) and start passing it back down the tree.
@@ -283,8 +197,6 @@ namespace hemelb
          */
         static const unsigned int SPREADFACTOR = 10;
 
-        const geometry::LatticeData * mLatDat;
-
         /**
          * Stability value of this node and its children to propagate upwards.
          */
@@ -302,6 +214,9 @@ namespace hemelb
          */
         lb::SimulationState* mSimState;
 
+        /** Assesses this node's own sites. */
+        LocalStabilityCheck<LatticeType> localCheck;
+
         /** Timing object. */
         reporting::Timers& timings;
 
@@ -30,6 +30,9 @@ namespace hemelb
        *  - DoCalculatePreCollision(CHydroVars&, site_t)
        *  - DoCollide(const LbmParameters*, unsigned int, CHydroVars&) returns distribn_t
        *  - DoReset(InitParams*)
+       *
+       * Collisions that can work on a batch of sites at once (see kernels::HydroVarsBatch) set
+       * SupportsBatches to true and implement CalculatePreCollisionBatch and CollideBatch.
        */
       template<typename CollisionImpl, typename KernelImpl>
       class BaseCollision
@@ -37,6 +40,8 @@ namespace hemelb
         public:
           typedef KernelImpl CKernel;
 
+          static const bool SupportsBatches = false;
+
           inline void CalculatePreCollision(kernels::HydroVars<KernelImpl>& hydroVars,
                                             const geometry::Site<geometry::LatticeData>& site)
           {
@@ -25,6 +25,9 @@ namespace hemelb
         public:
           typedef KernelType CKernel;
 
+          //! Batches are supported whenever the kernel supports them.
+          static const bool SupportsBatches = KernelType::SupportsBatches;
+
           Normal(kernels::InitParams& initParams) :
               kernel(initParams)
           {
@@ -42,6 +45,16 @@ namespace hemelb
             kernel.Collide(lbmParams, iHydroVars);
           }
 
+          inline void CalculatePreCollisionBatch(typename KernelType::KHydroVarsBatch& batch)
+          {
+            kernel.CalculateDensityMomentumFeqBatch(batch);
+          }
+
+          inline void CollideBatch(const LbmParameters* lbmParams, typename KernelType::KHydroVarsBatch& batch)
+          {
+            kernel.CollideBatch(lbmParams, batch);
+          }
+
 
           KernelType kernel;
 
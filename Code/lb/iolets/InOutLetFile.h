@@ -8,6 +8,7 @@
 #define HEMELB_LB_IOLETS_INOUTLETFILE_H
 
 #include "lb/iolets/InOutLet.h"
+#include "lb/iolets/PeriodicWaveform.h"
 
 namespace hemelb
 {
@@ -33,7 +34,7 @@ namespace hemelb
           virtual InOutLet* Clone() const;
           virtual void Reset(SimulationState &state)
           {
-            CalculateTable(state.GetTotalTimeSteps(), state.GetTimeStepLength());
+            ReadWaveform(state.GetTimeStepLength());
           }
 
           const std::string& GetFilePath()
@@ -55,12 +56,12 @@ namespace hemelb
           }
           LatticeDensity GetDensity(LatticeTimeStep timeStep) const
           {
-            return densityTable[timeStep];
+            return densityWaveform.Evaluate(timeStep);
           }
           virtual void Initialise(const util::UnitConverter* unitConverter);
         private:
-          void CalculateTable(LatticeTimeStep totalTimeSteps, PhysicalTime timeStepLength);
-          std::vector<LatticeDensity> densityTable;
+          void ReadWaveform(PhysicalTime timeStepLength);
+          PeriodicWaveform densityWaveform; //! One period of the density, in lattice units.
           LatticeDensity densityMin;
           LatticeDensity densityMax;
           std::string pressureFilePath;
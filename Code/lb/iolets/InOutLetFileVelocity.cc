@@ -31,86 +31,26 @@ namespace hemelb
         return copy;
       }
 
-      void InOutLetFileVelocity::CalculateTable(LatticeTimeStep totalTimeSteps, PhysicalTime timeStepLength)
+      void InOutLetFileVelocity::ReadWaveform(PhysicalTime timeStepLength)
       {
-        // First read in values from file
-        // Used to be complex code here to keep a vector unique, but this is just achieved by using a map.
-        std::map<PhysicalTime, PhysicalSpeed> timeValuePairs;
+        // The waveform repeats for as long as the simulation runs.
+        velocityWaveform.Read(velocityFilePath, timeStepLength);
 
-        double timeTemp, valueTemp;
-
-        util::check_file(velocityFilePath.c_str());
-        std::ifstream datafile(velocityFilePath.c_str());
-        log::Logger::Log<log::Debug, log::OnePerCore>("Reading iolet values from file:");
-        while (datafile.good())
-        {
-          datafile >> timeTemp >> valueTemp;
-          log::Logger::Log<log::Trace, log::OnePerCore>("Time: %f Value: %f", timeTemp, valueTemp);
-          timeValuePairs[timeTemp] = valueTemp;
-        }
-
-        datafile.close();
-        // the default iterator for maps traverses in key order, so no sort is needed.
-
-        std::vector<PhysicalTime> times(0);
-        std::vector<PhysicalSpeed> values(0);
-
-        // Must convert into vectors since LinearInterpolate works on a pair of vectors
-        // Determine min and max pressure on the way
-//        PhysicalPressure pMin = timeValuePairs.begin()->second;
-//        PhysicalPressure pMax = timeValuePairs.begin()->second;
-        for (std::map<PhysicalTime, PhysicalSpeed>::iterator entry = timeValuePairs.begin();
-            entry != timeValuePairs.end(); entry++)
-        {
-
-          /* If the time value in the input file stretches BEYOND the end of the simulation, then insert an interpolated end value and exit the loop. */
-          if(entry->first > totalTimeSteps*timeStepLength) {
-  
-            PhysicalTime time_diff = totalTimeSteps*timeStepLength - times.back();
-
-            PhysicalTime time_diff_ratio = time_diff / (entry->first - times.back());
-            PhysicalSpeed vel_diff = entry->second - values.back();
-
-            PhysicalSpeed final_velocity = values.back() + time_diff_ratio * vel_diff;
-
-            times.push_back(totalTimeSteps*timeStepLength);
-            values.push_back(final_velocity);
-            break;
-          }
-
-          times.push_back(entry->first);
-          values.push_back(entry->second);
-        }
-//        densityMin = units->ConvertPressureToLatticeUnits(pMin) / Cs2;
-//        densityMax = units->ConvertPressureToLatticeUnits(pMax) / Cs2;
-
-        /* If the time values in the input file end BEFORE the planned end of the simulation, then loop the profile afterwards (using %TimeStepsInInletVelocityProfile). */
-        int TimeStepsInInletVelocityProfile = times.back() / timeStepLength;
-
-        // Check if last point's value matches the first
-        if (values.back() != values.front())
-          throw Exception() << "Last point's value does not match the first point's value in "
-              << velocityFilePath;
-
-        // extend the table to one past the total time steps, so that the table is valid in the end-state, where the zero indexed time step is equal to the limit.
-        velocityTable.resize(totalTimeSteps + 1);
-        // Now convert these vectors into arrays using linear interpolation
-        for (unsigned int timeStep = 0; timeStep <= totalTimeSteps; timeStep++)
+        std::vector<double>& values = velocityWaveform.GetValues();
+        for (std::vector<double>::iterator value = values.begin(); value != values.end(); ++value)
         {
-          // The "% TimeStepsInInletVelocityProfile" here is to prevent profile stretching (it will loop instead).
-          double point = times.front()
-              + (static_cast<double>(timeStep % TimeStepsInInletVelocityProfile) / static_cast<double>(totalTimeSteps))
-                  * (times.back() - times.front());
-
-          PhysicalSpeed vel = util::NumericalFunctions::LinearInterpolate(times, values, point);
-
-          velocityTable[timeStep] = units->ConvertVelocityToLatticeUnits(vel);
+          *value = units->ConvertVelocityToLatticeUnits(*value);
         }
-
       }
 
       LatticeVelocity InOutLetFileVelocity::GetVelocity(const LatticePosition& x,
                                                         const LatticeTimeStep t) const
+      {
+        // Brackets to ensure that the scalar multiplies are done before vector * scalar.
+        return normal * (GetProfileSpeed(t) * GetProfileWeight(x));
+      }
+
+      Dimensionless InOutLetFileVelocity::GetProfileWeight(const LatticePosition& x) const
       {
 
         if (!useWeightsFromFile)
@@ -122,11 +62,7 @@ namespace hemelb
           Dimensionless rSqOverASq = (displ.GetMagnitudeSquared() - z * z) / (radius * radius);
           assert(rSqOverASq <= 1.0);
 
-          // Get the max velocity
-          LatticeSpeed max = velocityTable[t];
-
-          // Brackets to ensure that the scalar multiplies are done before vector * scalar.
-          return normal * (max * (1. - rSqOverASq));
+          return 1. - rSqOverASq;
         }
         else
         {
@@ -197,19 +133,14 @@ namespace hemelb
             xyz_residual[2] = -(std::ceil(x.z) - x.z);
           }
 
-          LatticeVelocity v_tot = 0;
           int iterations = 0;
 
           while (iterations < 3)
           {
-            if (weights_table.count(xyz) > 0)
+            std::map<std::vector<int>, double>::const_iterator weight = weights_table.find(xyz);
+            if (weight != weights_table.end())
             {
-              v_tot = normal * weights_table.at(xyz) * velocityTable[t];
-              //log::Logger::Log<log::Warning, log::OnePerCore>("%f %f %f %f",
-              //                                                              x.x,
-              //                                                              x.y,
-              //                                                              x.z, v_tot);
-              return v_tot;
+              return weight->second;
             }
 
             /*if (logging)
@@ -276,7 +207,7 @@ namespace hemelb
            * If you are unsure, you can increase the log level of this, run HemeLb
            * for 1 time step, and plot these points out. */
           log::Logger::Log<log::Trace, log::OnePerCore>("%f %f %f", x.x, x.y, x.z);
-          return normal * 0.0;
+          return 0.0;
         }
 
       }
@@ -8,6 +8,7 @@
 
 #include <map>
 #include "lb/iolets/InOutLetVelocity.h"
+#include "lb/iolets/PeriodicWaveform.h"
 
 namespace hemelb
 {
@@ -24,7 +25,7 @@ namespace hemelb
           InOutLet* Clone() const;
           void Reset(SimulationState &state)
           {
-            CalculateTable(state.GetTotalTimeSteps(), state.GetTimeStepLength());
+            ReadWaveform(state.GetTimeStepLength());
           }
 
           const std::string& GetFilePath()
@@ -37,6 +38,22 @@ namespace hemelb
           }
 
           LatticeVelocity GetVelocity(const LatticePosition& x, const LatticeTimeStep t) const;
+
+          bool HasFixedProfile() const
+          {
+            return true;
+          }
+          /**
+           * The fraction of the maximum speed at a position: parabolic across the iolet, or the
+           * weight of the nearest site in the weights file along the normal.
+           * @param x
+           * @return
+           */
+          Dimensionless GetProfileWeight(const LatticePosition& x) const;
+          LatticeSpeed GetProfileSpeed(const LatticeTimeStep t) const
+          {
+            return velocityWaveform.Evaluate(t);
+          }
           /*LatticeVelocity GetVelocity2(const util::Vector3D<int64_t> globalCoordinates,
                                                                   const LatticeTimeStep t) const;*/
 
@@ -47,8 +64,8 @@ namespace hemelb
         private:
           std::string velocityFilePath;
           std::string velocityWeightsFilePath;
-          void CalculateTable(LatticeTimeStep totalTimeSteps, PhysicalTime timeStepLength);
-          std::vector<LatticeSpeed> velocityTable;
+          void ReadWaveform(PhysicalTime timeStepLength);
+          PeriodicWaveform velocityWaveform; //! One period of the maximum speed, in lattice units.
           const util::UnitConverter* units;
 
           std::map<std::vector<int>, double> weights_table;
@@ -43,6 +43,23 @@ namespace hemelb
 
           virtual LatticeVelocity GetVelocity(const LatticePosition& x, const LatticeTimeStep t) const = 0;
 
+          /**
+           * Whether the velocity is the iolet's normal times a fixed weight for each position
+           * times a speed that only depends on time, i.e.
+           *
+           *   GetVelocity(x, t) == normal * (GetProfileSpeed(t) * GetProfileWeight(x))
+           *
+           * If so, streamers can look up the weight for each of their links once, rather than
+           * evaluating the whole profile on every time step.
+           * @return
+           */
+          virtual bool HasFixedProfile() const
+          {
+            return false;
+          }
+          virtual Dimensionless GetProfileWeight(const LatticePosition& x) const;
+          virtual LatticeSpeed GetProfileSpeed(const LatticeTimeStep t) const;
+
           //virtual LatticeVelocity GetVelocity2(const util::Vector3D<site_t> globalCoordinates,
           //                                                          const LatticeTimeStep t) const = 0;
 
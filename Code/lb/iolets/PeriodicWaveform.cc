@@ -0,0 +1,114 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <utility>
+
+#include "lb/iolets/PeriodicWaveform.h"
+#include "Exception.h"
+#include "log/Logger.h"
+#include "util/fileutils.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    namespace iolets
+    {
+      namespace
+      {
+        bool EarlierTime(const std::pair<double, double>& a, const std::pair<double, double>& b)
+        {
+          return a.first < b.first;
+        }
+      }
+
+      PeriodicWaveform::PeriodicWaveform() :
+          times(), values()
+      {
+      }
+
+      // IMPORTANT: to allow reading in data taken at irregular intervals the user
+      // needs to make sure that the last point in the file coincides with the first
+      // point of a new cycle for a continuous trace.
+      void PeriodicWaveform::Read(const std::string& path, PhysicalTime timeStepLength)
+      {
+        std::vector<std::pair<double, double> > timeValuePairs;
+        double timeTemp, valueTemp;
+
+        util::check_file(path.c_str());
+        std::ifstream datafile(path.c_str());
+        log::Logger::Log<log::Debug, log::OnePerCore>("Reading iolet values from file:");
+        while (datafile >> timeTemp >> valueTemp)
+        {
+          log::Logger::Log<log::Trace, log::OnePerCore>("Time: %f Value: %f", timeTemp, valueTemp);
+          timeValuePairs.push_back(std::make_pair(timeTemp, valueTemp));
+        }
+        datafile.close();
+
+        // Order by time. Where a time is repeated, the last value given for it wins.
+        std::stable_sort(timeValuePairs.begin(), timeValuePairs.end(), EarlierTime);
+        times.clear();
+        values.clear();
+        for (std::vector<std::pair<double, double> >::const_iterator entry = timeValuePairs.begin();
+            entry != timeValuePairs.end(); ++entry)
+        {
+          if (!times.empty() && entry->first == times.back())
+          {
+            values.back() = entry->second;
+          }
+          else
+          {
+            times.push_back(entry->first);
+            values.push_back(entry->second);
+          }
+        }
+
+        if (times.size() < 2)
+          throw Exception() << "Need at least two points to make a waveform in " << path;
+
+        // Check if last point's value matches the first
+        if (values.back() != values.front())
+          throw Exception() << "Last point's value does not match the first point's value in " << path;
+
+        const double firstTime = times.front();
+        for (std::vector<double>::iterator time = times.begin(); time != times.end(); ++time)
+        {
+          *time = (*time - firstTime) / timeStepLength;
+        }
+      }
+
+      double PeriodicWaveform::Evaluate(LatticeTimeStep timeStep) const
+      {
+        const double time = std::fmod(static_cast<double>(timeStep), times.back());
+
+        // Find the interval containing the time: times[upper - 1] <= time < times[upper].
+        const size_t upper = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+        if (upper == times.size())
+        {
+          return values.back();
+        }
+        const size_t lower = upper - 1;
+
+        // Linear interpolation of function f(x) between two points A and B
+        // f(A) + (fraction along x axis between A and B) * (f(B) - f(A))
+        return values[lower]
+            + (time - times[lower]) / (times[upper] - times[lower]) * (values[upper] - values[lower]);
+      }
+
+      double PeriodicWaveform::GetMinimum() const
+      {
+        return *std::min_element(values.begin(), values.end());
+      }
+
+      double PeriodicWaveform::GetMaximum() const
+      {
+        return *std::max_element(values.begin(), values.end());
+      }
+    }
+  }
+}
@@ -0,0 +1,67 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_IOLETS_PERIODICWAVEFORM_H
+#define HEMELB_LB_IOLETS_PERIODICWAVEFORM_H
+
+#include <string>
+#include <vector>
+#include "units.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    namespace iolets
+    {
+      /**
+       * One period of a waveform, read from a file of (time, value) pairs and linearly
+       * interpolated on demand.
+       *
+       * The last point must have the same value as the first; the waveform repeats with the
+       * period between them, so it can drive a simulation of any length. Only the points in the
+       * file are stored, so the memory needed doesn't depend on the number of time steps.
+       */
+      class PeriodicWaveform
+      {
+        public:
+          PeriodicWaveform();
+
+          /**
+           * Read the waveform from a file, expressing its times as a number of time steps after
+           * the first point. Values are as given in the file; they can be converted in place
+           * through GetValues.
+           *
+           * @param path
+           * @param timeStepLength
+           */
+          void Read(const std::string& path, PhysicalTime timeStepLength);
+
+          /**
+           * The value at the given time step, where time step zero is the first point in the
+           * file.
+           *
+           * @param timeStep
+           * @return
+           */
+          double Evaluate(LatticeTimeStep timeStep) const;
+
+          std::vector<double>& GetValues()
+          {
+            return values;
+          }
+
+          double GetMinimum() const;
+          double GetMaximum() const;
+
+        private:
+          std::vector<double> times; //! In time steps after the first point. The last is the period.
+          std::vector<double> values;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_LB_IOLETS_PERIODICWAVEFORM_H */
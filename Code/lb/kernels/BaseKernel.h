@@ -10,6 +10,7 @@
 #include <cstdlib>
 #include "constants.h"
 #include "lb/iolets/BoundaryValues.h"
+#include "lb/kernels/HydroVarsBatch.h"
 #include "lb/kernels/rheologyModels/RheologyModels.h"
 #include "geometry/neighbouring/NeighbouringDataManager.h"
 
@@ -190,6 +191,11 @@ namespace hemelb
        *  - DoCalculateDensityMomentumFeq(KHydroVars&, site_t)
        *  - DoCollide(const LbmParameters*, KHydroVars&, unsigned int) returns distibn_t
        *  - DoReset(InitParams*)
+       *
+       * Kernels whose relaxation doesn't depend on per-site state can also collide a batch of
+       * sites at once. Such kernels set SupportsBatches to true and implement
+       *  - DoCalculateDensityMomentumFeqBatch(HydroVarsBatch<LatticeType>&)
+       *  - DoCollideBatch(const LbmParameters*, HydroVarsBatch<LatticeType>&)
        */
       template<typename KernelImpl, typename LatticeImpl>
       class BaseKernel
@@ -197,6 +203,10 @@ namespace hemelb
         public:
           typedef HydroVars<KernelImpl> KHydroVars;
           typedef LatticeImpl LatticeType;
+          typedef HydroVarsBatch<LatticeImpl> KHydroVarsBatch;
+
+          //! Overridden by kernels that implement the batched methods.
+          static const bool SupportsBatches = false;
 
           inline void CalculateDensityMomentumFeq(KHydroVars& hydroVars, site_t index)
           {
@@ -213,6 +223,16 @@ namespace hemelb
             static_cast<KernelImpl*> (this)->DoCollide(lbmParams, hydroVars);
           }
 
+          inline void CalculateDensityMomentumFeqBatch(KHydroVarsBatch& batch)
+          {
+            static_cast<KernelImpl*> (this)->DoCalculateDensityMomentumFeqBatch(batch);
+          }
+
+          inline void CollideBatch(const LbmParameters* lbmParams, KHydroVarsBatch& batch)
+          {
+            static_cast<KernelImpl*> (this)->DoCollideBatch(lbmParams, batch);
+          }
+
       };
 
     }
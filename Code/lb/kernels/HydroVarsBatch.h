@@ -0,0 +1,112 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_KERNELS_HYDROVARSBATCH_H
+#define HEMELB_LB_KERNELS_HYDROVARSBATCH_H
+
+#include "units.h"
+#include "util/SimdDouble.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    namespace kernels
+    {
+      /**
+       * HydroVarsBatch: the hydrodynamic variables for a batch of WIDTH sites, for use by the
+       * kernels that can collide several sites at once.
+       *
+       * Everything is stored lane-fastest (f[direction][lane]), so that the values for one
+       * direction across the whole batch can be loaded into a single util::SimdDouble. Only the
+       * first siteCount lanes hold real sites; the remaining lanes must still contain valid
+       * (e.g. duplicated) distributions so that the arithmetic on them is harmless.
+       */
+      template<class LatticeType>
+      struct HydroVarsBatch
+      {
+        public:
+          static const unsigned WIDTH = util::SimdDouble::WIDTH;
+
+          //! Number of lanes that correspond to real sites.
+          unsigned siteCount;
+
+          distribn_t f[LatticeType::NUMVECTORS][WIDTH];
+          distribn_t f_eq[LatticeType::NUMVECTORS][WIDTH];
+          distribn_t f_neq[LatticeType::NUMVECTORS][WIDTH];
+          distribn_t fPostCollision[LatticeType::NUMVECTORS][WIDTH];
+
+          distribn_t density[WIDTH];
+          distribn_t momentum_x[WIDTH], momentum_y[WIDTH], momentum_z[WIDTH];
+          distribn_t velocity_x[WIDTH], velocity_y[WIDTH], velocity_z[WIDTH];
+
+          /**
+           * Copy the distributions of one site into the given lane.
+           * @param lane
+           * @param fOld
+           */
+          inline void SetF(unsigned lane, const distribn_t* fOld)
+          {
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              f[direction][lane] = fOld[direction];
+            }
+          }
+
+          /**
+           * Copy the distributions of the site in the given lane out, ordered by direction.
+           * @param lane
+           * @param fOld
+           */
+          inline void GetF(unsigned lane, distribn_t* fOld) const
+          {
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              fOld[direction] = f[direction][lane];
+            }
+          }
+
+          /**
+           * Fill the lanes from siteCount onwards with copies of lane 0, so that a partially
+           * filled batch doesn't divide by a zero density.
+           */
+          inline void PadUnusedLanes()
+          {
+            for (unsigned lane = siteCount; lane < WIDTH; ++lane)
+            {
+              for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+              {
+                f[direction][lane] = f[direction][0];
+              }
+            }
+          }
+
+          /**
+           * Copy the results for one lane into a per-site HydroVars object, so that the rest of
+           * the streaming code (link delegates, property caches) can be used unchanged.
+           *
+           * @param lane
+           * @param hydroVars
+           */
+          template<class HydroVarsType>
+          inline void Unpack(unsigned lane, HydroVarsType& hydroVars) const
+          {
+            hydroVars.density = density[lane];
+            hydroVars.momentum = util::Vector3D<distribn_t>(momentum_x[lane], momentum_y[lane], momentum_z[lane]);
+            hydroVars.velocity = util::Vector3D<distribn_t>(velocity_x[lane], velocity_y[lane], velocity_z[lane]);
+
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              hydroVars.SetFEq(direction, f_eq[direction][lane]);
+              hydroVars.SetFNeq(direction, f_neq[direction][lane]);
+              hydroVars.SetFPostCollision(direction, fPostCollision[direction][lane]);
+            }
+          }
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_LB_KERNELS_HYDROVARSBATCH_H */
@@ -25,6 +25,8 @@ namespace hemelb
       class LBGK : public BaseKernel<LBGK<LatticeType>, LatticeType>
       {
         public:
+          static const bool SupportsBatches = true;
+
           LBGK(InitParams& initParams)
           {
           }
@@ -71,6 +73,33 @@ namespace hemelb
             }
           }
 
+          inline void DoCalculateDensityMomentumFeqBatch(HydroVarsBatch<LatticeType>& batch)
+          {
+            LatticeType::CalculateDensityMomentumFEqBatch(batch.f,
+                                                          batch.density,
+                                                          batch.momentum_x,
+                                                          batch.momentum_y,
+                                                          batch.momentum_z,
+                                                          batch.velocity_x,
+                                                          batch.velocity_y,
+                                                          batch.velocity_z,
+                                                          batch.f_eq);
+
+            for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+            {
+              (util::SimdDouble::Load(batch.f[ii]) - util::SimdDouble::Load(batch.f_eq[ii])).Store(batch.f_neq[ii]);
+            }
+          }
+
+          inline void DoCollideBatch(const LbmParameters* const lbmParams, HydroVarsBatch<LatticeType>& batch)
+          {
+            const util::SimdDouble omega(lbmParams->GetOmega());
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              (util::SimdDouble::Load(batch.f[direction]) + util::SimdDouble::Load(batch.f_neq[direction]) * omega).Store(batch.fPostCollision[direction]);
+            }
+          }
+
       };
 
     }
@@ -51,11 +51,10 @@ namespace hemelb
       class MRT : public BaseKernel<MRT<MomentBasis>, typename MomentBasis::Lattice>
       {
         public:
+          static const bool SupportsBatches = true;
 
           MRT(InitParams& initParams)
           {
-            InitState(initParams);
-
             // Pre-compute the reduced moment basis divided by the basis times basis transposed.
             for (Direction direction = 0; direction < MomentBasis::Lattice::NUMVECTORS; ++direction)
             {
@@ -66,6 +65,8 @@ namespace hemelb
                         / MomentBasis::BASIS_TIMES_BASIS_TRANSPOSED[momentIndex];
               }
             }
+
+            InitState(initParams);
           }
 
           inline void DoCalculateDensityMomentumFeq(HydroVars<MRT>& hydroVars, site_t index)
@@ -123,6 +124,58 @@ namespace hemelb
             }
           }
 
+          inline void DoCalculateDensityMomentumFeqBatch(HydroVarsBatch<typename MomentBasis::Lattice>& batch)
+          {
+            MomentBasis::Lattice::CalculateDensityMomentumFEqBatch(batch.f,
+                                                                   batch.density,
+                                                                   batch.momentum_x,
+                                                                   batch.momentum_y,
+                                                                   batch.momentum_z,
+                                                                   batch.velocity_x,
+                                                                   batch.velocity_y,
+                                                                   batch.velocity_z,
+                                                                   batch.f_eq);
+
+            for (unsigned int ii = 0; ii < MomentBasis::Lattice::NUMVECTORS; ++ii)
+            {
+              (util::SimdDouble::Load(batch.f[ii]) - util::SimdDouble::Load(batch.f_eq[ii])).Store(batch.f_neq[ii]);
+            }
+          }
+
+          /**
+           * The batched collision projects f_neq into moment space and back in one go, using the
+           * collision matrix premultiplied into the normalised basis.
+           */
+          inline void DoCollideBatch(const LbmParameters* const lbmParams,
+                                     HydroVarsBatch<typename MomentBasis::Lattice>& batch)
+          {
+            typedef util::SimdDouble Simd;
+
+            Simd scaledMomentNeq[MomentBasis::NUM_KINETIC_MOMENTS];
+            for (unsigned momentIndex = 0; momentIndex < MomentBasis::NUM_KINETIC_MOMENTS; momentIndex++)
+            {
+              scaledMomentNeq[momentIndex] = Simd(0.0);
+            }
+            for (Direction direction = 0; direction < MomentBasis::Lattice::NUMVECTORS; ++direction)
+            {
+              const Simd fNeq = Simd::Load(batch.f_neq[direction]);
+              for (unsigned momentIndex = 0; momentIndex < MomentBasis::NUM_KINETIC_MOMENTS; momentIndex++)
+              {
+                scaledMomentNeq[momentIndex] += Simd(MomentBasis::REDUCED_MOMENT_BASIS[momentIndex][direction]) * fNeq;
+              }
+            }
+
+            for (Direction direction = 0; direction < MomentBasis::Lattice::NUMVECTORS; ++direction)
+            {
+              Simd collision(0.0);
+              for (unsigned momentIndex = 0; momentIndex < MomentBasis::NUM_KINETIC_MOMENTS; momentIndex++)
+              {
+                collision += Simd(collisionTimesNormalisedBasis[momentIndex][direction]) * scaledMomentNeq[momentIndex];
+              }
+              (Simd::Load(batch.f[direction]) - collision).Store(batch.fPostCollision[direction]);
+            }
+          }
+
           inline void DoReset(InitParams* initParams)
           {
             InitState(*initParams);
@@ -136,6 +189,7 @@ namespace hemelb
           {
             assert(newRelaxationParameters.size() == MomentBasis::NUM_KINETIC_MOMENTS);
             collisionMatrix = newRelaxationParameters;
+            UpdateCollisionTimesNormalisedBasis();
           }
 
         private:
@@ -144,6 +198,21 @@ namespace hemelb
 
           double normalisedReducedMomentBasis[MomentBasis::NUM_KINETIC_MOMENTS][MomentBasis::Lattice::NUMVECTORS];
 
+          /** The collision matrix times normalisedReducedMomentBasis, used by the batched collision. */
+          double collisionTimesNormalisedBasis[MomentBasis::NUM_KINETIC_MOMENTS][MomentBasis::Lattice::NUMVECTORS];
+
+          void UpdateCollisionTimesNormalisedBasis()
+          {
+            for (Direction direction = 0; direction < MomentBasis::Lattice::NUMVECTORS; ++direction)
+            {
+              for (unsigned momentIndex = 0; momentIndex < MomentBasis::NUM_KINETIC_MOMENTS; momentIndex++)
+              {
+                collisionTimesNormalisedBasis[momentIndex][direction] = collisionMatrix[momentIndex]
+                    * normalisedReducedMomentBasis[momentIndex][direction];
+              }
+            }
+          }
+
           /**
            *  Helper method to set/update member variables. Called from the constructor and Reset()
            *
@@ -152,6 +221,7 @@ namespace hemelb
           void InitState(const InitParams& initParams)
           {
             MomentBasis::SetUpCollisionMatrix(collisionMatrix, initParams.lbmParams->GetTau());
+            UpdateCollisionTimesNormalisedBasis();
           }
 
       };
@@ -34,6 +34,8 @@ namespace hemelb
           Direction iZero;
 
         public:
+          static const bool SupportsBatches = true;
+
           TRT(InitParams& initParams)
           {
             for (Direction i = 0; i < LatticeType::NUMVECTORS; ++i)
@@ -112,6 +114,56 @@ namespace hemelb
             }
           }
 
+          inline void DoCalculateDensityMomentumFeqBatch(HydroVarsBatch<LatticeType>& batch)
+          {
+            LatticeType::CalculateDensityMomentumFEqBatch(batch.f,
+                                                          batch.density,
+                                                          batch.momentum_x,
+                                                          batch.momentum_y,
+                                                          batch.momentum_z,
+                                                          batch.velocity_x,
+                                                          batch.velocity_y,
+                                                          batch.velocity_z,
+                                                          batch.f_eq);
+
+            for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+            {
+              (util::SimdDouble::Load(batch.f[ii]) - util::SimdDouble::Load(batch.f_eq[ii])).Store(batch.f_neq[ii]);
+            }
+          }
+
+          inline void DoCollideBatch(const LbmParameters* const lbmParams, HydroVarsBatch<LatticeType>& batch)
+          {
+            typedef util::SimdDouble Simd;
+
+            // See DoCollide for where these come from.
+            const distribn_t Lambda = 3.0 / 16.0;
+            const distribn_t tau_plus = lbmParams->GetTau();
+            const distribn_t tau_minus = 0.5 + Lambda / (tau_plus - 0.5);
+
+            const Simd halfOmegaPlus(0.5 * lbmParams->GetOmega());
+            const Simd halfOmegaMinus(0.5 * -1.0 / tau_minus);
+
+            (Simd::Load(batch.f[iZero])
+                + Simd(lbmParams->GetOmega()) * Simd::Load(batch.f_neq[iZero])).Store(batch.fPostCollision[iZero]);
+
+            for (OppList::const_iterator oppIt = directionPairs.begin();
+                oppIt != directionPairs.end();
+                ++oppIt)
+            {
+              const Direction& i = oppIt->first;
+              const Direction& iBar = oppIt->second;
+
+              const Simd fNeq = Simd::Load(batch.f_neq[i]);
+              const Simd fNeqBar = Simd::Load(batch.f_neq[iBar]);
+              const Simd sym = halfOmegaPlus * (fNeq + fNeqBar);
+              const Simd asym = halfOmegaMinus * (fNeq - fNeqBar);
+
+              (Simd::Load(batch.f[i]) + sym + asym).Store(batch.fPostCollision[i]);
+              (Simd::Load(batch.f[iBar]) + sym - asym).Store(batch.fPostCollision[iBar]);
+            }
+          }
+
       };
 
     }
@@ -58,6 +58,52 @@ namespace hemelb
             CalculateFeq(density, momentum_x, momentum_y, momentum_z, f_eq);
           }
 
+          inline static void CalculateFeqBatch(const distribn_t density[],
+                                               const distribn_t momentum_x[],
+                                               const distribn_t momentum_y[],
+                                               const distribn_t momentum_z[],
+                                               distribn_t f_eq[][util::SimdDouble::WIDTH])
+          {
+            typedef util::SimdDouble Simd;
+            const Simd mom_x = Simd::Load(momentum_x);
+            const Simd mom_y = Simd::Load(momentum_y);
+            const Simd mom_z = Simd::Load(momentum_z);
+
+            const Simd isotropicPart = Simd::Load(density)
+                - Simd(3. / 2.) * (mom_x * mom_x + mom_y * mom_y + mom_z * mom_z);
+
+            for (Direction i = 0; i < DmQn::NUMVECTORS; ++i)
+            {
+              const Simd mom_dot_ei = Simd(DmQn::CXD[i]) * mom_x + Simd(DmQn::CYD[i]) * mom_y
+                  + Simd(DmQn::CZD[i]) * mom_z;
+
+              (Simd(DmQn::EQMWEIGHTS[i])
+                  * (isotropicPart + Simd(9. / 2.) * mom_dot_ei * mom_dot_ei + Simd(3.) * mom_dot_ei)).Store(f_eq[i]);
+            }
+          }
+
+          inline static void CalculateDensityMomentumFEqBatch(const distribn_t f[][util::SimdDouble::WIDTH],
+                                                              distribn_t density[],
+                                                              distribn_t momentum_x[],
+                                                              distribn_t momentum_y[],
+                                                              distribn_t momentum_z[],
+                                                              distribn_t velocity_x[],
+                                                              distribn_t velocity_y[],
+                                                              distribn_t velocity_z[],
+                                                              distribn_t f_eq[][util::SimdDouble::WIDTH])
+          {
+            Lattice<DmQn>::CalculateDensityAndMomentumBatch(f, density, momentum_x, momentum_y, momentum_z);
+
+            for (unsigned lane = 0; lane < util::SimdDouble::WIDTH; ++lane)
+            {
+              velocity_x[lane] = momentum_x[lane];
+              velocity_y[lane] = momentum_y[lane];
+              velocity_z[lane] = momentum_z[lane];
+            }
+
+            CalculateFeqBatch(density, momentum_x, momentum_y, momentum_z, f_eq);
+          }
+
           inline static bool IsLatticeCompressible()
           {
             return false;
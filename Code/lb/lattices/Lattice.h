@@ -17,6 +17,7 @@
 #include "util/utilityFunctions.h"
 #include "util/Vector3D.h"
 #include "util/Matrix3D.h"
+#include "util/SimdDouble.h"
 
 namespace hemelb
 {
@@ -286,6 +287,101 @@ namespace hemelb
             CalculateFeq(density, momentum_x, momentum_y, momentum_z, f_eq);
           }
 
+          /**
+           * Batched equivalent of CalculateDensityAndMomentum, for util::SimdDouble::WIDTH sites
+           * at once. Distributions are indexed [direction][lane], the other arrays by lane.
+           *
+           * @param f
+           * @param density
+           * @param momentum_x
+           * @param momentum_y
+           * @param momentum_z
+           */
+          inline static void CalculateDensityAndMomentumBatch(const distribn_t f[][util::SimdDouble::WIDTH],
+                                                              distribn_t density[],
+                                                              distribn_t momentum_x[],
+                                                              distribn_t momentum_y[],
+                                                              distribn_t momentum_z[])
+          {
+            typedef util::SimdDouble Simd;
+            Simd rho(0.0), mom_x(0.0), mom_y(0.0), mom_z(0.0);
+
+            for (Direction direction = 0; direction < DmQn::NUMVECTORS; ++direction)
+            {
+              const Simd fDirection = Simd::Load(f[direction]);
+              rho += fDirection;
+              mom_x += Simd(DmQn::CXD[direction]) * fDirection;
+              mom_y += Simd(DmQn::CYD[direction]) * fDirection;
+              mom_z += Simd(DmQn::CZD[direction]) * fDirection;
+            }
+
+            rho.Store(density);
+            mom_x.Store(momentum_x);
+            mom_y.Store(momentum_y);
+            mom_z.Store(momentum_z);
+          }
+
+          /**
+           * Batched equivalent of CalculateFeq, for util::SimdDouble::WIDTH sites at once.
+           *
+           * @param density
+           * @param momentum_x
+           * @param momentum_y
+           * @param momentum_z
+           * @param f_eq
+           */
+          inline static void CalculateFeqBatch(const distribn_t density[],
+                                               const distribn_t momentum_x[],
+                                               const distribn_t momentum_y[],
+                                               const distribn_t momentum_z[],
+                                               distribn_t f_eq[][util::SimdDouble::WIDTH])
+          {
+            typedef util::SimdDouble Simd;
+            const Simd rho = Simd::Load(density);
+            const Simd mom_x = Simd::Load(momentum_x);
+            const Simd mom_y = Simd::Load(momentum_y);
+            const Simd mom_z = Simd::Load(momentum_z);
+
+            const Simd density_1 = Simd(1.0) / rho;
+            const Simd isotropicPart = rho
+                - Simd(3. / 2.) * (mom_x * mom_x + mom_y * mom_y + mom_z * mom_z) * density_1;
+            const Simd nineHalvesOfDensity_1 = Simd(9. / 2.) * density_1;
+
+            for (Direction i = 0; i < DmQn::NUMVECTORS; ++i)
+            {
+              const Simd mom_dot_ei = Simd(DmQn::CXD[i]) * mom_x + Simd(DmQn::CYD[i]) * mom_y
+                  + Simd(DmQn::CZD[i]) * mom_z;
+
+              (Simd(DmQn::EQMWEIGHTS[i])
+                  * (isotropicPart + nineHalvesOfDensity_1 * mom_dot_ei * mom_dot_ei + Simd(3.) * mom_dot_ei)).Store(f_eq[i]);
+            }
+          }
+
+          /**
+           * Batched equivalent of CalculateDensityMomentumFEq, for util::SimdDouble::WIDTH sites
+           * at once.
+           */
+          inline static void CalculateDensityMomentumFEqBatch(const distribn_t f[][util::SimdDouble::WIDTH],
+                                                              distribn_t density[],
+                                                              distribn_t momentum_x[],
+                                                              distribn_t momentum_y[],
+                                                              distribn_t momentum_z[],
+                                                              distribn_t velocity_x[],
+                                                              distribn_t velocity_y[],
+                                                              distribn_t velocity_z[],
+                                                              distribn_t f_eq[][util::SimdDouble::WIDTH])
+          {
+            typedef util::SimdDouble Simd;
+            CalculateDensityAndMomentumBatch(f, density, momentum_x, momentum_y, momentum_z);
+
+            const Simd rho = Simd::Load(density);
+            (Simd::Load(momentum_x) / rho).Store(velocity_x);
+            (Simd::Load(momentum_y) / rho).Store(velocity_y);
+            (Simd::Load(momentum_z) / rho).Store(velocity_z);
+
+            CalculateFeqBatch(density, momentum_x, momentum_y, momentum_z, f_eq);
+          }
+
           // von Mises stress computation given the non-equilibrium distribution functions.
           inline static void CalculateVonMisesStress(const distribn_t f[],
                                                      distribn_t &stress,
@@ -647,7 +743,7 @@ namespace hemelb
                 inverseVectorIndices[direction] = DmQn::INVERSEDIRECTIONS[direction];
               }
 
-              singletonInfo = new LatticeInfo(DmQn::NUMVECTORS, vectors, inverseVectorIndices);
+              singletonInfo = new LatticeInfo(DmQn::NUMVECTORS, vectors, inverseVectorIndices, DmQn::EQMWEIGHTS);
             }
 
             return *singletonInfo;
@@ -22,13 +22,15 @@ namespace hemelb
         public:
           inline LatticeInfo(unsigned numberOfVectors,
                              const util::Vector3D<int>* vectors,
-                             const Direction* inverseVectorIndicesIn) :
-              numVectors(numberOfVectors), vectorSet(), inverseVectorIndices()
+                             const Direction* inverseVectorIndicesIn,
+                             const distribn_t* equilibriumWeightsIn) :
+              numVectors(numberOfVectors), vectorSet(), inverseVectorIndices(), equilibriumWeights()
           {
             for (Direction direction = 0; direction < numberOfVectors; ++direction)
             {
               vectorSet.push_back(util::Vector3D<int>(vectors[direction]));
               inverseVectorIndices.push_back(inverseVectorIndicesIn[direction]);
+              equilibriumWeights.push_back(equilibriumWeightsIn[direction]);
             }
           }
 
@@ -47,10 +49,16 @@ namespace hemelb
             return inverseVectorIndices[index];
           }
 
+          inline distribn_t GetEquilibriumWeight(unsigned index) const
+          {
+            return equilibriumWeights[index];
+          }
+
         private:
           const unsigned numVectors;
           std::vector<util::Vector3D<int> > vectorSet;
           std::vector<Direction> inverseVectorIndices;
+          std::vector<distribn_t> equilibriumWeights;
       };
     }
   }
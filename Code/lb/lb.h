@@ -16,6 +16,7 @@
 #include "util/UnitConverter.h"
 #include "configuration/SimConfig.h"
 #include "reporting/Timers.h"
+#include "util/Threading.h"
 #include "lb/BuildSystemInterface.h"
 #include <typeinfo>
 
@@ -102,6 +103,23 @@ namespace hemelb
         hemelb::lb::LbmParameters *GetLbmParams();
         lb::MacroscopicPropertyCache& GetPropertyCache();
 
+        /**
+         * Get the time spent updating the sites of each collision type on this rank, when
+         * measuring collision costs (see SimConfig::IsCalibratingSiteWeights).
+         * @return
+         */
+        std::vector<double> GetCollisionSeconds() const;
+
+        /**
+         * Get the number of site updates of each collision type on this rank, when measuring
+         * collision costs.
+         * @return
+         */
+        const std::vector<site_t>& GetCollisionSiteUpdates() const
+        {
+          return collisionSiteUpdates;
+        }
+
       private:
         void SetInitialConditions();
 
@@ -127,7 +145,71 @@ namespace hemelb
         tOutletWallCollision* mOutletWallCollision;
 
         template<typename Collision>
-        void StreamAndCollide(Collision* collision, const site_t iFirstIndex, const site_t iSiteCount)
+        void StreamAndCollide(Collision* collision, const unsigned collisionType,
+                              const site_t iFirstIndex, const site_t iSiteCount)
+        {
+          StartCollisionCost(collisionType, iSiteCount);
+#ifdef HEMELB_USE_OPENMP
+          if (Collision::SupportsThreading)
+          {
+#pragma omp parallel
+            {
+              site_t threadFirstIndex, threadSiteCount;
+              util::threading::GetThreadRange(iFirstIndex, iSiteCount, threadFirstIndex, threadSiteCount);
+              StreamAndCollideRange(collision, threadFirstIndex, threadSiteCount);
+            }
+            StopCollisionCost(collisionType, iSiteCount, iSiteCount);
+            return;
+          }
+#endif
+          StreamAndCollideRange(collision, iFirstIndex, iSiteCount);
+          StopCollisionCost(collisionType, iSiteCount, iSiteCount);
+        }
+
+        template<typename Collision>
+        void PostStep(Collision* collision, const unsigned collisionType, const site_t iFirstIndex,
+                      const site_t iSiteCount)
+        {
+          // The post-step is part of the cost of the sites updated, so is timed without counting
+          // more updates.
+          StartCollisionCost(collisionType, iSiteCount);
+#ifdef HEMELB_USE_OPENMP
+          if (Collision::SupportsThreading)
+          {
+#pragma omp parallel
+            {
+              site_t threadFirstIndex, threadSiteCount;
+              util::threading::GetThreadRange(iFirstIndex, iSiteCount, threadFirstIndex, threadSiteCount);
+              PostStepRange(collision, threadFirstIndex, threadSiteCount);
+            }
+            StopCollisionCost(collisionType, iSiteCount, 0);
+            return;
+          }
+#endif
+          PostStepRange(collision, iFirstIndex, iSiteCount);
+          StopCollisionCost(collisionType, iSiteCount, 0);
+        }
+
+        void StartCollisionCost(const unsigned collisionType, const site_t iSiteCount)
+        {
+          if (measureCollisionCosts && iSiteCount > 0)
+          {
+            collisionTimers[collisionType].Start();
+          }
+        }
+
+        void StopCollisionCost(const unsigned collisionType, const site_t iSiteCount,
+                               const site_t siteUpdates)
+        {
+          if (measureCollisionCosts && iSiteCount > 0)
+          {
+            collisionTimers[collisionType].Stop();
+            collisionSiteUpdates[collisionType] += siteUpdates;
+          }
+        }
+
+        template<typename Collision>
+        void StreamAndCollideRange(Collision* collision, const site_t iFirstIndex, const site_t iSiteCount)
         {
           if (mVisControl->IsRendering())
           {
@@ -140,7 +222,7 @@ namespace hemelb
         }
 
         template<typename Collision>
-        void PostStep(Collision* collision, const site_t iFirstIndex, const site_t iSiteCount)
+        void PostStepRange(Collision* collision, const site_t iFirstIndex, const site_t iSiteCount)
         {
           if (mVisControl->IsRendering())
           {
@@ -171,6 +253,13 @@ namespace hemelb
         MacroscopicPropertyCache propertyCache;
 
         geometry::neighbouring::NeighbouringDataManager *neighbouringDataManager;
+
+        //! Whether to time the updates of each collision type, to calibrate the site weights.
+        const bool measureCollisionCosts;
+        //! The time spent on each collision type's sites, if measuring.
+        std::vector<reporting::Timer> collisionTimers;
+        //! The number of site updates of each collision type, if measuring.
+        std::vector<site_t> collisionSiteUpdates;
     };
 
   } // Namespace lb
@@ -27,6 +27,17 @@ namespace hemelb
       return propertyCache;
     }
 
+    template<class LatticeType>
+    std::vector<double> LBM<LatticeType>::GetCollisionSeconds() const
+    {
+      std::vector<double> seconds(COLLISION_TYPES);
+      for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; ++collisionType)
+      {
+        seconds[collisionType] = collisionTimers[collisionType].Get();
+      }
+      return seconds;
+    }
+
     template<class LatticeType>
     LBM<LatticeType>::LBM(configuration::SimConfig *iSimulationConfig,
                           net::Net* net,
@@ -36,7 +47,9 @@ namespace hemelb
                           geometry::neighbouring::NeighbouringDataManager *neighbouringDataManager) :
       mSimConfig(iSimulationConfig), mNet(net), mLatDat(latDat), mState(simState), 
           mParams(iSimulationConfig->GetTimeStepLength(), iSimulationConfig->GetVoxelSize()), timings(atimings),
-          propertyCache(*simState, *latDat), neighbouringDataManager(neighbouringDataManager)
+          propertyCache(*simState, *latDat), neighbouringDataManager(neighbouringDataManager),
+          measureCollisionCosts(iSimulationConfig->IsCalibratingSiteWeights()),
+          collisionTimers(COLLISION_TYPES), collisionSiteUpdates(COLLISION_TYPES, 0)
     {
       ReadParameters();
     }
@@ -175,18 +188,22 @@ namespace hemelb
     {
       distribn_t density = mUnits->ConvertPressureToLatticeUnits(mSimConfig->GetInitialPressure()) / Cs2;
 
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+      // The distributions stay close to the initial equilibrium, so store their departures from
+      // it.
+      mLatDat->SetStorageShiftDensity(density);
+#endif
+
       for (site_t i = 0; i < mLatDat->GetLocalFluidSiteCount(); i++)
       {
         distribn_t f_eq[LatticeType::NUMVECTORS];
 
         LatticeType::CalculateFeq(density, 0.0, 0.0, 0.0, f_eq);
 
-        distribn_t* f_old_p = mLatDat->GetFOld(i * LatticeType::NUMVECTORS);
-        distribn_t* f_new_p = mLatDat->GetFNew(i * LatticeType::NUMVECTORS);
-
         for (unsigned int l = 0; l < LatticeType::NUMVECTORS; l++)
         {
-          f_new_p[l] = f_old_p[l] = f_eq[l];
+          const site_t index = mLatDat->GetDistributionIndex<LatticeType>(i, l);
+          *mLatDat->GetFNew(index) = *mLatDat->GetFOld(index) = f_eq[l];
         }
       }
     }
@@ -219,24 +236,27 @@ namespace hemelb
        */
       site_t offset = mLatDat->GetMidDomainSiteCount();
 
-      StreamAndCollide(mMidFluidCollision, offset, mLatDat->GetDomainEdgeCollisionCount(0));
+      StreamAndCollide(mMidFluidCollision, 0, offset, mLatDat->GetDomainEdgeCollisionCount(0));
       offset += mLatDat->GetDomainEdgeCollisionCount(0);
 
-      StreamAndCollide(mWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(1));
+      StreamAndCollide(mWallCollision, 1, offset, mLatDat->GetDomainEdgeCollisionCount(1));
       offset += mLatDat->GetDomainEdgeCollisionCount(1);
 
       mInletValues->FinishReceive();
-      StreamAndCollide(mInletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(2));
+      StreamAndCollide(mInletCollision, 2, offset, mLatDat->GetDomainEdgeCollisionCount(2));
       offset += mLatDat->GetDomainEdgeCollisionCount(2);
 
       mOutletValues->FinishReceive();
-      StreamAndCollide(mOutletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(3));
+      StreamAndCollide(mOutletCollision, 3, offset, mLatDat->GetDomainEdgeCollisionCount(3));
       offset += mLatDat->GetDomainEdgeCollisionCount(3);
 
-      StreamAndCollide(mInletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(4));
+      StreamAndCollide(mInletWallCollision, 4, offset, mLatDat->GetDomainEdgeCollisionCount(4));
       offset += mLatDat->GetDomainEdgeCollisionCount(4);
 
-      StreamAndCollide(mOutletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(5));
+      StreamAndCollide(mOutletWallCollision, 5, offset, mLatDat->GetDomainEdgeCollisionCount(5));
+
+      // Make sure the distributions to send are in the send buffer.
+      mLatDat->PackSharedDistributions();
 
       timings[hemelb::reporting::Timers::lb_calc].Stop();
       timings[hemelb::reporting::Timers::lb].Stop();
@@ -258,22 +278,22 @@ namespace hemelb
        */
       site_t offset = 0;
 
-      StreamAndCollide(mMidFluidCollision, offset, mLatDat->GetMidDomainCollisionCount(0));
+      StreamAndCollide(mMidFluidCollision, 0, offset, mLatDat->GetMidDomainCollisionCount(0));
       offset += mLatDat->GetMidDomainCollisionCount(0);
 
-      StreamAndCollide(mWallCollision, offset, mLatDat->GetMidDomainCollisionCount(1));
+      StreamAndCollide(mWallCollision, 1, offset, mLatDat->GetMidDomainCollisionCount(1));
       offset += mLatDat->GetMidDomainCollisionCount(1);
 
-      StreamAndCollide(mInletCollision, offset, mLatDat->GetMidDomainCollisionCount(2));
+      StreamAndCollide(mInletCollision, 2, offset, mLatDat->GetMidDomainCollisionCount(2));
       offset += mLatDat->GetMidDomainCollisionCount(2);
 
-      StreamAndCollide(mOutletCollision, offset, mLatDat->GetMidDomainCollisionCount(3));
+      StreamAndCollide(mOutletCollision, 3, offset, mLatDat->GetMidDomainCollisionCount(3));
       offset += mLatDat->GetMidDomainCollisionCount(3);
 
-      StreamAndCollide(mInletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(4));
+      StreamAndCollide(mInletWallCollision, 4, offset, mLatDat->GetMidDomainCollisionCount(4));
       offset += mLatDat->GetMidDomainCollisionCount(4);
 
-      StreamAndCollide(mOutletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(5));
+      StreamAndCollide(mOutletWallCollision, 5, offset, mLatDat->GetMidDomainCollisionCount(5));
 
       timings[hemelb::reporting::Timers::lb_calc].Stop();
       timings[hemelb::reporting::Timers::lb].Stop();
@@ -284,10 +304,15 @@ namespace hemelb
     {
       timings[hemelb::reporting::Timers::lb].Start();
 
-      // Copy the distribution functions received from the neighbouring
-      // processors into the destination buffer "f_new".
-      // This is done here, after receiving the sent distributions from neighbours.
-      mLatDat->CopyReceived();
+      // The distribution functions received from the neighbouring processors have already
+      // been copied into the destination buffer "f_new", each as soon as it arrived, during
+      // the Net's Wait (see LatticeData::ExchangeComplete).
+#ifdef HEMELB_USE_SHARED_MEMORY_HALO
+      // Those from the same node weren't sent as messages, so copy them now.
+      timings[hemelb::reporting::Timers::mpiWait].Start();
+      mLatDat->CopyReceivedFromNode();
+      timings[hemelb::reporting::Timers::mpiWait].Stop();
+#endif
 
       // Do any cleanup steps necessary on boundary nodes
       site_t offset = mLatDat->GetMidDomainSiteCount();
@@ -295,41 +320,41 @@ namespace hemelb
       timings[hemelb::reporting::Timers::lb_calc].Start();
 
       //TODO yup, this is horrible. If you read this, please improve the following code.
-      PostStep(mMidFluidCollision, offset, mLatDat->GetDomainEdgeCollisionCount(0));
+      PostStep(mMidFluidCollision, 0, offset, mLatDat->GetDomainEdgeCollisionCount(0));
       offset += mLatDat->GetDomainEdgeCollisionCount(0);
 
-      PostStep(mWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(1));
+      PostStep(mWallCollision, 1, offset, mLatDat->GetDomainEdgeCollisionCount(1));
       offset += mLatDat->GetDomainEdgeCollisionCount(1);
 
-      PostStep(mInletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(2));
+      PostStep(mInletCollision, 2, offset, mLatDat->GetDomainEdgeCollisionCount(2));
       offset += mLatDat->GetDomainEdgeCollisionCount(2);
 
-      PostStep(mOutletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(3));
+      PostStep(mOutletCollision, 3, offset, mLatDat->GetDomainEdgeCollisionCount(3));
       offset += mLatDat->GetDomainEdgeCollisionCount(3);
 
-      PostStep(mInletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(4));
+      PostStep(mInletWallCollision, 4, offset, mLatDat->GetDomainEdgeCollisionCount(4));
       offset += mLatDat->GetDomainEdgeCollisionCount(4);
 
-      PostStep(mOutletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(5));
+      PostStep(mOutletWallCollision, 5, offset, mLatDat->GetDomainEdgeCollisionCount(5));
 
       offset = 0;
 
-      PostStep(mMidFluidCollision, offset, mLatDat->GetMidDomainCollisionCount(0));
+      PostStep(mMidFluidCollision, 0, offset, mLatDat->GetMidDomainCollisionCount(0));
       offset += mLatDat->GetMidDomainCollisionCount(0);
 
-      PostStep(mWallCollision, offset, mLatDat->GetMidDomainCollisionCount(1));
+      PostStep(mWallCollision, 1, offset, mLatDat->GetMidDomainCollisionCount(1));
       offset += mLatDat->GetMidDomainCollisionCount(1);
 
-      PostStep(mInletCollision, offset, mLatDat->GetMidDomainCollisionCount(2));
+      PostStep(mInletCollision, 2, offset, mLatDat->GetMidDomainCollisionCount(2));
       offset += mLatDat->GetMidDomainCollisionCount(2);
 
-      PostStep(mOutletCollision, offset, mLatDat->GetMidDomainCollisionCount(3));
+      PostStep(mOutletCollision, 3, offset, mLatDat->GetMidDomainCollisionCount(3));
       offset += mLatDat->GetMidDomainCollisionCount(3);
 
-      PostStep(mInletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(4));
+      PostStep(mInletWallCollision, 4, offset, mLatDat->GetMidDomainCollisionCount(4));
       offset += mLatDat->GetMidDomainCollisionCount(4);
 
-      PostStep(mOutletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(5));
+      PostStep(mOutletWallCollision, 5, offset, mLatDat->GetMidDomainCollisionCount(5));
 
       timings[hemelb::reporting::Timers::lb_calc].Stop();
       timings[hemelb::reporting::Timers::lb].Stop();
@@ -42,6 +42,12 @@ namespace hemelb
        *      geometry::LatticeData*, hemelb::vis::Control*)
        *  - DoReset(kernels::InitParams* init)
        *
+       * Concrete streamers may also set SupportsThreading to true if it is safe for LBM to split
+       * a site range between threads and call StreamAndCollide / PostStep on the pieces at the
+       * same time (HEMELB_USE_OPENMP). That holds when each site only writes its own outgoing
+       * distributions and property cache entries; streamers whose delegates update shared
+       * per-iolet or per-site maps (e.g. VirtualSiteIolet, JunkYang) must leave it false.
+       *
        * The design is to for the streamers to be pretty dumb and for them to
        * basically just control iteration over the sites and directions while
        * delegating the logic of actually streaming to some other classes
@@ -54,6 +60,8 @@ namespace hemelb
       class BaseStreamer
       {
         public:
+          static const bool SupportsThreading = false;
+
           template<bool tDoRayTracing>
           inline void StreamAndCollide(const site_t firstIndex,
                                        const site_t siteCount,
@@ -91,6 +99,14 @@ namespace hemelb
                                                 const LbmParameters* lbmParams,
                                                 lb::MacroscopicPropertyCache& propertyCache)
           {
+#ifdef HEMELB_USE_FUSED_MONITORING
+            // Check the distributions for the StabilityTester while they're to hand.
+            propertyCache.stabilityReduction.AddSite<LatticeType>(site.GetIndex(),
+                                                                  hydroVars.f,
+                                                                  hydroVars.density,
+                                                                  hydroVars.momentum);
+#endif
+
             if (propertyCache.densityCache.RequiresRefresh())
             {
               propertyCache.densityCache.Put(site.GetIndex(), hydroVars.density);
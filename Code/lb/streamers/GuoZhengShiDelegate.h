@@ -7,6 +7,8 @@
 #ifndef HEMELB_LB_STREAMERS_GUOZHENGSHIDELEGATE_H
 #define HEMELB_LB_STREAMERS_GUOZHENGSHIDELEGATE_H
 
+#include <algorithm>
+#include "Exception.h"
 #include "lb/streamers/BaseStreamerDelegate.h"
 #include "geometry/neighbouring/RequiredSiteInformation.h"
 #include "geometry/neighbouring/NeighbouringDataManager.h"
@@ -36,6 +38,11 @@ namespace hemelb
                 bValues(initParams.boundaryObject),
                 bbDelegate(delegatorCollider, initParams)
           {
+#ifdef HEMELB_USE_AA_STREAMING
+            // This reads the neighbouring sites' distributions part-way through the step, when the
+            // in-place update may already have overwritten them.
+            throw Exception() << "Guo-Zheng-Shi streaming is not supported with AA-pattern streaming.";
+#endif
             // Want to loop over each site this streamer is responsible for,
             // as specified in the siteRanges.
             for (std::vector<std::pair<site_t, site_t> >::iterator rangeIt =
@@ -217,7 +224,8 @@ namespace hemelb
                 else
                 {
                   // There is a neighbour site to use for standard GZS to calculate u_w2.
-                  const distribn_t *neighbourFOld = GetNeighbourFOld(site, i, latDat);
+                  distribn_t neighbourFOld[LatticeType::NUMVECTORS];
+                  GetNeighbourFOld(site, i, latDat, neighbourFOld);
                   // Now calculate this field information.
                   LatticeVelocity neighbourVelocity;
                   distribn_t neighbourFEq[LatticeType::NUMVECTORS];
@@ -287,17 +295,22 @@ namespace hemelb
             // Perform collision
             collider.Collide(lbmParams, hydroVarsWall);
             // stream
-            distribn_t* fNew = latDat->GetFNew(site.GetIndex() * LatticeType::NUMVECTORS);
-            fNew[i] = hydroVarsWall.GetFPostCollision()[i];
+            *latDat->GetFNew(latDat->GetDistributionIndex<LatticeType>(site.GetIndex(), i), i) =
+                hydroVarsWall.GetFPostCollision()[i];
 
           }
 
         private:
-          const distribn_t *GetNeighbourFOld(const geometry::Site<geometry::LatticeData>& site,
-                                             const Direction& i,
-                                             geometry::LatticeData* const latDat)
+          /**
+           * Copy the fOld values of the neighbouring site in direction i into neighbourFOld
+           * (which must have room for NUMVECTORS values).
+           */
+          void GetNeighbourFOld(const geometry::Site<geometry::LatticeData>& site,
+                                const Direction& i,
+                                geometry::LatticeData* const latDat,
+                                distribn_t* neighbourFOld)
           {
-            const distribn_t* neighbourFOld;
+            const distribn_t* source;
             // Find the neighbour's global location and which proc it's on.
             LatticeVector neighbourGlobalLocation = site.GetGlobalSiteCoords()
                 + LatticeVector(LatticeType::CX[i], LatticeType::CY[i], LatticeType::CZ[i]);
@@ -307,16 +320,17 @@ namespace hemelb
               // If it's local, get a Site object for it.
               geometry::Site<geometry::LatticeData> nextSiteOut =
                   latDat->GetSite(latDat->GetContiguousSiteId(neighbourGlobalLocation));
-              neighbourFOld = nextSiteOut.GetFOld<LatticeType> ();
+              source = nextSiteOut.GetFOld<LatticeType> ();
+              std::copy(source, source + LatticeType::NUMVECTORS, neighbourFOld);
             }
             else
             {
               const geometry::neighbouring::ConstNeighbouringSite
                   neighbourSite =
                       neighbouringLatticeData.GetSite(latDat->GetGlobalNoncontiguousSiteIdFromGlobalCoords(neighbourGlobalLocation));
-              neighbourFOld = neighbourSite.GetFOld<LatticeType> ();
+              source = neighbourSite.GetFOld<LatticeType> ();
+              std::copy(source, source + LatticeType::NUMVECTORS, neighbourFOld);
             }
-            return neighbourFOld;
 
           }
           // the collision
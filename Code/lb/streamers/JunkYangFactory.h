@@ -9,6 +9,7 @@
 
 #include "lb/kernels/BaseKernel.h"
 #include "lb/streamers/BaseStreamer.h"
+#include "Exception.h"
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/lu.hpp>
 #include <boost/numeric/ublas/io.hpp>
@@ -46,6 +47,11 @@ namespace hemelb
                   ioletLinkDelegate(collider, initParams), THETA(0.7),
                   latticeData(*initParams.latDat)
           {
+#ifdef HEMELB_USE_AA_STREAMING
+            // This keeps its own copies of fOld and writes to arbitrary directions at its sites,
+            // which assumes separate old and new distribution arrays.
+            throw Exception() << "Junk-Yang streaming is not supported with AA-pattern streaming.";
+#endif
             for (std::vector<std::pair<site_t, site_t> >::iterator rangeIt =
                 initParams.siteRanges.begin(); rangeIt != initParams.siteRanges.end(); ++rangeIt)
             {
@@ -181,7 +187,8 @@ namespace hemelb
                   incomingVelocityIter != incomingVelocities[siteIndex].end();
                   ++incomingVelocityIter, ++index)
               {
-                * (latticeData->GetFNew(siteIndex * LatticeType::NUMVECTORS + *incomingVelocityIter)) =
+                * (latticeData->GetFNew(latticeData->GetDistributionIndex<LatticeType>(siteIndex,
+                                                                                     *incomingVelocityIter))) =
                     systemSolution[index];
               }
 
@@ -465,8 +472,9 @@ namespace hemelb
                 outgoingDirIter != outgoingVelocities[contiguousSiteIndex].end();
                 ++outgoingDirIter, ++index)
             {
-              fNew[index] = *latticeData.GetFNew(contiguousSiteIndex * LatticeType::NUMVECTORS
-                  + *outgoingDirIter);
+              fNew[index] =
+                  *latticeData.GetFNew(latticeData.GetDistributionIndex<LatticeType>(contiguousSiteIndex,
+                                                                                    *outgoingDirIter));
             }
 
             rVector = THETA
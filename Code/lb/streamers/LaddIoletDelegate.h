@@ -7,7 +7,9 @@
 #ifndef HEMELB_LB_STREAMERS_LADDIOLETDELEGATE_H
 #define HEMELB_LB_STREAMERS_LADDIOLETDELEGATE_H
 
+#include <algorithm>
 #include "lb/streamers/SimpleBounceBackDelegate.h"
+#include "Exception.h"
 
 namespace hemelb
 {
@@ -25,8 +27,66 @@ namespace hemelb
 
           LaddIoletDelegate(CollisionType& delegatorCollider, kernels::InitParams& initParams) :
               SimpleBounceBackDelegate<CollisionType>(delegatorCollider, initParams),
-                  bValues(initParams.boundaryObject)
+                  bValues(initParams.boundaryObject), siteRanges(initParams.siteRanges)
           {
+            // For iolets with a fixed velocity profile, look up the weight at the half way point
+            // of each iolet link now, so streaming only has to scale it by the current speed.
+            // Index where each site's links start, so that finding them doesn't mean searching
+            // the ranges.
+            firstSite = 0;
+            site_t endSite = 0;
+            site_t siteCount = 0;
+            for (std::vector<std::pair<site_t, site_t> >::const_iterator rangeIt = siteRanges.begin();
+                rangeIt != siteRanges.end(); ++rangeIt)
+            {
+              if (rangeIt->second <= rangeIt->first)
+              {
+                continue;
+              }
+              firstSite = siteCount == 0 ?
+                rangeIt->first :
+                std::min(firstSite, rangeIt->first);
+              endSite = std::max(endSite, rangeIt->second);
+              siteCount += rangeIt->second - rangeIt->first;
+            }
+            firstLinkOfSite.resize(endSite - firstSite, -1);
+            site_t linkCount = 0;
+            for (std::vector<std::pair<site_t, site_t> >::const_iterator rangeIt = siteRanges.begin();
+                rangeIt != siteRanges.end(); ++rangeIt)
+            {
+              for (site_t siteIndex = rangeIt->first; siteIndex < rangeIt->second; ++siteIndex)
+              {
+                firstLinkOfSite[siteIndex - firstSite] = linkCount;
+                linkCount += LatticeType::NUMVECTORS;
+              }
+            }
+            linkWeights.resize(linkCount, 0.0);
+
+            for (std::vector<std::pair<site_t, site_t> >::const_iterator rangeIt = siteRanges.begin();
+                rangeIt != siteRanges.end(); ++rangeIt)
+            {
+              for (site_t siteIndex = rangeIt->first; siteIndex < rangeIt->second; ++siteIndex)
+              {
+                geometry::Site<const geometry::LatticeData> site = initParams.latDat->GetSite(siteIndex);
+                for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+                {
+                  if (!site.HasIolet(ii))
+                  {
+                    continue;
+                  }
+
+                  const iolets::InOutLetVelocity* iolet =
+                      dynamic_cast<const iolets::InOutLetVelocity*>(bValues->GetLocalIolet(site.GetIoletId()));
+                  if (iolet == NULL || !iolet->HasFixedProfile())
+                  {
+                    break;
+                  }
+
+                  linkWeights[GetLinkIndex(siteIndex, ii)] =
+                      iolet->GetProfileWeight(GetHalfWayPosition(site.GetGlobalSiteCoords(), ii));
+                }
+              }
+            }
           }
 
           inline void StreamLink(const LbmParameters* lbmParams,
@@ -48,15 +108,18 @@ namespace hemelb
             int boundaryId = site.GetIoletId();
             iolets::InOutLetVelocity* iolet =
                 dynamic_cast<iolets::InOutLetVelocity*>(bValues->GetLocalIolet(boundaryId));
-            LatticePosition sitePos(site.GetGlobalSiteCoords());
-
-            LatticePosition halfWay(sitePos);
-            halfWay.x += 0.5 * LatticeType::CX[ii];
-            halfWay.y += 0.5 * LatticeType::CY[ii];
-            halfWay.z += 0.5 * LatticeType::CZ[ii];
-
-            LatticeVelocity wallMom(iolet->GetVelocity(halfWay, bValues->GetTimeStep()));
-            //TODO: Add site.GetGlobalSiteCoords() as a first argument?
+            LatticeVelocity wallMom;
+            if (iolet->HasFixedProfile())
+            {
+              wallMom = iolet->GetNormal()
+                  * (iolet->GetProfileSpeed(bValues->GetTimeStep())
+                      * linkWeights[GetLinkIndex(site.GetIndex(), ii)]);
+            }
+            else
+            {
+              wallMom = iolet->GetVelocity(GetHalfWayPosition(site.GetGlobalSiteCoords(), ii),
+                                           bValues->GetTimeStep());
+            }
 
             if (CollisionType::CKernel::LatticeType::IsLatticeCompressible())
             {
@@ -67,12 +130,45 @@ namespace hemelb
                 * (wallMom.x * LatticeType::CX[ii] + wallMom.y * LatticeType::CY[ii]
                     + wallMom.z * LatticeType::CZ[ii]) / Cs2;
 
-            * (latticeData->GetFNew(SimpleBounceBackDelegate<CollisionImpl>::GetBBIndex(site.GetIndex(),
-                                                                                        ii))) =
+            * (latticeData->GetFNew(SimpleBounceBackDelegate<CollisionImpl>::GetBBIndex(latticeData,
+                                                                                        site.GetIndex(),
+                                                                                        ii),
+                                    ii)) =
                 hydroVars.GetFPostCollision()[ii] - correction;
           }
         private:
+          static LatticePosition GetHalfWayPosition(const LatticeVector& sitePos, Direction ii)
+          {
+            LatticePosition halfWay(sitePos);
+            halfWay.x += 0.5 * LatticeType::CX[ii];
+            halfWay.y += 0.5 * LatticeType::CY[ii];
+            halfWay.z += 0.5 * LatticeType::CZ[ii];
+            return halfWay;
+          }
+
+          /**
+           * The index in linkWeights of a link from one of this streamer's sites.
+           */
+          site_t GetLinkIndex(site_t siteIndex, Direction ii) const
+          {
+            if (siteIndex < firstSite || siteIndex >= firstSite + site_t(firstLinkOfSite.size())
+                || firstLinkOfSite[siteIndex - firstSite] < 0)
+            {
+              throw Exception() << "Site " << siteIndex << " isn't streamed by this Ladd iolet streamer";
+            }
+            return firstLinkOfSite[siteIndex - firstSite] + ii;
+          }
+
           iolets::BoundaryValues* bValues;
+          //! The site ranges this streamer updates.
+          std::vector<std::pair<site_t, site_t> > siteRanges;
+          //! Profile weight at the half way point of each iolet link, Q per site in siteRanges.
+          std::vector<Dimensionless> linkWeights;
+          //! The least site index in siteRanges.
+          site_t firstSite;
+          //! The index in linkWeights of each site's first link, from firstSite on; -1 for sites
+          //! not in siteRanges.
+          std::vector<site_t> firstLinkOfSite;
       };
 
     }
@@ -58,7 +58,7 @@ namespace hemelb
 
             Direction unstreamed = LatticeType::INVERSEDIRECTIONS[direction];
 
-            *latticeData->GetFNew(site.GetIndex() * LatticeType::NUMVECTORS + unstreamed)
+            *latticeData->GetFNew(latticeData->GetDistributionIndex<LatticeType>(site.GetIndex(), unstreamed), unstreamed)
                 = ghostHydrovars.GetFEq()[unstreamed];
           }
         protected:
@@ -7,6 +7,7 @@
 #ifndef HEMELB_LB_STREAMERS_SIMPLECOLLIDEANDSTREAM_H
 #define HEMELB_LB_STREAMERS_SIMPLECOLLIDEANDSTREAM_H
 
+#include <algorithm>
 #include "lb/streamers/BaseStreamer.h"
 #include "lb/streamers/SimpleCollideAndStreamDelegate.h"
 #include "lb/kernels/BaseKernel.h"
@@ -24,12 +25,24 @@ namespace hemelb
       {
         public:
           typedef CollisionImpl CollisionType;
+          static const bool SupportsThreading = true;
 
         private:
           CollisionType collider;
           SimpleCollideAndStreamDelegate<CollisionType> bulkLinkDelegate;
           typedef typename CollisionType::CKernel::LatticeType LatticeType;
 
+          /**
+           * Whether to collide sites in batches. Only some kernels gain from that once each
+           * site's results have been unpacked to stream (see the collision kernel benchmark), so
+           * it's a build option.
+           */
+#ifdef HEMELB_USE_BATCHED_COLLISIONS
+          static const bool Batched = CollisionType::SupportsBatches;
+#else
+          static const bool Batched = false;
+#endif
+
         public:
           SimpleCollideAndStream(kernels::InitParams& initParams) :
             collider(initParams), bulkLinkDelegate(collider, initParams)
@@ -43,6 +56,41 @@ namespace hemelb
                                          const LbmParameters* lbmParams,
                                          geometry::LatticeData* latDat,
                                          lb::MacroscopicPropertyCache& propertyCache)
+          {
+            StreamAndCollideSites<tDoRayTracing>(firstIndex,
+                                                 siteCount,
+                                                 lbmParams,
+                                                 latDat,
+                                                 propertyCache,
+                                                 BatchingTag<Batched>());
+          }
+
+          template<bool tDoRayTracing>
+          inline void DoPostStep(const site_t iFirstIndex,
+                                 const site_t iSiteCount,
+                                 const LbmParameters* iLbmParams,
+                                 geometry::LatticeData* bLatDat,
+                                 lb::MacroscopicPropertyCache& propertyCache)
+          {
+
+          }
+
+        private:
+          template<bool tBatched>
+          struct BatchingTag
+          {
+          };
+
+          /**
+           * Collide and stream one site at a time.
+           */
+          template<bool tDoRayTracing>
+          inline void StreamAndCollideSites(const site_t firstIndex,
+                                            const site_t siteCount,
+                                            const LbmParameters* lbmParams,
+                                            geometry::LatticeData* latDat,
+                                            lb::MacroscopicPropertyCache& propertyCache,
+                                            BatchingTag<false>)
           {
             for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
             {
@@ -71,16 +119,58 @@ namespace hemelb
             }
           }
 
+          /**
+           * Collide a batch of sites at a time with the collision's vectorised kernel, then stream
+           * and update the property caches for each site of the batch as usual.
+           *
+           * The batch is filled straight from the distribution arrays, which with the
+           * structure-of-arrays layout means one unit-stride read per direction, and each site's
+           * HydroVars then refers to its lane of the batch.
+           */
           template<bool tDoRayTracing>
-          inline void DoPostStep(const site_t iFirstIndex,
-                                 const site_t iSiteCount,
-                                 const LbmParameters* iLbmParams,
-                                 geometry::LatticeData* bLatDat,
-                                 lb::MacroscopicPropertyCache& propertyCache)
+          inline void StreamAndCollideSites(const site_t firstIndex,
+                                            const site_t siteCount,
+                                            const LbmParameters* lbmParams,
+                                            geometry::LatticeData* latDat,
+                                            lb::MacroscopicPropertyCache& propertyCache,
+                                            BatchingTag<true>)
           {
+            typedef typename CollisionType::CKernel::KHydroVarsBatch BatchType;
+            BatchType batch;
+            distribn_t laneFOld[LatticeType::NUMVECTORS];
 
-          }
+            for (site_t batchStart = firstIndex; batchStart < (firstIndex + siteCount); batchStart +=
+                BatchType::WIDTH)
+            {
+              batch.siteCount = (unsigned) std::min<site_t>(BatchType::WIDTH, firstIndex + siteCount - batchStart);
+
+              latDat->GetFOldForSites<LatticeType>(batchStart, batch.siteCount, batch.f);
+              batch.PadUnusedLanes();
 
+              collider.CalculatePreCollisionBatch(batch);
+              collider.CollideBatch(lbmParams, batch);
+
+              for (unsigned lane = 0; lane < batch.siteCount; ++lane)
+              {
+                geometry::Site<geometry::LatticeData> site = latDat->GetSite(batchStart + lane);
+
+                batch.GetF(lane, laneFOld);
+                kernels::HydroVars<typename CollisionType::CKernel> hydroVars(laneFOld);
+                hydroVars.tau = lbmParams->GetTau();
+                batch.Unpack(lane, hydroVars);
+
+                for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ii++)
+                {
+                  bulkLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, ii);
+                }
+
+                BaseStreamer<SimpleCollideAndStream>::template UpdateMinsAndMaxes<tDoRayTracing>(site,
+                                                                                                 hydroVars,
+                                                                                                 lbmParams,
+                                                                                                 propertyCache);
+              }
+            }
+          }
       };
     }
   }
@@ -31,7 +31,19 @@ namespace hemelb
                                  kernels::HydroVars<typename CollisionType::CKernel>& hydroVars,
                                  const Direction& direction)
           {
-            * (latticeData->GetFNew(site.GetStreamedIndex<LatticeType> (direction)))
+#ifdef HEMELB_USE_AA_STREAMING
+            // On the even steps of the AA pattern, the post-collision value stays at this site, in
+            // the slot of the opposite direction; the neighbour picks it up on the odd step.
+            if (!latticeData->IsAAOddStep())
+            {
+              * (latticeData->GetFNew(latticeData->GetDistributionIndex<LatticeType>(site.GetIndex(),
+                                                                                   LatticeType::INVERSEDIRECTIONS[direction]),
+                                      direction))
+                  = hydroVars.GetFPostCollision()[direction];
+              return;
+            }
+#endif
+            * (latticeData->GetFNew(site.GetStreamedIndex<LatticeType> (direction), direction))
                 = hydroVars.GetFPostCollision()[direction];
           }
 
@@ -30,6 +30,7 @@ namespace hemelb
       {
         public:
           typedef CollisionImpl CollisionType;
+          static const bool SupportsThreading = true;
 
         private:
           CollisionType collider;
@@ -121,6 +122,7 @@ namespace hemelb
       {
         public:
           typedef CollisionImpl CollisionType;
+          static const bool SupportsThreading = true;
 
         private:
           CollisionType collider;
@@ -214,6 +216,7 @@ namespace hemelb
       {
         public:
           typedef CollisionImpl CollisionType;
+          static const bool SupportsThreading = true;
           typedef typename CollisionType::CKernel::LatticeType LatticeType;
 
         private:
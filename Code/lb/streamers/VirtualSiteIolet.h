@@ -13,6 +13,7 @@
 #include "lb/streamers/BaseStreamerDelegate.h"
 #include "lb/streamers/VirtualSite.h"
 #include "log/Logger.h"
+#include "Exception.h"
 #include "util/FlatMap.h"
 #include <map>
 
@@ -64,6 +65,11 @@ namespace hemelb
                 wallLinkDelegate(collider, initParams), bValues(initParams.boundaryObject),
                 neighbouringLatticeData(initParams.latDat->GetNeighbouringData())
           {
+#ifdef HEMELB_USE_AA_STREAMING
+            // The iolet links are streamed in the post-step, from neighbouring sites' fOld, which
+            // has been overwritten by then.
+            throw Exception() << "Virtual-site iolet streaming is not supported with AA-pattern streaming.";
+#endif
             // Loop over the local in/outlets, creating the extra data objects.
             unsigned nIolets = bValues->GetLocalIoletCount();
             for (unsigned iIolet = 0; iIolet < nIolets; ++iIolet)
@@ -223,7 +229,7 @@ namespace hemelb
               CalculateVirtualSiteDistributions(*latDat, *iolet, extra->hydroVarsCache, *vSite, t);
               // Stream this direction
               Direction i = vSiteIt->second.direction;
-              * (latDat->GetFNew(siteIdx * LatticeType::NUMVECTORS + i)) = vSite->hv.fPostColl[i];
+              * (latDat->GetFNew(latDat->GetDistributionIndex<LatticeType>(siteIdx, i), i)) = vSite->hv.fPostColl[i];
               //* (latticeData->GetFNew(GetBBIndex(site.GetIndex(), direction))) = hydroVars.GetFPostCollision()[direction];
               //return (siteIndex * LatticeType::NUMVECTORS) + LatticeType::INVERSEDIRECTIONS[direction];
             }
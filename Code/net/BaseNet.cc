@@ -63,10 +63,73 @@ namespace hemelb
       WaitPointToPoint();
       WaitAllToAll();
 
+      // Anyone not told yet, because their rank had no communication or the implementation
+      // can't tell ranks apart, can go now that everything is done.
+      while (!exchangeListeners.empty())
+      {
+        NotifyExchangeComplete(exchangeListeners.begin()->first);
+      }
+
       displacementsBuffer.clear();
       countsBuffer.clear();
     }
 
+    void BaseNet::RequestExchangeNotification(proc_t rank, ExchangeListener& listener)
+    {
+      exchangeListeners.insert(std::make_pair(rank, &listener));
+    }
+
+    void BaseNet::NotifyExchangeComplete(proc_t rank)
+    {
+      std::pair<std::multimap<proc_t, ExchangeListener*>::iterator,
+          std::multimap<proc_t, ExchangeListener*>::iterator> listeners = exchangeListeners.equal_range(rank);
+      // Take them out first, so that each is told only once.
+      std::vector<ExchangeListener*> toNotify;
+      for (std::multimap<proc_t, ExchangeListener*>::iterator it = listeners.first; it != listeners.second; ++it)
+      {
+        toNotify.push_back(it->second);
+      }
+      exchangeListeners.erase(listeners.first, listeners.second);
+
+      for (std::vector<ExchangeListener*>::iterator listener = toNotify.begin(); listener != toNotify.end(); ++listener)
+      {
+        (*listener)->ExchangeComplete(rank);
+      }
+    }
+
+    void BaseNet::WaitAllNotifying(int count, MPI_Request* requests, const proc_t* requestRanks,
+                                   MPI_Status* statuses)
+    {
+      if (exchangeListeners.empty())
+      {
+        HEMELB_MPI_CALL(MPI_Waitall, (count, requests, statuses));
+        return;
+      }
+
+      outstandingRequests.clear();
+      for (int request = 0; request < count; ++request)
+      {
+        ++outstandingRequests[requestRanks[request]];
+      }
+
+      completedIndices.resize(count);
+      int remaining = count;
+      while (remaining > 0)
+      {
+        int completedCount;
+        HEMELB_MPI_CALL(MPI_Waitsome, (count, requests, &completedCount, &completedIndices[0], statuses));
+        for (int completed = 0; completed < completedCount; ++completed)
+        {
+          const proc_t rank = requestRanks[completedIndices[completed]];
+          if (--outstandingRequests[rank] == 0)
+          {
+            NotifyExchangeComplete(rank);
+          }
+        }
+        remaining -= completedCount;
+      }
+    }
+
     std::vector<int> & BaseNet::GetDisplacementsBuffer()
     {
       displacementsBuffer.push_back(std::vector<int>());
@@ -15,6 +15,7 @@
 #include "constants.h"
 #include "net/mpi.h"
 #include "net/MpiCommunicator.h"
+#include "net/ExchangeListener.h"
 
 namespace hemelb
 {
@@ -44,6 +45,31 @@ namespace hemelb
          */
         void Dispatch();
 
+        /**
+         * Ask to be told, during the next Wait, as soon as the point-to-point communication with
+         * a rank has completed, so that work on it can start while other ranks' messages are
+         * still in flight. Implementations that can't tell ranks apart notify at the end of the
+         * Wait. Requests last for one Wait only.
+         *
+         * @param rank
+         * @param listener
+         */
+        void RequestExchangeNotification(proc_t rank, ExchangeListener& listener);
+
+        /**
+         * Tell the Net which ranks this one regularly exchanges point-to-point data with, in both
+         * directions (e.g. the ranks sharing the halo of the lattice). Implementations that can
+         * make use of a fixed neighbourhood may do so; the default ignores it.
+         *
+         * This is collective: every rank of the communicator must call it together, and may
+         * need to go through every subsequent Send / Receive / Wait together too.
+         *
+         * @param neighbours
+         */
+        virtual void DeclareNeighbourhood(const std::vector<proc_t>& neighbours)
+        {
+        }
+
         inline const MpiCommunicator &GetCommunicator() const
         {
           return communicator;
@@ -92,6 +118,25 @@ namespace hemelb
         virtual void RequestAllToAllReceiveImpl(void * buffer,int count,MPI_Datatype type)=0;
         virtual void RequestAllToAllSendImpl(void * buffer,int count,MPI_Datatype type)=0;
 
+        /**
+         * Tell the listeners for a rank that its exchange is complete, once.
+         *
+         * @param rank
+         */
+        void NotifyExchangeComplete(proc_t rank);
+
+        /**
+         * Wait for a set of point-to-point requests, notifying the listeners for each rank as
+         * soon as all of its requests have completed.
+         *
+         * @param count The number of requests.
+         * @param requests
+         * @param requestRanks The rank each request communicates with.
+         * @param statuses
+         */
+        void WaitAllNotifying(int count, MPI_Request* requests, const proc_t* requestRanks,
+                              MPI_Status* statuses);
+
         std::vector<int> & GetDisplacementsBuffer();
         std::vector<int> & GetCountsBuffer();
 
@@ -103,6 +148,11 @@ namespace hemelb
          */
         std::vector<std::vector<int> > displacementsBuffer;
         std::vector<std::vector<int> > countsBuffer;
+
+        std::multimap<proc_t, ExchangeListener*> exchangeListeners;
+        //! For WaitAllNotifying: the indices of completed requests, and the requests left for each rank.
+        std::vector<int> completedIndices;
+        std::map<proc_t, int> outstandingRequests;
     };
   }
 }
@@ -0,0 +1,53 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "net/CollectiveAction.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    CollectiveAction::CollectiveAction(const MpiCommunicator& comms) :
+        collectiveComms(comms.Duplicate()), request(MPI_REQUEST_NULL), collectiveStarted(false)
+    {
+    }
+
+    CollectiveAction::~CollectiveAction()
+    {
+      // Every rank destroys its actions together, so this can't be left hanging.
+      MPI_Wait(&request, MPI_STATUS_IGNORE);
+    }
+
+    void CollectiveAction::RequestComms()
+    {
+      // Give MPI the chance to progress the collective; it is finished off in PostReceive.
+      if (request != MPI_REQUEST_NULL)
+      {
+        int done;
+        HEMELB_MPI_CALL(MPI_Test, (&request, &done, MPI_STATUS_IGNORE));
+      }
+    }
+
+    void CollectiveAction::PostReceive()
+    {
+      // MPI_Test sets the request to null once it has completed, in which case the result has
+      // arrived but hasn't been used yet. Either way, there is one only after the first iteration.
+      if (collectiveStarted)
+      {
+        HEMELB_MPI_CALL(MPI_Wait, (&request, MPI_STATUS_IGNORE));
+        CollectiveComplete();
+      }
+      StartCollective();
+      collectiveStarted = true;
+    }
+
+    void CollectiveAction::AbandonCollective()
+    {
+      HEMELB_MPI_CALL(MPI_Wait, (&request, MPI_STATUS_IGNORE));
+      collectiveStarted = false;
+    }
+  }
+}
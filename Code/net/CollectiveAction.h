@@ -0,0 +1,88 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_COLLECTIVEACTION_H
+#define HEMELB_NET_COLLECTIVEACTION_H
+
+#include "net/IteratedAction.h"
+#include "net/MpiCommunicator.h"
+#include "net/MpiConstness.h"
+#include "net/MpiDataType.h"
+#include "net/MpiError.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * CollectiveAction - a base for IteratedActions that combine values from every rank with a
+     * non-blocking MPI collective, as an alternative to the tree of PhasedBroadcast.
+     *
+     * On each iteration, PostReceive completes the collective started on the previous iteration
+     * and passes its result to CollectiveComplete; it then calls StartCollective, for the
+     * derived class to work out this rank's contribution and start the next one. RequestComms
+     * tests the collective in flight, so that MPI can progress it alongside the iteration's other
+     * communication and computation. Results are therefore always one iteration old, however
+     * many ranks there are, rather than taking twice the depth of a tree to arrive.
+     *
+     * Each action works on its own duplicate of the communicator, so that its collectives can't
+     * be matched with anybody else's. As with any collective, every rank must take part, which
+     * the step manager ensures.
+     */
+    class CollectiveAction : public IteratedAction
+    {
+      public:
+        virtual ~CollectiveAction();
+
+        void RequestComms();
+        void PostReceive();
+
+      protected:
+        CollectiveAction(const MpiCommunicator& comms);
+
+        /**
+         * Work out this rank's contribution and start the collective, using one of the Start
+         * functions below.
+         */
+        virtual void StartCollective() = 0;
+
+        /**
+         * Use the result of the collective started on the previous iteration.
+         */
+        virtual void CollectiveComplete() = 0;
+
+        /**
+         * Start an all-reduce of count elements, whose result will be in receive on every rank
+         * when CollectiveComplete is called.
+         *
+         * @param send
+         * @param receive
+         * @param count
+         * @param op
+         */
+        template<class T>
+        void StartAllReduce(const T* send, T* receive, int count, MPI_Op op)
+        {
+          HEMELB_MPI_CALL(MPI_Iallreduce,
+                          (MpiConstCast(send), receive, count, MpiDataType<T>(), op, collectiveComms, &request));
+        }
+
+        /**
+         * Finish any collective in flight without using its result, e.g. on a reset.
+         */
+        void AbandonCollective();
+
+        const MpiCommunicator collectiveComms;
+
+      private:
+        MPI_Request request;
+        //! Whether a collective has been started whose result hasn't been used yet.
+        bool collectiveStarted;
+    };
+  }
+}
+
+#endif /* HEMELB_NET_COLLECTIVEACTION_H */
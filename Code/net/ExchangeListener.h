@@ -0,0 +1,37 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_EXCHANGELISTENER_H
+#define HEMELB_NET_EXCHANGELISTENER_H
+
+#include "constants.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * Something that wants to be told, during a Net's Wait, when the point-to-point
+     * communication with a rank has completed: see BaseNet::RequestExchangeNotification.
+     */
+    class ExchangeListener
+    {
+      public:
+        virtual ~ExchangeListener()
+        {
+        }
+
+        /**
+         * Everything requested to be sent to and received from the rank this round has
+         * completed, so the received data can be used and the send buffers reused.
+         *
+         * @param rank
+         */
+        virtual void ExchangeComplete(proc_t rank) = 0;
+    };
+  }
+}
+
+#endif /* HEMELB_NET_EXCHANGELISTENER_H */
@@ -111,5 +111,19 @@ namespace hemelb
       HEMELB_MPI_CALL(MPI_Comm_dup, (*commPtr, &newComm));
       return MpiCommunicator(newComm, true);
     }
+
+    MpiCommunicator MpiCommunicator::SplitShared() const
+    {
+      MPI_Comm newComm;
+      HEMELB_MPI_CALL(MPI_Comm_split_type, (*commPtr, MPI_COMM_TYPE_SHARED, Rank(), MPI_INFO_NULL, &newComm));
+      return MpiCommunicator(newComm, true);
+    }
+
+    MpiCommunicator MpiCommunicator::Split(int colour, int key) const
+    {
+      MPI_Comm newComm;
+      HEMELB_MPI_CALL(MPI_Comm_split, (*commPtr, colour, key, &newComm));
+      return MpiCommunicator(newComm, true);
+    }
   }
 }
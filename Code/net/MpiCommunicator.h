@@ -88,6 +88,22 @@ namespace hemelb
          */
         MpiCommunicator Duplicate() const;
 
+        /**
+         * Split the communicator into the groups of ranks that can share memory, i.e. those on
+         * the same node - see MPI_COMM_SPLIT_TYPE with MPI_COMM_TYPE_SHARED. Ranks keep their
+         * relative order.
+         * @return
+         */
+        MpiCommunicator SplitShared() const;
+
+        /**
+         * Split the communicator into one for each colour - see MPI_COMM_SPLIT.
+         * @param colour
+         * @param key Orders the ranks within each new communicator.
+         * @return
+         */
+        MpiCommunicator Split(int colour, int key) const;
+
         template <typename T>
         void Broadcast(T& val, const int root) const;
         template <typename T>
@@ -103,15 +119,46 @@ namespace hemelb
         template <typename T>
         std::vector<T> Reduce(const std::vector<T>& vals, const MPI_Op& op, const int root) const;
 
+        /**
+         * Combine the values on all the lower ranks - see MPI_EXSCAN.
+         * @param val
+         * @param op
+         * @return The combination of the values of ranks 0 to Rank() - 1, or T() on rank 0.
+         */
+        template <typename T>
+        T ExclusiveScan(const T& val, const MPI_Op& op) const;
+
         template <typename T>
         std::vector<T> Gather(const T& val, const int root) const;
 
+        /**
+         * Gather variable amounts of data onto one rank - see MPI_GATHERV.
+         * @param vals This rank's data.
+         * @param receiveCounts How much comes from each rank; only needed on the root.
+         * @param root
+         * @return The data from every rank, in rank order, on the root; empty elsewhere.
+         */
+        template <typename T>
+        std::vector<T> GatherV(const std::vector<T>& vals, const std::vector<int>& receiveCounts,
+                               const int root) const;
+
         template <typename T>
         std::vector<T> AllGather(const T& val) const;
 
         template <typename T>
         std::vector<T> AllToAll(const std::vector<T>& vals) const;
 
+        /**
+         * Exchange variable amounts of data between every pair of ranks - see MPI_ALLTOALLV.
+         * @param vals The data to send, in order of destination rank.
+         * @param sendCounts How much of it goes to each rank.
+         * @param receiveCounts How much will come from each rank.
+         * @return The data received, in order of source rank.
+         */
+        template <typename T>
+        std::vector<T> AllToAllV(const std::vector<T>& vals, const std::vector<int>& sendCounts,
+                                 const std::vector<int>& receiveCounts) const;
+
         template <typename T>
         void Send(const T& val, int dest, int tag=0) const;
         template <typename T>
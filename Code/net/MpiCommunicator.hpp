@@ -84,6 +84,22 @@ namespace hemelb
       return ans;
     }
 
+    template<typename T>
+    T MpiCommunicator::ExclusiveScan(const T& val, const MPI_Op& op) const
+    {
+      T ans = T();
+      HEMELB_MPI_CALL(
+          MPI_Exscan,
+          (MpiConstCast(&val), &ans, 1, MpiDataType<T>(), op, *this)
+      );
+      // The standard leaves the result on rank 0 undefined.
+      if (Rank() == 0)
+      {
+        ans = T();
+      }
+      return ans;
+    }
+
     template<typename T>
     std::vector<T> MpiCommunicator::Gather(const T& val, const int root) const
     {
@@ -105,6 +121,35 @@ namespace hemelb
       return ans;
     }
 
+    template<typename T>
+    std::vector<T> MpiCommunicator::GatherV(const std::vector<T>& vals,
+                                            const std::vector<int>& receiveCounts,
+                                            const int root) const
+    {
+      std::vector<T> ans;
+      std::vector<int> receiveDisplacements;
+      if (Rank() == root)
+      {
+        // Standard says the receive arguments only matter at the root.
+        receiveDisplacements.resize(Size());
+        int totalReceived = 0;
+        for (int rank = 0; rank < Size(); ++rank)
+        {
+          receiveDisplacements[rank] = totalReceived;
+          totalReceived += receiveCounts[rank];
+        }
+        ans.resize(totalReceived);
+      }
+      HEMELB_MPI_CALL(
+          MPI_Gatherv,
+          (MpiConstCast(vals.empty() ? NULL : &vals[0]), vals.size(), MpiDataType<T>(),
+           ans.empty() ? NULL : &ans[0], Rank() == root ? MpiConstCast(&receiveCounts[0]) : NULL,
+           receiveDisplacements.empty() ? NULL : &receiveDisplacements[0], MpiDataType<T>(),
+           root, *this)
+      );
+      return ans;
+    }
+
     template<typename T>
     std::vector<T> MpiCommunicator::AllGather(const T& val) const
     {
@@ -133,6 +178,30 @@ namespace hemelb
       return ans;
     }
 
+    template <typename T>
+    std::vector<T> MpiCommunicator::AllToAllV(const std::vector<T>& vals, const std::vector<int>& sendCounts,
+                                              const std::vector<int>& receiveCounts) const
+    {
+      std::vector<int> sendDisplacements(sendCounts.size());
+      std::vector<int> receiveDisplacements(receiveCounts.size());
+      int totalReceived = 0;
+      for (size_t rank = 0; rank < sendCounts.size(); ++rank)
+      {
+        sendDisplacements[rank] = rank == 0 ? 0 : sendDisplacements[rank - 1] + sendCounts[rank - 1];
+        receiveDisplacements[rank] = totalReceived;
+        totalReceived += receiveCounts[rank];
+      }
+
+      std::vector<T> ans(totalReceived);
+      HEMELB_MPI_CALL(
+          MPI_Alltoallv,
+          (MpiConstCast(vals.empty() ? NULL : &vals[0]), MpiConstCast(&sendCounts[0]), &sendDisplacements[0], MpiDataType<T>(),
+           ans.empty() ? NULL : &ans[0], MpiConstCast(&receiveCounts[0]), &receiveDisplacements[0], MpiDataType<T>(),
+           *this)
+      );
+      return ans;
+    }
+
     template <typename T>
     void MpiCommunicator::Send(const T& val, int dest, int tag) const
     {
@@ -4,10 +4,14 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 #include <mpi.h>
+#ifdef HEMELB_USE_OPENMP
+  #include <omp.h>
+#endif
 
 #include "net/MpiEnvironment.h"
 #include "net/MpiError.h"
 #include "net/MpiCommunicator.h"
+#include "log/Logger.h"
 
 namespace hemelb
 {
@@ -19,9 +23,25 @@ namespace hemelb
     {
       if (!Initialized())
       {
+#ifdef HEMELB_USE_OPENMP
+        // Only the master thread makes MPI calls; the threads only share the site loops.
+        int provided;
+        HEMELB_MPI_CALL(MPI_Init_thread, (&argc, &argv, MPI_THREAD_FUNNELED, &provided));
+#else
         HEMELB_MPI_CALL(MPI_Init, (&argc, &argv));
+#endif
         HEMELB_MPI_CALL(MPI_Comm_set_errhandler, (MPI_COMM_WORLD, MPI_ERRORS_RETURN));
         doesOwnMpi = true;
+#ifdef HEMELB_USE_OPENMP
+        // Without that guarantee, MPI calls from a threaded process aren't safe: run one thread.
+        if (provided < MPI_THREAD_FUNNELED)
+        {
+          omp_set_num_threads(1);
+          log::Logger::Init();
+          log::Logger::Log<log::Warning, log::OnePerCore>("MPI provides thread support level %i, below MPI_THREAD_FUNNELED; using a single thread",
+                                                          provided);
+        }
+#endif
       }
     }
 
@@ -51,11 +51,38 @@ namespace hemelb
         void Read(std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
         template<typename T>
         void ReadAt(MPI_Offset offset, std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
+        /**
+         * Read at an offset with MPI_File_read_at_all. A collective operation: every rank must
+         * call it, though the buffer may be empty.
+         */
+        template<typename T>
+        void ReadAtAll(MPI_Offset offset, std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
 
         template<typename T>
         void Write(const std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
         template<typename T>
         void WriteAt(MPI_Offset offset, const std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
+
+        /**
+         * Write part of a buffer at an offset with MPI_File_write_at.
+         * @param offset
+         * @param data
+         * @param count
+         * @param stat
+         */
+        template<typename T>
+        void WriteAt(MPI_Offset offset, const T* data, int count, MPI_Status* stat = MPI_STATUS_IGNORE);
+
+        /**
+         * Start writing at an offset with MPI_File_iwrite_at. The data mustn't be changed
+         * until the request has completed.
+         * @param offset
+         * @param data
+         * @param count
+         * @param request
+         */
+        template<typename T>
+        void IWriteAt(MPI_Offset offset, const T* data, int count, MPI_Request* request);
       protected:
         MpiFile(const MpiCommunicator& parentComm, MPI_File fh);
 
@@ -30,6 +30,14 @@ namespace hemelb
           (*filePtr, offset, &buffer[0], buffer.size(), MpiDataType<T>(), stat)
       );
     }
+    template<typename T>
+    void MpiFile::ReadAtAll(MPI_Offset offset, std::vector<T>& buffer, MPI_Status* stat)
+    {
+      HEMELB_MPI_CALL(
+          MPI_File_read_at_all,
+          (*filePtr, offset, buffer.empty() ? NULL : &buffer[0], buffer.size(), MpiDataType<T>(), stat)
+      );
+    }
 
     template<typename T>
     void MpiFile::Write(const std::vector<T>& buffer, MPI_Status* stat)
@@ -48,6 +56,22 @@ namespace hemelb
       );
 
     }
+    template<typename T>
+    void MpiFile::WriteAt(MPI_Offset offset, const T* data, int count, MPI_Status* stat)
+    {
+      HEMELB_MPI_CALL(
+          MPI_File_write_at,
+          (*filePtr, offset, MpiConstCast(data), count, MpiDataType<T>(), stat)
+      );
+    }
+    template<typename T>
+    void MpiFile::IWriteAt(MPI_Offset offset, const T* data, int count, MPI_Request* request)
+    {
+      HEMELB_MPI_CALL(
+          MPI_File_iwrite_at,
+          (*filePtr, offset, MpiConstCast(data), count, MpiDataType<T>(), request)
+      );
+    }
 
   }
 }
@@ -27,6 +27,15 @@ namespace hemelb
         }
     };
 
+    /**
+     * Requests are the same if they would communicate the same memory in the same way.
+     */
+    inline bool operator==(const SimpleRequest& left, const SimpleRequest& right)
+    {
+      return left.Pointer == right.Pointer && left.Count == right.Count && left.Type == right.Type
+          && left.Rank == right.Rank;
+    }
+
     class ScalarRequest : public SimpleRequest
     {
       public:
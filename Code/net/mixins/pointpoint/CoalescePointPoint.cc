@@ -18,6 +18,7 @@ namespace hemelb
       {
         requests.resize(count, MPI_Request());
         statuses.resize(count, MPI_Status());
+        requestRanks.resize(count);
       }
     }
 
@@ -39,6 +40,7 @@ namespace hemelb
                   10,
                   communicator,
                   &requests[m]);
+        requestRanks[m] = it->first;
         ++m;
       }
 
@@ -94,6 +96,7 @@ namespace hemelb
                   10,
                   communicator,
                   &requests[receiveProcessorComms.size() + m]);
+        requestRanks[receiveProcessorComms.size() + m] = it->first;
 
         ++m;
       }
@@ -124,7 +127,10 @@ namespace hemelb
     void CoalescePointPoint::WaitPointToPoint()
     {
 
-      MPI_Waitall((int) (sendProcessorComms.size() + receiveProcessorComms.size()), &requests[0], &statuses[0]);
+      WaitAllNotifying((int) (sendProcessorComms.size() + receiveProcessorComms.size()),
+                       &requests[0],
+                       &requestRanks[0],
+                       &statuses[0]);
 
       for (std::map<proc_t, ProcComms>::iterator it = receiveProcessorComms.begin(); it != receiveProcessorComms.end();
           ++it)
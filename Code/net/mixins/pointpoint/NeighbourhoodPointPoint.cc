@@ -0,0 +1,224 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <map>
+#include "net/mixins/pointpoint/NeighbourhoodPointPoint.h"
+#include "net/ProcComms.h"
+#include "log/Logger.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    namespace
+    {
+      // MPI is happy with anything for a zero-length array, but &v[0] on an empty vector isn't.
+      template<class T>
+      T* DataOrNull(std::vector<T>& vector)
+      {
+        return vector.empty() ?
+          NULL :
+          &vector[0];
+      }
+    }
+
+    NeighbourhoodPointPoint::NeighbourhoodPointPoint(const MpiCommunicator& comms) :
+        BaseNet(comms), StoringNet(comms), neighbourhoodComm(MPI_COMM_NULL), neighbourCount(0),
+            currentPlan(NULL), collectiveRequest(MPI_REQUEST_NULL)
+    {
+    }
+
+    void NeighbourhoodPointPoint::DeclareNeighbourhood(const std::vector<proc_t>& neighbours)
+    {
+      // The plans refer to neighbours by their index, so can't outlive the neighbourhood.
+      FreePlans();
+      if (neighbourhoodComm != MPI_COMM_NULL)
+      {
+        HEMELB_MPI_CALL(MPI_Comm_free, (&neighbourhoodComm));
+      }
+
+      neighbourIndices.assign(communicator.Size(), -1);
+      for (size_t neighbour = 0; neighbour < neighbours.size(); ++neighbour)
+      {
+        neighbourIndices[neighbours[neighbour]] = (int) neighbour;
+      }
+      neighbourCount = neighbours.size();
+
+      // The halo is symmetric, so we receive from the same ranks we send to. Don't let MPI
+      // reorder the ranks, as the requests are made with ranks in the original communicator.
+      std::vector<int> ranks(neighbours.begin(), neighbours.end());
+      HEMELB_MPI_CALL(MPI_Dist_graph_create_adjacent,
+                      (communicator, (int) ranks.size(), DataOrNull(ranks), MPI_UNWEIGHTED, (int) ranks.size(), DataOrNull(ranks), MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &neighbourhoodComm));
+    }
+
+    void NeighbourhoodPointPoint::RequestSendImpl(void* pointer, int count, proc_t rank,
+                                                  MPI_Datatype type)
+    {
+      if (count > 0)
+      {
+        sends.push_back(SimpleRequest(pointer, count, type, rank));
+      }
+    }
+
+    void NeighbourhoodPointPoint::RequestReceiveImpl(void* pointer, int count, proc_t rank,
+                                                     MPI_Datatype type)
+    {
+      if (count > 0)
+      {
+        receives.push_back(SimpleRequest(pointer, count, type, rank));
+      }
+    }
+
+    void NeighbourhoodPointPoint::ReceivePointToPoint()
+    {
+      EnsurePlanSelected();
+      PostOthers(currentPlan->otherReceives, false);
+    }
+
+    void NeighbourhoodPointPoint::SendPointToPoint()
+    {
+      EnsurePlanSelected();
+      PostOthers(currentPlan->otherSends, true);
+
+      // The collective does the neighbours' receives as well as the sends, so has to wait
+      // until the data to send is ready.
+      if (neighbourhoodComm != MPI_COMM_NULL)
+      {
+        HEMELB_MPI_CALL(MPI_Ineighbor_alltoallw,
+                        (MPI_BOTTOM, DataOrNull(currentPlan->sendCounts), DataOrNull(currentPlan->sendDisplacements), DataOrNull(currentPlan->sendTypes), MPI_BOTTOM, DataOrNull(currentPlan->receiveCounts), DataOrNull(currentPlan->receiveDisplacements), DataOrNull(currentPlan->receiveTypes), neighbourhoodComm, &collectiveRequest));
+      }
+      BytesSent += currentPlan->bytesSent; //DTMP:
+    }
+
+    void NeighbourhoodPointPoint::PostOthers(const std::vector<SimpleRequest>& others, bool send)
+    {
+      for (std::vector<SimpleRequest>::const_iterator request = others.begin(); request != others.end(); ++request)
+      {
+        requests.push_back(MPI_REQUEST_NULL);
+        requestRanks.push_back(request->Rank);
+        if (send)
+        {
+          HEMELB_MPI_CALL(MPI_Isend,
+                          (request->Pointer, request->Count, request->Type, request->Rank, 10, communicator, &requests.back()));
+        }
+        else
+        {
+          HEMELB_MPI_CALL(MPI_Irecv,
+                          (request->Pointer, request->Count, request->Type, request->Rank, 10, communicator, &requests.back()));
+        }
+      }
+    }
+
+    void NeighbourhoodPointPoint::WaitPointToPoint()
+    {
+      if (!requests.empty())
+      {
+        statuses.resize(requests.size());
+        WaitAllNotifying((int) requests.size(), &requests[0], &requestRanks[0], &statuses[0]);
+      }
+      // The collective can't say which neighbour finished first, so the neighbours' listeners
+      // are told at the end of the Wait.
+      if (collectiveRequest != MPI_REQUEST_NULL)
+      {
+        HEMELB_MPI_CALL(MPI_Wait, (&collectiveRequest, MPI_STATUS_IGNORE));
+      }
+
+      // Clearing keeps the capacity, so the next exchange doesn't allocate.
+      requests.clear();
+      requestRanks.clear();
+      sends.clear();
+      receives.clear();
+      currentPlan = NULL;
+    }
+
+    // Finds the plan for the requests made since the last Wait, building it if there isn't one.
+    void NeighbourhoodPointPoint::EnsurePlanSelected()
+    {
+      if (currentPlan != NULL)
+      {
+        return;
+      }
+
+      bool isNew;
+      currentPlan = &plans.Select(sends, receives, isNew);
+      if (isNew)
+      {
+        BuildPlan(*currentPlan);
+      }
+    }
+
+    void NeighbourhoodPointPoint::BuildPlan(Plan& plan)
+    {
+      AddNeighbourTypes(plan.sends,
+                        plan.sendCounts,
+                        plan.sendDisplacements,
+                        plan.sendTypes,
+                        plan.otherSends,
+                        plan);
+      AddNeighbourTypes(plan.receives,
+                        plan.receiveCounts,
+                        plan.receiveDisplacements,
+                        plan.receiveTypes,
+                        plan.otherReceives,
+                        plan);
+    }
+
+    // Coalesces the requests for each neighbour into a struct datatype, placed by its absolute
+    // address so the collective can use MPI_BOTTOM for every buffer. Neighbours with nothing
+    // get a count of zero; requests for other ranks are put aside for Isend / Irecv.
+    void NeighbourhoodPointPoint::AddNeighbourTypes(const std::vector<SimpleRequest>& requests,
+                                                    std::vector<int>& counts,
+                                                    std::vector<MPI_Aint>& displacements,
+                                                    std::vector<MPI_Datatype>& datatypes,
+                                                    std::vector<SimpleRequest>& others, Plan& plan)
+    {
+      counts.assign(neighbourCount, 0);
+      displacements.assign(neighbourCount, 0);
+      datatypes.assign(neighbourCount, MPI_BYTE);
+
+      std::map<int, ProcComms> perNeighbour;
+      for (std::vector<SimpleRequest>::const_iterator request = requests.begin(); request != requests.end();
+          ++request)
+      {
+        if (neighbourhoodComm != MPI_COMM_NULL && neighbourIndices[request->Rank] >= 0)
+        {
+          perNeighbour[neighbourIndices[request->Rank]].push_back(*request);
+        }
+        else
+        {
+          others.push_back(*request);
+        }
+      }
+
+      for (std::map<int, ProcComms>::iterator it = perNeighbour.begin(); it != perNeighbour.end(); ++it)
+      {
+        it->second.CreateMPIType();
+        plan.types.push_back(it->second.Type);
+        counts[it->first] = 1;
+        MPI_Get_address(it->second.front().Pointer, &displacements[it->first]);
+        datatypes[it->first] = it->second.Type;
+      }
+    }
+
+    void NeighbourhoodPointPoint::FreePlans()
+    {
+      plans.Clear();
+      currentPlan = NULL;
+    }
+
+    /*!
+     Free the allocated data.
+     */
+    NeighbourhoodPointPoint::~NeighbourhoodPointPoint()
+    {
+      FreePlans();
+      if (neighbourhoodComm != MPI_COMM_NULL)
+      {
+        MPI_Comm_free(&neighbourhoodComm);
+      }
+    }
+  }
+}
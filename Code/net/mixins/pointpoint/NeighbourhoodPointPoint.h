@@ -0,0 +1,99 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_MIXINS_POINTPOINT_NEIGHBOURHOODPOINTPOINT_H
+#define HEMELB_NET_MIXINS_POINTPOINT_NEIGHBOURHOODPOINTPOINT_H
+#include <vector>
+#include "net/BaseNet.h"
+#include "net/mixins/StoringNet.h"
+#include "net/mixins/pointpoint/PlanCache.h"
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * Point-to-point communication using an MPI-3 neighbourhood collective.
+     *
+     * Once a neighbourhood has been declared, a distributed graph communicator is built over
+     * it, and each exchange sends everything for the neighbours with a single
+     * MPI_Ineighbor_alltoallw, one struct datatype per neighbour. The MPI library then knows
+     * the whole pattern and can schedule it for the network. Requests to ranks outside the
+     * neighbourhood, and every request before a neighbourhood is declared, use Isend / Irecv.
+     *
+     * The collective means that, after declaring a neighbourhood, all ranks must go through
+     * each exchange on this Net together, even those with nothing to send - as they do for the
+     * step manager's phases.
+     *
+     * The datatypes for a set of requests are kept in a PlanCache, as in PersistentPointPoint,
+     * so that a repeated exchange doesn't rebuild them.
+     */
+    class NeighbourhoodPointPoint : public virtual StoringNet
+    {
+
+      public:
+        NeighbourhoodPointPoint(const MpiCommunicator& comms);
+        ~NeighbourhoodPointPoint();
+
+        void WaitPointToPoint();
+        // The requests are recorded flat, so they can be compared with the stored plans.
+        virtual void RequestSendImpl(void* pointer, int count, proc_t rank, MPI_Datatype type);
+        virtual void RequestReceiveImpl(void* pointer, int count, proc_t rank, MPI_Datatype type);
+
+        void DeclareNeighbourhood(const std::vector<proc_t>& neighbours);
+
+      protected:
+        void ReceivePointToPoint();
+        void SendPointToPoint();
+
+      private:
+        struct Plan : public PointPointPlan
+        {
+            //! Arguments to the collective, one per neighbour.
+            std::vector<int> sendCounts;
+            std::vector<MPI_Aint> sendDisplacements;
+            std::vector<MPI_Datatype> sendTypes;
+            std::vector<int> receiveCounts;
+            std::vector<MPI_Aint> receiveDisplacements;
+            std::vector<MPI_Datatype> receiveTypes;
+            //! The requests for ranks outside the neighbourhood.
+            std::vector<SimpleRequest> otherSends;
+            std::vector<SimpleRequest> otherReceives;
+
+            void Free()
+            {
+              FreeTypes();
+            }
+        };
+
+        void EnsurePlanSelected();
+        void BuildPlan(Plan& plan);
+        void AddNeighbourTypes(const std::vector<SimpleRequest>& requests, std::vector<int>& counts,
+                               std::vector<MPI_Aint>& displacements, std::vector<MPI_Datatype>& datatypes,
+                               std::vector<SimpleRequest>& others, Plan& plan);
+        void FreePlans();
+        void PostOthers(const std::vector<SimpleRequest>& requests, bool send);
+
+        //! The graph communicator over the neighbourhood, or MPI_COMM_NULL if none is declared.
+        MPI_Comm neighbourhoodComm;
+        //! For each rank of the communicator, its index among the neighbours, or -1.
+        std::vector<int> neighbourIndices;
+        size_t neighbourCount;
+
+        std::vector<SimpleRequest> sends;
+        std::vector<SimpleRequest> receives;
+        PlanCache<Plan> plans;
+        Plan* currentPlan;
+
+        //! The requests in flight: Isends and Irecvs, then the collective if there is one.
+        std::vector<MPI_Request> requests;
+        std::vector<proc_t> requestRanks;
+        std::vector<MPI_Status> statuses;
+        MPI_Request collectiveRequest;
+    };
+  }
+}
+
+#endif
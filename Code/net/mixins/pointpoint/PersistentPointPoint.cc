@@ -0,0 +1,137 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <map>
+#include "net/mixins/pointpoint/PersistentPointPoint.h"
+#include "net/ProcComms.h"
+#include "log/Logger.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    void PersistentPointPoint::RequestSendImpl(void* pointer, int count, proc_t rank, MPI_Datatype type)
+    {
+      if (count > 0)
+      {
+        sends.push_back(SimpleRequest(pointer, count, type, rank));
+      }
+    }
+
+    void PersistentPointPoint::RequestReceiveImpl(void* pointer, int count, proc_t rank,
+                                                  MPI_Datatype type)
+    {
+      if (count > 0)
+      {
+        receives.push_back(SimpleRequest(pointer, count, type, rank));
+      }
+    }
+
+    void PersistentPointPoint::ReceivePointToPoint()
+    {
+      EnsurePlanSelected();
+      if (currentPlan->receiveCount > 0)
+      {
+        HEMELB_MPI_CALL(MPI_Startall, (currentPlan->receiveCount, &currentPlan->requests[0]));
+      }
+    }
+
+    void PersistentPointPoint::SendPointToPoint()
+    {
+      EnsurePlanSelected();
+      if (currentPlan->sendCount > 0)
+      {
+        HEMELB_MPI_CALL(MPI_Startall,
+                        (currentPlan->sendCount, &currentPlan->requests[currentPlan->receiveCount]));
+      }
+      BytesSent += currentPlan->bytesSent; //DTMP:
+    }
+
+    void PersistentPointPoint::WaitPointToPoint()
+    {
+      if (currentPlan != NULL && !currentPlan->requests.empty())
+      {
+        WaitAllNotifying((int) currentPlan->requests.size(),
+                         &currentPlan->requests[0],
+                         &currentPlan->requestRanks[0],
+                         &currentPlan->statuses[0]);
+      }
+
+      // Clearing keeps the capacity, so recording the next exchange doesn't allocate.
+      sends.clear();
+      receives.clear();
+      currentPlan = NULL;
+    }
+
+    // Finds the plan for the requests made since the last Wait, building it if there isn't one.
+    void PersistentPointPoint::EnsurePlanSelected()
+    {
+      if (currentPlan != NULL)
+      {
+        return;
+      }
+
+      bool isNew;
+      currentPlan = &plans.Select(sends, receives, isNew);
+      if (isNew)
+      {
+        BuildPlan(*currentPlan);
+      }
+    }
+
+    void PersistentPointPoint::BuildPlan(Plan& plan)
+    {
+      AddPerRankRequests(plan.receives, plan, false, communicator);
+      plan.receiveCount = (int) plan.requests.size();
+      AddPerRankRequests(plan.sends, plan, true, communicator);
+      plan.sendCount = (int) plan.requests.size() - plan.receiveCount;
+
+      plan.statuses.resize(plan.requests.size(), MPI_Status());
+    }
+
+    // Coalesces the requests for each rank into one struct datatype and makes a persistent
+    // request for it, in rank order as CoalescePointPoint does.
+    void PersistentPointPoint::AddPerRankRequests(const std::vector<SimpleRequest>& requests,
+                                                  Plan& plan, bool send,
+                                                  const MpiCommunicator& communicator)
+    {
+      std::map<proc_t, ProcComms> perRank;
+      for (std::vector<SimpleRequest>::const_iterator request = requests.begin(); request != requests.end();
+          ++request)
+      {
+        perRank[request->Rank].push_back(*request);
+      }
+
+      for (std::map<proc_t, ProcComms>::iterator it = perRank.begin(); it != perRank.end(); ++it)
+      {
+        it->second.CreateMPIType();
+        plan.types.push_back(it->second.Type);
+        plan.requests.push_back(MPI_REQUEST_NULL);
+        plan.requestRanks.push_back(it->first);
+
+        if (send)
+        {
+          HEMELB_MPI_CALL(MPI_Send_init,
+                          (it->second.front().Pointer, 1, it->second.Type, it->first, 10, communicator, &plan.requests.back()));
+        }
+        else
+        {
+          HEMELB_MPI_CALL(MPI_Recv_init,
+                          (it->second.front().Pointer, 1, it->second.Type, it->first, 10, communicator, &plan.requests.back()));
+        }
+      }
+    }
+
+    void PersistentPointPoint::Plan::Free()
+    {
+      for (std::vector<MPI_Request>::iterator request = requests.begin(); request != requests.end(); ++request)
+      {
+        MPI_Request_free(&*request);
+      }
+      FreeTypes();
+    }
+  }
+}
@@ -0,0 +1,85 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_MIXINS_POINTPOINT_PERSISTENTPOINTPOINT_H
+#define HEMELB_NET_MIXINS_POINTPOINT_PERSISTENTPOINTPOINT_H
+#include <vector>
+#include "net/BaseNet.h"
+#include "net/mixins/StoringNet.h"
+#include "net/mixins/pointpoint/PlanCache.h"
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * Point-to-point communication using persistent requests.
+     *
+     * As with CoalescePointPoint, everything sent to or received from a rank travels as a single
+     * message with a struct datatype. The datatypes and the persistent requests (MPI_Send_init /
+     * MPI_Recv_init) are kept in a plan, keyed by the exact set of requests made. When a later
+     * exchange makes the same requests - the same buffers, counts, types and ranks, as the halo
+     * exchange does every step - the plan's requests are just restarted with MPI_Startall, so
+     * the steady state neither allocates nor builds datatypes. Any other set of requests gets a
+     * plan of its own, kept in a PlanCache.
+     */
+    class PersistentPointPoint : public virtual StoringNet
+    {
+
+      public:
+        PersistentPointPoint(const MpiCommunicator& comms) :
+            BaseNet(comms), StoringNet(comms), currentPlan(NULL)
+        {
+        }
+
+        void WaitPointToPoint();
+        // The requests are recorded flat, rather than in StoringNet's per-rank maps, so that
+        // they can be compared cheaply with the stored plans.
+        virtual void RequestSendImpl(void* pointer, int count, proc_t rank, MPI_Datatype type);
+        virtual void RequestReceiveImpl(void* pointer, int count, proc_t rank, MPI_Datatype type);
+
+        /**
+         * The number of plans that have been built since construction, for monitoring how
+         * often the communication pattern changes.
+         *
+         * @return
+         */
+        unsigned int GetPlansBuilt() const
+        {
+          return plans.GetPlansBuilt();
+        }
+
+      protected:
+        void ReceivePointToPoint();
+        void SendPointToPoint();
+
+      private:
+        struct Plan : public PointPointPlan
+        {
+            //! One persistent request per receiving rank, followed by one per sending rank.
+            std::vector<MPI_Request> requests;
+            std::vector<proc_t> requestRanks;
+            std::vector<MPI_Status> statuses;
+            int receiveCount;
+            int sendCount;
+
+            void Free();
+        };
+
+        void EnsurePlanSelected();
+        void BuildPlan(Plan& plan);
+        static void AddPerRankRequests(const std::vector<SimpleRequest>& requests, Plan& plan,
+                                       bool send, const MpiCommunicator& communicator);
+
+        std::vector<SimpleRequest> sends;
+        std::vector<SimpleRequest> receives;
+        PlanCache<Plan> plans;
+        //! The plan for the exchange in progress, or NULL before the first Send / Receive.
+        Plan* currentPlan;
+    };
+  }
+}
+
+#endif
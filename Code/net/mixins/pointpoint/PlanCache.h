@@ -0,0 +1,143 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_MIXINS_POINTPOINT_PLANCACHE_H
+#define HEMELB_NET_MIXINS_POINTPOINT_PLANCACHE_H
+#include <deque>
+#include <vector>
+#include "net/mpi.h"
+#include "net/StoredRequest.h"
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * What every plan for a point-to-point exchange holds, whatever MPI calls it is carried
+     * out with: the requests it was built for and the datatypes made for them.
+     */
+    struct PointPointPlan
+    {
+        //! The requests this plan was built for, in the order they were made.
+        std::vector<SimpleRequest> sends;
+        std::vector<SimpleRequest> receives;
+        //! The datatypes created for this plan.
+        std::vector<MPI_Datatype> types;
+        //! The number of bytes the sends carry.
+        int bytesSent;
+
+        void FreeTypes()
+        {
+          for (std::vector<MPI_Datatype>::iterator type = types.begin(); type != types.end(); ++type)
+          {
+            MPI_Type_free(&*type);
+          }
+          types.clear();
+        }
+    };
+
+    /**
+     * The plans kept by the point-to-point mixins that prepare an exchange once and reuse it
+     * (PersistentPointPoint, NeighbourhoodPointPoint), keyed by the exact set of requests made.
+     * A few plans are kept, so that exchanges alternating between patterns (e.g. swapping
+     * distribution arrays) don't rebuild every time; beyond that the oldest is freed.
+     *
+     * PlanType derives from PointPointPlan and has a Free() method, releasing whatever MPI
+     * objects the mixin made for it.
+     */
+    template<class PlanType>
+    class PlanCache
+    {
+      public:
+        PlanCache() :
+            plansBuilt(0)
+        {
+        }
+
+        ~PlanCache()
+        {
+          Clear();
+        }
+
+        /**
+         * Get the plan for the given requests. If there isn't one, a plan is made with the
+         * requests and the bytes they send filled in, for the caller to build the rest of.
+         *
+         * @param sends
+         * @param receives
+         * @param isNew Set to whether the plan was just made.
+         * @return
+         */
+        PlanType& Select(const std::vector<SimpleRequest>& sends, const std::vector<SimpleRequest>& receives,
+                         bool& isNew)
+        {
+          // The most recently built plans are the likeliest to match.
+          for (typename std::deque<PlanType>::reverse_iterator plan = plans.rbegin(); plan != plans.rend(); ++plan)
+          {
+            if (plan->receives == receives && plan->sends == sends)
+            {
+              isNew = false;
+              return *plan;
+            }
+          }
+
+          if (plans.size() == MAX_PLANS)
+          {
+            plans.front().Free();
+            plans.pop_front();
+          }
+
+          plans.push_back(PlanType());
+          PlanType& plan = plans.back();
+          plan.sends = sends;
+          plan.receives = receives;
+          plan.bytesSent = 0;
+          for (std::vector<SimpleRequest>::const_iterator request = sends.begin(); request != sends.end(); ++request)
+          {
+            int typeSize = 0;
+            MPI_Type_size(request->Type, &typeSize);
+            plan.bytesSent += typeSize * request->Count;
+          }
+          ++plansBuilt;
+          isNew = true;
+          return plan;
+        }
+
+        /**
+         * Free all the plans.
+         */
+        void Clear()
+        {
+          for (typename std::deque<PlanType>::iterator plan = plans.begin(); plan != plans.end(); ++plan)
+          {
+            plan->Free();
+          }
+          plans.clear();
+        }
+
+        /**
+         * The number of plans that have been made since construction.
+         *
+         * @return
+         */
+        unsigned int GetPlansBuilt() const
+        {
+          return plansBuilt;
+        }
+
+      private:
+        //! The most plans kept at once.
+        static const size_t MAX_PLANS = 8;
+
+        std::deque<PlanType> plans;
+        unsigned int plansBuilt;
+    };
+
+    template<class PlanType>
+    const size_t PlanCache<PlanType>::MAX_PLANS;
+  }
+}
+
+#endif
@@ -18,6 +18,7 @@ namespace hemelb
       {
         requests.resize(count, MPI_Request());
         statuses.resize(count, MPI_Status());
+        requestRanks.resize(count);
       }
     }
 
@@ -39,6 +40,7 @@ namespace hemelb
                     10,
                     communicator,
                     &requests[m]);
+          requestRanks[m] = it->first;
           ++m;
         }
       }
@@ -89,6 +91,7 @@ namespace hemelb
                     10,
                     communicator,
                     &requests[count_receives+m]);
+          requestRanks[count_receives + m] = it->first;
           ++m;
         }
       }
@@ -103,7 +106,7 @@ namespace hemelb
 
     void SeparatedPointPoint::WaitPointToPoint()
     {
-      MPI_Waitall(static_cast<int>(count_sends+count_receives), &requests[0], &statuses[0]);
+      WaitAllNotifying(static_cast<int>(count_sends + count_receives), &requests[0], &requestRanks[0], &statuses[0]);
 
       receiveProcessorComms.clear();
       sendProcessorComms.clear();
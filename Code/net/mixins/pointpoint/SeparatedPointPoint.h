@@ -40,6 +40,8 @@ namespace hemelb
         // on each core, but also to minimise creation / deletion overheads.
         std::vector<MPI_Request> requests;
         std::vector<MPI_Status> statuses;
+        //! The rank each request communicates with.
+        std::vector<proc_t> requestRanks;
         unsigned int count_sends;
         unsigned int count_receives;
     };
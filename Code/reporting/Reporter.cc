@@ -4,6 +4,7 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include "reporting/Reporter.h"
 #include "ctemplate/template.h"
 
@@ -27,6 +28,14 @@ namespace hemelb
       reportableObjects.push_back(reportable);
     }
 
+    void Reporter::RemoveReportable(Reportable* reportable)
+    {
+      reportableObjects.erase(std::remove(reportableObjects.begin(),
+                                          reportableObjects.end(),
+                                          reportable),
+                              reportableObjects.end());
+    }
+
     void Reporter::Write(const std::string &ctemplate, const std::string &as)
     {
       std::string output;
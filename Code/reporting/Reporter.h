@@ -42,6 +42,7 @@ namespace hemelb
         void Image(); //! Inform the reporter that an image has been saved.
 
         void AddReportable(Reportable* reportable);
+        void RemoveReportable(Reportable* reportable);
 
         void WriteXML()
         {
@@ -117,6 +117,7 @@ namespace hemelb
           colloidUpdateCalculations,
           colloidOutput,
           extractionWriting,
+          rebalance, //!< Time spent repartitioning the domain during the run
           last
         //!< last, this has to be the last element of the enumeration so it can be used to track cardinality
         };
@@ -221,7 +222,7 @@ namespace hemelb
       "Move Counts Sending", "Move Data Sending", "Populating moves list for decomposition optimisation",
       "Initial geometry reading", "Colloid initialisation", "Colloid position communication",
       "Colloid velocity communication", "Colloid force calculations", "Colloid calculations for updating",
-      "Colloid outputting", "Extraction writing" };
+      "Colloid outputting", "Extraction writing", "Rebalancing" };
   }
 
 }
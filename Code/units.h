@@ -26,6 +26,13 @@ namespace hemelb
   typedef int64_t site_t;
   typedef int proc_t;
   typedef double distribn_t;
+  // The type the distributions are stored as in the lattice data. Arithmetic on them is always
+  // done in distribn_t.
+#ifdef HEMELB_USE_FLOAT_DISTRIBUTIONS
+  typedef float distribn_storage_t;
+#else
+  typedef distribn_t distribn_storage_t;
+#endif
   typedef unsigned Direction;
   typedef uint64_t sitedata_t;
 
@@ -56,9 +56,13 @@ namespace hemelb
          * The plane (x,y,3) is an outlet (boundary 1).
          * The planes (0,y,z), (3,y,z), (x,0,z) and (x,3,z) are all walls.
          *
+         * The sites are all on rank 0 unless splitAlongZ, when they're shared out between the
+         * ranks of comm in slabs along z.
+         *
          * @return
          */
-        static FourCubeLatticeData* Create(const net::IOCommunicator& comm, site_t sitesPerBlockUnit = 6, proc_t rankCount = 1)
+        static FourCubeLatticeData* Create(const net::IOCommunicator& comm, site_t sitesPerBlockUnit = 6, proc_t rankCount = 1,
+                                           bool splitAlongZ = false)
         {
           hemelb::geometry::Geometry readResult(util::Vector3D<site_t>::Ones(),
                                                 sitesPerBlockUnit);
@@ -86,7 +90,9 @@ namespace hemelb
                 hemelb::geometry::GeometrySite& site = block.Sites[index];
 
                 site.isFluid = true;
-                site.targetProcessor = 0;
+                site.targetProcessor = splitAlongZ ?
+                  proc_t( (k - minInd) * comm.Size() / sitesAlongCube) :
+                  0;
 
                 for (Direction direction = 1; direction < lb::lattices::D3Q15::NUMVECTORS; ++direction)
                 {
@@ -153,6 +159,10 @@ namespace hemelb
           }
 
           FourCubeLatticeData* returnable = new FourCubeLatticeData(readResult, comm);
+          if (splitAlongZ)
+          {
+            return returnable;
+          }
 
           // First, fiddle with the fluid site count, for tests that require this set.
           returnable->fluidSitesOnEachProcessor.resize(rankCount);
@@ -223,7 +233,7 @@ namespace hemelb
         {
           for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
           {
-            *GetFOld(site * LatticeType::NUMVECTORS + direction) = fOldIn[direction];
+            *GetFOld(GetDistributionIndex<LatticeType>(site, direction)) = fOldIn[direction];
           }
         }
 
@@ -7,8 +7,15 @@
 #ifndef HEMELB_UNITTESTS_SIMULATIONMASTERTESTS_H
 #define HEMELB_UNITTESTS_SIMULATIONMASTERTESTS_H
 
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <utility>
+#include <vector>
 #include <cppunit/TestFixture.h>
 #include "SimulationMaster.h"
+#include "io/formats/extraction.h"
+#include "io/writers/xdr/XdrMemReader.h"
 #include "unittests/helpers/FolderTestFixture.h"
 #include "unittests/helpers/LaddFail.h"
 
@@ -20,10 +27,40 @@ namespace hemelb
      * Class to test the simulation master.
      */
     using namespace helpers;
+
+    /**
+     * A simulation master that repartitions the domain every so many time steps, as if the
+     * load had become unbalanced.
+     */
+    class RebalancingSimulationMaster : public SimulationMaster
+    {
+      public:
+        RebalancingSimulationMaster(hemelb::configuration::CommandLine& options,
+                                    const hemelb::net::IOCommunicator& ioComms,
+                                    LatticeTimeStep period) :
+            SimulationMaster(options, ioComms), period(period)
+        {
+        }
+
+      protected:
+        void DoTimeStep()
+        {
+          SimulationMaster::DoTimeStep();
+          if (GetState()->GetTimeStep() % period == 0)
+          {
+            Rebalance();
+          }
+        }
+
+      private:
+        LatticeTimeStep period;
+    };
+
     class SimulationMasterTests : public FolderTestFixture
     {
         CPPUNIT_TEST_SUITE( SimulationMasterTests);
-        CPPUNIT_TEST( TestRun);CPPUNIT_TEST_SUITE_END();
+        CPPUNIT_TEST( TestRun);
+        CPPUNIT_TEST( TestRebalance);CPPUNIT_TEST_SUITE_END();
       public:
         void setUp()
         {
@@ -68,7 +105,135 @@ namespace hemelb
           AssertPresent("results/Extracted/surfacetraction.dat");
         }
 
+        void TestRebalance()
+        {
+          LADD_FAIL();
+          // Only one master at a time can listen for steering connections.
+          delete master;
+          master = NULL;
+          CopyResourceToTempdir("four_cube_rebalance.xml");
+
+          // Repartitioning mid-run mustn't change the results, nor what the monitoring has
+          // found.
+          RecordMap expected, actual;
+          hemelb::lb::Stability expectedStability = RunRebalancing(0, "unbalanced", expected);
+          hemelb::lb::Stability actualStability = RunRebalancing(10, "rebalanced", actual);
+          CPPUNIT_ASSERT_EQUAL(expectedStability, actualStability);
+
+          // The sites may be written in a different order after repartitioning.
+          CPPUNIT_ASSERT_EQUAL(size_t(20 * 64), expected.size());
+          CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+          for (RecordMap::const_iterator record = expected.begin(); record != expected.end(); ++record)
+          {
+            RecordMap::const_iterator found = actual.find(record->first);
+            CPPUNIT_ASSERT(found != actual.end());
+            CPPUNIT_ASSERT_EQUAL(record->second.size(), found->second.size());
+            for (size_t i = 0; i < record->second.size(); ++i)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(record->second[i],
+                                           found->second[i],
+                                           1e-6 * std::fabs(record->second[i]));
+            }
+          }
+        }
+
       private:
+        //! The values of each site, by time step and position.
+        typedef std::map<std::pair<uint64_t, std::vector<unsigned> >, std::vector<float> > RecordMap;
+
+        /**
+         * Run four_cube_rebalance.xml, repartitioning every so many steps (or not at all if
+         * zero), and read the whole geometry extraction file it writes.
+         */
+        hemelb::lb::Stability RunRebalancing(LatticeTimeStep period, const char* outputDirectory,
+                                             RecordMap& records)
+        {
+          const char* runArgv[] = { "hemelb", "-in", "four_cube_rebalance.xml", "-out", outputDirectory,
+                                    "-i", "1", "-ss", "1111" };
+          hemelb::configuration::CommandLine runOptions(9, runArgv);
+          SimulationMaster* run = (period == 0) ?
+            new SimulationMaster(runOptions, Comms()) :
+            new RebalancingSimulationMaster(runOptions, Comms(), period);
+          run->RunSimulation();
+          const hemelb::lb::Stability stability = run->GetState()->GetStability();
+          delete run;
+
+          const std::string path = std::string(outputDirectory)
+              + "/Extracted/wholegeometryvelocityandstress.dat";
+          std::FILE* file = std::fopen(path.c_str(), "r");
+          CPPUNIT_ASSERT(file != NULL);
+          std::vector<char> contents;
+          char piece[4096];
+          size_t nRead;
+          while ( (nRead = std::fread(piece, 1, sizeof(piece), file)) > 0)
+          {
+            contents.insert(contents.end(), piece, piece + nRead);
+          }
+          std::fclose(file);
+
+          hemelb::io::writers::xdr::XdrMemReader mainHeaderReader(&contents[0],
+                                                                  hemelb::io::formats::extraction::MainHeaderLength);
+          unsigned word;
+          double ignored;
+          for (unsigned i = 0; i < 3; ++i)
+          {
+            mainHeaderReader.readUnsignedInt(word);
+          }
+          for (unsigned i = 0; i < 4; ++i)
+          {
+            mainHeaderReader.readDouble(ignored);
+          }
+          uint64_t siteCount;
+          unsigned fieldCount, fieldHeaderLength;
+          mainHeaderReader.readUnsignedLong(siteCount);
+          mainHeaderReader.readUnsignedInt(fieldCount);
+          mainHeaderReader.readUnsignedInt(fieldHeaderLength);
+
+          // Each field is a name, the number of components and an offset.
+          unsigned valueCount = 0;
+          hemelb::io::writers::xdr::XdrMemReader fieldHeaderReader(&contents[hemelb::io::formats::extraction::MainHeaderLength],
+                                                                   fieldHeaderLength);
+          for (unsigned field = 0; field < fieldCount; ++field)
+          {
+            unsigned nameLength, components;
+            fieldHeaderReader.readUnsignedInt(nameLength);
+            for (unsigned i = 0; i < (nameLength + 3) / 4; ++i)
+            {
+              fieldHeaderReader.readUnsignedInt(word);
+            }
+            fieldHeaderReader.readUnsignedInt(components);
+            fieldHeaderReader.readDouble(ignored);
+            valueCount += components;
+          }
+
+          const size_t recordLength = 4 * (3 + valueCount);
+          const size_t bodyOffset = hemelb::io::formats::extraction::MainHeaderLength + fieldHeaderLength;
+          const size_t stepLength = 8 + siteCount * recordLength;
+          CPPUNIT_ASSERT_EQUAL(size_t(0), (contents.size() - bodyOffset) % stepLength);
+          hemelb::io::writers::xdr::XdrMemReader bodyReader(&contents[bodyOffset],
+                                                            contents.size() - bodyOffset);
+          for (size_t step = 0; step < (contents.size() - bodyOffset) / stepLength; ++step)
+          {
+            uint64_t timeStep;
+            bodyReader.readUnsignedLong(timeStep);
+            for (uint64_t site = 0; site < siteCount; ++site)
+            {
+              std::vector<unsigned> position(3);
+              for (unsigned i = 0; i < 3; ++i)
+              {
+                bodyReader.readUnsignedInt(position[i]);
+              }
+              std::vector<float>& values = records[std::make_pair(timeStep, position)];
+              values.resize(valueCount);
+              for (unsigned i = 0; i < valueCount; ++i)
+              {
+                bodyReader.readFloat(values[i]);
+              }
+            }
+          }
+          return stability;
+        }
+
         int argc;
         hemelb::configuration::CommandLine *options;
         SimulationMaster *master;
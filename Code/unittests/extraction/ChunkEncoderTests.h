@@ -0,0 +1,221 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_EXTRACTION_CHUNKENCODERTESTS_H
+#define HEMELB_UNITTESTS_EXTRACTION_CHUNKENCODERTESTS_H
+
+#include <limits>
+#include <vector>
+#include <zlib.h>
+#include <cppunit/TestFixture.h>
+#include "extraction/ChunkEncoder.h"
+#include "io/writers/xdr/XdrMemReader.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace extraction
+    {
+      class ChunkEncoderTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE (ChunkEncoderTests);
+          CPPUNIT_TEST (TestToHalf);
+          CPPUNIT_TEST (TestUncompressedChunk);
+          CPPUNIT_TEST (TestCompressedChunk);
+          CPPUNIT_TEST (TestIncompressibleChunk);
+          CPPUNIT_TEST (TestQuantisedNonFinite);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestToHalf()
+          {
+            CPPUNIT_ASSERT_EQUAL(uint16_t(0x3c00), Encoder::ToHalf(1.0f));
+            CPPUNIT_ASSERT_EQUAL(uint16_t(0xc000), Encoder::ToHalf(-2.0f));
+            // Rounded to the nearest.
+            CPPUNIT_ASSERT_EQUAL(uint16_t(0x2e66), Encoder::ToHalf(0.1f));
+            // The greatest, and too great.
+            CPPUNIT_ASSERT_EQUAL(uint16_t(0x7bff), Encoder::ToHalf(65504.0f));
+            CPPUNIT_ASSERT_EQUAL(uint16_t(0x7c00), Encoder::ToHalf(1.0e6f));
+            // The least subnormal, and too small.
+            CPPUNIT_ASSERT_EQUAL(uint16_t(0x0001), Encoder::ToHalf(5.9604645e-8f));
+            CPPUNIT_ASSERT_EQUAL(uint16_t(0x0000), Encoder::ToHalf(1.0e-9f));
+          }
+
+          void TestUncompressedChunk()
+          {
+            Encoder encoder(hemelb::io::formats::extraction::NoCompression);
+            std::vector<char> buffer(4, 'x');
+            Encode(encoder, buffer);
+
+            // The chunk goes after what was in the buffer, padded to a multiple of four bytes.
+            const unsigned rawLength = RawLength();
+            CPPUNIT_ASSERT_EQUAL(size_t(4 + 12 + (rawLength + 3) / 4 * 4), buffer.size());
+            CPPUNIT_ASSERT_EQUAL('x', buffer[3]);
+
+            hemelb::io::writers::xdr::XdrMemReader reader(&buffer[4], buffer.size() - 4);
+            unsigned storedLength;
+            CheckHeader(reader, storedLength, rawLength);
+            CPPUNIT_ASSERT_EQUAL(rawLength, storedLength);
+            CheckData(reader);
+          }
+
+          void TestCompressedChunk()
+          {
+            // Enough repetition for zlib to shorten it.
+            Encoder encoder(hemelb::io::formats::extraction::ZlibCompression);
+            std::vector<hemelb::extraction::FloatingType> values(256, 1.5);
+            std::vector<char> buffer;
+            encoder.Reset();
+            encoder.AppendField(hemelb::io::formats::extraction::Float32Encoding, values, 0.5);
+            encoder.Finish(256, buffer);
+
+            hemelb::io::writers::xdr::XdrMemReader headerReader(&buffer[0], buffer.size());
+            unsigned siteCount, storedLength, rawLength;
+            headerReader.readUnsignedInt(siteCount);
+            headerReader.readUnsignedInt(storedLength);
+            headerReader.readUnsignedInt(rawLength);
+            CPPUNIT_ASSERT_EQUAL(256u, siteCount);
+            CPPUNIT_ASSERT_EQUAL(256u * 4, rawLength);
+            CPPUNIT_ASSERT(storedLength < rawLength);
+            CPPUNIT_ASSERT_EQUAL(size_t(12 + (storedLength + 3) / 4 * 4), buffer.size());
+
+            std::vector<char> data(rawLength);
+            uLongf dataLength = data.size();
+            CPPUNIT_ASSERT_EQUAL(Z_OK,
+                                 uncompress(reinterpret_cast<Bytef*>(&data[0]),
+                                            &dataLength,
+                                            reinterpret_cast<const Bytef*>(&buffer[12]),
+                                            storedLength));
+            CPPUNIT_ASSERT_EQUAL(uLongf(rawLength), dataLength);
+
+            hemelb::io::writers::xdr::XdrMemReader reader(&data[0], data.size());
+            for (unsigned site = 0; site < siteCount; ++site)
+            {
+              float value;
+              reader.readFloat(value);
+              CPPUNIT_ASSERT_EQUAL(1.0f, value);
+            }
+          }
+
+          void TestIncompressibleChunk()
+          {
+            // One site of one value: zlib's own header would make it longer.
+            Encoder encoder(hemelb::io::formats::extraction::ZlibCompression);
+            std::vector<hemelb::extraction::FloatingType> values(1, 2.5);
+            std::vector<char> buffer;
+            encoder.Reset();
+            encoder.AppendField(hemelb::io::formats::extraction::Float32Encoding, values, 0.0);
+            encoder.Finish(1, buffer);
+
+            CPPUNIT_ASSERT_EQUAL(size_t(12 + 4), buffer.size());
+            hemelb::io::writers::xdr::XdrMemReader reader(&buffer[0], buffer.size());
+            unsigned siteCount, storedLength, rawLength;
+            reader.readUnsignedInt(siteCount);
+            reader.readUnsignedInt(storedLength);
+            reader.readUnsignedInt(rawLength);
+            CPPUNIT_ASSERT_EQUAL(1u, siteCount);
+            CPPUNIT_ASSERT_EQUAL(4u, rawLength);
+            CPPUNIT_ASSERT_EQUAL(rawLength, storedLength);
+            float value;
+            reader.readFloat(value);
+            CPPUNIT_ASSERT_EQUAL(2.5f, value);
+          }
+
+          void TestQuantisedNonFinite()
+          {
+            // NaNs and infinities get their own level, and don't widen the range.
+            std::vector<hemelb::extraction::FloatingType> values;
+            values.push_back(2.0);
+            values.push_back(std::numeric_limits<double>::quiet_NaN());
+            values.push_back(4.0);
+            values.push_back(std::numeric_limits<double>::infinity());
+
+            Encoder encoder(hemelb::io::formats::extraction::NoCompression);
+            std::vector<char> buffer;
+            encoder.Reset();
+            encoder.AppendField(hemelb::io::formats::extraction::QuantisedEncoding, values, 0.0);
+            encoder.Finish(4, buffer);
+
+            hemelb::io::writers::xdr::XdrMemReader reader(&buffer[12], buffer.size() - 12);
+            double bound;
+            reader.readDouble(bound);
+            CPPUNIT_ASSERT_EQUAL(2.0, bound);
+            reader.readDouble(bound);
+            CPPUNIT_ASSERT_EQUAL(4.0, bound);
+            unsigned word;
+            reader.readUnsignedInt(word);
+            CPPUNIT_ASSERT_EQUAL(0x0000ffffu, word);
+            reader.readUnsignedInt(word);
+            CPPUNIT_ASSERT_EQUAL(0xfffeffffu, word);
+          }
+
+        private:
+          typedef hemelb::extraction::ChunkEncoder Encoder;
+
+          /**
+           * A chunk of two sites, with one of each encoding.
+           */
+          void Encode(Encoder& encoder, std::vector<char>& buffer)
+          {
+            std::vector<hemelb::extraction::FloatingType> values;
+            values.push_back(1.5);
+            values.push_back(3.0);
+
+            encoder.Reset();
+            encoder.AppendField(hemelb::io::formats::extraction::Float32Encoding, values, 0.5);
+            encoder.AppendField(hemelb::io::formats::extraction::Float16Encoding, values, 0.5);
+            encoder.AppendField(hemelb::io::formats::extraction::QuantisedEncoding, values, 0.5);
+            encoder.Finish(2, buffer);
+          }
+
+          static unsigned RawLength()
+          {
+            return 2 * 4 + 2 * 2 + 16 + 2 * 2;
+          }
+
+          void CheckHeader(hemelb::io::writers::xdr::XdrMemReader& reader, unsigned& storedLength,
+                           unsigned rawLength)
+          {
+            unsigned siteCount;
+            unsigned readRawLength;
+            reader.readUnsignedInt(siteCount);
+            reader.readUnsignedInt(storedLength);
+            reader.readUnsignedInt(readRawLength);
+            CPPUNIT_ASSERT_EQUAL(2u, siteCount);
+            CPPUNIT_ASSERT_EQUAL(rawLength, readRawLength);
+          }
+
+          void CheckData(hemelb::io::writers::xdr::XdrMemReader& reader)
+          {
+            float single;
+            reader.readFloat(single);
+            CPPUNIT_ASSERT_EQUAL(1.0f, single);
+            reader.readFloat(single);
+            CPPUNIT_ASSERT_EQUAL(2.5f, single);
+
+            // Two halves, then the quantised range and levels, in 4-byte pieces.
+            unsigned word;
+            reader.readUnsignedInt(word);
+            CPPUNIT_ASSERT_EQUAL(0x3c004100u, word);
+
+            double bound;
+            reader.readDouble(bound);
+            CPPUNIT_ASSERT_EQUAL(1.0, bound);
+            reader.readDouble(bound);
+            CPPUNIT_ASSERT_EQUAL(2.5, bound);
+
+            reader.readUnsignedInt(word);
+            CPPUNIT_ASSERT_EQUAL(0x0000fffeu, word);
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (ChunkEncoderTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_EXTRACTION_CHUNKENCODERTESTS_H */
@@ -0,0 +1,179 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_EXTRACTION_LBDATASOURCEITERATORTESTS_H
+#define HEMELB_UNITTESTS_EXTRACTION_LBDATASOURCEITERATORTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "extraction/LbDataSourceIterator.h"
+#include "unittests/FourCubeLatticeData.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace extraction
+    {
+      /**
+       * Check that getting a field's values at many sites at once gives what reading the sites
+       * one by one does.
+       */
+      class LbDataSourceIteratorTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (LbDataSourceIteratorTests);
+          CPPUNIT_TEST (TestFieldValues);
+          CPPUNIT_TEST (TestRankIsNotAField);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void setUp()
+          {
+            helpers::HasCommsTestFixture::setUp();
+            latticeData = FourCubeLatticeData::Create(Comms(), 6, 1);
+            simState = new lb::SimulationState(60.0 / (70.0 * 5000.0), 1000);
+            propertyCache = new lb::MacroscopicPropertyCache(*simState, *latticeData);
+            unitConverter = new util::UnitConverter(simState->GetTimeStepLength(),
+                                                    0.01,
+                                                    PhysicalPosition::Zero());
+            dataSourceIterator = new hemelb::extraction::LbDataSourceIterator(*propertyCache,
+                                                                              *latticeData,
+                                                                              0,
+                                                                              *unitConverter);
+
+            propertyCache->densityCache.SetRefreshFlag();
+            propertyCache->velocityCache.SetRefreshFlag();
+            propertyCache->stressTensorCache.SetRefreshFlag();
+            propertyCache->tractionCache.SetRefreshFlag();
+            for (site_t site = 0; site < latticeData->GetLocalFluidSiteCount(); ++site)
+            {
+              propertyCache->densityCache.Put(site, 1.0 + 0.001 * site);
+              propertyCache->velocityCache.Put(site,
+                                               util::Vector3D<distribn_t>(0.01 * site, -0.02, 0.003 * site));
+              util::Matrix3D tensor;
+              for (unsigned row = 0; row < 3; ++row)
+              {
+                for (unsigned column = 0; column < 3; ++column)
+                {
+                  tensor[row][column] = 0.001 * site + row - column;
+                }
+              }
+              propertyCache->stressTensorCache.Put(site, tensor);
+              propertyCache->tractionCache.Put(site,
+                                               util::Vector3D<LatticeStress>(0.1, 0.002 * site, -0.3));
+            }
+
+            // Every seventh site.
+            for (site_t site = 3; site < latticeData->GetLocalFluidSiteCount(); site += 7)
+            {
+              siteIndices.push_back(site);
+            }
+          }
+
+          void tearDown()
+          {
+            delete dataSourceIterator;
+            delete unitConverter;
+            delete propertyCache;
+            delete simState;
+            delete latticeData;
+            helpers::HasCommsTestFixture::tearDown();
+          }
+
+          void TestFieldValues()
+          {
+            CheckField(hemelb::extraction::OutputField::Pressure);
+            CheckField(hemelb::extraction::OutputField::Velocity);
+            CheckField(hemelb::extraction::OutputField::StressTensor);
+            CheckField(hemelb::extraction::OutputField::Traction);
+          }
+
+          void TestRankIsNotAField()
+          {
+            std::vector<hemelb::extraction::FloatingType> values;
+            CPPUNIT_ASSERT_THROW(dataSourceIterator->GetFieldValues(hemelb::extraction::OutputField::MpiRank,
+                                                                    siteIndices,
+                                                                    values),
+                                 hemelb::Exception);
+          }
+
+        private:
+          /**
+           * Compare the iterator's own version, and the data source's default one that reads
+           * the sites one by one, to the site getters.
+           * @param field
+           */
+          void CheckField(hemelb::extraction::OutputField::FieldType field)
+          {
+            std::vector<hemelb::extraction::FloatingType> bulkValues;
+            dataSourceIterator->GetFieldValues(field, siteIndices, bulkValues);
+
+            std::vector<hemelb::extraction::FloatingType> defaultValues;
+            dataSourceIterator->hemelb::extraction::IterableDataSource::GetFieldValues(field,
+                                                                                       siteIndices,
+                                                                                       defaultValues);
+
+            CPPUNIT_ASSERT_EQUAL(defaultValues.size(), bulkValues.size());
+            CPPUNIT_ASSERT(bulkValues.size() >= siteIndices.size());
+            const size_t fieldLength = bulkValues.size() / siteIndices.size();
+            for (size_t i = 0; i < bulkValues.size(); ++i)
+            {
+              CPPUNIT_ASSERT(Same(defaultValues[i], bulkValues[i]));
+            }
+
+            // Spot-check the default against the getters at the first site.
+            dataSourceIterator->Reset();
+            for (site_t site = 0; site <= siteIndices[0]; ++site)
+            {
+              dataSourceIterator->ReadNext();
+            }
+            switch (field)
+            {
+              case hemelb::extraction::OutputField::Pressure:
+                CPPUNIT_ASSERT_EQUAL(size_t(1), fieldLength);
+                CPPUNIT_ASSERT_EQUAL(dataSourceIterator->GetPressure(), bulkValues[0]);
+                break;
+              case hemelb::extraction::OutputField::Velocity:
+                CPPUNIT_ASSERT_EQUAL(size_t(3), fieldLength);
+                CPPUNIT_ASSERT_EQUAL(dataSourceIterator->GetVelocity().z, bulkValues[2]);
+                break;
+              case hemelb::extraction::OutputField::StressTensor:
+                CPPUNIT_ASSERT_EQUAL(size_t(6), fieldLength);
+                CPPUNIT_ASSERT_EQUAL(dataSourceIterator->GetStressTensor()[1][2], bulkValues[4]);
+                break;
+              case hemelb::extraction::OutputField::Traction:
+                CPPUNIT_ASSERT_EQUAL(size_t(3), fieldLength);
+                CPPUNIT_ASSERT(Same(dataSourceIterator->GetTraction().y, bulkValues[1]));
+                break;
+              default:
+                CPPUNIT_FAIL("Field not checked");
+            }
+          }
+
+          /**
+           * Equal, or both NaN, as the traction is away from the walls, where the wall normal
+           * isn't set.
+           */
+          static bool Same(hemelb::extraction::FloatingType a, hemelb::extraction::FloatingType b)
+          {
+            return a == b || (a != a && b != b);
+          }
+
+          FourCubeLatticeData* latticeData;
+          lb::SimulationState* simState;
+          lb::MacroscopicPropertyCache* propertyCache;
+          util::UnitConverter* unitConverter;
+          hemelb::extraction::LbDataSourceIterator* dataSourceIterator;
+          std::vector<site_t> siteIndices;
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (LbDataSourceIteratorTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_EXTRACTION_LBDATASOURCEITERATORTESTS_H */
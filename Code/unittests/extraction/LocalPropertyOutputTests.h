@@ -7,8 +7,12 @@
 #ifndef HEMELB_UNITTESTS_EXTRACTION_LOCALPROPERTYOUTPUTTESTS_H
 #define HEMELB_UNITTESTS_EXTRACTION_LOCALPROPERTYOUTPUTTESTS_H
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <cstdio>
+#include <vector>
+#include <zlib.h>
 
 #include <cppunit/TestFixture.h>
 
@@ -16,7 +20,9 @@
 #include "io/writers/xdr/XdrMemReader.h"
 #include "extraction/PropertyOutputFile.h"
 #include "extraction/OutputField.h"
+#include "extraction/GeometrySelector.h"
 #include "extraction/WholeGeometrySelector.h"
+#include "net/MpiError.h"
 
 #include "unittests/helpers/HasCommsTestFixture.h"
 #include "unittests/extraction/DummyDataSource.h"
@@ -27,11 +33,44 @@ namespace hemelb
   {
     namespace extraction
     {
+      /**
+       * Shares the dummy data source's sites out between the cores, as though each had its own
+       * part of the geometry, taking every size'th site from its rank on. Every core has the
+       * same data source, so this is what the file should hold whatever the core count.
+       */
+      class SharedOutSelector : public hemelb::extraction::GeometrySelector
+      {
+        public:
+          SharedOutSelector(int rank, int size, bool hasSites) :
+              rank(rank), size(size), hasSites(hasSites)
+          {
+          }
+
+          static bool IsShared(const util::Vector3D<site_t>& location, int rank, int size)
+          {
+            return ( (location.x * 4 + location.y) * 4 + location.z) % size == rank;
+          }
+
+        protected:
+          bool IsWithinGeometry(const hemelb::extraction::IterableDataSource& data,
+                                const util::Vector3D<site_t>& location)
+          {
+            return hasSites && IsShared(location, rank, size);
+          }
+
+        private:
+          const int rank;
+          const int size;
+          const bool hasSites;
+      };
+
       class LocalPropertyOutputTests : public helpers::HasCommsTestFixture
       {
           CPPUNIT_TEST_SUITE (LocalPropertyOutputTests);
           CPPUNIT_TEST (TestStringWrittenLength);
-          CPPUNIT_TEST (TestWrite);CPPUNIT_TEST_SUITE_END();
+          CPPUNIT_TEST (TestWrite);
+          CPPUNIT_TEST (TestChunkedWrite);
+          CPPUNIT_TEST (TestGroupedWrite);CPPUNIT_TEST_SUITE_END();
 
         public:
           void setUp()
@@ -170,6 +209,8 @@ namespace hemelb
             simpleDataSource->FillFields();
             // Write it
             propertyWriter->Write(0);
+            // It might only have started writing.
+            propertyWriter->Flush();
 
             CheckDataWriting(simpleDataSource, 0, writtenFile);
 
@@ -179,6 +220,7 @@ namespace hemelb
             propertyWriter->Write(10);
             // This SHOULD write
             propertyWriter->Write(100);
+            propertyWriter->Flush();
 
             // The previous call to CheckDataWriting() sets the EOF indicator in writtenFile,
             // the previous call to Write() ought to unset it but it isn't working properly in
@@ -188,7 +230,344 @@ namespace hemelb
             CheckDataWriting(simpleDataSource, 100, writtenFile);
           }
 
+          void TestChunkedWrite()
+          {
+            // Compressed, with both of the reduced precision encodings.
+            simpleOutFile.chunked = true;
+            simpleOutFile.compression = hemelb::io::formats::extraction::ZlibCompression;
+            simpleOutFile.fields[0].encoding = hemelb::io::formats::extraction::QuantisedEncoding;
+            simpleOutFile.fields[1].encoding = hemelb::io::formats::extraction::Float16Encoding;
+
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource, &simpleOutFile, Comms());
+            simpleDataSource->FillFields();
+            propertyWriter->Write(0);
+            simpleDataSource->FillFields();
+            propertyWriter->Write(100);
+            propertyWriter->Flush();
+
+            std::vector<char> contents;
+            ReadFile(contents);
+
+            // The version, then the length of the field header, at the end of the main header.
+            hemelb::io::writers::xdr::XdrMemReader mainHeaderReader(&contents[0],
+                                                                    hemelb::io::formats::extraction::MainHeaderLength);
+            unsigned word;
+            mainHeaderReader.readUnsignedInt(word);
+            mainHeaderReader.readUnsignedInt(word);
+            mainHeaderReader.readUnsignedInt(word);
+            CPPUNIT_ASSERT_EQUAL(unsigned(hemelb::io::formats::extraction::ChunkedVersionNumber), word);
+            hemelb::io::writers::xdr::XdrMemReader fieldHeaderLengthReader(&contents[hemelb::io::formats::extraction::MainHeaderLength
+                                                                               - 4],
+                                                                           4);
+            fieldHeaderLengthReader.readUnsignedInt(word);
+            hemelb::io::writers::xdr::XdrMemReader compressionReader(&contents[hemelb::io::formats::extraction::MainHeaderLength],
+                                                                     4);
+            unsigned compression;
+            compressionReader.readUnsignedInt(compression);
+            CPPUNIT_ASSERT_EQUAL(unsigned(hemelb::io::formats::extraction::ZlibCompression), compression);
+
+            // The grid, then each written timestep's values.
+            size_t offset = hemelb::io::formats::extraction::MainHeaderLength + word;
+            std::vector<char> data;
+            ReadBlock(contents, offset, hemelb::io::formats::extraction::GridBlock, 0, data);
+            hemelb::io::writers::xdr::XdrMemReader gridReader(&data[0], data.size());
+            simpleDataSource->Reset();
+            while (simpleDataSource->ReadNext())
+            {
+              LatticeVector grid = simpleDataSource->GetPosition();
+              unsigned x, y, z;
+              gridReader.readUnsignedInt(x);
+              gridReader.readUnsignedInt(y);
+              gridReader.readUnsignedInt(z);
+              CPPUNIT_ASSERT_EQUAL((unsigned) grid.x, x);
+              CPPUNIT_ASSERT_EQUAL((unsigned) grid.y, y);
+              CPPUNIT_ASSERT_EQUAL((unsigned) grid.z, z);
+            }
+
+            // Only the last values are still there to compare with.
+            ReadBlock(contents, offset, hemelb::io::formats::extraction::ValuesBlock, 0, data);
+            ReadBlock(contents, offset, hemelb::io::formats::extraction::ValuesBlock, 100, data);
+            CPPUNIT_ASSERT_EQUAL(contents.size(), offset);
+            CheckChunkedValues(data);
+          }
+
+          void TestGroupedWrite()
+          {
+            // One writer for all the cores, each with some sites.
+            CheckGroupedWrite(1, false);
+            // Two writers, neither with any sites of its own, so that one (on rank 0) writes
+            // only the iteration number of its own and the other nothing at all.
+            CheckGroupedWrite(2, true);
+          }
+
         private:
+          /**
+           * Write two iterations with the cores grouped under writers, as they would be on a
+           * single node, and compare the file with the data source's values.
+           */
+          void CheckGroupedWrite(int writersPerNode, bool writersWithoutSites)
+          {
+            const int size = Comms().Size();
+            const int writers = std::min(writersPerNode, size);
+            std::vector<bool> hasSites(size, true);
+            for (int rank = 0; rank < size; ++rank)
+            {
+              // The lowest rank of each group is its writer.
+              const bool isWriter = rank == 0
+                  || (rank * writers / size) != ( (rank - 1) * writers / size);
+              hasSites[rank] = ! (writersWithoutSites && isWriter);
+            }
+
+            delete propertyWriter;
+            delete simpleOutFile.geometry;
+            simpleOutFile.geometry = new SharedOutSelector(Comms().Rank(), size, hasSites[Comms().Rank()]);
+            if (Comms().OnIORank())
+            {
+              std::remove(tempOutFileName);
+            }
+            HEMELB_MPI_CALL(MPI_Barrier, (Comms()));
+
+            propertyWriter = new hemelb::extraction::LocalPropertyOutput(*simpleDataSource,
+                                                                         &simpleOutFile,
+                                                                         Comms(),
+                                                                         writersPerNode);
+            simpleDataSource->FillFields();
+            propertyWriter->Write(0);
+            propertyWriter->Flush();
+            HEMELB_MPI_CALL(MPI_Barrier, (Comms()));
+            CheckGroupedValues(0, 0, hasSites);
+
+            simpleDataSource->FillFields();
+            propertyWriter->Write(100);
+            propertyWriter->Flush();
+            HEMELB_MPI_CALL(MPI_Barrier, (Comms()));
+            CheckGroupedValues(100, 1, hasSites);
+
+            // Everyone must have read the file before it goes.
+            delete propertyWriter;
+            propertyWriter = NULL;
+            HEMELB_MPI_CALL(MPI_Barrier, (Comms()));
+          }
+
+          /**
+           * Check the given written iteration: the iteration number, then each rank's records
+           * in turn, in the order of the data source.
+           */
+          void CheckGroupedValues(uint64_t timestep, unsigned iteration,
+                                  const std::vector<bool>& hasSites)
+          {
+            const int size = Comms().Size();
+            unsigned siteCount = 0;
+            for (int rank = 0; rank < size; ++rank)
+            {
+              simpleDataSource->Reset();
+              while (simpleDataSource->ReadNext())
+              {
+                if (hasSites[rank] && SharedOutSelector::IsShared(simpleDataSource->GetPosition(), rank, size))
+                {
+                  ++siteCount;
+                }
+              }
+            }
+
+            std::vector<char> contents;
+            ReadFile(contents);
+            CPPUNIT_ASSERT(contents.size() >= hemelb::io::formats::extraction::MainHeaderLength);
+            hemelb::io::writers::xdr::XdrMemReader fieldHeaderLengthReader(&contents[hemelb::io::formats::extraction::MainHeaderLength
+                                                                               - 4],
+                                                                           4);
+            unsigned writtenFieldHeaderLength;
+            fieldHeaderLengthReader.readUnsignedInt(writtenFieldHeaderLength);
+
+            // The iteration number, then 28 bytes for each site, as in CheckDataWriting().
+            const size_t iterationLength = 8 + 28 * siteCount;
+            const size_t offset = hemelb::io::formats::extraction::MainHeaderLength
+                + writtenFieldHeaderLength + iteration * iterationLength;
+            CPPUNIT_ASSERT_EQUAL(offset + iterationLength, contents.size());
+
+            hemelb::io::writers::xdr::XdrMemReader reader(&contents[offset], iterationLength);
+            uint64_t readTimestep;
+            reader.readUnsignedLong(readTimestep);
+            CPPUNIT_ASSERT_EQUAL(timestep, readTimestep);
+
+            for (int rank = 0; rank < size; ++rank)
+            {
+              simpleDataSource->Reset();
+              while (simpleDataSource->ReadNext())
+              {
+                LatticeVector grid = simpleDataSource->GetPosition();
+                if (! (hasSites[rank] && SharedOutSelector::IsShared(grid, rank, size)))
+                {
+                  continue;
+                }
+
+                unsigned x, y, z;
+                reader.readUnsignedInt(x);
+                reader.readUnsignedInt(y);
+                reader.readUnsignedInt(z);
+                CPPUNIT_ASSERT_EQUAL((unsigned) grid.x, x);
+                CPPUNIT_ASSERT_EQUAL((unsigned) grid.y, y);
+                CPPUNIT_ASSERT_EQUAL((unsigned) grid.z, z);
+
+                float pressure;
+                reader.readFloat(pressure);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(simpleDataSource->GetPressure(), (REFERENCE_PRESSURE_mmHg + (double) pressure), epsilon);
+
+                PhysicalVelocity velocity = simpleDataSource->GetVelocity();
+                float vx, vy, vz;
+                reader.readFloat(vx);
+                reader.readFloat(vy);
+                reader.readFloat(vz);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(velocity.x, (double) vx, epsilon);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(velocity.y, (double) vy, epsilon);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(velocity.z, (double) vz, epsilon);
+              }
+            }
+          }
+
+          /**
+           * Read the whole of the written file.
+           */
+          void ReadFile(std::vector<char>& contents)
+          {
+            FILE* file = std::fopen(simpleOutFile.filename.c_str(), "r");
+            CPPUNIT_ASSERT(file != NULL);
+            contents.clear();
+            char piece[4096];
+            size_t nRead;
+            while ( (nRead = std::fread(piece, 1, sizeof(piece), file)) > 0)
+            {
+              contents.insert(contents.end(), piece, piece + nRead);
+            }
+            std::fclose(file);
+          }
+
+          /**
+           * Read the block at the offset, checking its header, and uncompress its chunks'
+           * data, one after another.
+           */
+          void ReadBlock(std::vector<char>& contents, size_t& offset, unsigned type,
+                         uint64_t timestep, std::vector<char>& data)
+          {
+            hemelb::io::writers::xdr::XdrMemReader headerReader(&contents[offset],
+                                                                hemelb::io::formats::extraction::BlockHeaderLength);
+            unsigned readType, chunkCount;
+            uint64_t readTimestep, length;
+            headerReader.readUnsignedInt(readType);
+            headerReader.readUnsignedInt(chunkCount);
+            headerReader.readUnsignedLong(readTimestep);
+            headerReader.readUnsignedLong(length);
+            CPPUNIT_ASSERT_EQUAL(type, readType);
+            CPPUNIT_ASSERT_EQUAL(timestep, readTimestep);
+            offset += hemelb::io::formats::extraction::BlockHeaderLength;
+            const size_t end = offset + length;
+
+            data.clear();
+            for (unsigned chunk = 0; chunk < chunkCount; ++chunk)
+            {
+              hemelb::io::writers::xdr::XdrMemReader chunkReader(&contents[offset],
+                                                                 hemelb::io::formats::extraction::ChunkHeaderLength);
+              unsigned siteCount, storedLength, rawLength;
+              chunkReader.readUnsignedInt(siteCount);
+              chunkReader.readUnsignedInt(storedLength);
+              chunkReader.readUnsignedInt(rawLength);
+              offset += hemelb::io::formats::extraction::ChunkHeaderLength;
+
+              const size_t start = data.size();
+              data.resize(start + rawLength);
+              if (storedLength < rawLength)
+              {
+                uLongf uncompressedLength = rawLength;
+                CPPUNIT_ASSERT_EQUAL(Z_OK,
+                                     uncompress(reinterpret_cast<Bytef*>(&data[start]),
+                                                &uncompressedLength,
+                                                reinterpret_cast<const Bytef*>(&contents[offset]),
+                                                storedLength));
+                CPPUNIT_ASSERT_EQUAL(uLongf(rawLength), uncompressedLength);
+              }
+              else
+              {
+                std::copy(contents.begin() + offset, contents.begin() + offset + rawLength,
+                          data.begin() + start);
+              }
+              offset += (storedLength + 3) / 4 * 4;
+            }
+            CPPUNIT_ASSERT_EQUAL(end, offset);
+          }
+
+          /**
+           * Compare the values of a chunk of all the sites with the data source's, to within
+           * the precision of the encodings: the pressures' range is 2, over 65534 levels, and
+           * the velocities are at most 0.01, with 11 significant bits.
+           */
+          void CheckChunkedValues(std::vector<char>& data)
+          {
+            hemelb::io::writers::xdr::XdrMemReader reader(&data[0], data.size());
+            double least, greatest;
+            reader.readDouble(least);
+            reader.readDouble(greatest);
+            std::vector<unsigned short> halves;
+            unsigned siteCount = 0;
+            simpleDataSource->Reset();
+            while (simpleDataSource->ReadNext())
+            {
+              ++siteCount;
+            }
+
+            // The levels, two to a word, then the same for the halves.
+            std::vector<unsigned short> levels;
+            ReadShorts(reader, siteCount, levels);
+            ReadShorts(reader, 3 * siteCount, halves);
+
+            unsigned site = 0;
+            simpleDataSource->Reset();
+            while (simpleDataSource->ReadNext())
+            {
+              const double pressure = least + levels[site] * (greatest - least) / 65534.0;
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(simpleDataSource->GetPressure(),
+                                           REFERENCE_PRESSURE_mmHg + pressure,
+                                           1e-4);
+
+              PhysicalVelocity velocity = simpleDataSource->GetVelocity();
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(velocity.x, FromHalf(halves[3 * site]), 1e-5);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(velocity.y, FromHalf(halves[3 * site + 1]), 1e-5);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(velocity.z, FromHalf(halves[3 * site + 2]), 1e-5);
+              ++site;
+            }
+          }
+
+          /**
+           * Read big-endian ushorts, which XDR itself doesn't have, from the whole words
+           * holding them.
+           */
+          void ReadShorts(hemelb::io::writers::xdr::XdrMemReader& reader, unsigned count,
+                          std::vector<unsigned short>& shorts)
+          {
+            shorts.clear();
+            for (unsigned i = 0; i < count; i += 2)
+            {
+              unsigned word;
+              reader.readUnsignedInt(word);
+              shorts.push_back((unsigned short) (word >> 16));
+              shorts.push_back((unsigned short) word);
+            }
+            shorts.resize(count);
+          }
+
+          /**
+           * Only for the normal, positive halves of velocity components, and zero.
+           */
+          static double FromHalf(unsigned short half)
+          {
+            const int exponent = (half >> 10) & 0x1f;
+            const double mantissa = half & 0x3ff;
+            if (exponent == 0)
+            {
+              return std::ldexp(mantissa, -24);
+            }
+            return std::ldexp(1.0 + mantissa / 1024.0, exponent - 15);
+          }
+
           void CheckDataWriting(DummyDataSource* datasource, uint64_t timestep, FILE* file)
           {
             // The file should have an entry for each lattice point, consisting
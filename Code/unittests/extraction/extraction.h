@@ -7,7 +7,9 @@
 #ifndef HEMELB_UNITTESTS_EXTRACTION_EXTRACTION_H
 #define HEMELB_UNITTESTS_EXTRACTION_EXTRACTION_H
 
+#include "unittests/extraction/ChunkEncoderTests.h"
 #include "unittests/extraction/GeometrySelectorTests.h"
+#include "unittests/extraction/LbDataSourceIteratorTests.h"
 #include "unittests/extraction/LocalPropertyOutputTests.h"
 
 #endif /* HEMELB_UNITTESTS_EXTRACTION_EXTRACTION_H */
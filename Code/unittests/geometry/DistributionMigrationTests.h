@@ -0,0 +1,111 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_GEOMETRY_DISTRIBUTIONMIGRATIONTESTS_H
+#define HEMELB_UNITTESTS_GEOMETRY_DISTRIBUTIONMIGRATIONTESTS_H
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "geometry/DistributionMigration.h"
+#include "unittests/helpers/FourCubeBasedTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace geometry
+    {
+      class DistributionMigrationTests : public FourCubeBasedTestFixture
+      {
+          CPPUNIT_TEST_SUITE (DistributionMigrationTests);
+          CPPUNIT_TEST (TestMoveToNewLattice);
+          CPPUNIT_TEST (TestMoveSiteValues);
+          CPPUNIT_TEST_SUITE_END();
+
+          typedef lb::lattices::D3Q15 Lattice;
+
+        public:
+          void TestMoveToNewLattice()
+          {
+            // Give every site distinct distributions, identified by position.
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              distribn_t fOld[Lattice::NUMVECTORS];
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                fOld[direction] = GetExpected(latDat->GetSite(site).GetGlobalSiteCoords(), direction);
+              }
+              latDat->SetFOld<Lattice>(site, fOld);
+            }
+            const hemelb::geometry::DistributionMigration migration(*latDat);
+
+            // The new lattice has the same sites, but starts from scratch.
+            FourCubeLatticeData* newLatDat = FourCubeLatticeData::Create(Comms());
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              distribn_t fOld[Lattice::NUMVECTORS] = { };
+              newLatDat->SetFOld<Lattice>(site, fOld);
+            }
+
+            migration.MoveTo(*newLatDat, Comms());
+
+            for (site_t site = 0; site < newLatDat->GetLocalFluidSiteCount(); ++site)
+            {
+              // The distributions may be gathered into the Site, so it has to outlive fOld.
+              const hemelb::geometry::Site<hemelb::geometry::LatticeData> siteData = newLatDat->GetSite(site);
+              const distribn_t* fOld = siteData.GetFOld<Lattice>();
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                const distribn_t expected = GetExpected(newLatDat->GetSite(site).GetGlobalSiteCoords(),
+                                                        direction);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected,
+                                             fOld[direction],
+                                             expected * std::numeric_limits<distribn_storage_t>::epsilon());
+              }
+            }
+            delete newLatDat;
+          }
+
+          void TestMoveSiteValues()
+          {
+            // Two values per site, identified by position.
+            std::vector<distribn_t> values;
+            for (site_t site = 0; site < numSites; ++site)
+            {
+              values.push_back(-GetExpected(latDat->GetSite(site).GetGlobalSiteCoords(), 0));
+              values.push_back(-GetExpected(latDat->GetSite(site).GetGlobalSiteCoords(), 1));
+            }
+            hemelb::geometry::DistributionMigration migration(*latDat);
+            migration.AddSiteValues(values, 2);
+
+            FourCubeLatticeData* newLatDat = FourCubeLatticeData::Create(Comms());
+            std::vector<distribn_t> movedValues;
+            migration.MoveTo(*newLatDat, Comms(), movedValues);
+
+            CPPUNIT_ASSERT_EQUAL(size_t(2 * newLatDat->GetLocalFluidSiteCount()), movedValues.size());
+            for (site_t site = 0; site < newLatDat->GetLocalFluidSiteCount(); ++site)
+            {
+              const util::Vector3D<site_t> location = newLatDat->GetSite(site).GetGlobalSiteCoords();
+              CPPUNIT_ASSERT_EQUAL(-GetExpected(location, 0), movedValues[2 * site]);
+              CPPUNIT_ASSERT_EQUAL(-GetExpected(location, 1), movedValues[2 * site + 1]);
+            }
+            delete newLatDat;
+          }
+
+        private:
+          static distribn_t GetExpected(const util::Vector3D<site_t>& location, Direction direction)
+          {
+            return 1.0 + ( (location.x * 16 + location.y) * 16 + location.z) * Lattice::NUMVECTORS
+                + direction;
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (DistributionMigrationTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_GEOMETRY_DISTRIBUTIONMIGRATIONTESTS_H */
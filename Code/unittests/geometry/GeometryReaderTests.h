@@ -9,6 +9,7 @@
 #include "geometry/LatticeData.h"
 #include <cppunit/TestFixture.h>
 #include "lb/lattices/D3Q15.h"
+#include "lb/lattices/D3Q19.h"
 #include "resources/Resource.h"
 #include "unittests/FourCubeLatticeData.h"
 #include "unittests/helpers/FolderTestFixture.h"
@@ -27,7 +28,8 @@ namespace hemelb
       {
           CPPUNIT_TEST_SUITE ( GeometryReaderTests);
           CPPUNIT_TEST ( TestRead);
-          CPPUNIT_TEST ( TestSameAsFourCube);CPPUNIT_TEST_SUITE_END();
+          CPPUNIT_TEST ( TestSameAsFourCube);
+          CPPUNIT_TEST ( TestDecompositionCache);CPPUNIT_TEST_SUITE_END();
 
         public:
 
@@ -111,6 +113,44 @@ namespace hemelb
 
           }
 
+          void TestDecompositionCache()
+          {
+            LADD_FAIL();
+            Geometry decomposed = reader->LoadAndDecompose(simConfig->GetDataFilePath(),
+                                                           "four_cube.dcp");
+            CPPUNIT_ASSERT(util::file_exists("four_cube.dcp"));
+
+            // A new reader takes the same decomposition from the file, without rereading.
+            reporting::Timers cachedTimings(Comms());
+            GeometryReader cachedReader(false,
+                                        hemelb::lb::lattices::D3Q15::GetLatticeInfo(),
+                                        cachedTimings,
+                                        Comms());
+            Geometry cached = cachedReader.LoadAndDecompose(simConfig->GetDataFilePath(),
+                                                            "four_cube.dcp");
+            CPPUNIT_ASSERT_EQUAL(0.0, cachedTimings[reporting::Timers::reRead].Get());
+
+            for (site_t block = 0; block < decomposed.GetBlockCount(); ++block)
+            {
+              CPPUNIT_ASSERT_EQUAL(decomposed.Blocks[block].Sites.size(),
+                                   cached.Blocks[block].Sites.size());
+              for (size_t site = 0; site < decomposed.Blocks[block].Sites.size(); ++site)
+              {
+                CPPUNIT_ASSERT_EQUAL(decomposed.Blocks[block].Sites[site].targetProcessor,
+                                     cached.Blocks[block].Sites[site].targetProcessor);
+              }
+            }
+
+            // The decomposition depends on the lattice, so the cache doesn't apply to another.
+            reporting::Timers otherTimings(Comms());
+            GeometryReader otherReader(false,
+                                       hemelb::lb::lattices::D3Q19::GetLatticeInfo(),
+                                       otherTimings,
+                                       Comms());
+            otherReader.LoadAndDecompose(simConfig->GetDataFilePath(), "four_cube.dcp");
+            CPPUNIT_ASSERT(otherTimings[reporting::Timers::reRead].Get() > 0.0);
+          }
+
         private:
           GeometryReader *reader;
           LatticeData* lattice;
@@ -7,6 +7,9 @@
 #ifndef HEMELB_UNITTESTS_GEOMETRY_LATTICEDATATESTS_H
 #define HEMELB_UNITTESTS_GEOMETRY_LATTICEDATATESTS_H
 
+#include <cmath>
+#include <limits>
+#include <vector>
 #include "geometry/LatticeData.h"
 
 namespace hemelb
@@ -23,6 +26,8 @@ namespace hemelb
           CPPUNIT_TEST ( TestConstruct);
           CPPUNIT_TEST ( TestConvertGlobalId);
           CPPUNIT_TEST ( TestGetProcFromGlobalId);
+          CPPUNIT_TEST ( TestDistributionIndexing);
+          CPPUNIT_TEST ( TestDistributionStoragePrecision);
 
           CPPUNIT_TEST_SUITE_END();
 
@@ -68,6 +73,100 @@ namespace hemelb
             CPPUNIT_ASSERT_EQUAL(latDat->ProcProvidingSiteByGlobalNoncontiguousId(43), 0);
           }
 
+          void TestDistributionIndexing()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            const site_t siteCount = latDat->GetLocalFluidSiteCount();
+
+            // Whatever the storage layout, every (site, direction) pair must map to a distinct
+            // slot before the rubbish site, and reading a site's fOld back must give the values
+            // that were written for it.
+            std::vector<bool> used(siteCount * Lattice::NUMVECTORS, false);
+            for (site_t site = 0; site < siteCount; ++site)
+            {
+              distribn_t fOld[Lattice::NUMVECTORS];
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                site_t index = latDat->GetDistributionIndex<Lattice>(site, direction);
+                CPPUNIT_ASSERT_EQUAL(index, latDat->GetDistributionIndex(site, direction));
+                CPPUNIT_ASSERT(index >= 0);
+                CPPUNIT_ASSERT(index < siteCount * site_t(Lattice::NUMVECTORS));
+                CPPUNIT_ASSERT(!used[index]);
+                used[index] = true;
+
+                fOld[direction] = site * Lattice::NUMVECTORS + direction;
+              }
+              latDat->SetFOld<Lattice>(site, fOld);
+            }
+
+            for (site_t site = 0; site < siteCount; ++site)
+            {
+              const hemelb::geometry::Site<hemelb::geometry::LatticeData> siteData = latDat->GetSite(site);
+              const distribn_t* fOld = siteData.GetFOld<Lattice>();
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                // Exact, unless what's stored is the value less its (sub-unit) weight, which
+                // single precision rounds.
+                const distribn_t expected = site * Lattice::NUMVECTORS + direction;
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected,
+                                             fOld[direction],
+                                             (expected + 1.0) * std::numeric_limits<distribn_storage_t>::epsilon());
+              }
+            }
+
+            // Streaming to a local neighbour must land in that neighbour's slot for the same
+            // direction.
+            const util::Vector3D<site_t> centre(2, 2, 2);
+            const site_t centreId = latDat->GetContiguousSiteId(centre);
+            for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+            {
+              const util::Vector3D<site_t> neighbour = centre
+                  + util::Vector3D<site_t>(Lattice::CX[direction], Lattice::CY[direction], Lattice::CZ[direction]);
+              CPPUNIT_ASSERT_EQUAL(latDat->GetDistributionIndex<Lattice>(latDat->GetContiguousSiteId(neighbour),
+                                                                         direction),
+                                   latDat->GetSite(centreId).GetStreamedIndex<Lattice>(direction));
+            }
+          }
+
+          void TestDistributionStoragePrecision()
+          {
+            typedef lb::lattices::D3Q15 Lattice;
+            const site_t siteCount = latDat->GetLocalFluidSiteCount();
+
+            // Distributions near equilibrium are close to their weight. Storing them loses no
+            // more than the precision of the storage type, relative to the value or, when only
+            // the departure from the weight is stored, relative to that departure.
+            for (site_t site = 0; site < siteCount; ++site)
+            {
+              distribn_t fOld[Lattice::NUMVECTORS];
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                fOld[direction] = Lattice::EQMWEIGHTS[direction] * (1.0 + 1e-3 * std::sin(double(site + direction)));
+              }
+              latDat->SetFOld<Lattice>(site, fOld);
+            }
+
+            for (site_t site = 0; site < siteCount; ++site)
+            {
+              const hemelb::geometry::Site<hemelb::geometry::LatticeData> siteData = latDat->GetSite(site);
+              const distribn_t* fOld = siteData.GetFOld<Lattice>();
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                const distribn_t expected = Lattice::EQMWEIGHTS[direction]
+                    * (1.0 + 1e-3 * std::sin(double(site + direction)));
+#ifdef HEMELB_USE_SHIFTED_DISTRIBUTIONS
+                const distribn_t stored = std::fabs(expected - Lattice::EQMWEIGHTS[direction]);
+#else
+                const distribn_t stored = expected;
+#endif
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected,
+                                             fOld[direction],
+                                             stored * std::numeric_limits<distribn_storage_t>::epsilon()
+                                                 + expected * std::numeric_limits<distribn_t>::epsilon());
+              }
+            }
+          }
+
         private:
       };
       CPPUNIT_TEST_SUITE_REGISTRATION ( NeighbouringLatticeDataTests);
@@ -0,0 +1,80 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_GEOMETRY_LOADMONITORTESTS_H
+#define HEMELB_UNITTESTS_GEOMETRY_LOADMONITORTESTS_H
+
+#include <vector>
+#include "geometry/decomposition/LoadMonitor.h"
+#include "unittests/helpers/FourCubeBasedTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace geometry
+    {
+      using hemelb::geometry::decomposition::LoadMonitor;
+      using hemelb::geometry::decomposition::SiteWeights;
+
+      class LoadMonitorTests : public FourCubeBasedTestFixture
+      {
+          CPPUNIT_TEST_SUITE (LoadMonitorTests);
+          CPPUNIT_TEST (TestBalancedOnOneRank);
+          CPPUNIT_TEST (TestBlockWeights);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestBalancedOnOneRank()
+          {
+            reporting::Timers timers(Comms());
+            LoadMonitor monitor(Comms(), timers);
+            SpendTime(timers);
+
+            // A single rank is the slowest and the mean.
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, monitor.MeasureImbalance(*latDat), 1e-12);
+
+            const std::vector<float> factors = monitor.GetBlockLoadFactors(*latDat, SiteWeights());
+            CPPUNIT_ASSERT_EQUAL(size_t(latDat->GetBlockCount()), factors.size());
+            for (size_t block = 0; block < factors.size(); ++block)
+            {
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, factors[block], 1e-6f);
+            }
+          }
+
+          void TestBlockWeights()
+          {
+            SiteWeights weights;
+            std::vector<float> factors(2, 1.0f);
+            factors[1] = 1.5f;
+            weights.SetBlockLoadFactors(factors);
+
+            for (unsigned type = 0; type < SiteWeights::TYPE_COUNT; ++type)
+            {
+              const int base = weights[type] * SiteWeights::LOAD_FACTOR_RESOLUTION;
+              CPPUNIT_ASSERT_EQUAL(base, weights.GetWeight(type, 0));
+              CPPUNIT_ASSERT_EQUAL(int(1.5 * base + 0.5), weights.GetWeight(type, 1));
+            }
+          }
+
+        private:
+          static void SpendTime(reporting::Timers& timers)
+          {
+            timers[reporting::Timers::lb_calc].Start();
+            volatile double sum = 0.0;
+            for (int i = 0; i < 100000; ++i)
+            {
+              sum += i;
+            }
+            timers[reporting::Timers::lb_calc].Stop();
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (LoadMonitorTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_GEOMETRY_LOADMONITORTESTS_H */
@@ -0,0 +1,85 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_GEOMETRY_NODEPLACEMENTTESTS_H
+#define HEMELB_UNITTESTS_GEOMETRY_NODEPLACEMENTTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "geometry/decomposition/NodePlacement.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace geometry
+    {
+      using hemelb::geometry::decomposition::NodePlacement;
+
+      class NodePlacementTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (NodePlacementTests);
+          CPPUNIT_TEST (TestDetectsNodes);
+          CPPUNIT_TEST (TestOneNodeKeepsParts);
+          CPPUNIT_TEST (TestGroupsLinkedParts);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestDetectsNodes()
+          {
+            NodePlacement placement(Comms());
+            CPPUNIT_ASSERT(placement.GetNodeCount() >= 1);
+            CPPUNIT_ASSERT(placement.GetNodeCount() <= Comms().Size());
+            CPPUNIT_ASSERT_EQUAL(0, placement.GetNode(0));
+          }
+
+          void TestOneNodeKeepsParts()
+          {
+            NodePlacement placement(std::vector<int>(3, 0));
+            std::vector<NodePlacement::PartLink> links;
+            AddLink(links, 0, 2, 10);
+            const std::vector<proc_t> rankForEachPart = placement.PlaceParts(links);
+            for (proc_t part = 0; part < 3; ++part)
+            {
+              CPPUNIT_ASSERT_EQUAL(part, rankForEachPart[part]);
+            }
+          }
+
+          void TestGroupsLinkedParts()
+          {
+            // Ranks placed on two nodes round-robin, and a chain of parts 0-1-2-3 where the
+            // middle link is weakest. Left alone, every link would cross between nodes.
+            int nodes[] = { 0, 1, 0, 1 };
+            NodePlacement placement(std::vector<int>(nodes, nodes + 4));
+            std::vector<NodePlacement::PartLink> links;
+            AddLink(links, 0, 1, 10);
+            AddLink(links, 1, 2, 1);
+            AddLink(links, 2, 3, 10);
+            AddLink(links, 1, 0, 10);
+
+            const std::vector<proc_t> rankForEachPart = placement.PlaceParts(links);
+            CPPUNIT_ASSERT_EQUAL(0, rankForEachPart[0]);
+            CPPUNIT_ASSERT_EQUAL(2, rankForEachPart[1]);
+            CPPUNIT_ASSERT_EQUAL(1, rankForEachPart[2]);
+            CPPUNIT_ASSERT_EQUAL(3, rankForEachPart[3]);
+            CPPUNIT_ASSERT_EQUAL(int64_t(1), placement.CountLinksBetweenNodes(links, rankForEachPart));
+          }
+
+        private:
+          static void AddLink(std::vector<NodePlacement::PartLink>& links, proc_t from, proc_t to,
+                              int64_t count)
+          {
+            NodePlacement::PartLink link = { from, to, count };
+            links.push_back(link);
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (NodePlacementTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_GEOMETRY_NODEPLACEMENTTESTS_H */
@@ -0,0 +1,143 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_GEOMETRY_NODESHAREDHALOTESTS_H
+#define HEMELB_UNITTESTS_GEOMETRY_NODESHAREDHALOTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "geometry/NodeSharedHalo.h"
+#include "lb/lattices/D3Q15.h"
+#include "net/net.h"
+#include "unittests/FourCubeLatticeData.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace geometry
+    {
+      class NodeSharedHaloTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (NodeSharedHaloTests);
+          CPPUNIT_TEST (TestExchangeWithSelf);
+          CPPUNIT_TEST (TestExchangeThroughLatticeData);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestExchangeWithSelf()
+          {
+            // Every rank is on the same node as itself, so use that as the neighbour, twice, with
+            // the second taking values from further into the shared distributions.
+            const site_t firstShared = 10;
+            std::vector<hemelb::geometry::NeighbouringProcessor> neighbours(2);
+            neighbours[0].Rank = Comms().Rank();
+            neighbours[0].SharedDistributionCount = 2;
+            neighbours[0].FirstSharedDistribution = firstShared;
+            neighbours[1].Rank = Comms().Rank();
+            neighbours[1].SharedDistributionCount = 3;
+            neighbours[1].FirstSharedDistribution = firstShared + 2;
+
+            hemelb::geometry::NodeSharedHalo halo(Comms(), neighbours, firstShared);
+            CPPUNIT_ASSERT(halo.IsOnNode(0));
+            CPPUNIT_ASSERT(halo.IsOnNode(1));
+
+            // Several steps, so that both buffers get reused.
+            for (int step = 0; step < 4; ++step)
+            {
+              distribn_storage_t shared[5];
+              for (int i = 0; i < 5; ++i)
+              {
+                shared[i] = 10 * step + i;
+              }
+              halo.Publish(shared);
+              // Change them, to check that they were copied when published.
+              std::fill(shared, shared + 5, -1);
+
+              // Both neighbours are this rank, which put the values for itself at the
+              // position of the last one in the list.
+              const distribn_storage_t* received = halo.Receive(1);
+              for (int i = 0; i < 3; ++i)
+              {
+                CPPUNIT_ASSERT_EQUAL(distribn_storage_t(10 * step + 2 + i), received[i]);
+              }
+              halo.EndReceive();
+            }
+          }
+
+          /**
+           * Exchange the shared distributions of the four cube, split across the ranks, the way
+           * LBM does, so that
+           * with HEMELB_USE_SHARED_MEMORY_HALO and more than one rank on the node, the neighbours
+           * on the node go through the halo and the rest through messages. Each value streamed
+           * across a rank boundary identifies the site it came from and its direction.
+           */
+          void TestExchangeThroughLatticeData()
+          {
+#ifndef HEMELB_USE_AA_STREAMING
+            typedef hemelb::lb::lattices::D3Q15 Lattice;
+            FourCubeLatticeData* fourCube = FourCubeLatticeData::Create(Comms(), 6, 1, true);
+            hemelb::geometry::LatticeData& latDat = *fourCube;
+
+            // Past the fluid sites and the rubbish site, streaming goes to another rank.
+            const site_t firstShared = latDat.GetLocalFluidSiteCount() * Lattice::NUMVECTORS + 1;
+            for (site_t site = 0; site < latDat.GetLocalFluidSiteCount(); ++site)
+            {
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                const site_t streamedIndex = latDat.GetSite(site).GetStreamedIndex<Lattice>(direction);
+                if (streamedIndex >= firstShared)
+                {
+                  *latDat.GetFNew(streamedIndex) = Label(latDat.GetSite(site).GetGlobalSiteCoords(), direction);
+                }
+              }
+            }
+
+            net::Net net(Comms());
+            latDat.SendAndReceive(&net);
+            latDat.PackSharedDistributions();
+            net.Dispatch();
+            latDat.CopyReceivedFromNode();
+
+            // Each site with an upstream neighbour on another rank has that neighbour's value.
+            site_t receivedCount = 0;
+            for (site_t site = 0; site < latDat.GetLocalFluidSiteCount(); ++site)
+            {
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                const Direction inverse = Lattice::INVERSEDIRECTIONS[direction];
+                if (latDat.GetSite(site).GetStreamedIndex<Lattice>(inverse) < firstShared)
+                {
+                  continue;
+                }
+                const util::Vector3D<site_t> upstream = latDat.GetSite(site).GetGlobalSiteCoords()
+                    - util::Vector3D<site_t>(Lattice::CX[direction], Lattice::CY[direction], Lattice::CZ[direction]);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(Label(upstream, direction),
+                                             distribn_t(*latDat.GetFNew(latDat.GetDistributionIndex<Lattice>(site,
+                                                                                                              direction))),
+                                             0.1);
+                ++receivedCount;
+              }
+            }
+            delete fourCube;
+            CPPUNIT_ASSERT_EQUAL(Comms().Size() > 1, receivedCount > 0);
+#endif
+          }
+
+        private:
+          static distribn_t Label(const util::Vector3D<site_t>& position, Direction direction)
+          {
+            // Exact in single precision, less the storage shift, for coordinates under 16.
+            return ( (position.x * 16 + position.y) * 16 + position.z) * 16 + direction;
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (NodeSharedHaloTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_GEOMETRY_NODESHAREDHALOTESTS_H */
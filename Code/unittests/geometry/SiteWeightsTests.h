@@ -0,0 +1,92 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_GEOMETRY_SITEWEIGHTSTESTS_H
+#define HEMELB_UNITTESTS_GEOMETRY_SITEWEIGHTSTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "geometry/decomposition/SiteWeights.h"
+#include "geometry/decomposition/DecompositionWeights.h"
+#include "unittests/helpers/FolderTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace geometry
+    {
+      using hemelb::geometry::decomposition::SiteWeights;
+
+      class SiteWeightsTests : public helpers::FolderTestFixture
+      {
+          CPPUNIT_TEST_SUITE (SiteWeightsTests);
+          CPPUNIT_TEST (TestDefaultIsCompiledWeights);
+          CPPUNIT_TEST (TestFromCosts);
+          CPPUNIT_TEST (TestSaveAndLoad);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestDefaultIsCompiledWeights()
+          {
+            SiteWeights weights;
+            for (unsigned type = 0; type < SiteWeights::TYPE_COUNT; ++type)
+            {
+              CPPUNIT_ASSERT_EQUAL(hemelb::geometry::decomposition::hemelbSiteWeights[type],
+                                   weights[type]);
+            }
+          }
+
+          void TestFromCosts()
+          {
+            // Costs are relative to a bulk site, which weighs MEASURED_BULK_WEIGHT.
+            std::vector<double> secondsPerSite(SiteWeights::TYPE_COUNT, 0.0);
+            secondsPerSite[0] = 2e-7;
+            secondsPerSite[1] = 3e-7;
+            secondsPerSite[2] = 5e-7;
+            secondsPerSite[3] = 1e-9;
+            const SiteWeights weights = SiteWeights::FromCosts(secondsPerSite);
+
+            CPPUNIT_ASSERT_EQUAL(SiteWeights::MEASURED_BULK_WEIGHT, weights[0]);
+            CPPUNIT_ASSERT_EQUAL(15, weights[1]);
+            CPPUNIT_ASSERT_EQUAL(25, weights[2]);
+            // Weights never drop below one.
+            CPPUNIT_ASSERT_EQUAL(1, weights[3]);
+
+            // Unmeasured types keep the compiled-in ratio to bulk sites.
+            const int* compiled = hemelb::geometry::decomposition::hemelbSiteWeights;
+            for (unsigned type = 4; type < SiteWeights::TYPE_COUNT; ++type)
+            {
+              const int expected = (int) (double(compiled[type]) / compiled[0]
+                  * SiteWeights::MEASURED_BULK_WEIGHT + 0.5);
+              CPPUNIT_ASSERT_EQUAL(expected, weights[type]);
+            }
+          }
+
+          void TestSaveAndLoad()
+          {
+            std::vector<double> secondsPerSite(SiteWeights::TYPE_COUNT);
+            for (unsigned type = 0; type < SiteWeights::TYPE_COUNT; ++type)
+            {
+              secondsPerSite[type] = 1e-7 * (type + 1);
+            }
+            const SiteWeights saved = SiteWeights::FromCosts(secondsPerSite);
+            saved.Save("weights.xml");
+            AssertPresent("weights.xml");
+
+            const SiteWeights loaded = SiteWeights::Load("weights.xml");
+            for (unsigned type = 0; type < SiteWeights::TYPE_COUNT; ++type)
+            {
+              CPPUNIT_ASSERT_EQUAL(saved[type], loaded[type]);
+            }
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (SiteWeightsTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_GEOMETRY_SITEWEIGHTSTESTS_H */
@@ -0,0 +1,119 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_GEOMETRY_SPACEFILLINGCURVETESTS_H
+#define HEMELB_UNITTESTS_GEOMETRY_SPACEFILLINGCURVETESTS_H
+
+#include <cstdlib>
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "geometry/decomposition/SpaceFillingCurve.h"
+#include "unittests/helpers/CppUnitCompareVectors.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace geometry
+    {
+      using hemelb::geometry::decomposition::SpaceFillingCurve;
+
+      class SpaceFillingCurveTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (SpaceFillingCurveTests);
+          CPPUNIT_TEST (TestMortonKey);
+          CPPUNIT_TEST (TestHilbertKeyVisitsNeighbours);
+          CPPUNIT_TEST (TestPartitionEqualWeights);
+          CPPUNIT_TEST (TestPartitionUnequalWeights);
+          CPPUNIT_TEST_SUITE_END();
+
+          typedef util::Vector3D<site_t> Point;
+
+        public:
+          void TestMortonKey()
+          {
+            // The bits of x, y and z are interleaved, most significant first.
+            CPPUNIT_ASSERT_EQUAL(uint64_t(0), SpaceFillingCurve::MortonKey(Point(0, 0, 0), 2));
+            CPPUNIT_ASSERT_EQUAL(uint64_t(1), SpaceFillingCurve::MortonKey(Point(0, 0, 1), 2));
+            CPPUNIT_ASSERT_EQUAL(uint64_t(2), SpaceFillingCurve::MortonKey(Point(0, 1, 0), 2));
+            CPPUNIT_ASSERT_EQUAL(uint64_t(4), SpaceFillingCurve::MortonKey(Point(1, 0, 0), 2));
+            CPPUNIT_ASSERT_EQUAL(uint64_t(32), SpaceFillingCurve::MortonKey(Point(2, 0, 0), 2));
+            CPPUNIT_ASSERT_EQUAL(uint64_t(63), SpaceFillingCurve::MortonKey(Point(3, 3, 3), 2));
+          }
+
+          void TestHilbertKeyVisitsNeighbours()
+          {
+            for (unsigned bits = 1; bits <= 3; ++bits)
+            {
+              const site_t side = site_t(1) << bits;
+              std::vector<Point> pointWithKey(side * side * side, Point(-1));
+              for (site_t i = 0; i < side; ++i)
+              {
+                for (site_t j = 0; j < side; ++j)
+                {
+                  for (site_t k = 0; k < side; ++k)
+                  {
+                    uint64_t key = SpaceFillingCurve::HilbertKey(Point(i, j, k), bits);
+                    CPPUNIT_ASSERT(key < pointWithKey.size());
+                    CPPUNIT_ASSERT_EQUAL(site_t(-1), pointWithKey[key].x);
+                    pointWithKey[key] = Point(i, j, k);
+                  }
+                }
+              }
+
+              // Every key is used, and each point along the curve is next to the one before.
+              CPPUNIT_ASSERT_EQUAL(Point(0), pointWithKey[0]);
+              for (size_t key = 1; key < pointWithKey.size(); ++key)
+              {
+                Point step = pointWithKey[key] - pointWithKey[key - 1];
+                CPPUNIT_ASSERT_EQUAL(site_t(1), std::abs(step.x) + std::abs(step.y) + std::abs(step.z));
+              }
+            }
+          }
+
+          void TestPartitionEqualWeights()
+          {
+            uint64_t keyArray[] = { 5, 2, 7, 0, 3, 6, 1, 4 };
+            std::vector<uint64_t> keys(keyArray, keyArray + 8);
+            std::vector<idx_t> weights(8, 1);
+
+            std::vector<idx_t> parts = SpaceFillingCurve::Partition(Comms(), keys, weights, 4);
+
+            CPPUNIT_ASSERT_EQUAL(size_t(8), parts.size());
+            for (size_t point = 0; point < keys.size(); ++point)
+            {
+              CPPUNIT_ASSERT_EQUAL(idx_t(keys[point] / 2), parts[point]);
+            }
+          }
+
+          void TestPartitionUnequalWeights()
+          {
+            // Pieces of the curve with equal weight, however far apart the keys are.
+            uint64_t keyArray[] = { 10, 20, 30, 4000, 50000, 600000 };
+            idx_t weightArray[] = { 3, 1, 1, 1, 1, 1 };
+            std::vector<uint64_t> keys(keyArray, keyArray + 6);
+            std::vector<idx_t> weights(weightArray, weightArray + 6);
+
+            std::vector<idx_t> parts = SpaceFillingCurve::Partition(Comms(), keys, weights, 2);
+
+            idx_t expected[] = { 0, 0, 1, 1, 1, 1 };
+            for (size_t point = 0; point < keys.size(); ++point)
+            {
+              CPPUNIT_ASSERT_EQUAL(expected[point], parts[point]);
+            }
+
+            // A single part has everything.
+            parts = SpaceFillingCurve::Partition(Comms(), keys, weights, 1);
+            CPPUNIT_ASSERT_EQUAL(std::vector<idx_t>(6, 0), parts);
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (SpaceFillingCurveTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_GEOMETRY_SPACEFILLINGCURVETESTS_H */
@@ -10,6 +10,12 @@
 #include "unittests/geometry/GeometryReaderTests.h"
 #include "unittests/geometry/NeedsTests.h"
 #include "unittests/geometry/LatticeDataTests.h"
+#include "unittests/geometry/SpaceFillingCurveTests.h"
+#include "unittests/geometry/NodePlacementTests.h"
+#include "unittests/geometry/SiteWeightsTests.h"
+#include "unittests/geometry/LoadMonitorTests.h"
+#include "unittests/geometry/DistributionMigrationTests.h"
+#include "unittests/geometry/NodeSharedHaloTests.h"
 #include "unittests/geometry/neighbouring/neighbouring.h"
 
 #endif // ONCE
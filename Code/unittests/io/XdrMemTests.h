@@ -0,0 +1,152 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_IO_XDRMEMTESTS_H
+#define HEMELB_UNITTESTS_IO_XDRMEMTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "io/writers/xdr/XdrMemReader.h"
+#include "io/writers/xdr/XdrMemWriter.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace io
+    {
+      namespace xdr = hemelb::io::writers::xdr;
+
+      /**
+       * Check that the bulk array methods of the in-memory XDR reader and writer agree with
+       * reading and writing value by value.
+       */
+      class XdrMemTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE( XdrMemTests);
+          CPPUNIT_TEST( TestWriteMatchesSingleValues);
+          CPPUNIT_TEST( TestReadMatchesSingleValues);
+          CPPUNIT_TEST( TestOverrunIsRefused);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void setUp()
+          {
+            ints.push_back(0x01020304u);
+            ints.push_back(0xfffffffeu);
+            ints.push_back(7u);
+            longs.push_back(0x0102030405060708ull);
+            doubles.push_back(-1.25);
+            doubles.push_back(1.0e-300);
+            floats.push_back(3.5f);
+            floats.push_back(-0.0f);
+            floats.push_back(1.0e30f);
+          }
+
+          void TestWriteMatchesSingleValues()
+          {
+            std::vector<char> singleBuffer(Length()), bulkBuffer(Length());
+            {
+              xdr::XdrMemWriter writer(&singleBuffer[0], singleBuffer.size());
+              writer << uint32_t(42);
+              for (size_t i = 0; i < ints.size(); ++i)
+                writer << ints[i];
+              for (size_t i = 0; i < longs.size(); ++i)
+                writer << longs[i];
+              for (size_t i = 0; i < doubles.size(); ++i)
+                writer << doubles[i];
+              for (size_t i = 0; i < floats.size(); ++i)
+                writer << floats[i];
+            }
+            {
+              // The bulk methods carry on from, and leave the stream where, others do.
+              xdr::XdrMemWriter writer(&bulkBuffer[0], bulkBuffer.size());
+              writer << uint32_t(42);
+              CPPUNIT_ASSERT(writer.writeUnsignedInts(&ints[0], ints.size()));
+              CPPUNIT_ASSERT(writer.writeUnsignedLongs(&longs[0], longs.size()));
+              CPPUNIT_ASSERT(writer.writeDoubles(&doubles[0], doubles.size()));
+              CPPUNIT_ASSERT(writer.writeFloats(&floats[0], floats.size()));
+              CPPUNIT_ASSERT_EQUAL(Length(), writer.getCurrentStreamPosition());
+            }
+            CPPUNIT_ASSERT(singleBuffer == bulkBuffer);
+            // Big-endian.
+            CPPUNIT_ASSERT_EQUAL(char(0x01), bulkBuffer[4]);
+            CPPUNIT_ASSERT_EQUAL(char(0x04), bulkBuffer[7]);
+          }
+
+          void TestReadMatchesSingleValues()
+          {
+            std::vector<char> buffer(Length());
+            {
+              xdr::XdrMemWriter writer(&buffer[0], buffer.size());
+              writer << uint32_t(42);
+              for (size_t i = 0; i < ints.size(); ++i)
+                writer << ints[i];
+              for (size_t i = 0; i < longs.size(); ++i)
+                writer << longs[i];
+              for (size_t i = 0; i < doubles.size(); ++i)
+                writer << doubles[i];
+              for (size_t i = 0; i < floats.size(); ++i)
+                writer << floats[i];
+            }
+
+            xdr::XdrMemReader reader(&buffer[0], buffer.size());
+            unsigned first;
+            reader.readUnsignedInt(first);
+            CPPUNIT_ASSERT_EQUAL(42u, first);
+
+            std::vector<uint32_t> readInts(ints.size());
+            std::vector<uint64_t> readLongs(longs.size());
+            std::vector<double> readDoubles(doubles.size());
+            CPPUNIT_ASSERT(reader.readUnsignedInts(&readInts[0], readInts.size()));
+            CPPUNIT_ASSERT(reader.readUnsignedLongs(&readLongs[0], readLongs.size()));
+            CPPUNIT_ASSERT(reader.readDoubles(&readDoubles[0], readDoubles.size()));
+            CPPUNIT_ASSERT(ints == readInts);
+            CPPUNIT_ASSERT(longs == readLongs);
+            CPPUNIT_ASSERT(doubles == readDoubles);
+
+            // Single reads carry on from where the bulk ones left off.
+            for (size_t i = 0; i < floats.size(); ++i)
+            {
+              float value;
+              CPPUNIT_ASSERT(reader.readFloat(value));
+              CPPUNIT_ASSERT_EQUAL(floats[i], value);
+            }
+          }
+
+          void TestOverrunIsRefused()
+          {
+            std::vector<char> buffer(12, 'x');
+            xdr::XdrMemWriter writer(&buffer[0], buffer.size());
+            writer << uint32_t(1);
+            CPPUNIT_ASSERT(!writer.writeDoubles(&doubles[0], doubles.size()));
+            CPPUNIT_ASSERT_EQUAL(4u, writer.getCurrentStreamPosition());
+            CPPUNIT_ASSERT_EQUAL('x', buffer[4]);
+
+            xdr::XdrMemReader reader(&buffer[0], buffer.size());
+            std::vector<uint32_t> readInts(4);
+            CPPUNIT_ASSERT(!reader.readUnsignedInts(&readInts[0], readInts.size()));
+            CPPUNIT_ASSERT(reader.readUnsignedInts(&readInts[0], 3));
+            CPPUNIT_ASSERT_EQUAL(1u, readInts[0]);
+          }
+
+        private:
+          unsigned Length() const
+          {
+            return 4 + 4 * ints.size() + 8 * longs.size() + 8 * doubles.size() + 4 * floats.size();
+          }
+
+          std::vector<uint32_t> ints;
+          std::vector<uint64_t> longs;
+          std::vector<double> doubles;
+          std::vector<float> floats;
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION( XdrMemTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_IO_XDRMEMTESTS_H
@@ -9,5 +9,6 @@
 
 #include "unittests/io/PathManagerTests.h"
 #include "unittests/io/xml.h"
+#include "unittests/io/XdrMemTests.h"
 
 #endif //ONCE
@@ -0,0 +1,194 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_LBTESTS_COLLECTIVEMONITORINGTESTS_H
+#define HEMELB_UNITTESTS_LBTESTS_COLLECTIVEMONITORINGTESTS_H
+
+#include <algorithm>
+#include <cppunit/TestFixture.h>
+#include <limits>
+
+#include "lb/CollectiveIncompressibilityChecker.h"
+#include "lb/CollectiveStabilityTester.h"
+#include "unittests/FourCubeLatticeData.h"
+#include "unittests/lbtests/LbTestsHelper.h"
+
+#include "unittests/helpers/FourCubeBasedTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace lbtests
+    {
+      /**
+       * The monitors that combine the ranks' results with non-blocking collectives. The results
+       * of a step are available after the next step's PostReceive.
+       */
+      class CollectiveMonitoringTests : public helpers::FourCubeBasedTestFixture
+      {
+          CPPUNIT_TEST_SUITE (CollectiveMonitoringTests);
+          CPPUNIT_TEST (TestIncompressibilityChecker);
+          CPPUNIT_TEST (TestStabilityTester);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void setUp()
+          {
+            FourCubeBasedTestFixture::setUp();
+            LbTestsHelper::InitialiseAnisotropicTestData<lb::lattices::D3Q15>(latDat);
+            cache = new lb::MacroscopicPropertyCache(*simState, *latDat);
+
+            cache->densityCache.SetRefreshFlag();
+            cache->velocityCache.SetRefreshFlag();
+            lbtests::LbTestsHelper::UpdatePropertyCache<lb::lattices::D3Q15>(*latDat, *cache, *simState);
+
+            // See IncompressibilityCheckerTests for where these come from.
+            distribn_t numDirections = (distribn_t) lb::lattices::D3Q15::NUMVECTORS;
+            distribn_t numSites = (distribn_t) latDat->GetLocalFluidSiteCount();
+            smallestDefaultDensity = numDirections * (numDirections + 1) / 20;
+            largestDefaultDensity = (numDirections * (numDirections + 1) / 20)
+                + ( (numSites - 1) * numDirections / 100);
+            largestDefaultVelocityMagnitude = 0.0433012701892219;
+
+            // Every post-collision distribution positive, so that the sites are stable.
+            for (site_t site = 0; site < latDat->GetLocalFluidSiteCount(); ++site)
+            {
+              for (unsigned direction = 0; direction < lb::lattices::D3Q15::NUMVECTORS; ++direction)
+              {
+                *latDat->GetFNew(latDat->GetDistributionIndex<lb::lattices::D3Q15>(site, direction)) = 1.0;
+              }
+            }
+
+            eps = 1e-9 + 10.0 * largestDefaultDensity * std::numeric_limits<distribn_storage_t>::epsilon();
+
+            timings = new hemelb::reporting::Timers(Comms());
+            net = new net::Net(Comms());
+          }
+
+          void tearDown()
+          {
+            delete net;
+            delete timings;
+            delete cache;
+            FourCubeBasedTestFixture::tearDown();
+          }
+
+          void AdvanceActorOneTimeStep(net::IteratedAction& actor)
+          {
+            actor.RequestComms();
+            actor.PreSend();
+            actor.PreReceive();
+            actor.PostReceive();
+            actor.EndIteration();
+          }
+
+          void TestIncompressibilityChecker()
+          {
+            lb::CollectiveIncompressibilityChecker incompChecker(latDat, net, simState, *cache, *timings, 10.0);
+
+            // Nothing until the first reduction has finished, a step after it started.
+            CPPUNIT_ASSERT(!incompChecker.AreDensitiesAvailable());
+            AdvanceActorOneTimeStep(incompChecker);
+            CPPUNIT_ASSERT(!incompChecker.AreDensitiesAvailable());
+            AdvanceActorOneTimeStep(incompChecker);
+            CPPUNIT_ASSERT(incompChecker.AreDensitiesAvailable());
+
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(smallestDefaultDensity, incompChecker.GetGlobalSmallestDensity(), eps);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(largestDefaultDensity, incompChecker.GetGlobalLargestDensity(), eps);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL( (largestDefaultDensity - smallestDefaultDensity)
+                                             / hemelb::lb::REFERENCE_DENSITY,
+                                         incompChecker.GetMaxRelativeDensityDifference(),
+                                         eps);
+            CPPUNIT_ASSERT(incompChecker.IsDensityDiffWithinRange());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(largestDefaultVelocityMagnitude,
+                                         incompChecker.GetGlobalLargestVelocityMagnitude(),
+                                         eps);
+
+            // Densities outside the range, which the checker then remembers once they've gone.
+            distribn_t original[lb::lattices::D3Q15::NUMVECTORS];
+            const geometry::Site<geometry::LatticeData> site = latDat->GetSite(0);
+            const distribn_t* fOld = site.GetFOld<lb::lattices::D3Q15>();
+            std::copy(fOld, fOld + lb::lattices::D3Q15::NUMVECTORS, original);
+            distribn_t dense[lb::lattices::D3Q15::NUMVECTORS];
+            std::fill(dense, dense + lb::lattices::D3Q15::NUMVECTORS, 100.0 / lb::lattices::D3Q15::NUMVECTORS);
+            latDat->SetFOld<lb::lattices::D3Q15>(0, dense);
+            RefreshCache();
+            AdvanceActorOneTimeStep(incompChecker);
+            latDat->SetFOld<lb::lattices::D3Q15>(0, original);
+            RefreshCache();
+            AdvanceActorOneTimeStep(incompChecker);
+
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(smallestDefaultDensity, incompChecker.GetGlobalSmallestDensity(), eps);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, incompChecker.GetGlobalLargestDensity(), eps);
+            CPPUNIT_ASSERT(!incompChecker.IsDensityDiffWithinRange());
+
+            AdvanceActorOneTimeStep(incompChecker);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, incompChecker.GetGlobalLargestDensity(), eps);
+          }
+
+          void TestStabilityTester()
+          {
+            configuration::SimConfig::MonitoringConfig testerConfig;
+            lb::CollectiveStabilityTester<lb::lattices::D3Q15> tester(latDat,
+                                                                      net,
+                                                                      simState,
+                                                                      *cache,
+                                                                      *timings,
+                                                                      &testerConfig);
+            CPPUNIT_ASSERT_EQUAL(lb::UndefinedStability, simState->GetStability());
+
+            AdvanceActorOneTimeStep(tester);
+            CPPUNIT_ASSERT_EQUAL(lb::UndefinedStability, simState->GetStability());
+            AdvanceActorOneTimeStep(tester);
+            CPPUNIT_ASSERT_EQUAL(lb::Stable, simState->GetStability());
+
+            // One site going unstable, however the monitoring finds out about it.
+            geometry::LatticeData::DistributionPointer fNew =
+                latDat->GetFNew(latDat->GetDistributionIndex<lb::lattices::D3Q15>(0, 0));
+            *fNew = -1.0;
+            distribn_t f[lb::lattices::D3Q15::NUMVECTORS];
+            std::fill(f, f + lb::lattices::D3Q15::NUMVECTORS, -1.0);
+            cache->stabilityReduction.AddSite<lb::lattices::D3Q15>(0, f, 1.0, util::Vector3D<distribn_t>::Zero());
+
+            AdvanceActorOneTimeStep(tester);
+            CPPUNIT_ASSERT_EQUAL(lb::Stable, simState->GetStability());
+            AdvanceActorOneTimeStep(tester);
+            CPPUNIT_ASSERT_EQUAL(lb::Unstable, simState->GetStability());
+
+            // Starting again forgets it.
+            *fNew = 1.0;
+            tester.Reset();
+            CPPUNIT_ASSERT_EQUAL(lb::UndefinedStability, simState->GetStability());
+            AdvanceActorOneTimeStep(tester);
+            AdvanceActorOneTimeStep(tester);
+            CPPUNIT_ASSERT_EQUAL(lb::Stable, simState->GetStability());
+          }
+
+        private:
+          void RefreshCache()
+          {
+            cache->densityCache.SetRefreshFlag();
+            cache->velocityCache.SetRefreshFlag();
+            LbTestsHelper::UpdatePropertyCache<lb::lattices::D3Q15>(*latDat, *cache, *simState);
+          }
+
+          lb::MacroscopicPropertyCache* cache;
+          hemelb::reporting::Timers* timings;
+          net::Net* net;
+
+          distribn_t smallestDefaultDensity;
+          distribn_t largestDefaultDensity;
+          distribn_t largestDefaultVelocityMagnitude;
+          distribn_t eps;
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (CollectiveMonitoringTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_LBTESTS_COLLECTIVEMONITORINGTESTS_H */
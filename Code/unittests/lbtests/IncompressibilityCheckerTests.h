@@ -8,6 +8,7 @@
 #define HEMELB_UNITTESTS_LBTESTS_INCOMPRESSIBILITYCHECKERTESTS_H
 
 #include <cppunit/TestFixture.h>
+#include <limits>
 
 #include "lb/IncompressibilityChecker.hpp"
 #include "unittests/FourCubeLatticeData.h"
@@ -49,7 +50,9 @@ namespace hemelb
                 + ( (numSites - 1) * numDirections / 100); // = sum_{j=1}^{numDirections} j/10 + (numSites-1)/100 = 21.45 with current configuration of FourCubeLatticeData
             largestDefaultVelocityMagnitude = 0.0433012701892219; // with current configuration of FourCubeLatticeData
 
-            eps = 1e-9;
+            // The densities are sums over distributions held in their storage type, which may
+            // be single precision.
+            eps = 1e-9 + 10.0 * largestDefaultDensity * std::numeric_limits<distribn_storage_t>::epsilon();
 
             timings = new hemelb::reporting::Timers(Comms());
             net = new net::Net(Comms());
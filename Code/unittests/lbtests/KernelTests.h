@@ -11,6 +11,7 @@
 #include <sstream>
 
 #include "lb/kernels/Kernels.h"
+#include "lb/lattices/Lattices.h"
 #include "lb/kernels/rheologyModels/RheologyModels.h"
 #include "lb/kernels/momentBasis/DHumieresD3Q15MRTBasis.h"
 #include "lb/kernels/momentBasis/DHumieresD3Q19MRTBasis.h"
@@ -39,7 +40,10 @@ namespace hemelb
           CPPUNIT_TEST ( TestLBGKCalculationsAndCollision);
           CPPUNIT_TEST ( TestLBGKNNCalculationsAndCollision);
           CPPUNIT_TEST ( TestMRTConstantRelaxationTimeEqualsLBGK);
-          CPPUNIT_TEST ( TestD3Q19MRTConstantRelaxationTimeEqualsLBGK);CPPUNIT_TEST_SUITE_END();
+          CPPUNIT_TEST ( TestD3Q19MRTConstantRelaxationTimeEqualsLBGK);
+          CPPUNIT_TEST ( TestBatchedLBGKMatchesSingleSite);
+          CPPUNIT_TEST ( TestBatchedTRTMatchesSingleSite);
+          CPPUNIT_TEST ( TestBatchedMRTMatchesSingleSite);CPPUNIT_TEST_SUITE_END();
         public:
           void setUp()
           {
@@ -699,6 +703,90 @@ namespace hemelb
                                                    allowedError);
             }
           }
+
+          void TestBatchedLBGKMatchesSingleSite()
+          {
+            CheckBatchMatchesSingleSite<lb::kernels::LBGK<lb::lattices::D3Q15> >("LBGK D3Q15");
+            CheckBatchMatchesSingleSite<lb::kernels::LBGK<lb::lattices::D3Q19> >("LBGK D3Q19");
+            CheckBatchMatchesSingleSite<lb::kernels::LBGK<lb::lattices::D3Q27> >("LBGK D3Q27");
+            CheckBatchMatchesSingleSite<lb::kernels::LBGK<lb::lattices::D3Q15i> >("LBGK D3Q15i");
+          }
+
+          void TestBatchedTRTMatchesSingleSite()
+          {
+            CheckBatchMatchesSingleSite<lb::kernels::TRT<lb::lattices::D3Q15> >("TRT D3Q15");
+            CheckBatchMatchesSingleSite<lb::kernels::TRT<lb::lattices::D3Q19> >("TRT D3Q19");
+            CheckBatchMatchesSingleSite<lb::kernels::TRT<lb::lattices::D3Q27> >("TRT D3Q27");
+          }
+
+          void TestBatchedMRTMatchesSingleSite()
+          {
+            CheckBatchMatchesSingleSite<lb::kernels::MRT<lb::kernels::momentBasis::DHumieresD3Q15MRTBasis> >("MRT D3Q15");
+            CheckBatchMatchesSingleSite<lb::kernels::MRT<lb::kernels::momentBasis::DHumieresD3Q19MRTBasis> >("MRT D3Q19");
+          }
+
+        private:
+          /**
+           * Collide a partially filled batch of sites with the batched kernel methods and check
+           * every lane against colliding the same site on its own.
+           */
+          template<class Kernel>
+          void CheckBatchMatchesSingleSite(const std::string& name)
+          {
+            typedef typename Kernel::LatticeType Lattice;
+            typedef typename Kernel::KHydroVarsBatch Batch;
+            Kernel kernel(initParams);
+            distribn_t allowedError = 1e-10;
+
+            // Leave the last lane empty when the batch has more than one, to check the padding.
+            Batch batch;
+            batch.siteCount = Batch::WIDTH > 1 ?
+              Batch::WIDTH - 1 :
+              1;
+            distribn_t fOld[Batch::WIDTH][Lattice::NUMVECTORS];
+            for (unsigned lane = 0; lane < batch.siteCount; ++lane)
+            {
+              LbTestsHelper::InitialiseAnisotropicTestData<Lattice>(lane, fOld[lane]);
+              batch.SetF(lane, fOld[lane]);
+            }
+            batch.PadUnusedLanes();
+
+            kernel.CalculateDensityMomentumFeqBatch(batch);
+            kernel.CollideBatch(lbmParams, batch);
+
+            for (unsigned lane = 0; lane < batch.siteCount; ++lane)
+            {
+              lb::kernels::HydroVars<Kernel> hydroVars(fOld[lane]);
+              kernel.CalculateDensityMomentumFeq(hydroVars, lane);
+              kernel.Collide(lbmParams, hydroVars);
+
+              std::stringstream message;
+              message << name << ", lane " << lane;
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(), hydroVars.density, batch.density[lane], allowedError);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(), hydroVars.momentum.x, batch.momentum_x[lane], allowedError);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(), hydroVars.momentum.y, batch.momentum_y[lane], allowedError);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(), hydroVars.momentum.z, batch.momentum_z[lane], allowedError);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(), hydroVars.velocity.x, batch.velocity_x[lane], allowedError);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(), hydroVars.velocity.y, batch.velocity_y[lane], allowedError);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(), hydroVars.velocity.z, batch.velocity_z[lane], allowedError);
+
+              for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+              {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(),
+                                                     hydroVars.GetFEq()[direction],
+                                                     batch.f_eq[direction][lane],
+                                                     allowedError);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(),
+                                                     hydroVars.GetFNeq()[direction],
+                                                     batch.f_neq[direction][lane],
+                                                     allowedError);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(),
+                                                     hydroVars.GetFPostCollision()[direction],
+                                                     batch.fPostCollision[direction][lane],
+                                                     allowedError);
+              }
+            }
+          }
       };
       CPPUNIT_TEST_SUITE_REGISTRATION ( KernelTests);
     }
@@ -0,0 +1,106 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_LBTESTS_STABILITYREDUCTIONTESTS_H
+#define HEMELB_UNITTESTS_LBTESTS_STABILITYREDUCTIONTESTS_H
+
+#include <limits>
+#include <cppunit/TestFixture.h>
+
+#include "lb/StabilityReduction.h"
+#include "lb/lattices/D3Q15.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace lbtests
+    {
+      class StabilityReductionTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE (StabilityReductionTests);
+          CPPUNIT_TEST (TestStability);
+          CPPUNIT_TEST (TestConvergence);
+          CPPUNIT_TEST_SUITE_END();
+
+          typedef lb::lattices::D3Q15 Lattice;
+
+        public:
+          void setUp()
+          {
+            for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+            {
+              f[direction] = Lattice::EQMWEIGHTS[direction];
+            }
+          }
+
+          void TestStability()
+          {
+            lb::StabilityReduction reduction(2);
+            bool unstable, unconverged;
+
+            reduction.AddSite<Lattice>(0, f, 1.0, util::Vector3D<distribn_t>(0.0));
+            reduction.AddSite<Lattice>(1, f, 1.0, util::Vector3D<distribn_t>(0.0));
+            reduction.Collect(unstable, unconverged);
+            CPPUNIT_ASSERT(!unstable);
+            // Without the convergence check, nothing is unconverged.
+            CPPUNIT_ASSERT(!unconverged);
+
+            // A value that isn't positive in any step since the last collection is unstable.
+            f[Lattice::NUMVECTORS - 1] = 0.0;
+            reduction.AddSite<Lattice>(0, f, 1.0, util::Vector3D<distribn_t>(0.0));
+            f[Lattice::NUMVECTORS - 1] = Lattice::EQMWEIGHTS[Lattice::NUMVECTORS - 1];
+            reduction.AddSite<Lattice>(0, f, 1.0, util::Vector3D<distribn_t>(0.0));
+            reduction.Collect(unstable, unconverged);
+            CPPUNIT_ASSERT(unstable);
+
+            // Collecting starts again.
+            reduction.AddSite<Lattice>(0, f, 1.0, util::Vector3D<distribn_t>(0.0));
+            reduction.Collect(unstable, unconverged);
+            CPPUNIT_ASSERT(!unstable);
+
+            // So are NaNs.
+            f[0] = std::numeric_limits<distribn_t>::quiet_NaN();
+            reduction.AddSite<Lattice>(1, f, 1.0, util::Vector3D<distribn_t>(0.0));
+            reduction.Collect(unstable, unconverged);
+            CPPUNIT_ASSERT(unstable);
+          }
+
+          void TestConvergence()
+          {
+            lb::StabilityReduction reduction(2);
+            reduction.SetConvergenceCheck(0.01);
+            bool unstable, unconverged;
+
+            // With no previous velocity, a site can't have converged.
+            reduction.AddSite<Lattice>(0, f, 2.0, util::Vector3D<distribn_t>(0.1, 0.0, 0.0));
+            reduction.AddSite<Lattice>(1, f, 2.0, util::Vector3D<distribn_t>(0.0, 0.1, 0.0));
+            reduction.Collect(unstable, unconverged);
+            CPPUNIT_ASSERT(!unstable);
+            CPPUNIT_ASSERT(unconverged);
+
+            // Velocities (momentum / density) within the tolerance of the last step.
+            reduction.AddSite<Lattice>(0, f, 2.0, util::Vector3D<distribn_t>(0.11, 0.0, 0.0));
+            reduction.AddSite<Lattice>(1, f, 2.0, util::Vector3D<distribn_t>(0.0, 0.1, 0.01));
+            reduction.Collect(unstable, unconverged);
+            CPPUNIT_ASSERT(!unconverged);
+
+            // One site changes by more than the tolerance.
+            reduction.AddSite<Lattice>(0, f, 2.0, util::Vector3D<distribn_t>(0.11, 0.0, 0.0));
+            reduction.AddSite<Lattice>(1, f, 2.0, util::Vector3D<distribn_t>(0.0, 0.1, 0.05));
+            reduction.Collect(unstable, unconverged);
+            CPPUNIT_ASSERT(unconverged);
+          }
+
+        private:
+          distribn_t f[Lattice::NUMVECTORS];
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (StabilityReductionTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_LBTESTS_STABILITYREDUCTIONTESTS_H */
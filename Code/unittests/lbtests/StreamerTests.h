@@ -9,7 +9,9 @@
 
 #include <cppunit/TestFixture.h>
 #include <iostream>
+#include <limits>
 #include <sstream>
+#include <vector>
 
 #include "lb/streamers/Streamers.h"
 #include "geometry/SiteData.h"
@@ -22,7 +24,8 @@ namespace hemelb
   {
     namespace lbtests
     {
-      static const distribn_t allowedError = 1e-10;
+      // The distributions go through their storage type, which may be single precision.
+      static const distribn_t allowedError = 1e-10 + 100.0 * std::numeric_limits<distribn_storage_t>::epsilon();
 
       /**
        * StreamerTests:
@@ -40,7 +43,8 @@ namespace hemelb
           CPPUNIT_TEST ( TestGuoZhengShi);
           CPPUNIT_TEST ( TestNashZerothOrderPressureIolet);
           CPPUNIT_TEST ( TestNashZerothOrderPressureBB);
-          CPPUNIT_TEST ( TestJunkYangEquivalentToBounceBack);CPPUNIT_TEST_SUITE_END();
+          CPPUNIT_TEST ( TestJunkYangEquivalentToBounceBack);
+          CPPUNIT_TEST ( TestSeveralStepsMatchTwoArrayStreaming);CPPUNIT_TEST_SUITE_END();
         public:
 
           void setUp()
@@ -83,9 +87,6 @@ namespace hemelb
               geometry::Site < geometry::LatticeData > streamedSite
                   = latDat->GetSite(streamedToSite);
 
-              distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
-                  * streamedToSite);
-
               for (unsigned int streamedDirection = 0; streamedDirection
                   < lb::lattices::D3Q15::NUMVECTORS; ++streamedDirection)
               {
@@ -98,7 +99,7 @@ namespace hemelb
                 if (streamerIndex >= 0 && streamerIndex < (lb::lattices::D3Q15::NUMVECTORS
                     * latDat->GetLocalFluidSiteCount()))
                 {
-                  site_t streamerSiteId = streamerIndex / lb::lattices::D3Q15::NUMVECTORS;
+                  site_t streamerSiteId = GetSiteOfDistribution(streamerIndex);
 
                   // Calculate streamerFOld at this site.
                   distribn_t streamerFOld[lb::lattices::D3Q15::NUMVECTORS];
@@ -116,7 +117,7 @@ namespace hemelb
                   // in the same direction as we're streaming from.
                   CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("SimpleCollideAndStream, StreamAndCollide",
                                                        streamerHydroVars.GetFPostCollision()[streamedDirection],
-                                                       streamedToFNew[streamedDirection],
+                                                       GetFNew(streamedToSite, streamedDirection),
                                                        allowedError);
                 }
               }
@@ -149,9 +150,6 @@ namespace hemelb
               const geometry::Site<geometry::LatticeData> streamedSite =
                   latDat->GetSite(streamedToSite);
 
-              distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
-                  * streamedToSite);
-
               for (unsigned int streamedDirection = 0; streamedDirection
                   < lb::lattices::D3Q15::NUMVECTORS; ++streamedDirection)
               {
@@ -168,7 +166,7 @@ namespace hemelb
                 if (streamerIndex >= 0 && streamerIndex < (lb::lattices::D3Q15::NUMVECTORS
                     * latDat->GetLocalFluidSiteCount()))
                 {
-                  site_t streamerSiteId = streamerIndex / lb::lattices::D3Q15::NUMVECTORS;
+                  site_t streamerSiteId = GetSiteOfDistribution(streamerIndex);
 
                   // Calculate streamerFOld at this site.
                   distribn_t streamerFOld[lb::lattices::D3Q15::NUMVECTORS];
@@ -186,7 +184,7 @@ namespace hemelb
                   // in the same direction as we're streaming from.
                   CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("SimpleCollideAndStream, StreamAndCollide",
                                                        streamerHydroVars.GetFPostCollision()[streamedDirection],
-                                                       streamedToFNew[streamedDirection],
+                                                       GetFNew(streamedToSite, streamedDirection),
                                                        allowedError);
                 }
                 else if (streamedSite.GetSiteType() == geometry::INLET_TYPE
@@ -235,8 +233,7 @@ namespace hemelb
                   distribn_t awayFromWallFOld[lb::lattices::D3Q15::NUMVECTORS];
 
                   site_t awayFromWallIndex =
-                      streamedSite.GetStreamedIndex<lb::lattices::D3Q15> (streamedDirection)
-                          / lb::lattices::D3Q15::NUMVECTORS;
+                      GetSiteOfDistribution(streamedSite.GetStreamedIndex<lb::lattices::D3Q15> (streamedDirection));
 
                   // If there's a valid index in that direction, use BFL
                   if (awayFromWallIndex >= 0 && awayFromWallIndex
@@ -275,9 +272,7 @@ namespace hemelb
                     // Assert that this is the case.
                     CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(msg.str(),
                                                          streamed,
-                                                         * (latDat->GetFNew(streamedToSite
-                                                             * lb::lattices::D3Q15::NUMVECTORS
-                                                             + streamedDirection)),
+                                                         GetFNew(streamedToSite, streamedDirection),
                                                          allowedError);
                   }
 
@@ -290,9 +285,7 @@ namespace hemelb
 
                     CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(msg.str(),
                                                          hydroVars.GetFPostCollision()[oppDirection],
-                                                         * (latDat->GetFNew(streamedToSite
-                                                             * lb::lattices::D3Q15::NUMVECTORS
-                                                             + streamedDirection)),
+                                                         GetFNew(streamedToSite, streamedDirection),
                                                          allowedError);
                   }
                 }
@@ -363,8 +356,6 @@ namespace hemelb
               site_t streamedToSite = firstWallSite + wallSiteLocalIndex;
               const geometry::Site<geometry::LatticeData> streamedSite =
                   latDat->GetSite(streamedToSite);
-              distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
-                  * streamedToSite);
 
               for (unsigned int streamedDirection = 0; streamedDirection
                   < lb::lattices::D3Q15::NUMVECTORS; ++streamedDirection)
@@ -380,7 +371,7 @@ namespace hemelb
                     * latDat->GetLocalFluidSiteCount()))
                 {
                   // The streamer index is a valid index in the domain, therefore stream and collide has happened
-                  site_t streamerSiteId = streamerIndex / lb::lattices::D3Q15::NUMVECTORS;
+                  site_t streamerSiteId = GetSiteOfDistribution(streamerIndex);
 
                   // Calculate streamerFOld at this site.
                   distribn_t streamerFOld[lb::lattices::D3Q15::NUMVECTORS];
@@ -398,7 +389,7 @@ namespace hemelb
                   // in the same direction as we're streaming from.
                   CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("SimpleCollideAndStream, StreamAndCollide",
                                                        streamerHydroVars.GetFPostCollision()[streamedDirection],
-                                                       streamedToFNew[streamedDirection],
+                                                       GetFNew(streamedToSite, streamedDirection),
                                                        allowedError);
                 }
                 else
@@ -423,7 +414,7 @@ namespace hemelb
                   msg << "Simple bounce-back: site " << streamedToSite << " direction "
                       << streamedDirection;
                   CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(msg.str(),
-                                                       streamedToFNew[streamedDirection],
+                                                       GetFNew(streamedToSite, streamedDirection),
                                                        hydroVars.GetFPostCollision()[oppDirection],
                                                        allowedError);
                 }
@@ -503,9 +494,8 @@ namespace hemelb
                     {
                       // This is the second method for estimating: using the next fluid site
                       // away from the wall.
-                      const site_t nextSiteAwayFromWall = streamer.GetStreamedIndex<
-                          lb::lattices::D3Q15> (streamedDirection)
-                          / lb::lattices::D3Q15::NUMVECTORS;
+                      const site_t nextSiteAwayFromWall =
+                          GetSiteOfDistribution(streamer.GetStreamedIndex<lb::lattices::D3Q15> (streamedDirection));
                       const geometry::Site<geometry::LatticeData>& nextSiteAway =
                           latDat->GetSite(nextSiteAwayFromWall);
                       distribn_t nextSiteOutFOld[lb::lattices::D3Q15::NUMVECTORS];
@@ -550,8 +540,7 @@ namespace hemelb
                     distribn_t prediction = fEqm[streamedDirection] + (1.0 + lbmParams->GetOmega())
                         * fNeqWall;
                     // This is the answer from the code we're testing
-                    distribn_t streamedFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
-                        * chosenSite)[streamedDirection];
+                    distribn_t streamedFNew = GetFNew(chosenSite, streamedDirection);
 
                     CPPUNIT_ASSERT_DOUBLES_EQUAL(prediction, streamedFNew, allowedError);
                     break;
@@ -566,8 +555,7 @@ namespace hemelb
                       Direction inv = lb::lattices::D3Q15::INVERSEDIRECTIONS[streamedDirection];
                       distribn_t prediction = streamerHydroVars.GetFPostCollision()[inv];
                       // This is the answer from the code we're testing
-                      distribn_t streamedFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
-                          * chosenSite)[streamedDirection];
+                      distribn_t streamedFNew = GetFNew(chosenSite, streamedDirection);
                       CPPUNIT_ASSERT_DOUBLES_EQUAL(prediction, streamedFNew, allowedError);
                     }
                     else
@@ -596,8 +584,7 @@ namespace hemelb
                       distribn_t prediction = fEqm[streamedDirection] + (1.0
                           + lbmParams->GetOmega()) * fNeqWall;
                       // This is the answer from the code we're testing
-                      distribn_t streamedFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
-                          * chosenSite)[streamedDirection];
+                      distribn_t streamedFNew = GetFNew(chosenSite, streamedDirection);
 
                       CPPUNIT_ASSERT_DOUBLES_EQUAL(prediction, streamedFNew, allowedError);
 
@@ -702,8 +689,6 @@ namespace hemelb
               site_t streamedToSite = firstWallSite + wallSiteLocalIndex;
               const geometry::Site<geometry::LatticeData> streamedSite =
                   latDat->GetSite(streamedToSite);
-              distribn_t* streamedToFNew = latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
-                  * streamedToSite);
 
               for (unsigned int streamedDirection = 0; streamedDirection
                   < lb::lattices::D3Q15::NUMVECTORS; ++streamedDirection)
@@ -719,7 +704,7 @@ namespace hemelb
                     * latDat->GetLocalFluidSiteCount()))
                 {
                   // The streamer index is a valid index in the domain, therefore stream and collide has happened
-                  site_t streamerSiteId = streamerIndex / lb::lattices::D3Q15::NUMVECTORS;
+                  site_t streamerSiteId = GetSiteOfDistribution(streamerIndex);
 
                   // Calculate streamerFOld at this site.
                   distribn_t streamerFOld[lb::lattices::D3Q15::NUMVECTORS];
@@ -737,7 +722,7 @@ namespace hemelb
                   // in the same direction as we're streaming from.
                   CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("SimpleCollideAndStream, StreamAndCollide",
                                                        streamerHydroVars.GetFPostCollision()[streamedDirection],
-                                                       streamedToFNew[streamedDirection],
+                                                       GetFNew(streamedToSite, streamedDirection),
                                                        allowedError);
                 }
                 else
@@ -762,7 +747,7 @@ namespace hemelb
                   msg << "Junk&Yang bounce-back equivalent: site " << streamedToSite
                       << " direction " << streamedDirection;
                   CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(msg.str(),
-                                                       streamedToFNew[streamedDirection],
+                                                       GetFNew(streamedToSite, streamedDirection),
                                                        hydroVars.GetFPostCollision()[oppDirection],
                                                        allowedError);
                 }
@@ -875,8 +860,7 @@ namespace hemelb
                                                                         ghostSiteMomentum.z,
                                                                         ghostPostCollision);
 
-                  CPPUNIT_ASSERT_DOUBLES_EQUAL(latDat->GetFNew(chosenSite
-                                                   * lb::lattices::D3Q15::NUMVECTORS)[chosenUnstreamedDirection],
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(GetFNew(chosenSite, chosenUnstreamedDirection),
                                                ghostPostCollision[chosenUnstreamedDirection],
                                                allowedError);
                 }
@@ -972,8 +956,7 @@ namespace hemelb
                 // Check the case by a wall.
                 if (streamer.HasWall(streamedDirection))
                 {
-                  distribn_t streamedToFNew = *latDat->GetFNew(lb::lattices::D3Q15::NUMVECTORS
-                      * chosenSite + inverseDirection);
+                  distribn_t streamedToFNew = GetFNew(chosenSite, inverseDirection);
 
                   CPPUNIT_ASSERT_DOUBLES_EQUAL(streamerHydroVars.GetFPostCollision()[streamedDirection],
                                                streamedToFNew,
@@ -1006,8 +989,7 @@ namespace hemelb
                                                                         ghostSiteMomentum.z,
                                                                         ghostPostCollision);
 
-                  CPPUNIT_ASSERT_DOUBLES_EQUAL(latDat->GetFNew(chosenSite
-                                                   * lb::lattices::D3Q15::NUMVECTORS)[chosenUnstreamedDirection],
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(GetFNew(chosenSite, chosenUnstreamedDirection),
                                                ghostPostCollision[chosenUnstreamedDirection],
                                                allowedError);
                 }
@@ -1015,7 +997,108 @@ namespace hemelb
             }
           }
 
+          /**
+           * Run several time steps, bouncing back at every wall and iolet link so that each
+           * distribution is written on every step, and compare the distributions after each
+           * step with plain two-array streaming done here. With AA-pattern streaming
+           * (HEMELB_USE_AA_STREAMING) that checks both the even and the odd steps.
+           */
+          void TestSeveralStepsMatchTwoArrayStreaming()
+          {
+            typedef lb::collisions::Normal<lb::kernels::LBGK<lb::lattices::D3Q15> > Collision;
+            lb::streamers::WallIoletStreamerTypeFactory<Collision, lb::streamers::SimpleBounceBackDelegate<Collision>,
+                lb::streamers::SimpleBounceBackDelegate<Collision> > bounceBack(initParams);
+
+            LbTestsHelper::InitialiseAnisotropicTestData<lb::lattices::D3Q15>(latDat);
+
+            const site_t siteCount = latDat->GetLocalFluidSiteCount();
+            std::vector<distribn_t> fOld(siteCount * lb::lattices::D3Q15::NUMVECTORS);
+            std::vector<distribn_t> fNew(siteCount * lb::lattices::D3Q15::NUMVECTORS);
+            for (site_t site = 0; site < siteCount; ++site)
+            {
+              LbTestsHelper::InitialiseAnisotropicTestData<lb::lattices::D3Q15>(site,
+                                                                                &fOld[site
+                                                                                    * lb::lattices::D3Q15::NUMVECTORS]);
+            }
+
+            for (unsigned step = 0; step < 4; ++step)
+            {
+              bounceBack.StreamAndCollide<false> (0, siteCount, lbmParams, latDat, *propertyCache);
+              bounceBack.PostStep<false> (0, siteCount, lbmParams, latDat, *propertyCache);
+              latDat->SwapOldAndNew();
+
+              for (site_t site = 0; site < siteCount; ++site)
+              {
+                geometry::Site<geometry::LatticeData> streamerSite = latDat->GetSite(site);
+                lb::kernels::HydroVars<lb::kernels::LBGK<lb::lattices::D3Q15> >
+                    hydroVars(&fOld[site * lb::lattices::D3Q15::NUMVECTORS]);
+                hydroVars.tau = lbmParams->GetTau();
+                normalCollision->CalculatePreCollision(hydroVars, streamerSite);
+                normalCollision->Collide(lbmParams, hydroVars);
+
+                for (Direction direction = 0; direction < lb::lattices::D3Q15::NUMVECTORS; ++direction)
+                {
+                  if (streamerSite.HasWall(direction) || streamerSite.HasIolet(direction))
+                  {
+                    fNew[site * lb::lattices::D3Q15::NUMVECTORS + lb::lattices::D3Q15::INVERSEDIRECTIONS[direction]] =
+                        hydroVars.GetFPostCollision()[direction];
+                  }
+                  else
+                  {
+                    const site_t streamedToSite =
+                        GetSiteOfDistribution(streamerSite.GetStreamedIndex<lb::lattices::D3Q15> (direction));
+                    fNew[streamedToSite * lb::lattices::D3Q15::NUMVECTORS + direction] =
+                        hydroVars.GetFPostCollision()[direction];
+                  }
+                }
+              }
+              fOld.swap(fNew);
+
+              for (site_t site = 0; site < siteCount; ++site)
+              {
+                const geometry::Site<geometry::LatticeData> streamedSite = latDat->GetSite(site);
+                const distribn_t* streamedFOld = streamedSite.GetFOld<lb::lattices::D3Q15> ();
+                for (Direction direction = 0; direction < lb::lattices::D3Q15::NUMVECTORS; ++direction)
+                {
+                  std::stringstream message;
+                  message << "Step " << step << ", site " << site << ", direction " << direction;
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message.str(),
+                                                       fOld[site * lb::lattices::D3Q15::NUMVECTORS + direction],
+                                                       streamedFOld[direction],
+                                                       allowedError);
+                }
+              }
+            }
+          }
+
         private:
+          /**
+           * The distribution streamed to a site in a direction, wherever the storage layout
+           * keeps it.
+           */
+          distribn_t GetFNew(site_t site, Direction direction) const
+          {
+            return *latDat->GetFNew(latDat->GetFNewIndex<lb::lattices::D3Q15>(site, direction));
+          }
+
+          /**
+           * The site that a distribution index belongs to, whatever the storage layout. Indices
+           * past the fluid sites' distributions (the rubbish site and those shared with other
+           * ranks) give the local fluid site count.
+           */
+          site_t GetSiteOfDistribution(site_t distributionIndex) const
+          {
+            if (distributionIndex >= lb::lattices::D3Q15::NUMVECTORS * latDat->GetLocalFluidSiteCount())
+            {
+              return latDat->GetLocalFluidSiteCount();
+            }
+#ifdef HEMELB_USE_SOA_DISTRIBUTIONS
+            return distributionIndex % latDat->GetLocalFluidSiteCount();
+#else
+            return distributionIndex / lb::lattices::D3Q15::NUMVECTORS;
+#endif
+          }
+
           lb::MacroscopicPropertyCache* propertyCache;
           lb::collisions::Normal<lb::kernels::LBGK<lb::lattices::D3Q15> >* normalCollision;
       };
@@ -494,11 +494,15 @@ namespace hemelb
                   LatticeVector pos(i, j, k);
                   site_t siteIdx = latDat->GetContiguousSiteId(pos);
                   //geometry::Site < geometry::LatticeData > site = latDat->GetSite(siteIdx);
-                  distribn_t* fOld = latDat->GetFNew(siteIdx * Lattice::NUMVECTORS);
+                  distribn_t fEq[Lattice::NUMVECTORS];
                   LatticeDensity rho = GetDensity(pos);
                   LatticeVelocity u = GetVelocity(pos);
                   u *= rho;
-                  Lattice::CalculateFeq(rho, u.x, u.y, u.z, fOld);
+                  Lattice::CalculateFeq(rho, u.x, u.y, u.z, fEq);
+                  for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+                  {
+                    *latDat->GetFNew(latDat->GetDistributionIndex<Lattice>(siteIdx, direction)) = fEq[direction];
+                  }
                 }
               }
             }
@@ -49,6 +49,7 @@ namespace hemelb
             CPPUNIT_TEST_SUITE(InOutLetTests);
             CPPUNIT_TEST(TestCosineConstruct);
             CPPUNIT_TEST(TestFileConstruct);
+            CPPUNIT_TEST(TestFileRepeats);
             CPPUNIT_TEST(TestIoletCoordinates);
             CPPUNIT_TEST(TestParabolicVelocityConstruct);
             CPPUNIT_TEST(TestWomersleyVelocityConstruct);
@@ -166,6 +167,42 @@ namespace hemelb
               FolderTestFixture::tearDown();
             }
 
+            void TestFileRepeats()
+            {
+              FolderTestFixture::setUp();
+              CopyResourceToTempdir("iolet.txt");
+              MoveToTempdir();
+
+              UncheckedSimConfig config(Resource("config_file_inlet.xml").Path());
+              lb::SimulationState state = lb::SimulationState(config.GetTimeStepLength(),
+                                                              config.GetTotalTimeSteps());
+              const util::UnitConverter& converter = config.GetUnitConverter();
+              file = static_cast<InOutLetFile*>(config.GetInlets()[0]);
+              file->Initialise(&converter);
+              file->Reset(state);
+
+              // The file's waveform lasts 4s, which is the length of this simulation. It should
+              // be interpolated between its points, and repeat after it ends.
+              const LatticeTimeStep period = converter.ConvertTimeToLatticeUnits(4.0);
+              const LatticeTimeStep quarter = period / 4;
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(80.0,
+                                           converter.ConvertPressureToPhysicalUnits(file->GetDensity(quarter)
+                                               * Cs2),
+                                           1e-6);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(81.0,
+                                           converter.ConvertPressureToPhysicalUnits(file->GetDensity(quarter
+                                               + quarter / 2) * Cs2),
+                                           1e-6);
+              for (LatticeTimeStep timeStep = 0; timeStep <= period; timeStep += quarter / 2)
+              {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(file->GetDensity(timeStep), file->GetDensity(timeStep + period), 1e-12);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(file->GetDensity(timeStep),
+                                             file->GetDensity(timeStep + 250 * period),
+                                             1e-12);
+              }
+              FolderTestFixture::tearDown();
+            }
+
             void TestParabolicVelocityConstruct()
             {
 
@@ -331,6 +368,15 @@ namespace hemelb
                 CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0075, physVelPointEqui[2], 1e-9);
               }
 
+              // The velocity is the peak speed scaled by a fixed profile, which streamers can
+              // look up once per link.
+              CPPUNIT_ASSERT(fileVel->HasFixedProfile());
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, fileVel->GetProfileWeight(pointAtCentrelineLatticeUnits), 1e-12);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(0.75, fileVel->GetProfileWeight(pointEquidistant), 1e-12);
+              CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01,
+                                           converter.ConvertVelocityToPhysicalUnits(fileVel->GetProfileSpeed(converter.ConvertTimeToLatticeUnits(3.0))),
+                                           1e-9);
+
               FolderTestFixture::tearDown();
             }
 
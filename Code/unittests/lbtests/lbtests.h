@@ -12,6 +12,8 @@
 #include "unittests/lbtests/StreamerTests.h"
 #include "unittests/lbtests/RheologyModelTests.h"
 #include "unittests/lbtests/IncompressibilityCheckerTests.h"
+#include "unittests/lbtests/CollectiveMonitoringTests.h"
+#include "unittests/lbtests/StabilityReductionTests.h"
 #include "unittests/lbtests/LatticeTests.h"
 #include "unittests/lbtests/iolets/BoundaryTests.h"
 #include "unittests/lbtests/iolets/InOutLetTests.h"
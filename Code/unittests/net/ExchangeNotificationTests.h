@@ -0,0 +1,98 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_NET_EXCHANGENOTIFICATIONTESTS_H
+#define HEMELB_UNITTESTS_NET_EXCHANGENOTIFICATIONTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "net/net.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace net
+    {
+      using namespace hemelb::net;
+
+      /**
+       * Records the ranks it's told about, and the value in a receive buffer at the time.
+       */
+      class RecordingExchangeListener : public ExchangeListener
+      {
+        public:
+          RecordingExchangeListener(const int& buffer) :
+              buffer(buffer)
+          {
+          }
+
+          void ExchangeComplete(proc_t rank)
+          {
+            ranks.push_back(rank);
+            valuesSeen.push_back(buffer);
+          }
+
+          const int& buffer;
+          std::vector<proc_t> ranks;
+          std::vector<int> valuesSeen;
+      };
+
+      class ExchangeNotificationTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (ExchangeNotificationTests);
+          CPPUNIT_TEST (TestNotifiedOnceAfterReceive);
+          CPPUNIT_TEST (TestNotifiedWithoutComms);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestNotifiedOnceAfterReceive()
+          {
+            Net net(Comms());
+            int sent = 42;
+            int received = 0;
+            RecordingExchangeListener listener(received);
+
+            net.RequestSendR(sent, Comms().Rank());
+            net.RequestReceiveR(received, Comms().Rank());
+            net.RequestExchangeNotification(Comms().Rank(), listener);
+            net.Dispatch();
+
+            CPPUNIT_ASSERT_EQUAL(size_t(1), listener.ranks.size());
+            CPPUNIT_ASSERT_EQUAL(Comms().Rank(), listener.ranks[0]);
+            // The data had arrived by the time the listener was told.
+            CPPUNIT_ASSERT_EQUAL(42, listener.valuesSeen[0]);
+
+            // Requests only last for one Wait.
+            net.RequestSendR(sent, Comms().Rank());
+            net.RequestReceiveR(received, Comms().Rank());
+            net.Dispatch();
+            CPPUNIT_ASSERT_EQUAL(size_t(1), listener.ranks.size());
+          }
+
+          void TestNotifiedWithoutComms()
+          {
+            Net net(Comms());
+            int unused = 0;
+            RecordingExchangeListener listener(unused);
+            RecordingExchangeListener otherListener(unused);
+
+            // With nothing to wait for, listeners are still told by the end of the Wait.
+            net.RequestExchangeNotification(Comms().Rank(), listener);
+            net.RequestExchangeNotification(Comms().Rank(), otherListener);
+            net.Dispatch();
+
+            CPPUNIT_ASSERT_EQUAL(size_t(1), listener.ranks.size());
+            CPPUNIT_ASSERT_EQUAL(size_t(1), otherListener.ranks.size());
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (ExchangeNotificationTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_NET_EXCHANGENOTIFICATIONTESTS_H
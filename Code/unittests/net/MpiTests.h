@@ -27,6 +27,7 @@ namespace hemelb
         public:
         CPPUNIT_TEST_SUITE (MpiTests);
         CPPUNIT_TEST (TestMpiComm);
+        CPPUNIT_TEST (TestScanSplitAndGather);
         CPPUNIT_TEST_SUITE_END();
 
           void TestMpiComm()
@@ -57,7 +58,47 @@ namespace hemelb
               CPPUNIT_ASSERT(commWorld2 != commWorld);
             }
           }
+
+          void TestScanSplitAndGather()
+          {
+            MpiCommunicator commWorld = MpiCommunicator::World();
+            const int rank = commWorld.Rank();
+
+            // 1 + 2 + ... + rank
+            CPPUNIT_ASSERT_EQUAL(rank * (rank + 1) / 2, commWorld.ExclusiveScan(rank + 1, MPI_SUM));
+
+            // Keep the order, but in reverse.
+            MpiCommunicator reversed = commWorld.Split(0, -rank);
+            CPPUNIT_ASSERT_EQUAL(commWorld.Size(), reversed.Size());
+            CPPUNIT_ASSERT_EQUAL(commWorld.Size() - 1 - rank, reversed.Rank());
+
+            // Each rank sends as many values as its rank, all its rank.
+            std::vector<int> counts(commWorld.Size());
+            for (int other = 0; other < commWorld.Size(); ++other)
+            {
+              counts[other] = other;
+            }
+            std::vector<int> gathered = commWorld.GatherV(std::vector<int>(rank, rank), counts, 0);
+            if (rank == 0)
+            {
+              CPPUNIT_ASSERT_EQUAL(size_t(commWorld.Size() * (commWorld.Size() - 1) / 2),
+                                   gathered.size());
+              size_t index = 0;
+              for (int other = 0; other < commWorld.Size(); ++other)
+              {
+                for (int value = 0; value < other; ++value)
+                {
+                  CPPUNIT_ASSERT_EQUAL(other, gathered[index++]);
+                }
+              }
+            }
+            else
+            {
+              CPPUNIT_ASSERT(gathered.empty());
+            }
+          }
       };
+
       CPPUNIT_TEST_SUITE_REGISTRATION (MpiTests);
     }
   }
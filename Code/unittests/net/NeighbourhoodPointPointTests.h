@@ -0,0 +1,93 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_NET_NEIGHBOURHOODPOINTPOINTTESTS_H
+#define HEMELB_UNITTESTS_NET_NEIGHBOURHOODPOINTPOINTTESTS_H
+
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include "net/net.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+#include "unittests/net/ExchangeNotificationTests.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace net
+    {
+      using namespace hemelb::net;
+
+      // A Net using the neighbourhood collective, whatever the build's default is.
+      class NeighbourhoodNet : public NeighbourhoodPointPoint,
+                               public InterfaceDelegationNet,
+                               public SeparatedAllToAll,
+                               public SeparatedGathers
+      {
+        public:
+          NeighbourhoodNet(const MpiCommunicator &communicator) :
+              BaseNet(communicator), StoringNet(communicator), NeighbourhoodPointPoint(communicator),
+                  InterfaceDelegationNet(communicator), SeparatedAllToAll(communicator),
+                  SeparatedGathers(communicator)
+          {
+          }
+      };
+
+      class NeighbourhoodPointPointTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (NeighbourhoodPointPointTests);
+          CPPUNIT_TEST (TestWithoutNeighbourhood);
+          CPPUNIT_TEST (TestWithNeighbourhood);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestWithoutNeighbourhood()
+          {
+            NeighbourhoodNet net(Comms());
+            int sent = 5;
+            int received = 0;
+
+            net.RequestSendR(sent, Comms().Rank());
+            net.RequestReceiveR(received, Comms().Rank());
+            net.Dispatch();
+            CPPUNIT_ASSERT_EQUAL(5, received);
+          }
+
+          void TestWithNeighbourhood()
+          {
+            NeighbourhoodNet net(Comms());
+            net.DeclareNeighbourhood(std::vector<proc_t>(1, Comms().Rank()));
+
+            double sent[2] = { 0.0, 0.0 };
+            double received[2] = { 0.0, 0.0 };
+            int unused = 0;
+            RecordingExchangeListener listener(unused);
+
+            for (int step = 0; step < 3; ++step)
+            {
+              sent[0] = 1.5 * step;
+              sent[1] = -2.5 * step;
+              net.RequestSend(sent, 2, Comms().Rank());
+              net.RequestReceive(received, 2, Comms().Rank());
+              net.RequestExchangeNotification(Comms().Rank(), listener);
+              net.Dispatch();
+
+              CPPUNIT_ASSERT_EQUAL(1.5 * step, received[0]);
+              CPPUNIT_ASSERT_EQUAL(-2.5 * step, received[1]);
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(3), listener.ranks.size());
+
+            // Everyone still goes through an exchange with nothing in it.
+            net.Dispatch();
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (NeighbourhoodPointPointTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_NET_NEIGHBOURHOODPOINTPOINTTESTS_H
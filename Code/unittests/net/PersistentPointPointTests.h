@@ -0,0 +1,106 @@
+
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_NET_PERSISTENTPOINTPOINTTESTS_H
+#define HEMELB_UNITTESTS_NET_PERSISTENTPOINTPOINTTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "net/net.h"
+#include "unittests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace net
+    {
+      using namespace hemelb::net;
+
+      // A Net using persistent point-to-point, whatever the build's default is.
+      class PersistentNet : public PersistentPointPoint,
+                            public InterfaceDelegationNet,
+                            public SeparatedAllToAll,
+                            public SeparatedGathers
+      {
+        public:
+          PersistentNet(const MpiCommunicator &communicator) :
+              BaseNet(communicator), StoringNet(communicator), PersistentPointPoint(communicator),
+                  InterfaceDelegationNet(communicator), SeparatedAllToAll(communicator),
+                  SeparatedGathers(communicator)
+          {
+          }
+      };
+
+      class PersistentPointPointTests : public helpers::HasCommsTestFixture
+      {
+          CPPUNIT_TEST_SUITE (PersistentPointPointTests);
+          CPPUNIT_TEST (TestRepeatedExchangeReusesPlan);
+          CPPUNIT_TEST (TestChangedExchangeGetsNewPlan);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestRepeatedExchangeReusesPlan()
+          {
+            PersistentNet net(Comms());
+            int sent[2] = { 1, 2 };
+            int received[2] = { 0, 0 };
+
+            for (int step = 0; step < 3; ++step)
+            {
+              sent[0] = 10 * step;
+              sent[1] = 10 * step + 1;
+              net.RequestSendR(sent[0], Comms().Rank());
+              net.RequestSendR(sent[1], Comms().Rank());
+              net.RequestReceiveR(received[0], Comms().Rank());
+              net.RequestReceiveR(received[1], Comms().Rank());
+              net.Dispatch();
+
+              // The restarted requests carry the buffers' current contents.
+              CPPUNIT_ASSERT_EQUAL(10 * step, received[0]);
+              CPPUNIT_ASSERT_EQUAL(10 * step + 1, received[1]);
+            }
+
+            CPPUNIT_ASSERT_EQUAL(1u, net.GetPlansBuilt());
+          }
+
+          void TestChangedExchangeGetsNewPlan()
+          {
+            PersistentNet net(Comms());
+            int sent = 7;
+            int otherSent = 8;
+            int received = 0;
+
+            net.RequestSendR(sent, Comms().Rank());
+            net.RequestReceiveR(received, Comms().Rank());
+            net.Dispatch();
+            CPPUNIT_ASSERT_EQUAL(7, received);
+
+            // Sending from another buffer needs another plan...
+            net.RequestSendR(otherSent, Comms().Rank());
+            net.RequestReceiveR(received, Comms().Rank());
+            net.Dispatch();
+            CPPUNIT_ASSERT_EQUAL(8, received);
+            CPPUNIT_ASSERT_EQUAL(2u, net.GetPlansBuilt());
+
+            // ...but going back to the first reuses its plan.
+            sent = 9;
+            net.RequestSendR(sent, Comms().Rank());
+            net.RequestReceiveR(received, Comms().Rank());
+            net.Dispatch();
+            CPPUNIT_ASSERT_EQUAL(9, received);
+            CPPUNIT_ASSERT_EQUAL(2u, net.GetPlansBuilt());
+
+            // An exchange with nothing in it is fine too.
+            net.Dispatch();
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION (PersistentPointPointTests);
+    }
+  }
+}
+
+#endif // HEMELB_UNITTESTS_NET_PERSISTENTPOINTPOINTTESTS_H
@@ -9,5 +9,8 @@
 
 #include "unittests/net/phased/phased.h"
 #include "unittests/net/MpiTests.h"
+#include "unittests/net/ExchangeNotificationTests.h"
+#include "unittests/net/PersistentPointPointTests.h"
+#include "unittests/net/NeighbourhoodPointPointTests.h"
 
 #endif
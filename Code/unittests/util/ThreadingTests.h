@@ -0,0 +1,64 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UNITTESTS_UTIL_THREADINGTESTS_H
+#define HEMELB_UNITTESTS_UTIL_THREADINGTESTS_H
+
+#include <cppunit/TestFixture.h>
+#include "util/Threading.h"
+
+namespace hemelb
+{
+  namespace unittests
+  {
+    namespace util
+    {
+      using namespace hemelb::util;
+
+      class ThreadingTests : public CppUnit::TestFixture
+      {
+          CPPUNIT_TEST_SUITE(ThreadingTests);
+          CPPUNIT_TEST(TestThreadRangesCoverRange);
+          CPPUNIT_TEST(TestThreadRangesWithMoreThreadsThanSites);
+          CPPUNIT_TEST_SUITE_END();
+
+        public:
+          void TestThreadRangesCoverRange()
+          {
+            // 10 sites starting at 7, over 4 threads: 3, 3, 2, 2.
+            site_t expectedFirst[4] = { 7, 10, 13, 15 };
+            site_t expectedCount[4] = { 3, 3, 2, 2 };
+
+            for (int thread = 0; thread < 4; ++thread)
+            {
+              site_t first, count;
+              threading::GetThreadRange(7, 10, thread, 4, first, count);
+              CPPUNIT_ASSERT_EQUAL(expectedFirst[thread], first);
+              CPPUNIT_ASSERT_EQUAL(expectedCount[thread], count);
+            }
+          }
+
+          void TestThreadRangesWithMoreThreadsThanSites()
+          {
+            // Every site must be handled exactly once, and the ranges must be contiguous.
+            site_t next = 3;
+            for (int thread = 0; thread < 5; ++thread)
+            {
+              site_t first, count;
+              threading::GetThreadRange(3, 2, thread, 5, first, count);
+              CPPUNIT_ASSERT_EQUAL(next, first);
+              CPPUNIT_ASSERT(count == 0 || count == 1);
+              next += count;
+            }
+            CPPUNIT_ASSERT_EQUAL((site_t) 5, next);
+          }
+      };
+
+      CPPUNIT_TEST_SUITE_REGISTRATION(ThreadingTests);
+    }
+  }
+}
+
+#endif /* HEMELB_UNITTESTS_UTIL_THREADINGTESTS_H */
@@ -11,5 +11,6 @@
 #include "unittests/util/Matrix3DTests.h"
 #include "unittests/util/UnitConverterTests.h"
 #include "unittests/util/BesselTests.h"
+#include "unittests/util/ThreadingTests.h"
 
 #endif
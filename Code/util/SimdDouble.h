@@ -0,0 +1,203 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UTIL_SIMDDOUBLE_H
+#define HEMELB_UTIL_SIMDDOUBLE_H
+
+#if defined(HEMELB_USE_AVX512) || defined(HEMELB_USE_AVX2) || defined(HEMELB_USE_SSE3)
+  #include <immintrin.h>
+#endif
+
+namespace hemelb
+{
+  namespace util
+  {
+    /**
+     * A pack of doubles that are operated on together, one per lane. This is what the batched
+     * collision kernels use to work on several sites at once.
+     *
+     * The width is fixed at build time by the widest instruction set enabled: AVX-512 (8 lanes),
+     * AVX2 (4 lanes) or SSE3 (2 lanes). Without any of those we fall back to a plain loop over
+     * four doubles, which the compiler is free to vectorise for whatever the target is.
+     *
+     * Loads and stores are unaligned so callers don't need to worry about where their arrays
+     * start.
+     */
+    class SimdDouble
+    {
+      public:
+#if defined(HEMELB_USE_AVX512)
+        typedef __m512d Register;
+        static const unsigned WIDTH = 8;
+#elif defined(HEMELB_USE_AVX2)
+        typedef __m256d Register;
+        static const unsigned WIDTH = 4;
+#elif defined(HEMELB_USE_SSE3)
+        typedef __m128d Register;
+        static const unsigned WIDTH = 2;
+#else
+        static const unsigned WIDTH = 4;
+#endif
+
+        SimdDouble()
+        {
+        }
+
+        /**
+         * Broadcast a single value to all lanes.
+         * @param value
+         */
+        explicit SimdDouble(double value)
+        {
+#if defined(HEMELB_USE_AVX512)
+          reg = _mm512_set1_pd(value);
+#elif defined(HEMELB_USE_AVX2)
+          reg = _mm256_set1_pd(value);
+#elif defined(HEMELB_USE_SSE3)
+          reg = _mm_set1_pd(value);
+#else
+          for (unsigned lane = 0; lane < WIDTH; ++lane)
+          {
+            values[lane] = value;
+          }
+#endif
+        }
+
+        /**
+         * Load WIDTH consecutive values.
+         * @param source
+         * @return
+         */
+        static inline SimdDouble Load(const double* source)
+        {
+          SimdDouble ans;
+#if defined(HEMELB_USE_AVX512)
+          ans.reg = _mm512_loadu_pd(source);
+#elif defined(HEMELB_USE_AVX2)
+          ans.reg = _mm256_loadu_pd(source);
+#elif defined(HEMELB_USE_SSE3)
+          ans.reg = _mm_loadu_pd(source);
+#else
+          for (unsigned lane = 0; lane < WIDTH; ++lane)
+          {
+            ans.values[lane] = source[lane];
+          }
+#endif
+          return ans;
+        }
+
+        /**
+         * Store all lanes to WIDTH consecutive values.
+         * @param destination
+         */
+        inline void Store(double* destination) const
+        {
+#if defined(HEMELB_USE_AVX512)
+          _mm512_storeu_pd(destination, reg);
+#elif defined(HEMELB_USE_AVX2)
+          _mm256_storeu_pd(destination, reg);
+#elif defined(HEMELB_USE_SSE3)
+          _mm_storeu_pd(destination, reg);
+#else
+          for (unsigned lane = 0; lane < WIDTH; ++lane)
+          {
+            destination[lane] = values[lane];
+          }
+#endif
+        }
+
+        inline SimdDouble operator+(const SimdDouble& right) const
+        {
+          SimdDouble ans;
+#if defined(HEMELB_USE_AVX512)
+          ans.reg = _mm512_add_pd(reg, right.reg);
+#elif defined(HEMELB_USE_AVX2)
+          ans.reg = _mm256_add_pd(reg, right.reg);
+#elif defined(HEMELB_USE_SSE3)
+          ans.reg = _mm_add_pd(reg, right.reg);
+#else
+          for (unsigned lane = 0; lane < WIDTH; ++lane)
+          {
+            ans.values[lane] = values[lane] + right.values[lane];
+          }
+#endif
+          return ans;
+        }
+
+        inline SimdDouble operator-(const SimdDouble& right) const
+        {
+          SimdDouble ans;
+#if defined(HEMELB_USE_AVX512)
+          ans.reg = _mm512_sub_pd(reg, right.reg);
+#elif defined(HEMELB_USE_AVX2)
+          ans.reg = _mm256_sub_pd(reg, right.reg);
+#elif defined(HEMELB_USE_SSE3)
+          ans.reg = _mm_sub_pd(reg, right.reg);
+#else
+          for (unsigned lane = 0; lane < WIDTH; ++lane)
+          {
+            ans.values[lane] = values[lane] - right.values[lane];
+          }
+#endif
+          return ans;
+        }
+
+        inline SimdDouble operator*(const SimdDouble& right) const
+        {
+          SimdDouble ans;
+#if defined(HEMELB_USE_AVX512)
+          ans.reg = _mm512_mul_pd(reg, right.reg);
+#elif defined(HEMELB_USE_AVX2)
+          ans.reg = _mm256_mul_pd(reg, right.reg);
+#elif defined(HEMELB_USE_SSE3)
+          ans.reg = _mm_mul_pd(reg, right.reg);
+#else
+          for (unsigned lane = 0; lane < WIDTH; ++lane)
+          {
+            ans.values[lane] = values[lane] * right.values[lane];
+          }
+#endif
+          return ans;
+        }
+
+        inline SimdDouble operator/(const SimdDouble& right) const
+        {
+          SimdDouble ans;
+#if defined(HEMELB_USE_AVX512)
+          ans.reg = _mm512_div_pd(reg, right.reg);
+#elif defined(HEMELB_USE_AVX2)
+          ans.reg = _mm256_div_pd(reg, right.reg);
+#elif defined(HEMELB_USE_SSE3)
+          ans.reg = _mm_div_pd(reg, right.reg);
+#else
+          for (unsigned lane = 0; lane < WIDTH; ++lane)
+          {
+            ans.values[lane] = values[lane] / right.values[lane];
+          }
+#endif
+          return ans;
+        }
+
+        inline SimdDouble& operator+=(const SimdDouble& right)
+        {
+          return *this = *this + right;
+        }
+
+        inline SimdDouble& operator-=(const SimdDouble& right)
+        {
+          return *this = *this - right;
+        }
+
+      private:
+#if defined(HEMELB_USE_AVX512) || defined(HEMELB_USE_AVX2) || defined(HEMELB_USE_SSE3)
+        Register reg;
+#else
+        double values[WIDTH];
+#endif
+    };
+  }
+}
+
+#endif /* HEMELB_UTIL_SIMDDOUBLE_H */
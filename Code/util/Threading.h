@@ -0,0 +1,101 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UTIL_THREADING_H
+#define HEMELB_UTIL_THREADING_H
+
+#ifdef HEMELB_USE_OPENMP
+  #include <omp.h>
+#endif
+#include "units.h"
+
+namespace hemelb
+{
+  namespace util
+  {
+    /**
+     * Helpers for the optional on-node threading (HEMELB_USE_OPENMP). Without OpenMP these
+     * describe a single thread, so callers don't need their own ifdefs to get a range.
+     *
+     * Work is always divided into contiguous, statically assigned blocks of sites, so that a
+     * given thread touches the same part of the distribution arrays on every time step (and
+     * when they are first written, which determines the NUMA node the pages end up on).
+     */
+    namespace threading
+    {
+      /**
+       * @return The number of threads in the current parallel region (1 outside one).
+       */
+      inline int GetThreadCount()
+      {
+#ifdef HEMELB_USE_OPENMP
+        return omp_get_num_threads();
+#else
+        return 1;
+#endif
+      }
+
+      /**
+       * @return The largest number of threads a parallel region would have (1 without OpenMP).
+       */
+      inline int GetMaxThreadCount()
+      {
+#ifdef HEMELB_USE_OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+      }
+
+      /**
+       * @return This thread's number within the current parallel region (0 outside one).
+       */
+      inline int GetThreadNumber()
+      {
+#ifdef HEMELB_USE_OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+      }
+
+      /**
+       * Split the range [firstIndex, firstIndex + siteCount) into threadCount contiguous
+       * blocks whose sizes differ by at most one, and return the block for the given thread.
+       *
+       * @param firstIndex
+       * @param siteCount
+       * @param thread
+       * @param threadCount
+       * @param threadFirstIndex
+       * @param threadSiteCount
+       */
+      inline void GetThreadRange(const site_t firstIndex, const site_t siteCount, const int thread,
+                                 const int threadCount, site_t& threadFirstIndex, site_t& threadSiteCount)
+      {
+        const site_t baseCount = siteCount / threadCount;
+        const site_t remainder = siteCount % threadCount;
+
+        threadSiteCount = baseCount + (thread < remainder ?
+          1 :
+          0);
+        threadFirstIndex = firstIndex + thread * baseCount + (thread < remainder ?
+          thread :
+          remainder);
+      }
+
+      /**
+       * As above, for the calling thread of the current parallel region.
+       */
+      inline void GetThreadRange(const site_t firstIndex, const site_t siteCount, site_t& threadFirstIndex,
+                                 site_t& threadSiteCount)
+      {
+        GetThreadRange(firstIndex, siteCount, GetThreadNumber(), GetThreadCount(), threadFirstIndex, threadSiteCount);
+      }
+    }
+  }
+}
+
+#endif /* HEMELB_UTIL_THREADING_H */
@@ -0,0 +1,60 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_UTIL_UNINITIALISEDALLOCATOR_H
+#define HEMELB_UTIL_UNINITIALISEDALLOCATOR_H
+
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace hemelb
+{
+  namespace util
+  {
+    /**
+     * A std::allocator that default-initialises rather than value-initialises elements, so
+     * that resizing a std::vector of plain numbers leaves the new memory untouched.
+     *
+     * We use this for the distribution arrays so that the first write to each page happens
+     * in the (possibly threaded) code that fills them, rather than in std::vector::resize on
+     * the master thread.
+     */
+    template<typename T>
+    class UninitialisedAllocator : public std::allocator<T>
+    {
+      public:
+        template<typename U>
+        struct rebind
+        {
+            typedef UninitialisedAllocator<U> other;
+        };
+
+        UninitialisedAllocator()
+        {
+        }
+
+        template<typename U>
+        UninitialisedAllocator(const UninitialisedAllocator<U>& other) :
+            std::allocator<T>(other)
+        {
+        }
+
+        template<typename U>
+        void construct(U* pointer)
+        {
+          ::new (static_cast<void*>(pointer)) U;
+        }
+
+        template<typename U, typename ... Args>
+        void construct(U* pointer, Args&&... args)
+        {
+          ::new (static_cast<void*>(pointer)) U(std::forward<Args>(args)...);
+        }
+    };
+  }
+}
+
+#endif /* HEMELB_UTIL_UNINITIALISEDALLOCATOR_H */
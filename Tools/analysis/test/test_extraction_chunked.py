@@ -0,0 +1,157 @@
+
+# This file is part of HemeLB and is Copyright (C)
+# the HemeLB team and/or their institutions, as detailed in the
+# file AUTHORS. This software is provided under the terms of the
+# license in the file LICENSE.
+
+import os
+import shutil
+import tempfile
+import unittest
+import xdrlib
+import zlib
+
+import numpy as np
+
+from hemeTools.parsers import HemeLbMagicNumber
+from hemeTools.parsers.extraction import ExtractedProperty, ExtractionMagicNumber, \
+    ZlibCompression, Float32Encoding, Float16Encoding, QuantisedEncoding, \
+    QuantisedNonFiniteLevel, GridBlock, ValuesBlock
+
+VoxelSize = 1e-4
+Origin = (0.5, -0.25, 1.0)
+Fields = [('pressure', 1, 80.0, Float32Encoding),
+          ('velocity', 3, 0.0, Float16Encoding),
+          ('shearstress', 1, 0.0, QuantisedEncoding)]
+
+def Chunk(siteCount, data):
+    """A chunk as a core writes it: compressed only if that makes it shorter.
+    """
+    compressed = zlib.compress(data)
+    stored = compressed if len(compressed) < len(data) else data
+    header = xdrlib.Packer()
+    header.pack_uint(siteCount)
+    header.pack_uint(len(stored))
+    header.pack_uint(len(data))
+    return header.get_buffer() + stored + b'\0' * (-len(stored) % 4)
+
+def Block(blockType, time, chunks):
+    body = b''.join(chunks)
+    header = xdrlib.Packer()
+    header.pack_uint(blockType)
+    header.pack_uint(len(chunks))
+    header.pack_uhyper(time)
+    header.pack_uhyper(len(body))
+    return header.get_buffer() + body
+
+def Quantise(values):
+    finite = np.isfinite(values)
+    least, greatest = values[finite].min(), values[finite].max()
+    scale = (QuantisedNonFiniteLevel - 1.0) / (greatest - least) if greatest > least else 0.0
+    levels = np.round((values - least) * scale)
+    levels[~finite] = QuantisedNonFiniteLevel
+    return np.array([least, greatest], '>f8').tobytes() + levels.astype('>u2').tobytes()
+
+def ValuesChunk(values):
+    data = b''
+    for (name, length, offset, encoding) in Fields:
+        fieldValues = values[name] - offset
+        if encoding == Float32Encoding:
+            data += fieldValues.astype('>f4').tobytes()
+        elif encoding == Float16Encoding:
+            data += fieldValues.astype('>f2').tobytes()
+        else:
+            data += Quantise(fieldValues)
+        continue
+    return Chunk(len(values['pressure']), data)
+
+class TestExtractionChunked(unittest.TestCase):
+    """Read a file of the chunked format, as if written by two cores: one with
+    enough sites for its chunks to compress, and one with a single site,
+    whose chunks are stored as they are.
+    """
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        self.filename = os.path.join(self.dir, 'chunked.xtr')
+
+        rng = np.random.RandomState(42)
+        self.grids = [np.array([(i % 4, i // 4 % 4, i // 16) for i in xrange(32)], dtype=np.uint32),
+                      np.array([(7, 7, 7)], dtype=np.uint32)]
+        self.times = [0, 100]
+        self.values = {}
+        for time in self.times:
+            self.values[time] = [dict(pressure=80.0 + rng.uniform(size=len(grid)),
+                                      velocity=0.01 * rng.uniform(size=(len(grid), 3)),
+                                      shearstress=rng.uniform(size=len(grid)))
+                                 for grid in self.grids]
+            continue
+        # One of each kind of value the quantised encoding can't represent.
+        self.values[100][0]['shearstress'][3] = np.nan
+        self.values[100][0]['shearstress'][5] = np.inf
+
+        fieldHeader = xdrlib.Packer()
+        fieldHeader.pack_uint(ZlibCompression)
+        for (name, length, offset, encoding) in Fields:
+            fieldHeader.pack_string(name)
+            fieldHeader.pack_uint(length)
+            fieldHeader.pack_double(offset)
+            fieldHeader.pack_uint(encoding)
+            continue
+        fieldHeader = fieldHeader.get_buffer()
+
+        mainHeader = xdrlib.Packer()
+        mainHeader.pack_uint(HemeLbMagicNumber)
+        mainHeader.pack_uint(ExtractionMagicNumber)
+        mainHeader.pack_uint(5)
+        mainHeader.pack_double(VoxelSize)
+        for x in Origin:
+            mainHeader.pack_double(x)
+            continue
+        mainHeader.pack_uhyper(sum(len(grid) for grid in self.grids))
+        mainHeader.pack_uint(len(Fields))
+        mainHeader.pack_uint(len(fieldHeader))
+
+        contents = mainHeader.get_buffer() + fieldHeader
+        contents += Block(GridBlock, 0,
+                          [Chunk(len(grid), grid.astype('>u4').tobytes()) for grid in self.grids])
+        for time in self.times:
+            contents += Block(ValuesBlock, time,
+                              [ValuesChunk(values) for values in self.values[time]])
+            continue
+        with open(self.filename, 'wb') as f:
+            f.write(contents)
+        return
+
+    def tearDown(self):
+        shutil.rmtree(self.dir)
+
+    def test_times(self):
+        extracted = ExtractedProperty(self.filename)
+        self.assertEqual(self.times, list(extracted.times))
+
+    def test_grid(self):
+        extracted = ExtractedProperty(self.filename)
+        data = extracted.GetByTimeStep(0)
+        self.assertTrue((np.concatenate(self.grids) == data.grid).all())
+        self.assertTrue(np.allclose(VoxelSize * np.concatenate(self.grids) + Origin, data.position))
+
+    def test_values(self):
+        extracted = ExtractedProperty(self.filename)
+        for time in self.times:
+            data = extracted.GetByTimeStep(time)
+            pressure = np.concatenate([values['pressure'] for values in self.values[time]])
+            self.assertTrue(np.allclose(pressure, data.pressure, atol=1e-5))
+            velocity = np.concatenate([values['velocity'] for values in self.values[time]])
+            self.assertTrue(np.allclose(velocity, data.velocity.reshape(velocity.shape), atol=1e-5))
+            continue
+
+    def test_quantised_non_finite(self):
+        extracted = ExtractedProperty(self.filename)
+        shearStress = extracted.GetByTimeStep(100).shearstress
+        expected = np.concatenate([values['shearstress'] for values in self.values[100]])
+        finite = np.isfinite(expected)
+        self.assertTrue(np.isnan(shearStress[~finite]).all())
+        self.assertTrue(np.allclose(expected[finite], shearStress[finite], atol=1e-4))
+
+if __name__ == '__main__':
+    unittest.main()
@@ -6,6 +6,7 @@
 
 import os.path
 import xdrlib
+import zlib
 import numpy as np
 
 from .. import HemeLbMagicNumber
@@ -14,6 +15,14 @@ ExtractionMagicNumber = 0x78747204
 MainHeaderLength = 60
 TimeStepDataLength = 8
 
+# The chunked format, version 5
+NoCompression, ZlibCompression = 0, 1
+Float32Encoding, Float16Encoding, QuantisedEncoding = 0, 1, 2
+QuantisedNonFiniteLevel = 65535
+GridBlock, ValuesBlock = 1, 2
+BlockHeaderLength = 24
+ChunkHeaderLength = 12
+
 class FieldSpec(object):
     """Represent the data type of a single record in both XDR format and
     the native (fast) format of the machine.
@@ -132,11 +141,143 @@ class ExtractedPropertyV4Parser(object):
             return data + operand
         pass
 
+class ExtractedPropertyV5Parser(object):
+    """Parser for the chunked format, where each block is made of a chunk from
+    each core, and the sites' positions are only stored in grid blocks, when
+    they change.
+    """
+    def __init__(self, fieldCount, siteCount):
+        self._fieldCount = fieldCount
+        self._siteCount = siteCount
+
+    def ParseFieldHeader(self, decoder):
+        self._fieldSpec = FieldSpec([('id', None, np.uint64, 1, None),
+                               ('position', None, np.float32, (3,), None)])
+        self._compression = decoder.unpack_uint()
+        self._fields = []
+
+        for iField in xrange(self._fieldCount):
+            name = decoder.unpack_string()
+            length = decoder.unpack_uint()
+            offset = decoder.unpack_double()
+            encoding = decoder.unpack_uint()
+            self._fields.append((name, length, offset, encoding))
+            self._fieldSpec.Append(name, length, '>f4', np.float32)
+            continue
+        return self._fieldSpec
+
+    def ScanBlocks(self, dataFile, start, filesize):
+        """Find the values blocks in the file, with their time steps, and the
+        grid block that each goes with.
+        """
+        times = []
+        self._blocks = []
+        gridOffset = None
+        pos = start
+        while pos < filesize:
+            dataFile.seek(pos)
+            header = dataFile.read(BlockHeaderLength)
+            assert len(header) == BlockHeaderLength, \
+                "Extraction file appears to have a partial block header"
+            decoder = xdrlib.Unpacker(header)
+            blockType = decoder.unpack_uint()
+            chunkCount = decoder.unpack_uint()
+            time = decoder.unpack_uhyper()
+            length = decoder.unpack_uhyper()
+
+            if blockType == GridBlock:
+                gridOffset = pos
+            elif blockType == ValuesBlock:
+                assert gridOffset is not None, \
+                    "Extraction file has values before any grid block"
+                times.append(time)
+                self._blocks.append((pos, gridOffset))
+            else:
+                raise ValueError("Unknown block type {0} in extraction file".format(blockType))
+
+            pos += BlockHeaderLength + length
+            continue
+
+        assert pos == filesize, "Extraction file appears to have a partial block"
+        return np.array(times, dtype=int)
+
+    def Load(self, filename, idx):
+        """Decode the values block of the time index, and its grid block.
+        """
+        valuesOffset, gridOffset = self._blocks[idx]
+        dataFile = file(filename, 'rb')
+        try:
+            gridChunks = self._ReadChunks(dataFile, gridOffset)
+            valueChunks = self._ReadChunks(dataFile, valuesOffset)
+        finally:
+            dataFile.close()
+
+        result = np.recarray(self._siteCount, dtype=self._fieldSpec.GetMem())
+        result.grid = np.concatenate(
+            [np.frombuffer(data, dtype='>u4').reshape((siteCount, 3))
+             for siteCount, data in gridChunks])
+
+        fieldValues = [[] for field in self._fields]
+        for siteCount, data in valueChunks:
+            pos = 0
+            for (name, length, offset, encoding), values in zip(self._fields, fieldValues):
+                count = siteCount * length
+                if encoding == Float32Encoding:
+                    chunkValues = np.frombuffer(data, '>f4', count, pos).astype(np.float32)
+                    pos += 4 * count
+                elif encoding == Float16Encoding:
+                    chunkValues = np.frombuffer(data, '>f2', count, pos).astype(np.float32)
+                    pos += 2 * count
+                elif encoding == QuantisedEncoding:
+                    least, greatest = np.frombuffer(data, '>f8', 2, pos)
+                    pos += 16
+                    levels = np.frombuffer(data, '>u2', count, pos)
+                    pos += 2 * count
+                    chunkValues = least + levels * ((greatest - least) / (QuantisedNonFiniteLevel - 1.0))
+                    chunkValues[levels == QuantisedNonFiniteLevel] = np.nan
+                else:
+                    raise ValueError("Unknown encoding {0} of field '{1}'".format(encoding, name))
+                values.append(chunkValues + offset)
+                continue
+            continue
+
+        for (name, length, offset, encoding), values in zip(self._fields, fieldValues):
+            shape = (self._siteCount, length) if length > 1 else (self._siteCount,)
+            setattr(result, name, np.concatenate(values).reshape(shape))
+            continue
+        return result
+
+    def _ReadChunks(self, dataFile, pos):
+        """Read the chunks of the block at pos, returning the number of sites
+        and the decompressed data of each.
+        """
+        dataFile.seek(pos)
+        decoder = xdrlib.Unpacker(dataFile.read(BlockHeaderLength))
+        blockType = decoder.unpack_uint()
+        chunkCount = decoder.unpack_uint()
+
+        chunks = []
+        for iChunk in xrange(chunkCount):
+            decoder = xdrlib.Unpacker(dataFile.read(ChunkHeaderLength))
+            siteCount = decoder.unpack_uint()
+            storedLength = decoder.unpack_uint()
+            rawLength = decoder.unpack_uint()
+            data = dataFile.read((storedLength + 3) // 4 * 4)[:storedLength]
+            # Chunks that wouldn't compress are stored as they are.
+            if self._compression == ZlibCompression and storedLength < rawLength:
+                data = zlib.decompress(data)
+            assert len(data) == rawLength, "Extraction file chunk has the wrong length"
+            chunks.append((siteCount, data))
+            continue
+        return chunks
+
+    pass
+
 class ExtractedProperty(object):
     """Represent the contents of a HemeLB property extraction file.
     
     """
-    HandledVersions = [3,4]
+    HandledVersions = [3,4,5]
 
     def __init__(self, filename):
         """Read the file's headers and determine how many times and which times
@@ -182,6 +323,9 @@ class ExtractedProperty(object):
             self.parser = ExtractedPropertyV3Parser(self.fieldCount, self.siteCount)
         elif version == 4:
             self.parser = ExtractedPropertyV4Parser(self.fieldCount, self.siteCount)
+        elif version == 5:
+            self.parser = ExtractedPropertyV5Parser(self.fieldCount, self.siteCount)
+        self.version = version
         return
 
     def _ReadFieldHeader(self):
@@ -212,6 +356,13 @@ class ExtractedProperty(object):
         """
         filesize = os.path.getsize(self.filename)
         self._totalHeaderLength = MainHeaderLength + self._fieldHeaderLength
+        if self.version == 5:
+            times = self.parser.ScanBlocks(self._file, self._totalHeaderLength, filesize)
+            assert np.alltrue(np.argsort(times) == np.arange(len(times))), \
+                "Times in extraction file are not monotonically increasing!"
+            self.times = times
+            return
+
         bodysize = filesize - self._totalHeaderLength
         assert bodysize % self._recordLength == 0, \
             "Extraction file appears to have partial record(s), residual %s / %s , bodysize %s"%(bodysize % self._recordLength,self._recordLength,bodysize)
@@ -272,9 +423,11 @@ class ExtractedProperty(object):
         
         Fields are as specified in the file with the addition of 
         """
-        mapped = self._MemMap(idx)
-
-        answer = self.parser.parse(mapped)
+        if self.version == 5:
+            answer = self.parser.Load(self.filename, idx)
+        else:
+            mapped = self._MemMap(idx)
+            answer = self.parser.parse(mapped)
         
         answer.id = np.arange(self.siteCount)
         answer.position = self.voxelSizeMetres * answer.grid + self.originMetres